@@ -119,6 +119,9 @@ BelCardParser::BelCardParser(bool useVCard3Grammar) {
 	BelCardBirthPlace::setHandlerAndCollectors(_parser, _v3);
 	BelCardDeathPlace::setHandlerAndCollectors(_parser, _v3);
 	BelCardDeathDate::setHandlerAndCollectors(_parser, _v3);
+
+	// Every property alternative starts with an optional group, don't parse it again for each of them.
+	_parser->memoizeRule("group");
 }
 
 BelCardParser::~BelCardParser() {
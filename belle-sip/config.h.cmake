@@ -37,6 +37,7 @@
 #cmakedefine HAVE_CLOCK_GETTIME
 
 #cmakedefine HAVE_RESINIT
+#cmakedefine HAVE_EPOLL
 
 #cmakedefine HAVE_TUNNEL
 #cmakedefine HAVE_ZLIB
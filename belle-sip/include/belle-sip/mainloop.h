@@ -62,11 +62,31 @@ BELLESIP_EXPORT void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, b
 
 BELLESIP_EXPORT void belle_sip_main_loop_remove_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source);
 
+typedef enum belle_sip_main_loop_backend {
+	BELLE_SIP_MAIN_LOOP_BACKEND_DEFAULT, /* epoll when available, poll otherwise */
+	BELLE_SIP_MAIN_LOOP_BACKEND_POLL,    /* poll(), or WaitForMultipleObjectsEx() on Windows */
+	BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL    /* Linux only */
+} belle_sip_main_loop_backend_t;
+
 /**
  * Creates a mainloop.
  **/
 BELLESIP_EXPORT belle_sip_main_loop_t *belle_sip_main_loop_new(void);
 
+/**
+ * Creates a mainloop waiting for events with the given backend.
+ * The poll backend rebuilds the set of watched sockets at each iteration, so that an iteration costs O(n) in the
+ * number of sockets. The epoll backend only updates the watched set when sources are added, removed or have their
+ * events changed, and an iteration only costs the number of ready sockets.
+ * The poll backend is used when the requested one is not available on the platform.
+ **/
+BELLESIP_EXPORT belle_sip_main_loop_t *belle_sip_main_loop_new_with_backend(belle_sip_main_loop_backend_t backend);
+
+/**
+ * Returns the backend actually used by the mainloop, never BELLE_SIP_MAIN_LOOP_BACKEND_DEFAULT.
+ **/
+BELLESIP_EXPORT belle_sip_main_loop_backend_t belle_sip_main_loop_get_backend(const belle_sip_main_loop_t *ml);
+
 /**
  * Adds a timeout into the main loop
  * @param ml
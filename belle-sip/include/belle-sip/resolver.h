@@ -49,6 +49,17 @@ typedef void (*belle_sip_resolver_srv_callback_t)(void *data,
  **/
 typedef void (*belle_sip_resolver_callback_t)(void *data, belle_sip_resolver_results_t *results);
 
+/**
+ * Counters of the DNS cache of a stack, see belle_sip_stack_get_dns_cache_stats().
+ **/
+typedef struct belle_sip_dns_cache_stats {
+	unsigned int hits;      /**< resolutions answered from the cache */
+	unsigned int misses;    /**< DNS queries sent because the answer was not in the cache */
+	unsigned int coalesced; /**< resolutions that waited for the answer of a query already sent for the same name */
+	unsigned int entries;   /**< answers currently in the cache, including the ones of the pending queries */
+	unsigned int evicted;   /**< answers removed before their expiration to keep the size of the cache bounded */
+} belle_sip_dns_cache_stats_t;
+
 BELLE_SIP_BEGIN_DECLS
 
 BELLESIP_EXPORT const char *belle_sip_dns_srv_get_target(const belle_sip_dns_srv_t *obj);
@@ -135,6 +146,33 @@ BELLESIP_EXPORT belle_sip_resolver_context_t *belle_sip_stack_resolve_srv(belle_
  **/
 BELLESIP_EXPORT int belle_sip_resolver_context_cancel(belle_sip_resolver_context_t *ctx);
 
+/**
+ * Enables or disables the DNS cache of the stack, enabled by default.
+ * The A, AAAA and SRV answers are kept for the TTL given by the DNS server, and the absence of record for the negative
+ * caching TTL of the zone. The resolutions of a name whose query is already pending wait for its answer instead of
+ * sending another query. Disabling the cache flushes it.
+ **/
+BELLESIP_EXPORT void belle_sip_stack_enable_dns_cache(belle_sip_stack_t *stack, unsigned char enable);
+
+BELLESIP_EXPORT unsigned char belle_sip_stack_dns_cache_enabled(const belle_sip_stack_t *stack);
+
+/**
+ * Removes all the answers from the DNS cache. The answers of the pending queries are still notified, but not kept.
+ **/
+BELLESIP_EXPORT void belle_sip_stack_flush_dns_cache(belle_sip_stack_t *stack);
+
+/**
+ * Sends in background the DNS queries that a SIP resolution of this domain would need, so that their answers are in
+ * the cache when it is done: the SRV queries for the udp, tcp and tls transports, and the A and AAAA queries for the
+ * domain and the targets of its SRV records.
+ * @param stack the stack
+ * @param domain the SIP domain, typically the one of a configured proxy
+ **/
+BELLESIP_EXPORT void belle_sip_stack_prewarm_dns_cache(belle_sip_stack_t *stack, const char *domain);
+
+BELLESIP_EXPORT void belle_sip_stack_get_dns_cache_stats(const belle_sip_stack_t *stack,
+                                                         belle_sip_dns_cache_stats_t *stats);
+
 /**
  * Lookups the source address from local interface that can be used to connect to a destination address.
  * local_port is only used to be assigned into the result source address.
@@ -20,6 +20,7 @@
 #include "belle-sip/headers.h"
 #include "belle-sip/parameters.h"
 #include "sip/sip_parser.hh"
+#include <ctype.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,7 +32,159 @@
  * header
  ***********************/
 
-GET_SET_STRING(belle_sip_header, name);
+struct well_known_header {
+	const char *name;
+	size_t length;
+};
+
+#define WELL_KNOWN_HEADER(name)                                                                                        \
+	{ name, sizeof(name) - 1 }
+
+/*in the order of belle_sip_header_id_t*/
+static const struct well_known_header well_known_headers[] = {{NULL, 0},
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_VIA),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_FROM),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_TO),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_CALL_ID),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_CSEQ),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_CONTACT),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_MAX_FORWARDS),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_CONTENT_LENGTH),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_CONTENT_TYPE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_ROUTE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_RECORD_ROUTE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_SERVICE_ROUTE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_EXPIRES),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_ALLOW),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_SUPPORTED),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_REQUIRE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_USER_AGENT),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_AUTHORIZATION),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_PROXY_AUTHORIZATION),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_WWW_AUTHENTICATE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_PROXY_AUTHENTICATE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_AUTHENTICATION_INFO),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_EVENT),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_SUBSCRIPTION_STATE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_SESSION_EXPIRES),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_REASON),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_DATE),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_PRIVACY),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_P_PREFERRED_IDENTITY),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_REFER_TO),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_REFERRED_BY),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_REPLACES),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_DIVERSION),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_RETRY_AFTER),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_CONTENT_DISPOSITION),
+                                                              WELL_KNOWN_HEADER(BELLE_SIP_ACCEPT)};
+
+static_assert(sizeof(well_known_headers) / sizeof(well_known_headers[0]) == BELLE_SIP_HEADER_ID_COUNT,
+              "well_known_headers must have an entry per belle_sip_header_id_t");
+
+belle_sip_header_id_t belle_sip_header_id_from_name(const char *name) {
+	size_t length = strlen(name);
+	int first = tolower((unsigned char)name[0]);
+	int i;
+	for (i = 1; i < BELLE_SIP_HEADER_ID_COUNT; i++) {
+		const struct well_known_header *header = &well_known_headers[i];
+		if (header->length == length && tolower((unsigned char)header->name[0]) == first &&
+		    strcasecmp(header->name, name) == 0)
+			return (belle_sip_header_id_t)i;
+	}
+	return BELLE_SIP_HEADER_ID_OTHER;
+}
+
+belle_sip_header_id_t belle_sip_header_id_from_type_id(belle_sip_type_id_t type_id) {
+	switch (type_id) {
+		case BELLE_SIP_TYPE_ID(belle_sip_header_via_t):
+			return BELLE_SIP_HEADER_ID_VIA;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_from_t):
+			return BELLE_SIP_HEADER_ID_FROM;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_to_t):
+			return BELLE_SIP_HEADER_ID_TO;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_call_id_t):
+			return BELLE_SIP_HEADER_ID_CALL_ID;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_cseq_t):
+			return BELLE_SIP_HEADER_ID_CSEQ;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_contact_t):
+			return BELLE_SIP_HEADER_ID_CONTACT;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_max_forwards_t):
+			return BELLE_SIP_HEADER_ID_MAX_FORWARDS;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_content_length_t):
+			return BELLE_SIP_HEADER_ID_CONTENT_LENGTH;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_content_type_t):
+			return BELLE_SIP_HEADER_ID_CONTENT_TYPE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_route_t):
+			return BELLE_SIP_HEADER_ID_ROUTE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_record_route_t):
+			return BELLE_SIP_HEADER_ID_RECORD_ROUTE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_service_route_t):
+			return BELLE_SIP_HEADER_ID_SERVICE_ROUTE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_expires_t):
+			return BELLE_SIP_HEADER_ID_EXPIRES;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_allow_t):
+			return BELLE_SIP_HEADER_ID_ALLOW;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_supported_t):
+			return BELLE_SIP_HEADER_ID_SUPPORTED;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_require_t):
+			return BELLE_SIP_HEADER_ID_REQUIRE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_user_agent_t):
+			return BELLE_SIP_HEADER_ID_USER_AGENT;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_authorization_t):
+			return BELLE_SIP_HEADER_ID_AUTHORIZATION;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_proxy_authorization_t):
+			return BELLE_SIP_HEADER_ID_PROXY_AUTHORIZATION;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_www_authenticate_t):
+			return BELLE_SIP_HEADER_ID_WWW_AUTHENTICATE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_proxy_authenticate_t):
+			return BELLE_SIP_HEADER_ID_PROXY_AUTHENTICATE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_authentication_info_t):
+			return BELLE_SIP_HEADER_ID_AUTHENTICATION_INFO;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_event_t):
+			return BELLE_SIP_HEADER_ID_EVENT;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_subscription_state_t):
+			return BELLE_SIP_HEADER_ID_SUBSCRIPTION_STATE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_session_expires_t):
+			return BELLE_SIP_HEADER_ID_SESSION_EXPIRES;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_reason_t):
+			return BELLE_SIP_HEADER_ID_REASON;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_date_t):
+			return BELLE_SIP_HEADER_ID_DATE;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_privacy_t):
+			return BELLE_SIP_HEADER_ID_PRIVACY;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_p_preferred_identity_t):
+			return BELLE_SIP_HEADER_ID_P_PREFERRED_IDENTITY;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_refer_to_t):
+			return BELLE_SIP_HEADER_ID_REFER_TO;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_referred_by_t):
+			return BELLE_SIP_HEADER_ID_REFERRED_BY;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_replaces_t):
+			return BELLE_SIP_HEADER_ID_REPLACES;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_diversion_t):
+			return BELLE_SIP_HEADER_ID_DIVERSION;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_retry_after_t):
+			return BELLE_SIP_HEADER_ID_RETRY_AFTER;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_content_disposition_t):
+			return BELLE_SIP_HEADER_ID_CONTENT_DISPOSITION;
+		case BELLE_SIP_TYPE_ID(belle_sip_header_accept_t):
+			return BELLE_SIP_HEADER_ID_ACCEPT;
+		default:
+			return BELLE_SIP_HEADER_ID_OTHER;
+	}
+}
+
+const char *belle_sip_header_get_name(const belle_sip_header_t *obj) {
+	return obj->name;
+}
+
+void belle_sip_header_set_name(belle_sip_header_t *obj, const char *value) {
+	char *previous_value = obj->name; /*preserve if same value re-asigned*/
+	obj->name = value ? belle_sip_strdup(value) : NULL;
+	obj->id = value ? belle_sip_header_id_from_name(value) : BELLE_SIP_HEADER_ID_OTHER;
+	if (previous_value != NULL) belle_sip_free(previous_value);
+}
+
 #define PROTO_SIP 0x1
 #define PROTO_HTTP 0x1 << 1
 typedef belle_sip_header_t *(*header_parse_func)(const char *);
@@ -128,6 +281,7 @@ void belle_sip_header_init(belle_sip_header_t *header) {
 
 static void belle_sip_header_clone(belle_sip_header_t *header, const belle_sip_header_t *orig) {
 	CLONE_STRING(belle_sip_header, name, header, orig)
+	header->id = orig->id;
 	if (belle_sip_header_get_next(orig)) {
 		belle_sip_header_set_next(
 		    header, BELLE_SIP_HEADER(belle_sip_object_clone(BELLE_SIP_OBJECT(belle_sip_header_get_next(orig)))));
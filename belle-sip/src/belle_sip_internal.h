@@ -314,7 +314,11 @@ struct belle_sip_source {
 	unsigned char expired;
 	unsigned char oneshot;
 	unsigned char notify_required; /*for testing purpose, use to ask for being scheduled*/
-	bctbx_iterator_t *it;          /*for fast removal*/
+	unsigned char registered;      /* watched by the epoll backend, with registered_fd and registered_events */
+	belle_sip_fd_t registered_fd;
+	unsigned short registered_events;
+	struct belle_sip_source *timer_prev, *timer_next; /* links in the timer wheel list given by timer_slot */
+	unsigned short timer_slot;                        /* 0 when not in the timer wheel */
 	belle_sip_main_loop_t *ml;
 };
 
@@ -335,6 +339,8 @@ belle_sip_source_t *belle_sip_fd_source_new(
 void belle_sip_source_uninit(belle_sip_source_t *s);
 void belle_sip_source_reset(belle_sip_source_t *s);
 void belle_sip_source_set_notify(belle_sip_source_t *s, belle_sip_source_func_t func);
+/*for testing purpose, asks the main loop to notify the source with BELLE_SIP_EVENT_READ at next iteration*/
+void belle_sip_source_set_notify_required(belle_sip_source_t *s, unsigned char yesno);
 
 /* include private headers */
 #include "channel.h"
@@ -344,6 +350,31 @@ void belle_sip_source_set_notify(belle_sip_source_t *s, belle_sip_source_func_t
 
 #define belle_sip_list_next(elem) ((elem)->next)
 
+/*
+ * Hash index of objects by a string key, that the index gets from the objects themselves with get_key(). The key of an
+ * object must not change while it is in the index.
+ */
+typedef struct belle_sip_hash_index belle_sip_hash_index_t;
+typedef const char *(*belle_sip_hash_index_key_func_t)(const void *obj);
+
+belle_sip_hash_index_t *belle_sip_hash_index_new(belle_sip_hash_index_key_func_t get_key);
+void belle_sip_hash_index_destroy(belle_sip_hash_index_t *index);
+void belle_sip_hash_index_add(belle_sip_hash_index_t *index, void *obj);
+/*returns 0 if the object was removed, -1 if it was not in the index*/
+int belle_sip_hash_index_remove(belle_sip_hash_index_t *index, void *obj);
+/*returns the first object with this key for which compare_func returns 0, the last added first*/
+void *belle_sip_hash_index_find_custom(const belle_sip_hash_index_t *index,
+                                       const char *key,
+                                       belle_sip_compare_func compare_func,
+                                       const void *user_data);
+/*returns the first object for which compare_func returns 0, whatever its key*/
+void *belle_sip_hash_index_find_any(const belle_sip_hash_index_t *index,
+                                    belle_sip_compare_func compare_func,
+                                    const void *user_data);
+/*returns a list of all the objects, to be freed with belle_sip_list_free()*/
+belle_sip_list_t *belle_sip_hash_index_get_all(const belle_sip_hash_index_t *index);
+size_t belle_sip_hash_index_get_count(const belle_sip_hash_index_t *index);
+
 #undef MIN
 #define MIN(a, b) ((a) > (b) ? (b) : (a))
 #undef MAX
@@ -611,12 +642,62 @@ belle_sip_param_pair_t *belle_sip_param_pair_ref(belle_sip_param_pair_t *obj);
 
 void belle_sip_param_pair_unref(belle_sip_param_pair_t *obj);
 
+/*
+ * The headers known by the stack, identified by their full name (case insensitive). The messages keep them in fixed
+ * slots, so that looking them up does not need to compare their name with the ones of all the other headers.
+ */
+typedef enum belle_sip_header_id {
+	BELLE_SIP_HEADER_ID_OTHER = 0, /*any other name, including the compact forms*/
+	BELLE_SIP_HEADER_ID_VIA,
+	BELLE_SIP_HEADER_ID_FROM,
+	BELLE_SIP_HEADER_ID_TO,
+	BELLE_SIP_HEADER_ID_CALL_ID,
+	BELLE_SIP_HEADER_ID_CSEQ,
+	BELLE_SIP_HEADER_ID_CONTACT,
+	BELLE_SIP_HEADER_ID_MAX_FORWARDS,
+	BELLE_SIP_HEADER_ID_CONTENT_LENGTH,
+	BELLE_SIP_HEADER_ID_CONTENT_TYPE,
+	BELLE_SIP_HEADER_ID_ROUTE,
+	BELLE_SIP_HEADER_ID_RECORD_ROUTE,
+	BELLE_SIP_HEADER_ID_SERVICE_ROUTE,
+	BELLE_SIP_HEADER_ID_EXPIRES,
+	BELLE_SIP_HEADER_ID_ALLOW,
+	BELLE_SIP_HEADER_ID_SUPPORTED,
+	BELLE_SIP_HEADER_ID_REQUIRE,
+	BELLE_SIP_HEADER_ID_USER_AGENT,
+	BELLE_SIP_HEADER_ID_AUTHORIZATION,
+	BELLE_SIP_HEADER_ID_PROXY_AUTHORIZATION,
+	BELLE_SIP_HEADER_ID_WWW_AUTHENTICATE,
+	BELLE_SIP_HEADER_ID_PROXY_AUTHENTICATE,
+	BELLE_SIP_HEADER_ID_AUTHENTICATION_INFO,
+	BELLE_SIP_HEADER_ID_EVENT,
+	BELLE_SIP_HEADER_ID_SUBSCRIPTION_STATE,
+	BELLE_SIP_HEADER_ID_SESSION_EXPIRES,
+	BELLE_SIP_HEADER_ID_REASON,
+	BELLE_SIP_HEADER_ID_DATE,
+	BELLE_SIP_HEADER_ID_PRIVACY,
+	BELLE_SIP_HEADER_ID_P_PREFERRED_IDENTITY,
+	BELLE_SIP_HEADER_ID_REFER_TO,
+	BELLE_SIP_HEADER_ID_REFERRED_BY,
+	BELLE_SIP_HEADER_ID_REPLACES,
+	BELLE_SIP_HEADER_ID_DIVERSION,
+	BELLE_SIP_HEADER_ID_RETRY_AFTER,
+	BELLE_SIP_HEADER_ID_CONTENT_DISPOSITION,
+	BELLE_SIP_HEADER_ID_ACCEPT,
+	BELLE_SIP_HEADER_ID_COUNT
+} belle_sip_header_id_t;
+
+belle_sip_header_id_t belle_sip_header_id_from_name(const char *name);
+/*returns the id of the header name used by the headers of this type*/
+belle_sip_header_id_t belle_sip_header_id_from_type_id(belle_sip_type_id_t type_id);
+
 /*class header*/
 struct _belle_sip_header {
 	belle_sip_object_t base;
 	belle_sip_header_t *next;
 	char *name;
 	char *unparsed_value;
+	belle_sip_header_id_t id; /*computed from the name when it is set*/
 };
 
 void belle_sip_response_fill_for_dialog(belle_sip_response_t *obj, belle_sip_request_t *req);
@@ -698,6 +779,18 @@ struct belle_sip_hop {
 	char *channel_bank_identifier;
 };
 
+/*
+ DNS cache shared by the resolutions of a stack, see belle_sip_resolver.c
+*/
+typedef struct belle_sip_dns_cache belle_sip_dns_cache_t;
+
+belle_sip_dns_cache_t *belle_sip_dns_cache_new(belle_sip_stack_t *stack);
+/*cancels the pending queries, their waiting resolutions are never notified*/
+void belle_sip_dns_cache_destroy(belle_sip_dns_cache_t *cache);
+void belle_sip_dns_cache_flush(belle_sip_dns_cache_t *cache);
+/*above this number of entries, the oldest answers are evicted*/
+void belle_sip_dns_cache_set_max_entries(belle_sip_dns_cache_t *cache, size_t max_entries);
+
 /*
  belle_sip_stack_t
 */
@@ -723,6 +816,7 @@ struct belle_sip_stack {
 	bctbx_list_t *user_host_entries; /*list of belle_sip_param_pair_t* storing user provided dns entries name  for
 	                                    hostname, value for ip value*/
 	belle_sip_list_t *dns_servers;   /*used when dns servers are supplied by app layer*/
+	belle_sip_dns_cache_t *dns_cache;
 	/*http proxy stuff to be used by both http and sip provider*/
 	char *http_proxy_host;
 	int http_proxy_port;
@@ -737,6 +831,7 @@ struct belle_sip_stack {
 	unsigned char dns_search_enabled;
 	unsigned char reconnect_to_primary_asap;
 	unsigned char simulate_non_working_srv;
+	unsigned char dns_cache_enabled;
 	unsigned char
 	    ai_family_preference; /* AF_INET or AF_INET6, the address family to try first for outgoing connections.*/
 #ifdef HAVE_DNS_SERVICE
@@ -749,8 +844,9 @@ BELLESIP_EXPORT belle_sip_hop_t *
 belle_sip_hop_new(const char *transport, const char *cname, const char *host, int port);
 BELLESIP_EXPORT belle_sip_hop_t *belle_sip_hop_new_from_uri(const belle_sip_uri_t *uri);
 BELLESIP_EXPORT belle_sip_hop_t *belle_sip_hop_new_from_generic_uri(const belle_generic_uri_t *uri);
-void belle_sip_hop_set_channel_bank_identifier(belle_sip_hop_t *hop, const char *channel_bank_identifier);
-const char *belle_sip_hop_get_channel_bank_identifier(const belle_sip_hop_t *hop);
+BELLESIP_EXPORT void belle_sip_hop_set_channel_bank_identifier(belle_sip_hop_t *hop,
+                                                               const char *channel_bank_identifier);
+BELLESIP_EXPORT const char *belle_sip_hop_get_channel_bank_identifier(const belle_sip_hop_t *hop);
 
 BELLESIP_EXPORT belle_sip_hop_t *belle_sip_stack_get_next_hop(belle_sip_stack_t *stack, belle_sip_request_t *req);
 /* Return -1 if requested authentication is not compatible with local digest authentication security policy, 0 if
@@ -768,9 +864,9 @@ struct belle_sip_provider {
 	belle_sip_list_t *lps; /*listening points*/
 	belle_sip_list_t *listeners;
 	belle_sip_list_t *internal_listeners; /*for transaction internaly managed by belle-sip. I.E by refreshers*/
-	belle_sip_list_t *client_transactions;
-	belle_sip_list_t *server_transactions;
-	belle_sip_list_t *dialogs;
+	belle_sip_hash_index_t *client_transactions; /*indexed by branch id*/
+	belle_sip_hash_index_t *server_transactions; /*indexed by branch id*/
+	belle_sip_hash_index_t *dialogs;             /*indexed by call-id*/
 	belle_sip_list_t *auth_contexts;
 	unsigned short unconditional_answer;
 	unsigned char rport_enabled; /*0 if rport should not be set in via header*/
@@ -830,13 +926,36 @@ belle_http_provider_t *belle_http_provider_new(belle_sip_stack_t *s, const char
  **/
 
 void belle_sip_message_init(belle_sip_message_t *message);
+/*same as belle_sip_message_get_header() and belle_sip_message_get_headers() for the well known headers*/
+belle_sip_header_t *belle_sip_message_get_header_by_id(const belle_sip_message_t *message, belle_sip_header_id_t id);
+const belle_sip_list_t *belle_sip_message_get_headers_by_id(const belle_sip_message_t *message,
+                                                            belle_sip_header_id_t id);
+/*
+ * The headers of a message as they were marshalled when it was last sent on an unreliable channel, kept so that its
+ * retransmissions are sent as is. They are invalidated when a header is added or removed, or when the body or the
+ * request uri is changed. Changes made to the header objects themselves are not tracked.
+ */
+BELLESIP_EXPORT void
+belle_sip_message_set_marshalled_headers(belle_sip_message_t *msg, const char *buffer, size_t size);
+/*returns NULL if there are none, or if they were invalidated*/
+BELLESIP_EXPORT const char *belle_sip_message_get_marshalled_headers(const belle_sip_message_t *msg, size_t *size);
+void belle_sip_message_invalidate_marshalled_headers(belle_sip_message_t *msg);
+/*frees the kept headers, once the message will no longer be retransmitted*/
+void belle_sip_message_release_marshalled_headers(belle_sip_message_t *msg);
+/*when enabled (the default), the start line and the most frequent headers are parsed by hand, not by the grammar*/
+BELLESIP_EXPORT void belle_sip_message_enable_fast_parser(bool_t enable);
 
 struct _belle_sip_message {
 	belle_sip_object_t base;
 	belle_sip_list_t *header_list;
+	/*the containers of header_list that hold the well known headers, indexed by header id*/
+	struct _headers_container *header_slots[BELLE_SIP_HEADER_ID_COUNT];
 	belle_sip_body_handler_t *body_handler;
 	char *multipart_body_cache;
 	char *channel_bank_identifier;
+	char *marshalled_headers;       /*see belle_sip_message_set_marshalled_headers()*/
+	size_t marshalled_headers_size; /*0 if the marshalled headers are not valid*/
+	size_t marshalled_headers_capacity;
 };
 
 struct _belle_sip_request {
@@ -1000,6 +1119,8 @@ void belle_sip_server_transaction_init(belle_sip_server_transaction_t *t,
                                        belle_sip_request_t *req);
 void belle_sip_server_transaction_on_request(belle_sip_server_transaction_t *t, belle_sip_request_t *req);
 void _belle_sip_server_transaction_send_response(belle_sip_server_transaction_t *t, belle_sip_response_t *resp);
+/*same as _belle_sip_server_transaction_send_response(), for a retransmission*/
+void _belle_sip_server_transaction_resend_response(belle_sip_server_transaction_t *t, belle_sip_response_t *resp);
 
 struct belle_sip_ist {
 	belle_sip_server_transaction_t base;
@@ -1278,6 +1399,12 @@ int belle_sip_body_handler_send_chunk(belle_sip_body_handler_t *obj,
                                       uint8_t *buf,
                                       size_t *size);
 void belle_sip_body_handler_end_transfer(belle_sip_body_handler_t *obj);
+/*
+ * Returns the content of a memory body handler so that a channel can send it without copying it, and accounts for its
+ * whole transfer. Returns NULL for the other body handlers, whose content has to be sent with
+ * belle_sip_body_handler_send_chunk().
+ */
+const uint8_t *belle_sip_body_handler_send_in_place(belle_sip_body_handler_t *obj, belle_sip_message_t *msg);
 
 BELLE_SIP_DECLARE_CUSTOM_VPTR_BEGIN(belle_sip_memory_body_handler_t, belle_sip_body_handler_t)
 BELLE_SIP_DECLARE_CUSTOM_VPTR_END
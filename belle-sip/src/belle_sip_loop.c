@@ -17,11 +17,14 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "bctoolbox/map.h"
 #include "belle-sip/belle-sip.h"
 #include "belle_sip_internal.h"
 #include <limits.h>
 
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifndef _WIN32
 #include <poll.h>
 #include <unistd.h>
@@ -247,19 +250,253 @@ void *belle_sip_source_get_user_data(const belle_sip_source_t *s) {
 void belle_sip_source_set_user_data(belle_sip_source_t *s, void *user_data) {
 	s->data = user_data;
 }
-int belle_sip_source_set_events(belle_sip_source_t *source, int event_mask) {
-	source->events = event_mask;
-	return 0;
-}
-
 belle_sip_socket_t belle_sip_source_get_socket(const belle_sip_source_t *source) {
 	return source->sock;
 }
 
+/*
+ * Hierarchical timer wheel holding the sources with a timeout, with O(1) insertion and removal.
+ * Level 0 has one slot per millisecond of the current 256 ms period, the upper levels one slot per period of the level
+ * below: a timer is put in the lowest level where its expiration date shares the period of the wheel's current time,
+ * and moved down ("cascaded") when the current time enters its slot. Expired timers wait in the due list until they
+ * are removed from the wheel or rescheduled, in expiration order for the same millisecond. Timers more than 2^32 ms
+ * away are kept in the far list, examined each time the highest level wraps.
+ */
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 8
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+/* values of belle_sip_source_t.timer_slot, 0 meaning not in the wheel */
+#define TIMER_WHEEL_SLOT_DUE (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 1)
+#define TIMER_WHEEL_SLOT_FAR (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 2)
+
+typedef struct belle_sip_timer_wheel {
+	uint64_t now; /* timers expiring at or before this date are in the due list */
+	size_t count;
+	belle_sip_source_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; /* circular lists, head->timer_prev is the tail */
+	uint64_t non_empty[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS / 64];
+	belle_sip_source_t *due;
+	belle_sip_source_t *far;
+} belle_sip_timer_wheel_t;
+
+static int belle_sip_timer_wheel_lowest_bit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(word);
+#else
+	int i = 0;
+	while (!(word & 1)) {
+		word >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
+
+/* returns the first non-empty slot of the level at or after index 'from', or -1 */
+static int belle_sip_timer_wheel_next_slot(const belle_sip_timer_wheel_t *w, int level, int from) {
+	int word = from / 64;
+	uint64_t bits;
+	if (from >= TIMER_WHEEL_SLOTS) return -1;
+	bits = w->non_empty[level][word] & (~(uint64_t)0 << (from % 64));
+	while (bits == 0) {
+		if (++word == TIMER_WHEEL_SLOTS / 64) return -1;
+		bits = w->non_empty[level][word];
+	}
+	return word * 64 + belle_sip_timer_wheel_lowest_bit(bits);
+}
+
+static belle_sip_source_t **belle_sip_timer_wheel_get_list(belle_sip_timer_wheel_t *w, unsigned short slot) {
+	if (slot == TIMER_WHEEL_SLOT_DUE) return &w->due;
+	if (slot == TIMER_WHEEL_SLOT_FAR) return &w->far;
+	return &w->slots[(slot - 1) / TIMER_WHEEL_SLOTS][(slot - 1) % TIMER_WHEEL_SLOTS];
+}
+
+static void belle_sip_timer_wheel_append(belle_sip_timer_wheel_t *w, unsigned short slot, belle_sip_source_t *s) {
+	belle_sip_source_t **list = belle_sip_timer_wheel_get_list(w, slot);
+	if (*list) {
+		s->timer_prev = (*list)->timer_prev;
+		s->timer_next = *list;
+		s->timer_prev->timer_next = s;
+		(*list)->timer_prev = s;
+	} else {
+		s->timer_prev = s->timer_next = s;
+		*list = s;
+		if (slot < TIMER_WHEEL_SLOT_DUE)
+			w->non_empty[(slot - 1) / TIMER_WHEEL_SLOTS][((slot - 1) % TIMER_WHEEL_SLOTS) / 64] |=
+			    (uint64_t)1 << ((slot - 1) % 64);
+	}
+	s->timer_slot = slot;
+}
+
+/* detaches a whole list from the wheel, the sources keep their stale timer_slot */
+static belle_sip_source_t *belle_sip_timer_wheel_take_list(belle_sip_timer_wheel_t *w, unsigned short slot) {
+	belle_sip_source_t **list = belle_sip_timer_wheel_get_list(w, slot);
+	belle_sip_source_t *head = *list;
+	*list = NULL;
+	if (slot < TIMER_WHEEL_SLOT_DUE)
+		w->non_empty[(slot - 1) / TIMER_WHEEL_SLOTS][((slot - 1) % TIMER_WHEEL_SLOTS) / 64] &=
+		    ~((uint64_t)1 << ((slot - 1) % 64));
+	return head;
+}
+
+static unsigned short belle_sip_timer_wheel_get_slot(const belle_sip_timer_wheel_t *w, uint64_t expire) {
+	uint64_t diff = expire ^ w->now;
+	int level;
+	if (expire <= w->now) return TIMER_WHEEL_SLOT_DUE;
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		if ((diff >> ((level + 1) * TIMER_WHEEL_SLOT_BITS)) == 0)
+			return (unsigned short)(1 + level * TIMER_WHEEL_SLOTS +
+			                        ((expire >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK));
+	}
+	return TIMER_WHEEL_SLOT_FAR;
+}
+
+static void belle_sip_timer_wheel_add(belle_sip_timer_wheel_t *w, belle_sip_source_t *s) {
+	belle_sip_timer_wheel_append(w, belle_sip_timer_wheel_get_slot(w, s->expire_ms), s);
+	w->count++;
+}
+
+static void belle_sip_timer_wheel_remove(belle_sip_timer_wheel_t *w, belle_sip_source_t *s) {
+	belle_sip_source_t **list = belle_sip_timer_wheel_get_list(w, s->timer_slot);
+	if (s->timer_next == s) {
+		belle_sip_timer_wheel_take_list(w, s->timer_slot);
+	} else {
+		s->timer_prev->timer_next = s->timer_next;
+		s->timer_next->timer_prev = s->timer_prev;
+		if (*list == s) *list = s->timer_next;
+	}
+	s->timer_prev = s->timer_next = NULL;
+	s->timer_slot = 0;
+	w->count--;
+}
+
+static void belle_sip_timer_wheel_make_due(belle_sip_timer_wheel_t *w, belle_sip_source_t *s) {
+	belle_sip_timer_wheel_remove(w, s);
+	belle_sip_timer_wheel_append(w, TIMER_WHEEL_SLOT_DUE, s);
+	w->count++;
+}
+
+/* puts back the sources of a detached list at their place according to the current time */
+static void belle_sip_timer_wheel_redistribute(belle_sip_timer_wheel_t *w, belle_sip_source_t *head) {
+	belle_sip_source_t *s, *next;
+	if (head == NULL) return;
+	head->timer_prev->timer_next = NULL;
+	for (s = head; s != NULL; s = next) {
+		next = s->timer_next;
+		belle_sip_timer_wheel_append(w, belle_sip_timer_wheel_get_slot(w, s->expire_ms), s);
+	}
+}
+
+/* date of the next expiration or cascade, the latter being also the earliest possible expiration of its timers */
+static uint64_t belle_sip_timer_wheel_get_next_date(const belle_sip_timer_wheel_t *w) {
+	int level, shift, idx;
+	if (w->due) return w->now;
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		shift = level * TIMER_WHEEL_SLOT_BITS;
+		idx = belle_sip_timer_wheel_next_slot(w, level, (int)((w->now >> shift) & TIMER_WHEEL_SLOT_MASK) + 1);
+		if (idx != -1)
+			return ((w->now >> (shift + TIMER_WHEEL_SLOT_BITS)) << (shift + TIMER_WHEEL_SLOT_BITS)) |
+			       ((uint64_t)idx << shift);
+	}
+	if (w->far) return ((w->now >> 32) + 1) << 32;
+	return UINT64_MAX;
+}
+
+/* called when the current time enters a new level 0 period */
+static void belle_sip_timer_wheel_cascade(belle_sip_timer_wheel_t *w) {
+	int level, idx;
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		idx = (int)((w->now >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK);
+		belle_sip_timer_wheel_redistribute(
+		    w, belle_sip_timer_wheel_take_list(w, (unsigned short)(1 + level * TIMER_WHEEL_SLOTS + idx)));
+		if (idx != 0) return;
+	}
+	belle_sip_timer_wheel_redistribute(w, belle_sip_timer_wheel_take_list(w, TIMER_WHEEL_SLOT_FAR));
+}
+
+/* moves the current time to 'date', the timers expiring until then being appended to the due list */
+static void belle_sip_timer_wheel_advance(belle_sip_timer_wheel_t *w, uint64_t date) {
+	uint64_t stop, next;
+	int idx;
+
+	while (w->now < date) {
+		if (w->count == 0) {
+			w->now = date;
+			break;
+		}
+		if ((w->now & TIMER_WHEEL_SLOT_MASK) == TIMER_WHEEL_SLOT_MASK) {
+			w->now++;
+			belle_sip_timer_wheel_cascade(w);
+		} else {
+			stop = MIN(date, w->now | TIMER_WHEEL_SLOT_MASK);
+			idx = (int)(w->now & TIMER_WHEEL_SLOT_MASK) + 1;
+			w->now = stop;
+			while ((idx = belle_sip_timer_wheel_next_slot(w, 0, idx)) != -1 &&
+			       idx <= (int)(stop & TIMER_WHEEL_SLOT_MASK)) {
+				belle_sip_timer_wheel_redistribute(w, belle_sip_timer_wheel_take_list(w, (unsigned short)(1 + idx)));
+				idx++;
+			}
+		}
+		if (w->now < date && (w->now & TIMER_WHEEL_SLOT_MASK) == TIMER_WHEEL_SLOT_MASK) {
+			/* level 0 is empty: skip the periods up to the next cascade of a non-empty slot */
+			next = belle_sip_timer_wheel_get_next_date(w);
+			if (next > w->now + 1) w->now = MIN(date, next - 1);
+		}
+	}
+}
+
+static belle_sip_source_t *belle_sip_timer_wheel_get_first(belle_sip_timer_wheel_t *w) {
+	int level, idx;
+	if (w->due) return w->due;
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		if ((idx = belle_sip_timer_wheel_next_slot(w, level, 0)) != -1) return w->slots[level][idx];
+	}
+	return w->far;
+}
+
+static belle_sip_source_t *belle_sip_timer_wheel_find_in_list(belle_sip_source_t *head, unsigned long id) {
+	belle_sip_source_t *s = head;
+	if (head == NULL) return NULL;
+	do {
+		if (s->id == id) return s;
+		s = s->timer_next;
+	} while (s != head);
+	return NULL;
+}
+
+static belle_sip_source_t *belle_sip_timer_wheel_find(belle_sip_timer_wheel_t *w, unsigned long id) {
+	belle_sip_source_t *ret;
+	int level, idx;
+	if ((ret = belle_sip_timer_wheel_find_in_list(w->due, id))) return ret;
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		for (idx = belle_sip_timer_wheel_next_slot(w, level, 0); idx != -1;
+		     idx = belle_sip_timer_wheel_next_slot(w, level, idx + 1)) {
+			if ((ret = belle_sip_timer_wheel_find_in_list(w->slots[level][idx], id))) return ret;
+		}
+	}
+	return belle_sip_timer_wheel_find_in_list(w->far, id);
+}
+
+/*
+ * A backend waits for the fd sources to be ready. prepare() and collect() are called with the sources mutex held,
+ * wait() without it. collect() appends the sources to be notified to the list, with a reference taken.
+ */
+typedef struct belle_sip_main_loop_backend_ops {
+	belle_sip_main_loop_backend_t type;
+	int (*init)(belle_sip_main_loop_t *ml);
+	void (*uninit)(belle_sip_main_loop_t *ml);
+	void (*add_fd_source)(belle_sip_main_loop_t *ml, belle_sip_source_t *s);
+	void (*remove_fd_source)(belle_sip_main_loop_t *ml, belle_sip_source_t *s);
+	void (*update_fd_source)(belle_sip_main_loop_t *ml, belle_sip_source_t *s);
+	void (*prepare)(belle_sip_main_loop_t *ml);
+	int (*wait)(belle_sip_main_loop_t *ml, int duration);
+	void (*collect)(belle_sip_main_loop_t *ml, bctbx_list_t **to_be_notified, bctbx_list_t **to_be_notified_last);
+} belle_sip_main_loop_backend_ops_t;
+
 struct belle_sip_main_loop {
 	belle_sip_object_t base;
 	belle_sip_list_t *fd_sources;
-	bctbx_map_t *timer_sources;
+	belle_sip_timer_wheel_t timers;
 	bctbx_mutex_t
 	    sources_mutex; // mutex to avoid concurency between source addition/removing/cancelling and main loop iteration.
 	belle_sip_object_pool_t *pool;
@@ -269,26 +506,336 @@ struct belle_sip_main_loop {
 #ifndef _WIN32
 	int control_fds[2];
 	unsigned long thread_id;
+#endif
+	const belle_sip_main_loop_backend_ops_t *backend;
+	/* poll backend */
+	belle_sip_pollfd_t *pfd;
+	int pfd_size;
+	int pfd_count;
+	/* epoll backend */
+	int polling;                          /* the backend is waiting, its results may refer to removed sources */
+	belle_sip_list_t *removed_sources;    /* sources removed while polling, kept alive until collect() */
+	unsigned char fd_sources_scan_needed; /* cancelled or notify_required sources must be looked up */
+#ifdef HAVE_EPOLL
+	int epoll_fd;
+	struct epoll_event *epoll_events;
+	int epoll_nevents;
+	belle_sip_source_t **fd_owners; /* registered source of each fd, indexed by fd */
+	int fd_owners_size;
 #endif
 };
 
-static void belle_sip_main_loop_remove_source_internal(belle_sip_main_loop_t *ml,
-                                                       belle_sip_source_t *source,
-                                                       bool_t destroy_timer_sources) {
+int belle_sip_source_set_events(belle_sip_source_t *source, int event_mask) {
+	belle_sip_main_loop_t *ml = source->ml;
+	source->events = event_mask;
+	if (source->registered) {
+		bctbx_mutex_lock(&ml->sources_mutex);
+		ml->backend->update_fd_source(ml, source);
+		bctbx_mutex_unlock(&ml->sources_mutex);
+	}
+	return 0;
+}
+
+void belle_sip_source_set_notify_required(belle_sip_source_t *s, unsigned char yesno) {
+	s->notify_required = yesno;
+	if (yesno && s->ml) s->ml->fd_sources_scan_needed = TRUE;
+}
+
+/**
+ * Clear all data of a pipe.
+ * @param[in] read_fd Opened file descriptor used to read the pipe. This fd MUST have O_NONBLOCK flag set.
+ * @return On success, return the number of bytes that have been cleard or zero if the pipe was already empty.
+ * On failure, return -1 and set errno.
+ */
+static ssize_t clear_pipe(int read_fd) {
+	char buffer[1024];
+	ssize_t nread, cum_nread = 0;
+	do {
+		nread = read(read_fd, buffer, sizeof(buffer));
+		if (nread > 0) cum_nread += nread;
+	} while (nread > 0);
+	if (nread < 0 && errno != EAGAIN) return -1;
+	else return cum_nread;
+}
+
+/*
+ Poll backend: the pollfd table is rebuilt from the whole list of fd sources at each iteration.
+ */
+
+static int poll_backend_init(belle_sip_main_loop_t *ml) {
+	return 0;
+}
+
+static void poll_backend_uninit(belle_sip_main_loop_t *ml) {
+	if (ml->pfd) belle_sip_free(ml->pfd);
+	ml->pfd = NULL;
+}
+
+static void poll_backend_nop(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+}
+
+static void poll_backend_prepare(belle_sip_main_loop_t *ml) {
+	bctbx_list_t *elem;
+	int i = 0;
+
+	if (ml->pfd_size < ml->nsources + 1) {
+		ml->pfd_size = ml->nsources + 1;
+		ml->pfd = (belle_sip_pollfd_t *)belle_sip_realloc(ml->pfd, ml->pfd_size * sizeof(belle_sip_pollfd_t));
+	}
+	for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
+		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+		if (!s->cancelled) {
+			if (s->fd != (belle_sip_fd_t)-1) {
+				belle_sip_source_to_poll(s, ml->pfd, i);
+				++i;
+			}
+		}
+	}
+#ifndef _WIN32
+	ml->pfd[i].fd = ml->control_fds[0];
+	ml->pfd[i].events = POLLIN;
+	ml->pfd[i].revents = 0;
+	++i;
+#endif
+	ml->pfd_count = i;
+}
+
+static int poll_backend_wait(belle_sip_main_loop_t *ml, int duration) {
+	int ret = belle_sip_poll(ml->pfd, ml->pfd_count, duration);
+	if (ret == -1) return -1;
+#ifndef _WIN32
+	if (ml->pfd[ml->pfd_count - 1].revents == POLLIN) {
+		if (clear_pipe(ml->control_fds[0]) == -1)
+			belle_sip_fatal("Cannot read control pipe of main loop thread: %s", strerror(errno));
+	}
+#endif
+	return 0;
+}
+
+static void
+poll_backend_collect(belle_sip_main_loop_t *ml, bctbx_list_t **to_be_notified, bctbx_list_t **to_be_notified_last) {
+	bctbx_list_t *elem;
+	for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
+		unsigned revents = 0;
+		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+		if (!s->cancelled) {
+			if (s->fd != (belle_sip_fd_t)-1) {
+				if (s->notify_required) { /*for testing purpose to force channel to read*/
+					revents = BELLE_SIP_EVENT_READ;
+					s->notify_required = 0; /*reset*/
+				} else {
+					revents = belle_sip_source_get_revents(s, ml->pfd);
+				}
+				s->revents = revents;
+			} else {
+				belle_sip_error("Source [%p] does not contains any fd !", s);
+			}
+			if (revents != 0) {
+				*to_be_notified = bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
+			}
+		} else *to_be_notified = bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
+	}
+	ml->fd_sources_scan_needed = FALSE;
+}
+
+static const belle_sip_main_loop_backend_ops_t poll_backend = {
+    BELLE_SIP_MAIN_LOOP_BACKEND_POLL, poll_backend_init,    poll_backend_uninit, poll_backend_nop,
+    poll_backend_nop,                 poll_backend_nop,     poll_backend_prepare, poll_backend_wait,
+    poll_backend_collect};
+
+#ifdef HAVE_EPOLL
+/*
+ Epoll backend: fd sources are registered once in the epoll set, which is only updated when they are added, removed or
+ have their events changed. Registration is level-triggered: a notified source is not required to drain its socket.
+ */
+
+#define BELLE_SIP_EPOLL_MAX_EVENTS 256
+
+static uint32_t belle_sip_event_to_epoll(unsigned int events) {
+	uint32_t ret = 0;
+	if (events & BELLE_SIP_EVENT_READ) ret |= EPOLLIN;
+	if (events & BELLE_SIP_EVENT_WRITE) ret |= EPOLLOUT;
+	if (events & BELLE_SIP_EVENT_ERROR) ret |= EPOLLERR;
+	return ret;
+}
+
+static unsigned int belle_sip_epoll_to_event(uint32_t events) {
+	unsigned int ret = 0;
+	if (events & EPOLLIN) ret |= BELLE_SIP_EVENT_READ;
+	if (events & EPOLLOUT) ret |= BELLE_SIP_EVENT_WRITE;
+	if (events & EPOLLERR) ret |= BELLE_SIP_EVENT_ERROR;
+	return ret;
+}
+
+static int epoll_backend_init(belle_sip_main_loop_t *ml) {
+	struct epoll_event ev = {0};
+
+	ml->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (ml->epoll_fd == -1) {
+		belle_sip_error("epoll_create1() failed: %s", strerror(errno));
+		return -1;
+	}
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL; /* the control pipe */
+	if (epoll_ctl(ml->epoll_fd, EPOLL_CTL_ADD, ml->control_fds[0], &ev) == -1) {
+		belle_sip_error("Cannot watch control pipe of main loop: %s", strerror(errno));
+		close(ml->epoll_fd);
+		return -1;
+	}
+	ml->epoll_events = belle_sip_malloc0(BELLE_SIP_EPOLL_MAX_EVENTS * sizeof(struct epoll_event));
+	return 0;
+}
+
+static void epoll_backend_uninit(belle_sip_main_loop_t *ml) {
+	close(ml->epoll_fd);
+	belle_sip_free(ml->epoll_events);
+	if (ml->fd_owners) belle_sip_free(ml->fd_owners);
+}
+
+static void epoll_backend_add_fd_source(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+	struct epoll_event ev = {0};
+	belle_sip_source_t *owner;
+	int fd = s->fd;
+
+	if (fd < 0) return;
+	if (fd >= ml->fd_owners_size) {
+		int size = MAX(fd + 1, 2 * ml->fd_owners_size);
+		ml->fd_owners = (belle_sip_source_t **)belle_sip_realloc(ml->fd_owners, size * sizeof(belle_sip_source_t *));
+		memset(ml->fd_owners + ml->fd_owners_size, 0, (size - ml->fd_owners_size) * sizeof(belle_sip_source_t *));
+		ml->fd_owners_size = size;
+	}
+	owner = ml->fd_owners[fd];
+	ev.events = belle_sip_event_to_epoll(s->events);
+	ev.data.ptr = s;
+	if (epoll_ctl(ml->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+		/* the fd was closed under a previous source that is still in the loop: the kernel already forgot it */
+		if (owner && owner != s) owner->registered = FALSE;
+	} else if (errno == EEXIST && owner && owner != s && owner->registered) {
+		belle_sip_error("Source [%p] cannot be watched: fd [%i] is already watched by source [%p]", s, fd, owner);
+		return;
+	} else if (errno != EEXIST || epoll_ctl(ml->epoll_fd, EPOLL_CTL_MOD, fd, &ev) == -1) {
+		belle_sip_error("Source [%p] cannot be watched: epoll_ctl() failed for fd [%i]: %s", s, fd, strerror(errno));
+		return;
+	}
+	s->registered = TRUE;
+	s->registered_fd = fd;
+	s->registered_events = s->events;
+	ml->fd_owners[fd] = s;
+}
+
+static void epoll_backend_remove_fd_source(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+	if (!s->registered) return;
+	s->registered = FALSE;
+	/* if the fd was reset, the socket is already closed and no longer in the epoll set */
+	if (s->fd == s->registered_fd) epoll_ctl(ml->epoll_fd, EPOLL_CTL_DEL, s->fd, NULL);
+	if (ml->fd_owners[s->registered_fd] == s) ml->fd_owners[s->registered_fd] = NULL;
+}
+
+static void epoll_backend_update_fd_source(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+	if (s->registered && s->fd == s->registered_fd) {
+		struct epoll_event ev = {0};
+		if (s->events == s->registered_events) return;
+		ev.events = belle_sip_event_to_epoll(s->events);
+		ev.data.ptr = s;
+		if (epoll_ctl(ml->epoll_fd, EPOLL_CTL_MOD, s->fd, &ev) == -1) {
+			belle_sip_error("Source [%p]: epoll_ctl() failed for fd [%i]: %s", s, s->fd, strerror(errno));
+		}
+		s->registered_events = s->events;
+	} else {
+		epoll_backend_remove_fd_source(ml, s);
+		epoll_backend_add_fd_source(ml, s);
+	}
+}
+
+static void epoll_backend_prepare(belle_sip_main_loop_t *ml) {
+	ml->polling = TRUE;
+}
+
+static int epoll_backend_wait(belle_sip_main_loop_t *ml, int duration) {
+	ml->epoll_nevents = epoll_wait(ml->epoll_fd, ml->epoll_events, BELLE_SIP_EPOLL_MAX_EVENTS, duration);
+	if (ml->epoll_nevents == -1) {
+		if (errno != EINTR) belle_sip_error("epoll_wait() error: %s", strerror(errno));
+		ml->epoll_nevents = 0;
+		return -1;
+	}
+	return 0;
+}
+
+static void
+epoll_backend_collect(belle_sip_main_loop_t *ml, bctbx_list_t **to_be_notified, bctbx_list_t **to_be_notified_last) {
+	bctbx_list_t *elem;
+	int i;
+
+	if (ml->fd_sources_scan_needed) {
+		ml->fd_sources_scan_needed = FALSE;
+		for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
+			belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+			if (!s->cancelled && s->notify_required) { /*for testing purpose to force channel to read*/
+				s->revents = BELLE_SIP_EVENT_READ;
+				s->notify_required = 0;
+			} else if (!s->cancelled) continue;
+			*to_be_notified = bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
+		}
+	}
+	for (i = 0; i < ml->epoll_nevents; i++) {
+		belle_sip_source_t *s = (belle_sip_source_t *)ml->epoll_events[i].data.ptr;
+		unsigned int revents;
+		if (s == NULL) {
+			if (clear_pipe(ml->control_fds[0]) == -1)
+				belle_sip_fatal("Cannot read control pipe of main loop thread: %s", strerror(errno));
+			continue;
+		}
+		/* skip sources removed since epoll_wait() returned, and those already in the list */
+		if (!s->registered || s->cancelled || s->revents != 0) continue;
+		revents = belle_sip_epoll_to_event(ml->epoll_events[i].events);
+		if (revents != 0) {
+			s->revents = revents;
+			*to_be_notified = bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
+		}
+	}
+	ml->epoll_nevents = 0;
+}
+
+static const belle_sip_main_loop_backend_ops_t epoll_backend = {BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL,
+                                                                 epoll_backend_init,
+                                                                 epoll_backend_uninit,
+                                                                 epoll_backend_add_fd_source,
+                                                                 epoll_backend_remove_fd_source,
+                                                                 epoll_backend_update_fd_source,
+                                                                 epoll_backend_prepare,
+                                                                 epoll_backend_wait,
+                                                                 epoll_backend_collect};
+#endif
+
+/* releases the sources removed while the backend was waiting, called with the sources mutex held */
+static void belle_sip_main_loop_end_polling(belle_sip_main_loop_t *ml) {
+	ml->polling = FALSE;
+	while (ml->removed_sources) {
+		belle_sip_source_t *s = (belle_sip_source_t *)ml->removed_sources->data;
+		ml->removed_sources = belle_sip_list_delete_link(ml->removed_sources, ml->removed_sources);
+		belle_sip_object_unref(s);
+	}
+}
+
+void belle_sip_main_loop_remove_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source) {
 	int unrefs = 0;
+	int removed = 0;
 
 	bctbx_mutex_lock(&ml->sources_mutex);
 	if (source->node.next || source->node.prev || &source->node == ml->fd_sources) {
 		ml->fd_sources = belle_sip_list_remove_link(ml->fd_sources, &source->node);
-		unrefs++;
+		ml->backend->remove_fd_source(ml, source);
+		/* the results of the pending wait may still point to this source */
+		if (ml->polling) ml->removed_sources = belle_sip_list_prepend(ml->removed_sources, source);
+		else unrefs++;
+		removed++;
 	}
-	if (source->it) {
-		if (destroy_timer_sources) bctbx_map_erase(ml->timer_sources, source->it);
-		bctbx_iterator_delete(source->it);
-		source->it = NULL;
+	if (source->timer_slot) {
+		belle_sip_timer_wheel_remove(&ml->timers, source);
 		unrefs++;
+		removed++;
 	}
-	if (unrefs) {
+	if (removed) {
 		source->cancelled = TRUE;
 		ml->nsources--;
 		bctbx_mutex_unlock(&ml->sources_mutex);
@@ -301,23 +848,10 @@ static void belle_sip_main_loop_remove_source_internal(belle_sip_main_loop_t *ml
 	bctbx_mutex_unlock(&ml->sources_mutex);
 }
 
-void belle_sip_main_loop_remove_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source) {
-	belle_sip_main_loop_remove_source_internal(ml, source, TRUE);
-}
-
 static void belle_sip_main_loop_destroy(belle_sip_main_loop_t *ml) {
-	bctbx_iterator_t *it = bctbx_map_ullong_begin(ml->timer_sources);
-	bctbx_iterator_t *end = bctbx_map_ullong_end(ml->timer_sources);
-
-	while (!bctbx_iterator_ullong_equals(it, end)) {
-		belle_sip_main_loop_remove_source_internal(
-		    ml, (belle_sip_source_t *)bctbx_pair_ullong_get_second(bctbx_iterator_ullong_get_pair(it)), FALSE);
-		it = bctbx_iterator_ullong_get_next(it);
+	while (ml->timers.count > 0) {
+		belle_sip_main_loop_remove_source(ml, belle_sip_timer_wheel_get_first(&ml->timers));
 	}
-
-	bctbx_iterator_ullong_delete(it);
-	bctbx_iterator_ullong_delete(end);
-
 	while (ml->fd_sources) {
 		belle_sip_main_loop_remove_source(ml, (belle_sip_source_t *)ml->fd_sources->data);
 	}
@@ -325,8 +859,8 @@ static void belle_sip_main_loop_destroy(belle_sip_main_loop_t *ml) {
 		belle_sip_object_unref(ml->pool);
 	}
 
-	bctbx_mmap_ullong_delete(ml->timer_sources);
 	bctbx_mutex_destroy(&ml->sources_mutex);
+	ml->backend->uninit(ml);
 
 #ifndef _WIN32
 	close(ml->control_fds[0]);
@@ -338,9 +872,13 @@ BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(belle_sip_main_loop_t);
 BELLE_SIP_INSTANCIATE_VPTR(belle_sip_main_loop_t, belle_sip_object_t, belle_sip_main_loop_destroy, NULL, NULL, FALSE);
 
 belle_sip_main_loop_t *belle_sip_main_loop_new(void) {
+	return belle_sip_main_loop_new_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_DEFAULT);
+}
+
+belle_sip_main_loop_t *belle_sip_main_loop_new_with_backend(belle_sip_main_loop_backend_t backend) {
 	belle_sip_main_loop_t *m = belle_sip_object_new(belle_sip_main_loop_t);
 	m->pool = belle_sip_object_pool_push();
-	m->timer_sources = bctbx_mmap_ullong_new();
+	m->timers.now = belle_sip_time_ms();
 	bctbx_mutex_init(&m->sources_mutex, NULL);
 
 #ifndef _WIN32
@@ -350,12 +888,37 @@ belle_sip_main_loop_t *belle_sip_main_loop_new(void) {
 	if (fcntl(m->control_fds[0], F_SETFL, O_NONBLOCK) < 0) {
 		belle_sip_fatal("Fail to set O_NONBLOCK flag on the reading fd of the control pipe: %s", strerror(errno));
 	}
+	/* a full pipe already wakes the loop up: adding many sources before it runs must not block */
+	if (fcntl(m->control_fds[1], F_SETFL, O_NONBLOCK) < 0) {
+		belle_sip_fatal("Fail to set O_NONBLOCK flag on the writing fd of the control pipe: %s", strerror(errno));
+	}
 	m->thread_id = 0;
 #endif
 
+#ifdef HAVE_EPOLL
+	if (backend != BELLE_SIP_MAIN_LOOP_BACKEND_POLL) {
+		m->backend = &epoll_backend;
+		if (m->backend->init(m) != 0) {
+			belle_sip_warning("Main loop [%p]: epoll backend unavailable, using poll.", m);
+			m->backend = NULL;
+		}
+	}
+#else
+	if (backend == BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL)
+		belle_sip_warning("Main loop [%p]: epoll backend not supported on this platform, using poll.", m);
+#endif
+	if (m->backend == NULL) {
+		m->backend = &poll_backend;
+		m->backend->init(m);
+	}
+
 	return m;
 }
 
+belle_sip_main_loop_backend_t belle_sip_main_loop_get_backend(const belle_sip_main_loop_t *ml) {
+	return ml->backend->type;
+}
+
 void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source) {
 	bctbx_mutex_lock(&ml->sources_mutex);
 	if (source->node.next || source->node.prev) {
@@ -370,13 +933,13 @@ void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, belle_sip_source_
 	if (source->timeout >= 0) {
 		belle_sip_object_ref(source);
 		source->expire_ms = belle_sip_time_ms() + source->timeout;
-		source->it = bctbx_map_insert_and_delete_with_returned_it(
-		    ml->timer_sources, (bctbx_pair_t *)bctbx_pair_ullong_new(source->expire_ms, source));
+		belle_sip_timer_wheel_add(&ml->timers, source);
 	}
 	source->cancelled = FALSE;
 	if (source->fd != (belle_sip_fd_t)-1) {
 		belle_sip_object_ref(source);
 		ml->fd_sources = belle_sip_list_concat(&source->node, ml->fd_sources);
+		ml->backend->add_fd_source(ml, source);
 	}
 
 	ml->nsources++;
@@ -468,26 +1031,23 @@ void belle_sip_source_set_timeout(belle_sip_source_t *s, unsigned int value_ms)
 
 void belle_sip_source_set_timeout_int64(belle_sip_source_t *s, int64_t value_ms) {
 	belle_sip_main_loop_t *ml = s->ml;
-	int removed_from_map = FALSE;
+	int removed_from_wheel = FALSE;
 	// take the mutex only when the source has been added to the mail loop
 	if (ml) bctbx_mutex_lock(&ml->sources_mutex);
 	if (!s->expired) {
 		s->expire_ms = belle_sip_time_ms() + value_ms;
-		if (s->it) {
-			/*this timeout is already sorted in the timer_sources map, we need to move it to its new place*/
-			bctbx_map_erase(ml->timer_sources, s->it);
-			bctbx_iterator_delete(s->it);
+		if (s->timer_slot) {
+			/*this timeout is already in the timer wheel, we need to move it to its new place*/
+			belle_sip_timer_wheel_remove(&ml->timers, s);
 			if (value_ms != -1) {
-				s->it = bctbx_map_insert_and_delete_with_returned_it(
-				    ml->timer_sources, (bctbx_pair_t *)bctbx_pair_ullong_new(s->expire_ms, s));
+				belle_sip_timer_wheel_add(&ml->timers, s);
 			} else {
-				s->it = NULL;
-				removed_from_map = TRUE;
+				removed_from_wheel = TRUE;
 			}
 		}
 	}
 	s->timeout = value_ms;
-	if (removed_from_map) belle_sip_object_unref(s);
+	if (removed_from_wheel) belle_sip_object_unref(s);
 	if (ml) bctbx_mutex_unlock(&ml->sources_mutex);
 }
 
@@ -507,12 +1067,11 @@ void belle_sip_source_cancel(belle_sip_source_t *s) {
 	if (s->ml) {
 		bctbx_mutex_lock(&s->ml->sources_mutex);
 		s->cancelled = TRUE;
-		if (s->it) {
-			bctbx_map_erase(s->ml->timer_sources, s->it);
-			bctbx_iterator_delete(s->it);
-			/*put on front*/
-			s->it = bctbx_map_insert_and_delete_with_returned_it(s->ml->timer_sources,
-			                                                     (bctbx_pair_t *)bctbx_pair_ullong_new(0, s));
+		/* the backend may not look at it otherwise */
+		if (s->node.next || s->node.prev || &s->node == s->ml->fd_sources) s->ml->fd_sources_scan_needed = TRUE;
+		if (s->timer_slot) {
+			/*make it due, so that it is removed at next iteration*/
+			belle_sip_timer_wheel_make_due(&s->ml->timers, s);
 		}
 		bctbx_mutex_unlock(&s->ml->sources_mutex);
 	} else {
@@ -528,16 +1087,13 @@ static int match_source_id(const void *s, const void *pid) {
 }
 
 belle_sip_source_t *belle_sip_main_loop_find_source(belle_sip_main_loop_t *ml, unsigned long id) {
-	bctbx_iterator_t *it;
 	belle_sip_source_t *ret = NULL;
 	belle_sip_list_t *elem = belle_sip_list_find_custom(ml->fd_sources, match_source_id, (const void *)(intptr_t)id);
 	if (elem != NULL) {
 		ret = (belle_sip_source_t *)elem->data;
-	} else if ((it = bctbx_map_find_custom(ml->timer_sources, match_source_id, (const void *)(intptr_t)id))) {
-		ret = (belle_sip_source_t *)bctbx_pair_get_second(bctbx_iterator_get_pair(it));
-		bctbx_iterator_delete(it);
-	} /*else
-	    ret = NULL;*/
+	} else {
+		ret = belle_sip_timer_wheel_find(&ml->timers, id);
+	}
 
 	return ret;
 }
@@ -547,27 +1103,7 @@ void belle_sip_main_loop_cancel_source(belle_sip_main_loop_t *ml, unsigned long
 	if (s) belle_sip_source_cancel(s);
 }
 
-/**
- * Clear all data of a pipe.
- * @param[in] read_fd Opened file descriptor used to read the pipe. This fd MUST have O_NONBLOCK flag set.
- * @return On success, return the number of bytes that have been cleard or zero if the pipe was already empty.
- * On failure, return -1 and set errno.
- */
-static ssize_t clear_pipe(int read_fd) {
-	char buffer[1024];
-	ssize_t nread, cum_nread = 0;
-	do {
-		nread = read(read_fd, buffer, sizeof(buffer));
-		if (nread > 0) cum_nread += nread;
-	} while (nread > 0);
-	if (nread < 0 && errno != EAGAIN) return -1;
-	else return cum_nread;
-}
-
 static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
-	size_t pfd_size = (ml->nsources + 1) * sizeof(belle_sip_pollfd_t);
-	belle_sip_pollfd_t *pfd = (belle_sip_pollfd_t *)belle_sip_malloc0(pfd_size);
-	int i = 0;
 	bctbx_list_t *elem, *next;
 	int duration = -1;
 	int ret;
@@ -577,111 +1113,62 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 	int can_clean = belle_sip_object_pool_cleanable(
 	    ml->pool); /*iterate might not be called by the thread that created the main loop*/
 	belle_sip_object_pool_t *tmp_pool = NULL;
-	bctbx_iterator_t *it, *end;
+	belle_sip_source_t *s;
 
 	if (!can_clean) {
 		/*Push a temporary pool for the time of the iterate loop*/
 		tmp_pool = belle_sip_object_pool_push();
 	}
 
-	/*Step 1: prepare the pollfd table and get the next timeout value */
+	/*Step 1: prepare the backend and get the next timeout value */
 	bctbx_mutex_lock(&ml->sources_mutex); // Lock for the whole step 1
-	for (elem = ml->fd_sources; elem != NULL; elem = next) {
-		next = elem->next;
-		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
-		if (!s->cancelled) {
-			if (s->fd != (belle_sip_fd_t)-1) {
-				belle_sip_source_to_poll(s, pfd, i);
-				++i;
-			}
-		}
-	}
-#ifndef _WIN32
-	pfd[i].fd = ml->control_fds[0];
-	pfd[i].events = POLLIN;
-	++i;
-#endif
-	/*all source with timeout are in ml->timer_sources*/
-	if (bctbx_map_size(ml->timer_sources) > 0) {
-		int64_t diff;
-		uint64_t next_wakeup_time;
-		it = bctbx_map_begin(ml->timer_sources);
-		/*use first because in case of canceled timer, key ==0 , key != s->expire_ms */
-		next_wakeup_time = bctbx_pair_ullong_get_first((const bctbx_pair_ullong_t *)bctbx_iterator_get_pair(it));
+	ml->backend->prepare(ml);
+	/*all source with timeout are in ml->timers*/
+	if (ml->timers.count > 0) {
+		uint64_t next_wakeup_time = belle_sip_timer_wheel_get_next_date(&ml->timers);
 		/* compute the amount of time to wait for shortest timeout*/
 		cur = belle_sip_time_ms();
-		diff = next_wakeup_time - cur;
-		if (diff > 0) duration = MIN((unsigned int)diff, INT_MAX);
+		if (next_wakeup_time > cur) duration = (int)MIN(next_wakeup_time - cur, (uint64_t)INT_MAX);
 		else duration = 0;
-		bctbx_iterator_delete(it);
-		it = NULL;
 	}
+	/* cancelled sources and forced notifications are not reported by the wait */
+	if (ml->fd_sources_scan_needed) duration = 0;
 	bctbx_mutex_unlock(&ml->sources_mutex);
 
 	/* do the poll */
-	ret = belle_sip_poll(pfd, i, duration);
+	ret = ml->backend->wait(ml, duration);
 	if (ret == -1) {
+		bctbx_mutex_lock(&ml->sources_mutex);
+		belle_sip_main_loop_end_polling(ml);
+		bctbx_mutex_unlock(&ml->sources_mutex);
 		goto end;
 	}
 
-#ifndef _WIN32
-	if (pfd[i - 1].revents == POLLIN) {
-		if (clear_pipe(ml->control_fds[0]) == -1)
-			belle_sip_fatal("Cannot read control pipe of main loop thread: %s", strerror(errno));
-	}
-#endif
-
 	/* Step 2: examine poll results and determine the list of source to be notified */
 	bctbx_mutex_lock(&ml->sources_mutex); // Lock for step 2 and step 3.
 	cur = belle_sip_time_ms();
-	for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
-		unsigned revents = 0;
-		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
-		if (!s->cancelled) {
-			if (s->fd != (belle_sip_fd_t)-1) {
-				if (s->notify_required) { /*for testing purpose to force channel to read*/
-					revents = BELLE_SIP_EVENT_READ;
-					s->notify_required = 0; /*reset*/
-				} else {
-					revents = belle_sip_source_get_revents(s, pfd);
-				}
-				s->revents = revents;
-			} else {
-				belle_sip_error("Source [%p] does not contains any fd !", s);
-			}
-			if (revents != 0) {
-				to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
-			}
-		} else to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
-	}
+	ml->backend->collect(ml, &to_be_notified, &to_be_notified_last);
+	belle_sip_main_loop_end_polling(ml);
 
 	/* Step 3: find timeouted sources */
-	it = bctbx_map_begin(ml->timer_sources);
-	end = bctbx_map_end(ml->timer_sources);
-	while (!bctbx_iterator_equals(it, end)) {
-		/*use first because in case of canceled timer, key != s->expire_ms*/
-		uint64_t expire = bctbx_pair_ullong_get_first((const bctbx_pair_ullong_t *)bctbx_iterator_get_pair(it));
-		belle_sip_source_t *s = (belle_sip_source_t *)bctbx_pair_get_second(bctbx_iterator_get_pair(it));
-		if (expire > cur) {
-			/* no need to continue looping because map is ordered*/
-			break;
-		} else {
+	belle_sip_timer_wheel_advance(&ml->timers, cur);
+	if ((s = ml->timers.due) != NULL) {
+		/* the due list holds the expired and cancelled timers */
+		do {
 			if (s->revents == 0) {
 				s->expired = TRUE;
 				to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
 			} /*else already in to_be_notified by Step 2*/
 
 			s->revents |= BELLE_SIP_EVENT_TIMEOUT;
-			it = bctbx_iterator_get_next(it);
-		}
+			s = s->timer_next;
+		} while (s != ml->timers.due);
 	}
-	bctbx_iterator_delete(it);
-	bctbx_iterator_delete(end);
 	bctbx_mutex_unlock(&ml->sources_mutex);
 
 	/* Step 4: notify those to be notified */
 	for (elem = to_be_notified; elem != NULL;) {
-		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+		s = (belle_sip_source_t *)elem->data;
 		next = elem->next;
 		if (!s->cancelled) {
 
@@ -698,13 +1185,11 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 				belle_sip_main_loop_remove_source(ml, s);
 			} else {
 				bctbx_mutex_lock(&ml->sources_mutex);
-				if (s->expired && s->it) {
-					bctbx_map_erase(ml->timer_sources, s->it);
-					bctbx_iterator_delete(s->it);
-					s->it = NULL;
+				if (s->expired && s->timer_slot) {
+					belle_sip_timer_wheel_remove(&ml->timers, s);
 					belle_sip_object_unref(s);
 				}
-				if (!s->it && s->timeout >= 0) {
+				if (!s->timer_slot && s->timeout >= 0) {
 					/*timeout needs to be started again */
 					if (ret == BELLE_SIP_CONTINUE_WITHOUT_CATCHUP) {
 						s->expire_ms = cur + s->timeout;
@@ -712,8 +1197,7 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 						s->expire_ms += s->timeout;
 					}
 					s->expired = FALSE;
-					s->it = bctbx_map_insert_and_delete_with_returned_it(
-					    ml->timer_sources, (bctbx_pair_t *)bctbx_pair_ullong_new(s->expire_ms, s));
+					belle_sip_timer_wheel_add(&ml->timers, s);
 					belle_sip_object_ref(s);
 				}
 				bctbx_mutex_unlock(&ml->sources_mutex);
@@ -727,14 +1211,12 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 		elem = next;
 	}
 
+end:
 	if (can_clean) belle_sip_object_pool_clean(ml->pool);
 	else if (tmp_pool) {
 		belle_sip_object_unref(tmp_pool);
 		tmp_pool = NULL;
 	}
-
-end:
-	belle_sip_free(pfd);
 }
 
 void belle_sip_main_loop_run(belle_sip_main_loop_t *ml) {
@@ -770,7 +1252,7 @@ void belle_sip_main_loop_sleep(belle_sip_main_loop_t *ml, int milliseconds) {
 void belle_sip_main_loop_wake_up(belle_sip_main_loop_t *ml) {
 
 #ifndef _WIN32
-	if (write(ml->control_fds[1], "wake up!", 1) == -1) {
+	if (write(ml->control_fds[1], "wake up!", 1) == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
 		belle_sip_fatal("Cannot write to control pipe of main loop thread: %s", strerror(errno));
 	}
 #else
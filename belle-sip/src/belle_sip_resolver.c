@@ -23,6 +23,7 @@
 #ifdef HAVE_MDNS
 #include <dns_sd.h>
 #endif
+#include <ctype.h>
 #include <stdint.h>
 #include <stdlib.h>
 #ifdef __APPLE__
@@ -60,6 +61,8 @@ typedef struct belle_sip_combined_resolver_context belle_sip_combined_resolver_c
 typedef struct belle_sip_dual_resolver_context belle_sip_dual_resolver_context_t;
 #define BELLE_SIP_DUAL_RESOLVER_CONTEXT(obj) BELLE_SIP_CAST(obj, belle_sip_dual_resolver_context_t)
 
+typedef struct belle_sip_dns_cache_entry belle_sip_dns_cache_entry_t;
+
 struct belle_sip_dns_srv {
 	belle_sip_object_t base;
 	unsigned short priority;
@@ -292,6 +295,9 @@ struct belle_sip_simple_resolver_context {
 	int family;
 	int flags;
 	uint64_t start_time;
+	belle_sip_dns_cache_entry_t *cache_entry; /*entry of the DNS cache whose pending query this context waits for*/
+	uint32_t negative_ttl;                    /*TTL of the SOA record given with an empty answer*/
+	unsigned char answered;                   /*an answer, possibly empty, was received from the DNS server*/
 #ifdef HAVE_MDNS
 	char *srv_prefix;
 	char *srv_name;
@@ -780,9 +786,14 @@ static int resolver_process_data(belle_sip_simple_resolver_context_t *ctx, unsig
 					if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
 						BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
 				}
+			} else if (rr.section == DNS_S_NS && rr.class == DNS_C_IN && rr.type == DNS_T_SOA) {
+				/*the negative caching TTL of the zone, see RFC 2308*/
+				if ((error = dns_any_parse(dns_any_init(&any, sizeof(any)), &rr, ans)) == 0)
+					ctx->negative_ttl = MIN(rr.ttl, any.soa.minimum);
 			}
 		}
 		free(ans);
+		ctx->answered = TRUE;
 #if defined(USE_GETADDRINFO_FALLBACK) || defined(HAVE_MDNS)
 		ctx->getaddrinfo_cancelled = TRUE;
 #endif
@@ -1437,6 +1448,392 @@ static belle_sip_simple_resolver_context_t *resolver_start_query(belle_sip_simpl
 	return NULL;
 }
 
+static belle_sip_simple_resolver_context_t *
+simple_resolver_context_new(belle_sip_stack_t *stack, const char *name, enum dns_type type) {
+	belle_sip_simple_resolver_context_t *ctx = belle_sip_object_new(belle_sip_simple_resolver_context_t);
+	belle_sip_resolver_context_init((belle_sip_resolver_context_t *)ctx, stack);
+	ctx->name = belle_sip_strdup(name);
+	ctx->type = type;
+	ctx->negative_ttl = UINT32_MAX;
+#ifdef HAVE_DNS_SERVICE
+	ctx->dns_service_queue = stack->dns_service_queue;
+	dispatch_retain(ctx->dns_service_queue); // take a ref on the dispatch queue
+	if (type == DNS_T_SRV) ctx->dns_service_type = kDNSServiceType_SRV;
+	else ctx->dns_service_type = (type == DNS_T_AAAA) ? kDNSServiceType_AAAA : kDNSServiceType_A;
+	if (stack->use_dns_service == TRUE) {
+		bctbx_mutex_init(&ctx->notify_mutex, NULL);
+	}
+#endif /* HAVE_DNS_SERVICE */
+#if (defined(USE_GETADDRINFO_FALLBACK) || defined(HAVE_MDNS)) && defined(_WIN32)
+	ctx->ctlevent = (belle_sip_fd_t)-1;
+#endif
+	belle_sip_object_set_name((belle_sip_object_t *)ctx, ctx->name);
+	/* Take a ref for the entire duration of the DNS procedure, it will be released when it is finished */
+	belle_sip_object_ref(ctx);
+	return ctx;
+}
+
+/*
+ * The DNS cache keeps the A, AAAA and SRV answers for their TTL, and the empty answers for the negative caching TTL of
+ * the SOA record sent with them (RFC 2308). The errors and timeouts are not cached, nor the answers without TTL, such
+ * as the ones of the hosts file.
+ * The query for a name that is not in the cache is made by a resolver context of the cache itself, and the resolver
+ * contexts of the stack that need this name wait for its answer: cancelling one of them does not cancel the query for
+ * the others, and its answer is kept anyway.
+ * The number of entries is capped: once the expired ones are removed, the answers kept for the longest time are evicted
+ * to make room for a new query. The pending queries are never evicted.
+ */
+#define BELLE_SIP_DNS_CACHE_MAX_NEGATIVE_TTL 3600
+#define BELLE_SIP_DNS_CACHE_PURGE_THRESHOLD 1024 /*the expired entries are removed above this number of entries*/
+#define BELLE_SIP_DNS_CACHE_MAX_ENTRIES 2048
+
+struct belle_sip_dns_cache_entry {
+	belle_sip_dns_cache_t *cache;
+	char *key;
+	enum dns_type type;
+	uint64_t expires;                           /*in ms, meaningless while the query is pending*/
+	belle_sip_list_t *addresses;                /*numeric hosts (char *) of the A or AAAA answer*/
+	belle_sip_list_t *srv_list;                 /*belle_sip_dns_srv_t of the SRV answer, sorted by priority*/
+	belle_sip_simple_resolver_context_t *query; /*pending query, NULL once answered*/
+	belle_sip_list_t *waiters;                  /*belle_sip_simple_resolver_context_t waiting for the answer*/
+	unsigned char prewarm;                      /*query the targets of the SRV answer as well*/
+	unsigned char stale;                        /*flushed while the query was pending, its answer is not kept*/
+	belle_sip_dns_cache_entry_t *older;         /*links of the kept answers, in the order they were answered*/
+	belle_sip_dns_cache_entry_t *newer;
+};
+
+struct belle_sip_dns_cache {
+	belle_sip_stack_t *stack;
+	belle_sip_hash_index_t *entries;
+	belle_sip_dns_cache_entry_t *oldest; /*kept answer evicted first when the cache is full*/
+	belle_sip_dns_cache_entry_t *newest;
+	size_t max_entries;
+	belle_sip_dns_cache_stats_t stats;
+};
+
+static void dns_cache_query(belle_sip_dns_cache_t *cache,
+                            char *key,
+                            const char *name,
+                            enum dns_type type,
+                            belle_sip_simple_resolver_context_t *waiter);
+
+static const char *dns_cache_entry_get_key(const void *obj) {
+	return ((const belle_sip_dns_cache_entry_t *)obj)->key;
+}
+
+static int dns_cache_entry_compare_key(const void *obj, const void *key) {
+	const belle_sip_dns_cache_entry_t *entry = (const belle_sip_dns_cache_entry_t *)obj;
+	if (entry->stale) return -1;
+	return strcmp(entry->key, (const char *)key);
+}
+
+static void dns_cache_entry_free(belle_sip_dns_cache_entry_t *entry) {
+	belle_sip_list_free_with_data(entry->addresses, belle_sip_free);
+	belle_sip_list_free_with_data(entry->srv_list, belle_sip_object_unref);
+	belle_sip_free(entry->key);
+	belle_sip_free(entry);
+}
+
+/*the names are case insensitive, with or without their trailing dot*/
+static char *dns_cache_make_key(const char *name, enum dns_type type) {
+	char *key = belle_sip_strdup_printf("%i:%s", (int)type, name);
+	size_t len = strlen(key);
+	char *p;
+	if (key[len - 1] == '.') key[len - 1] = '\0';
+	for (p = key; *p != '\0'; p++) {
+		*p = (char)tolower((unsigned char)*p);
+	}
+	return key;
+}
+
+static int dns_cache_usable(const belle_sip_stack_t *stack, const char *name) {
+	if (!stack->dns_cache_enabled) return FALSE;
+	/*the simulated failures must apply to every resolution*/
+	if (stack->resolver_send_error || stack->resolver_tx_delay > 0 || stack->dns_timeout == 0) return FALSE;
+#ifdef HAVE_DNS_SERVICE
+	if (stack->use_dns_service) return FALSE; /*DNSService has its own cache, in mDNSResponder*/
+#endif
+#ifdef HAVE_MDNS
+	if (is_mdns_query(name)) return FALSE;
+#endif
+	return TRUE;
+}
+
+belle_sip_dns_cache_t *belle_sip_dns_cache_new(belle_sip_stack_t *stack) {
+	belle_sip_dns_cache_t *cache = belle_sip_new0(belle_sip_dns_cache_t);
+	cache->stack = stack;
+	cache->entries = belle_sip_hash_index_new(dns_cache_entry_get_key);
+	cache->max_entries = BELLE_SIP_DNS_CACHE_MAX_ENTRIES;
+	return cache;
+}
+
+void belle_sip_dns_cache_set_max_entries(belle_sip_dns_cache_t *cache, size_t max_entries) {
+	cache->max_entries = max_entries;
+}
+
+/*appends the entry whose answer is kept to the eviction order*/
+static void dns_cache_link_entry(belle_sip_dns_cache_t *cache, belle_sip_dns_cache_entry_t *entry) {
+	entry->older = cache->newest;
+	if (cache->newest) cache->newest->newer = entry;
+	else cache->oldest = entry;
+	cache->newest = entry;
+}
+
+/*does nothing for the pending entries, which are not linked*/
+static void dns_cache_unlink_entry(belle_sip_dns_cache_t *cache, belle_sip_dns_cache_entry_t *entry) {
+	if (entry->older) entry->older->newer = entry->newer;
+	else if (cache->oldest == entry) cache->oldest = entry->newer;
+	if (entry->newer) entry->newer->older = entry->older;
+	else if (cache->newest == entry) cache->newest = entry->older;
+	entry->older = entry->newer = NULL;
+}
+
+static void dns_cache_remove_entry(belle_sip_dns_cache_t *cache, belle_sip_dns_cache_entry_t *entry) {
+	dns_cache_unlink_entry(cache, entry);
+	belle_sip_hash_index_remove(cache->entries, entry);
+	dns_cache_entry_free(entry);
+}
+
+void belle_sip_dns_cache_destroy(belle_sip_dns_cache_t *cache) {
+	belle_sip_list_t *entries = belle_sip_hash_index_get_all(cache->entries);
+	belle_sip_list_t *elem;
+	for (elem = entries; elem != NULL; elem = elem->next) {
+		belle_sip_dns_cache_entry_t *entry = (belle_sip_dns_cache_entry_t *)elem->data;
+		belle_sip_list_t *waiter;
+		for (waiter = entry->waiters; waiter != NULL; waiter = waiter->next) {
+			((belle_sip_simple_resolver_context_t *)waiter->data)->cache_entry = NULL;
+		}
+		belle_sip_list_free(entry->waiters);
+		entry->waiters = NULL;
+		if (entry->query) belle_sip_resolver_context_cancel(BELLE_SIP_RESOLVER_CONTEXT(entry->query));
+		dns_cache_entry_free(entry);
+	}
+	belle_sip_list_free(entries);
+	belle_sip_hash_index_destroy(cache->entries);
+	belle_sip_free(cache);
+}
+
+void belle_sip_dns_cache_flush(belle_sip_dns_cache_t *cache) {
+	belle_sip_list_t *entries = belle_sip_hash_index_get_all(cache->entries);
+	belle_sip_list_t *elem;
+	for (elem = entries; elem != NULL; elem = elem->next) {
+		belle_sip_dns_cache_entry_t *entry = (belle_sip_dns_cache_entry_t *)elem->data;
+		if (entry->query) entry->stale = TRUE; /*removed once answered*/
+		else dns_cache_remove_entry(cache, entry);
+	}
+	belle_sip_list_free(entries);
+}
+
+static void dns_cache_purge(belle_sip_dns_cache_t *cache) {
+	belle_sip_list_t *entries = belle_sip_hash_index_get_all(cache->entries);
+	belle_sip_list_t *elem;
+	uint64_t now = belle_sip_time_ms();
+	for (elem = entries; elem != NULL; elem = elem->next) {
+		belle_sip_dns_cache_entry_t *entry = (belle_sip_dns_cache_entry_t *)elem->data;
+		if (entry->query == NULL && entry->expires <= now) dns_cache_remove_entry(cache, entry);
+	}
+	belle_sip_list_free(entries);
+}
+
+/*makes room for a new entry*/
+static void dns_cache_evict(belle_sip_dns_cache_t *cache) {
+	if (belle_sip_hash_index_get_count(cache->entries) >= BELLE_SIP_DNS_CACHE_PURGE_THRESHOLD) dns_cache_purge(cache);
+	while (belle_sip_hash_index_get_count(cache->entries) >= cache->max_entries && cache->oldest != NULL) {
+		cache->stats.evicted++;
+		dns_cache_remove_entry(cache, cache->oldest);
+	}
+}
+
+/*returns the entry of this key, pending or not expired, if any*/
+static belle_sip_dns_cache_entry_t *dns_cache_find(belle_sip_dns_cache_t *cache, const char *key) {
+	belle_sip_dns_cache_entry_t *entry =
+	    belle_sip_hash_index_find_custom(cache->entries, key, dns_cache_entry_compare_key, key);
+	if (entry && entry->query == NULL && entry->expires <= belle_sip_time_ms()) {
+		dns_cache_remove_entry(cache, entry);
+		entry = NULL;
+	}
+	return entry;
+}
+
+static belle_sip_dns_srv_t *dns_srv_clone(const belle_sip_dns_srv_t *srv) {
+	belle_sip_dns_srv_t *obj = belle_sip_object_new(belle_sip_dns_srv_t);
+	obj->priority = srv->priority;
+	obj->weight = srv->weight;
+	obj->port = srv->port;
+	obj->target = belle_sip_strdup(srv->target);
+	return obj;
+}
+
+/*gives the answer of the entry to a resolver context, as if it had received it from the DNS server*/
+static void dns_cache_entry_fill(const belle_sip_dns_cache_entry_t *entry,
+                                 belle_sip_simple_resolver_context_t *ctx,
+                                 uint32_t ttl) {
+	const belle_sip_list_t *elem;
+	if (entry->type == DNS_T_SRV) {
+		for (elem = entry->srv_list; elem != NULL; elem = elem->next) {
+			belle_sip_dns_srv_t *srv = dns_srv_clone((const belle_sip_dns_srv_t *)elem->data);
+			ctx->srv_list = belle_sip_list_append(ctx->srv_list, belle_sip_object_ref(srv));
+		}
+	} else {
+		int family = (ctx->flags & AI_V4MAPPED) ? AF_INET6 : ctx->family;
+		for (elem = entry->addresses; elem != NULL; elem = elem->next) {
+			ctx->ai_list = ai_list_append(
+			    ctx->ai_list, bctbx_ip_address_to_addrinfo(family, SOCK_STREAM, (const char *)elem->data, ctx->port));
+		}
+	}
+	if (ttl < ctx->base.min_ttl) ctx->base.min_ttl = ttl;
+}
+
+/*sends the query of a name whose answer is not in the cache, without waiting for it*/
+static void dns_cache_prefetch(belle_sip_dns_cache_t *cache, const char *name, enum dns_type type) {
+	char *key = dns_cache_make_key(name, type);
+	if (dns_cache_find(cache, key)) belle_sip_free(key);
+	else dns_cache_query(cache, key, name, type, NULL);
+}
+
+static void dns_cache_prewarm_srv_targets(belle_sip_dns_cache_t *cache, const belle_sip_dns_cache_entry_t *entry) {
+	const belle_sip_list_t *elem;
+	for (elem = entry->srv_list; elem != NULL; elem = elem->next) {
+		const char *target = ((const belle_sip_dns_srv_t *)elem->data)->target;
+		dns_cache_prefetch(cache, target, DNS_T_A);
+		dns_cache_prefetch(cache, target, DNS_T_AAAA);
+	}
+}
+
+/*
+ * Called with the answer of the query of the entry, its TTL being UINT32_MAX if there was none. The answer is kept if
+ * it has a TTL, then notified to the waiting resolver contexts.
+ */
+static void dns_cache_entry_answered(belle_sip_dns_cache_entry_t *entry, uint32_t ttl) {
+	belle_sip_dns_cache_t *cache = entry->cache;
+	belle_sip_list_t *waiters = entry->waiters;
+	belle_sip_list_t *elem;
+
+	entry->waiters = NULL;
+	entry->query = NULL;
+	/*the answer is given to all the waiters before notifying them, as their callbacks may flush the cache or cancel
+	 * each other*/
+	for (elem = waiters; elem != NULL; elem = elem->next) {
+		belle_sip_simple_resolver_context_t *ctx = (belle_sip_simple_resolver_context_t *)elem->data;
+		belle_sip_object_ref(ctx);
+		ctx->cache_entry = NULL;
+		dns_cache_entry_fill(entry, ctx, ttl);
+	}
+	if (ttl > 0 && ttl != UINT32_MAX && !entry->stale) {
+		entry->expires = belle_sip_time_ms() + (uint64_t)ttl * 1000;
+		if (entry->prewarm) dns_cache_prewarm_srv_targets(cache, entry);
+		/*linked after the queries of the prewarm, so that they cannot evict it*/
+		dns_cache_link_entry(cache, entry);
+	} else {
+		dns_cache_remove_entry(cache, entry);
+	}
+	for (elem = waiters; elem != NULL; elem = elem->next) {
+		belle_sip_resolver_context_notify(BELLE_SIP_RESOLVER_CONTEXT(elem->data));
+		belle_sip_object_unref(elem->data);
+	}
+	belle_sip_list_free(waiters);
+}
+
+static uint32_t dns_cache_negative_ttl(const belle_sip_simple_resolver_context_t *query) {
+	if (!query->answered || query->negative_ttl == UINT32_MAX) return UINT32_MAX;
+	return MIN(query->negative_ttl, BELLE_SIP_DNS_CACHE_MAX_NEGATIVE_TTL);
+}
+
+static void dns_cache_on_results(void *data, belle_sip_resolver_results_t *results) {
+	belle_sip_dns_cache_entry_t *entry = (belle_sip_dns_cache_entry_t *)data;
+	const struct addrinfo *ai;
+	uint32_t ttl = results->ttl;
+
+	for (ai = results->ai_list; ai != NULL; ai = ai->ai_next) {
+		char host[NI_MAXHOST + 1];
+		if (bctbx_getnameinfo(ai->ai_addr, (socklen_t)ai->ai_addrlen, host, sizeof(host), NULL, 0, NI_NUMERICHOST) ==
+		    0)
+			entry->addresses = belle_sip_list_append(entry->addresses, belle_sip_strdup(host));
+	}
+	if (results->ai_list == NULL) ttl = dns_cache_negative_ttl(entry->query);
+	dns_cache_entry_answered(entry, ttl);
+}
+
+static void dns_cache_on_srv_results(void *data, const char *name, belle_sip_list_t *srv_list, uint32_t ttl) {
+	belle_sip_dns_cache_entry_t *entry = (belle_sip_dns_cache_entry_t *)data;
+	entry->srv_list = srv_list;
+	if (srv_list == NULL) ttl = dns_cache_negative_ttl(entry->query);
+	dns_cache_entry_answered(entry, ttl);
+}
+
+/*creates the entry of key, whose ownership is taken, and sends its query*/
+static void dns_cache_query(belle_sip_dns_cache_t *cache,
+                            char *key,
+                            const char *name,
+                            enum dns_type type,
+                            belle_sip_simple_resolver_context_t *waiter) {
+	belle_sip_dns_cache_entry_t *entry = belle_sip_new0(belle_sip_dns_cache_entry_t);
+	belle_sip_simple_resolver_context_t *query = simple_resolver_context_new(cache->stack, name, type);
+
+	entry->cache = cache;
+	entry->key = key;
+	entry->type = type;
+	entry->query = query;
+	entry->prewarm = (waiter == NULL);
+	if (waiter) {
+		waiter->cache_entry = entry;
+		entry->waiters = belle_sip_list_append(NULL, waiter);
+	}
+	dns_cache_evict(cache);
+	belle_sip_hash_index_add(cache->entries, entry);
+	cache->stats.misses++;
+
+	if (type == DNS_T_SRV) {
+		query->srv_cb = dns_cache_on_srv_results;
+		query->srv_cb_data = entry;
+	} else {
+		query->cb = dns_cache_on_results;
+		query->cb_data = entry;
+		query->family = (type == DNS_T_AAAA) ? AF_INET6 : AF_INET;
+	}
+	/*the answer may be notified before returning, and the entry removed if it is not to be kept*/
+	resolver_start_query(query);
+}
+
+static void dns_cache_resolve(belle_sip_dns_cache_t *cache, belle_sip_simple_resolver_context_t *ctx) {
+	char *key = dns_cache_make_key(ctx->name, ctx->type);
+	belle_sip_dns_cache_entry_t *entry = dns_cache_find(cache, key);
+
+	if (entry == NULL) {
+		dns_cache_query(cache, key, ctx->name, ctx->type, ctx);
+		return;
+	}
+	belle_sip_free(key);
+	if (entry->query) {
+		cache->stats.coalesced++;
+		ctx->cache_entry = entry;
+		entry->waiters = belle_sip_list_append(entry->waiters, ctx);
+	} else {
+		cache->stats.hits++;
+		belle_sip_message("%s resolved from the DNS cache", ctx->name);
+		dns_cache_entry_fill(entry, ctx, (uint32_t)((entry->expires - belle_sip_time_ms() + 999) / 1000));
+		belle_sip_resolver_context_notify(BELLE_SIP_RESOLVER_CONTEXT(ctx));
+	}
+}
+
+static void dns_cache_remove_waiter(belle_sip_simple_resolver_context_t *ctx) {
+	if (ctx->cache_entry == NULL) return;
+	ctx->cache_entry->waiters = belle_sip_list_remove(ctx->cache_entry->waiters, ctx);
+	ctx->cache_entry = NULL;
+}
+
+/*starts a resolution, returns the context if its results are not notified yet, NULL otherwise*/
+static belle_sip_resolver_context_t *simple_resolver_context_start(belle_sip_simple_resolver_context_t *ctx) {
+	belle_sip_resolver_context_t *ret = NULL;
+
+	if (!dns_cache_usable(ctx->base.stack, ctx->name)) return (belle_sip_resolver_context_t *)resolver_start_query(ctx);
+	belle_sip_object_ref(ctx);
+	dns_cache_resolve(ctx->base.stack->dns_cache, ctx);
+	if (!ctx->base.notified) ret = BELLE_SIP_RESOLVER_CONTEXT(ctx);
+	belle_sip_object_unref(ctx);
+	return ret;
+}
+
 static void belle_sip_combined_resolver_context_destroy(belle_sip_combined_resolver_context_t *obj) {
 	if (obj->name != NULL) {
 		belle_sip_free(obj->name);
@@ -1555,6 +1952,7 @@ static void belle_sip_dual_resolver_context_destroy(belle_sip_dual_resolver_cont
 }
 
 static void simple_resolver_context_cancel(belle_sip_resolver_context_t *obj) {
+	dns_cache_remove_waiter(BELLE_SIP_SIMPLE_RESOLVER_CONTEXT(obj));
 	belle_sip_main_loop_remove_source(obj->stack->ml, (belle_sip_source_t *)obj);
 }
 
@@ -1830,31 +2228,15 @@ static belle_sip_resolver_context_t *belle_sip_stack_resolve_single(belle_sip_st
                                                                     belle_sip_resolver_callback_t cb,
                                                                     void *data) {
 	/* Then perform asynchronous DNS A or AAAA query */
-	belle_sip_simple_resolver_context_t *ctx = belle_sip_object_new(belle_sip_simple_resolver_context_t);
-	belle_sip_resolver_context_init((belle_sip_resolver_context_t *)ctx, stack);
+	belle_sip_simple_resolver_context_t *ctx =
+	    simple_resolver_context_new(stack, name, (family == AF_INET6) ? DNS_T_AAAA : DNS_T_A);
 	ctx->cb_data = data;
 	ctx->cb = cb;
-	ctx->name = belle_sip_strdup(name);
 	ctx->port = port;
 	ctx->flags = flags;
-	belle_sip_object_set_name((belle_sip_object_t *)ctx, ctx->name);
-	/* Take a ref for the entire duration of the DNS procedure, it will be released when it is finished */
-	belle_sip_object_ref(ctx);
 	if (family == 0) family = AF_UNSPEC;
 	ctx->family = family;
-#ifdef HAVE_DNS_SERVICE
-	ctx->dns_service_queue = stack->dns_service_queue;
-	dispatch_retain(ctx->dns_service_queue); // take a ref on the dispatch queue
-	ctx->dns_service_type = (ctx->family == AF_INET6) ? kDNSServiceType_AAAA : kDNSServiceType_A;
-	if (stack->use_dns_service == TRUE) {
-		bctbx_mutex_init(&ctx->notify_mutex, NULL);
-	}
-#endif /* HAVE_DNS_SERVICE */
-	ctx->type = (ctx->family == AF_INET6) ? DNS_T_AAAA : DNS_T_A;
-#if (defined(USE_GETADDRINFO_FALLBACK) || defined(HAVE_MDNS)) && defined(_WIN32)
-	ctx->ctlevent = (belle_sip_fd_t)-1;
-#endif
-	return (belle_sip_resolver_context_t *)resolver_start_query(ctx);
+	return simple_resolver_context_start(ctx);
 }
 
 static uint8_t belle_sip_resolver_context_can_be_cancelled(belle_sip_resolver_context_t *obj) {
@@ -1975,9 +2357,9 @@ belle_sip_resolver_context_t *belle_sip_stack_resolve_srv(belle_sip_stack_t *sta
                                                           const char *name,
                                                           belle_sip_resolver_srv_callback_t cb,
                                                           void *data) {
-	belle_sip_simple_resolver_context_t *ctx = belle_sip_object_new(belle_sip_simple_resolver_context_t);
 	char *srv_prefix = srv_prefix_from_service_and_transport(service, transport);
-	belle_sip_resolver_context_init((belle_sip_resolver_context_t *)ctx, stack);
+	char *srv_name = belle_sip_concat(srv_prefix, name, NULL);
+	belle_sip_simple_resolver_context_t *ctx = simple_resolver_context_new(stack, srv_name, DNS_T_SRV);
 	ctx->srv_cb_data = data;
 	ctx->srv_cb = cb;
 #ifdef HAVE_MDNS
@@ -1986,21 +2368,41 @@ belle_sip_resolver_context_t *belle_sip_stack_resolve_srv(belle_sip_stack_t *sta
 	ctx->resolving = 0;
 	ctx->browse_finished = FALSE;
 #endif
-	ctx->name = belle_sip_concat(srv_prefix, name, NULL);
-#ifdef HAVE_DNS_SERVICE
-	ctx->dns_service_queue = stack->dns_service_queue;
-	dispatch_retain(ctx->dns_service_queue); // take a ref on the dispatch queue
-	ctx->dns_service_type = kDNSServiceType_SRV;
-	if (stack->use_dns_service == TRUE) {
-		bctbx_mutex_init(&ctx->notify_mutex, NULL);
-	}
-#endif /* HAVE_DNS_SERVICE */
-	ctx->type = DNS_T_SRV;
-	belle_sip_object_set_name((belle_sip_object_t *)ctx, ctx->name);
-	/* Take a ref for the entire duration of the DNS procedure, it will be released when it is finished */
-	belle_sip_object_ref(ctx);
+	belle_sip_free(srv_name);
 	belle_sip_free(srv_prefix);
-	return (belle_sip_resolver_context_t *)resolver_start_query(ctx);
+	return simple_resolver_context_start(ctx);
+}
+
+void belle_sip_stack_flush_dns_cache(belle_sip_stack_t *stack) {
+	belle_sip_dns_cache_flush(stack->dns_cache);
+}
+
+void belle_sip_stack_prewarm_dns_cache(belle_sip_stack_t *stack, const char *domain) {
+	static const char *transports[] = {"udp", "tcp", "tls"};
+	struct addrinfo *res;
+	size_t i;
+
+	if (!dns_cache_usable(stack, domain)) return;
+	res = bctbx_ip_address_to_addrinfo(AF_UNSPEC, SOCK_STREAM, domain, 0);
+	if (res) {
+		bctbx_freeaddrinfo(res); /*nothing to resolve*/
+		return;
+	}
+	belle_sip_message("Prewarming the DNS cache for %s", domain);
+	for (i = 0; stack->dns_srv_enabled && i < sizeof(transports) / sizeof(transports[0]); i++) {
+		char *srv_prefix = srv_prefix_from_service_and_transport(NULL, transports[i]);
+		char *srv_name = belle_sip_concat(srv_prefix, domain, NULL);
+		dns_cache_prefetch(stack->dns_cache, srv_name, DNS_T_SRV);
+		belle_sip_free(srv_name);
+		belle_sip_free(srv_prefix);
+	}
+	dns_cache_prefetch(stack->dns_cache, domain, DNS_T_A);
+	dns_cache_prefetch(stack->dns_cache, domain, DNS_T_AAAA);
+}
+
+void belle_sip_stack_get_dns_cache_stats(const belle_sip_stack_t *stack, belle_sip_dns_cache_stats_t *stats) {
+	*stats = stack->dns_cache->stats;
+	stats->entries = (unsigned int)belle_sip_hash_index_get_count(stack->dns_cache->entries);
 }
 
 int belle_sip_resolver_context_cancel(belle_sip_resolver_context_t *obj) {
@@ -457,3 +457,118 @@ char *belle_sip_display_name_to_backslashed_escaped_string(const char *buff) {
 	output_buff[out_buff_index] = '\0';
 	return belle_sip_strdup(output_buff);
 }
+
+/*
+ * The objects are kept in chained buckets, whose number is doubled when there are more objects than buckets: the
+ * buckets stay short, so that a lookup only compares a few objects, whatever their total number.
+ */
+#define BELLE_SIP_HASH_INDEX_INITIAL_SIZE 64
+
+struct belle_sip_hash_index {
+	belle_sip_hash_index_key_func_t get_key;
+	belle_sip_list_t **buckets;
+	size_t nbuckets; /*always a power of two*/
+	size_t count;
+};
+
+/*FNV-1a*/
+static size_t hash_index_hash(const char *key) {
+	uint32_t hash = 2166136261u;
+	for (; *key != '\0'; key++) {
+		hash ^= (uint8_t)*key;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static belle_sip_list_t **hash_index_bucket(const belle_sip_hash_index_t *index, const char *key) {
+	return &index->buckets[hash_index_hash(key) & (index->nbuckets - 1)];
+}
+
+belle_sip_hash_index_t *belle_sip_hash_index_new(belle_sip_hash_index_key_func_t get_key) {
+	belle_sip_hash_index_t *index = belle_sip_new0(belle_sip_hash_index_t);
+	index->get_key = get_key;
+	index->nbuckets = BELLE_SIP_HASH_INDEX_INITIAL_SIZE;
+	index->buckets = belle_sip_malloc0(index->nbuckets * sizeof(belle_sip_list_t *));
+	return index;
+}
+
+void belle_sip_hash_index_destroy(belle_sip_hash_index_t *index) {
+	size_t i;
+	for (i = 0; i < index->nbuckets; i++) {
+		belle_sip_list_free(index->buckets[i]);
+	}
+	belle_sip_free(index->buckets);
+	belle_sip_free(index);
+}
+
+static void hash_index_grow(belle_sip_hash_index_t *index) {
+	belle_sip_list_t **old_buckets = index->buckets;
+	size_t old_nbuckets = index->nbuckets;
+	size_t i;
+
+	index->nbuckets *= 2;
+	index->buckets = belle_sip_malloc0(index->nbuckets * sizeof(belle_sip_list_t *));
+	for (i = 0; i < old_nbuckets; i++) {
+		/*appended from the last to keep the order of the objects with the same key*/
+		belle_sip_list_t *elem = belle_sip_list_last_elem(old_buckets[i]);
+		for (; elem != NULL; elem = elem->prev) {
+			belle_sip_list_t **bucket = hash_index_bucket(index, index->get_key(elem->data));
+			*bucket = belle_sip_list_prepend(*bucket, elem->data);
+		}
+		belle_sip_list_free(old_buckets[i]);
+	}
+	belle_sip_free(old_buckets);
+}
+
+void belle_sip_hash_index_add(belle_sip_hash_index_t *index, void *obj) {
+	belle_sip_list_t **bucket;
+	if (index->count >= index->nbuckets) hash_index_grow(index);
+	bucket = hash_index_bucket(index, index->get_key(obj));
+	*bucket = belle_sip_list_prepend(*bucket, obj);
+	index->count++;
+}
+
+int belle_sip_hash_index_remove(belle_sip_hash_index_t *index, void *obj) {
+	belle_sip_list_t **bucket = hash_index_bucket(index, index->get_key(obj));
+	belle_sip_list_t *elem = belle_sip_list_find(*bucket, obj);
+	if (elem == NULL) return -1;
+	*bucket = belle_sip_list_delete_link(*bucket, elem);
+	index->count--;
+	return 0;
+}
+
+void *belle_sip_hash_index_find_custom(const belle_sip_hash_index_t *index,
+                                       const char *key,
+                                       belle_sip_compare_func compare_func,
+                                       const void *user_data) {
+	belle_sip_list_t *elem = belle_sip_list_find_custom(*hash_index_bucket(index, key), compare_func, user_data);
+	return elem ? elem->data : NULL;
+}
+
+void *belle_sip_hash_index_find_any(const belle_sip_hash_index_t *index,
+                                    belle_sip_compare_func compare_func,
+                                    const void *user_data) {
+	size_t i;
+	for (i = 0; i < index->nbuckets; i++) {
+		belle_sip_list_t *elem = belle_sip_list_find_custom(index->buckets[i], compare_func, user_data);
+		if (elem) return elem->data;
+	}
+	return NULL;
+}
+
+belle_sip_list_t *belle_sip_hash_index_get_all(const belle_sip_hash_index_t *index) {
+	belle_sip_list_t *all = NULL;
+	size_t i;
+	for (i = 0; i < index->nbuckets; i++) {
+		const belle_sip_list_t *elem;
+		for (elem = index->buckets[i]; elem != NULL; elem = elem->next) {
+			all = belle_sip_list_prepend(all, elem->data);
+		}
+	}
+	return all;
+}
+
+size_t belle_sip_hash_index_get_count(const belle_sip_hash_index_t *index) {
+	return index->count;
+}
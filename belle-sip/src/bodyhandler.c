@@ -252,7 +252,19 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_memory_body_handler_t){
     belle_sip_memory_body_handler_recv_chunk,
     belle_sip_memory_body_handler_send_chunk} BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_END
 
-    void *belle_sip_memory_body_handler_get_buffer(const belle_sip_memory_body_handler_t *obj) {
+    const uint8_t *belle_sip_body_handler_send_in_place(belle_sip_body_handler_t *obj, belle_sip_message_t *msg) {
+	belle_sip_memory_body_handler_t *mbh;
+	if (!BELLE_SIP_OBJECT_IS_INSTANCE_OF(obj, belle_sip_memory_body_handler_t)) return NULL;
+	mbh = (belle_sip_memory_body_handler_t *)obj;
+	if (mbh->buffer == NULL || obj->expected_size == 0) return NULL;
+	belle_sip_body_handler_begin_send_transfer(obj);
+	obj->transfered_size = obj->expected_size;
+	update_progress(obj, msg);
+	belle_sip_body_handler_end_transfer(obj);
+	return mbh->buffer;
+}
+
+void *belle_sip_memory_body_handler_get_buffer(const belle_sip_memory_body_handler_t *obj) {
 	return obj->buffer;
 }
 
@@ -18,6 +18,7 @@
  */
 
 #include "belle_sip_internal.h"
+#include "channel_bank.hh"
 #include <ctype.h>
 #include <limits.h>
 #include <wchar.h>
@@ -179,7 +180,8 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_channel_t){
     NULL, /* connect */
     NULL, /* channel_send */
     NULL, /* channel_recv */
-    NULL  /* close */
+    NULL, /* close */
+    NULL  /* channel_sendv */
     BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_END
 
     static void fix_incoming_via(belle_sip_request_t *msg, const struct addrinfo *origin) {
@@ -1015,6 +1017,15 @@ int belle_sip_channel_send(belle_sip_channel_t *obj, const void *buf, size_t buf
 	return BELLE_SIP_OBJECT_VPTR(obj, belle_sip_channel_t)->channel_send(obj, buf, buflen);
 }
 
+int belle_sip_channel_sendv(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt) {
+	update_inactivity_timer(obj, FALSE);
+	return BELLE_SIP_OBJECT_VPTR(obj, belle_sip_channel_t)->channel_sendv(obj, iov, iovcnt);
+}
+
+int belle_sip_channel_can_sendv(const belle_sip_channel_t *obj) {
+	return BELLE_SIP_OBJECT_VPTR(obj, belle_sip_channel_t)->channel_sendv != NULL;
+}
+
 static bool_t is_pong(const char *buf, size_t buflen) {
 	return buflen == 2 && strncmp(buf, "\r\n", 2) == 0;
 }
@@ -1127,6 +1138,11 @@ static void channel_connect_next(belle_sip_channel_t *obj) {
 	belle_sip_object_unref(obj);
 }
 
+/* the channel bank indexes the channels by peer address, name and port */
+static void channel_update_bank(belle_sip_channel_t *obj) {
+	if (obj->bank) belle_sip_channel_bank_update_channel(obj->bank, obj);
+}
+
 static void channel_set_current_peer(belle_sip_channel_t *obj, const struct addrinfo *ai) {
 	if (obj->resolver_results) {
 		const belle_sip_dns_srv_t *srv = belle_sip_resolver_results_get_srv_from_addrinfo(obj->resolver_results, ai);
@@ -1139,6 +1155,7 @@ static void channel_set_current_peer(belle_sip_channel_t *obj, const struct addr
 		obj->current_peer_cname = NULL;
 	}
 	obj->current_peer = ai;
+	channel_update_bank(obj);
 }
 
 static void belle_sip_channel_handle_error(belle_sip_channel_t *obj) {
@@ -1217,13 +1234,25 @@ static void free_ewouldblock_buffer(belle_sip_channel_t *obj) {
 	}
 }
 
-static void handle_ewouldblock(belle_sip_channel_t *obj, const char *buffer, size_t size) {
+static void handle_ewouldblock_iov(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt) {
+	size_t size = 0;
+	int i;
 	belle_sip_source_set_events((belle_sip_source_t *)obj,
 	                            BELLE_SIP_EVENT_READ | BELLE_SIP_EVENT_WRITE | BELLE_SIP_EVENT_ERROR);
 	free_ewouldblock_buffer(obj);
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].len;
 	obj->ewouldblock_buffer = belle_sip_malloc(size);
 	obj->ewouldblock_size = size;
-	memcpy(obj->ewouldblock_buffer, buffer, size);
+	for (i = 0, size = 0; i < iovcnt; i++) {
+		memcpy(obj->ewouldblock_buffer + size, iov[i].base, iov[i].len);
+		size += iov[i].len;
+	}
+}
+
+static void handle_ewouldblock(belle_sip_channel_t *obj, const char *buffer, size_t size) {
+	belle_sip_iovec_t iov = {buffer, size};
+	handle_ewouldblock_iov(obj, &iov, 1);
 }
 
 static size_t find_non_printable(const char *buffer, size_t size) {
@@ -1294,12 +1323,38 @@ static char *make_logbuf(belle_sip_channel_t *obj,
 	return logbuf;
 }
 
-static int send_buffer(belle_sip_channel_t *obj, const char *buffer, size_t size) {
+/*same as make_logbuf() for the first size bytes of a vectored send*/
+static char *make_iov_logbuf(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt, size_t size) {
+	char *buffer;
+	char *logbuf;
+	size_t off = 0;
+	int i;
+
+	if (iovcnt == 1) return make_logbuf(obj, BELLE_SIP_LOG_MESSAGE, iov[0].base, size, BELLE_SIP_DIRECTION_SEND);
+	if (!belle_sip_log_level_enabled(BELLE_SIP_LOG_MESSAGE)) return NULL;
+	buffer = belle_sip_malloc(size);
+	for (i = 0; i < iovcnt && off < size; i++) {
+		size_t len = MIN(iov[i].len, size - off);
+		memcpy(buffer + off, iov[i].base, len);
+		off += len;
+	}
+	logbuf = make_logbuf(obj, BELLE_SIP_LOG_MESSAGE, buffer, size, BELLE_SIP_DIRECTION_SEND);
+	belle_sip_free(buffer);
+	return logbuf;
+}
+
+/*sends the buffers of iov at once, with the vectored send of the channel if there are several*/
+static int send_buffers(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt) {
 	int ret = 0;
 	char *logbuf = NULL;
+	size_t size = 0;
+	int i;
 
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].len;
 	if (obj->stack->send_error == 0) {
-		ret = belle_sip_channel_send(obj, buffer, size);
+		if (iovcnt == 1) ret = belle_sip_channel_send(obj, iov[0].base, size);
+		else ret = belle_sip_channel_sendv(obj, iov, iovcnt);
 	} else if (obj->stack->send_error < 0) {
 		/*for testing purpose only */
 		belle_sip_message("channel[%p]: simulating socket error [%i].", obj, (int)obj->stack->send_error);
@@ -1317,14 +1372,14 @@ static int send_buffer(belle_sip_channel_t *obj, const char *buffer, size_t size
 			channel_set_state(obj, BELLE_SIP_CHANNEL_ERROR);
 		} /*ewouldblock error has to be handled by caller*/
 	} else if (size == (size_t)ret) {
-		logbuf = make_logbuf(obj, BELLE_SIP_LOG_MESSAGE, buffer, size, BELLE_SIP_DIRECTION_SEND);
+		logbuf = make_iov_logbuf(obj, iov, iovcnt, size);
 		if (logbuf) {
 			belle_sip_message("channel [%p]: message %s to [%s://%s:%i], size: [%i] bytes\n%s", obj,
 			                  obj->stack->send_error == 0 ? "sent" : "silently discarded",
 			                  belle_sip_channel_get_transport_name(obj), obj->peer_name, obj->peer_port, ret, logbuf);
 		}
 	} else {
-		logbuf = make_logbuf(obj, BELLE_SIP_LOG_MESSAGE, buffer, ret, BELLE_SIP_DIRECTION_SEND);
+		logbuf = make_iov_logbuf(obj, iov, iovcnt, ret);
 		if (logbuf) {
 			belle_sip_message("channel [%p]: message partly sent to [%s://%s:%i], sent: [%i/%i] bytes:\n%s", obj,
 			                  belle_sip_channel_get_transport_name(obj), obj->peer_name, obj->peer_port, ret, (int)size,
@@ -1335,6 +1390,11 @@ static int send_buffer(belle_sip_channel_t *obj, const char *buffer, size_t size
 	return ret;
 }
 
+static int send_buffer(belle_sip_channel_t *obj, const char *buffer, size_t size) {
+	belle_sip_iovec_t iov = {buffer, size};
+	return send_buffers(obj, &iov, 1);
+}
+
 static void check_content_length(belle_sip_message_t *msg, size_t body_len) {
 	belle_sip_header_content_length_t *ctlen =
 	    belle_sip_message_get_header_by_type(msg, belle_sip_header_content_length_t);
@@ -1423,13 +1483,56 @@ static void _send_message(belle_sip_channel_t *obj) {
 	}
 
 	if (obj->out_state == OUTPUT_STREAM_SENDING_HEADERS) {
-		BELLE_SIP_CHANNEL_INVOKE_SENDING_LISTENERS(obj, msg);
-		check_content_length(msg, body_len);
-		error = belle_sip_object_marshal((belle_sip_object_t *)msg, buffer, sizeof(buffer) - 1, &len);
-		if (error != BELLE_SIP_OK) {
-			belle_sip_error("channel [%p] _send_message: marshaling failed.", obj);
+		/*retransmissions reuse the headers marshalled for the previous transmission*/
+		const char *headers = belle_sip_message_get_marshalled_headers(msg, &len);
+		const uint8_t *body = NULL;
+
+		if (headers == NULL) {
+			BELLE_SIP_CHANNEL_INVOKE_SENDING_LISTENERS(obj, msg);
+			check_content_length(msg, body_len);
+			error = belle_sip_object_marshal((belle_sip_object_t *)msg, buffer, sizeof(buffer) - 1, &len);
+			if (error != BELLE_SIP_OK) {
+				belle_sip_error("channel [%p] _send_message: marshaling failed.", obj);
+				goto done;
+			}
+			/*only requests and responses sent on unreliable channels are retransmitted*/
+			if (!belle_sip_channel_is_reliable(obj)) belle_sip_message_set_marshalled_headers(msg, buffer, len);
+			headers = buffer;
+		}
+		if (bh && body_len > 0 && belle_sip_channel_can_sendv(obj))
+			body = belle_sip_body_handler_send_in_place(bh, msg);
+		if (body) {
+			/*send the headers and the body at once, without copying the body after the headers*/
+			belle_sip_iovec_t iov[2];
+			belle_sip_iovec_t *it = iov;
+			int iovcnt = 2;
+
+			iov[0].base = headers;
+			iov[0].len = len;
+			iov[1].base = body;
+			iov[1].len = body_len;
+			do {
+				sendret = send_buffers(obj, it, iovcnt);
+				if (sendret > 0) {
+					off = (size_t)sendret;
+					while (iovcnt > 0 && off >= it->len) {
+						off -= it->len;
+						it++;
+						iovcnt--;
+					}
+					if (iovcnt == 0) break;
+					it->base = (const uint8_t *)it->base + off;
+					it->len -= off;
+				} else if (belle_sip_error_code_is_would_block(-sendret)) {
+					handle_ewouldblock_iov(obj, it, iovcnt);
+					return;
+				} else { /*error or disconnection case*/
+					goto done;
+				}
+			} while (1);
 			goto done;
 		}
+		if (headers != buffer) memcpy(buffer, headers, len);
 		/*send the headers and eventually the body if it fits in our buffer*/
 		if (bh) {
 			size_t max_body_len = sizeof(buffer) - 1 - len;
@@ -1716,6 +1819,7 @@ void belle_sip_channel_connect(belle_sip_channel_t *obj) {
 		/*the SRV resolution provided a port number that must be used*/
 		obj->srv_overrides_port = TRUE;
 		obj->peer_port = port;
+		channel_update_bank(obj);
 	}
 	belle_sip_message("Trying to connect to [%s://%s:%i]", belle_sip_channel_get_transport_name(obj), ip,
 	                  obj->peer_port);
@@ -1765,7 +1869,16 @@ static void queue_message_delayed(belle_sip_channel_t *obj, belle_sip_message_t
 	belle_sip_message("channel %p: message sending delayed by %i ms", obj, obj->stack->tx_delay);
 }
 
+int belle_sip_channel_queue_retransmission(belle_sip_channel_t *obj, belle_sip_message_t *msg) {
+	if (obj->stack->tx_delay > 0) {
+		queue_message_delayed(obj, msg);
+	} else queue_message(obj, msg);
+	return 0;
+}
+
 int belle_sip_channel_queue_message(belle_sip_channel_t *obj, belle_sip_message_t *msg) {
+	/*the message may have been modified since it was last sent*/
+	belle_sip_message_invalidate_marshalled_headers(msg);
 	if (obj->stack->tx_delay > 0) {
 		queue_message_delayed(obj, msg);
 	} else queue_message(obj, msg);
@@ -1786,7 +1899,7 @@ void belle_sip_channel_check_dns_reusability(belle_sip_channel_t *obj) {
 
 void belle_sip_channel_set_simulated_recv_return(belle_sip_channel_t *obj, int recv_error) {
 	obj->simulated_recv_return = recv_error;
-	obj->base.notify_required = (recv_error <= 0);
+	belle_sip_source_set_notify_required((belle_sip_source_t *)obj, recv_error <= 0);
 }
 
 const char *belle_sip_channel_get_bank_identifier(const belle_sip_channel_t *obj) {
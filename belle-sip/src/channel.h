@@ -33,6 +33,13 @@
 #define belle_sip_network_buffer_size 65535
 #define belle_sip_send_network_buffer_size 16384
 #define belle_sip_max_network_data_size_per_iterate 1000000 /* 1Mo */
+#define belle_sip_max_iovec_count 8 /* for the vectored send of a channel */
+
+/*a piece of the data given to the vectored send of a channel*/
+typedef struct belle_sip_iovec {
+	const void *base;
+	size_t len;
+} belle_sip_iovec_t;
 
 typedef enum belle_sip_channel_state {
 	BELLE_SIP_CHANNEL_INIT,
@@ -53,6 +60,7 @@ const char *belle_sip_channel_state_to_string(belle_sip_channel_state_t state);
  *or outgoing client sockets).
  **/
 typedef struct belle_sip_channel belle_sip_channel_t;
+typedef struct _belle_sip_channel_bank belle_sip_channel_bank_t;
 
 BELLE_SIP_DECLARE_INTERFACE_BEGIN(belle_sip_channel_listener_t)
 void (*on_state_changed)(belle_sip_channel_listener_t *l, belle_sip_channel_t *, belle_sip_channel_state_t state);
@@ -91,6 +99,7 @@ struct belle_sip_channel {
 	belle_sip_source_t base;
 	belle_sip_stack_t *stack;
 	belle_sip_listening_point_t *lp; /*the listening point that owns this channel*/
+	belle_sip_channel_bank_t *bank;  /*the bank indexing this channel, not referenced*/
 	char *bank_identifier;
 	belle_sip_channel_state_t state;
 	belle_sip_list_t *state_listeners;
@@ -153,13 +162,14 @@ void belle_sip_channel_add_listener(belle_sip_channel_t *chan, belle_sip_channel
 
 void belle_sip_channel_remove_listener(belle_sip_channel_t *obj, belle_sip_channel_listener_t *l);
 
-int belle_sip_channel_matches(const belle_sip_channel_t *obj, const belle_sip_hop_t *hop, const struct addrinfo *addr);
+BELLESIP_EXPORT int
+belle_sip_channel_matches(const belle_sip_channel_t *obj, const belle_sip_hop_t *hop, const struct addrinfo *addr);
 
 void belle_sip_channel_resolve(belle_sip_channel_t *obj);
 
 void belle_sip_channel_connect(belle_sip_channel_t *obj);
 
-void belle_sip_channel_prepare(belle_sip_channel_t *obj);
+BELLESIP_EXPORT void belle_sip_channel_prepare(belle_sip_channel_t *obj);
 
 void belle_sip_channel_close(belle_sip_channel_t *obj);
 /**
@@ -167,6 +177,13 @@ void belle_sip_channel_close(belle_sip_channel_t *obj);
  * returns number of send byte or <0 in case of error
  */
 int belle_sip_channel_send(belle_sip_channel_t *obj, const void *buf, size_t buflen);
+/**
+ * Sends the iovcnt buffers of iov at once, as a single datagram for unreliable channels.
+ * Must be called only if the channel implements it, see belle_sip_channel_can_sendv().
+ * returns number of send byte or <0 in case of error
+ */
+int belle_sip_channel_sendv(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt);
+BELLESIP_EXPORT int belle_sip_channel_can_sendv(const belle_sip_channel_t *obj);
 
 int belle_sip_channel_recv(belle_sip_channel_t *obj, void *buf, size_t buflen);
 /*only used by channels implementation*/
@@ -192,7 +209,12 @@ void belle_sip_channel_set_socket(belle_sip_channel_t *obj, belle_sip_socket_t s
  */
 belle_sip_message_t *belle_sip_channel_pick_message(belle_sip_channel_t *obj);
 
-int belle_sip_channel_queue_message(belle_sip_channel_t *obj, belle_sip_message_t *msg);
+BELLESIP_EXPORT int belle_sip_channel_queue_message(belle_sip_channel_t *obj, belle_sip_message_t *msg);
+/**
+ * Same as belle_sip_channel_queue_message() for the retransmission of a message already sent on this channel: the
+ * headers marshalled for the previous transmission are sent again, unless the message was modified in between.
+ */
+int belle_sip_channel_queue_retransmission(belle_sip_channel_t *obj, belle_sip_message_t *msg);
 
 int belle_sip_channel_is_reliable(const belle_sip_channel_t *obj);
 
@@ -225,7 +247,7 @@ void channel_set_state(belle_sip_channel_t *obj, belle_sip_channel_state_t state
 int belle_sip_channel_process_data(belle_sip_channel_t *obj, unsigned int revents);
 
 /*this function is to be used only in belle_sip_listening_point_clean_channels()*/
-void belle_sip_channel_force_close(belle_sip_channel_t *obj);
+BELLESIP_EXPORT void belle_sip_channel_force_close(belle_sip_channel_t *obj);
 
 /*this function is for transactions to report that a channel seems non working because a timeout occured for example.
  It results in the channel possibly entering error state, so that it gets cleaned. Next transactions will re-open a new
@@ -250,9 +272,9 @@ void belle_sip_channel_enable_ping_pong(belle_sip_channel_t *obj, int enabled);
 
 int belle_sip_channel_ping_pong_enabled(const belle_sip_channel_t *obj);
 
-const char *belle_sip_channel_get_bank_identifier(const belle_sip_channel_t *obj);
+BELLESIP_EXPORT const char *belle_sip_channel_get_bank_identifier(const belle_sip_channel_t *obj);
 
-void belle_sip_channel_set_bank_identifier(belle_sip_channel_t *obj, const char *identifier);
+BELLESIP_EXPORT void belle_sip_channel_set_bank_identifier(belle_sip_channel_t *obj, const char *identifier);
 
 BELLE_SIP_END_DECLS
 
@@ -263,6 +285,7 @@ int (*connect)(belle_sip_channel_t *obj, const struct addrinfo *ai);
 int (*channel_send)(belle_sip_channel_t *obj, const void *buf, size_t buflen);
 int (*channel_recv)(belle_sip_channel_t *obj, void *buf, size_t buflen);
 void (*close)(belle_sip_channel_t *obj);
+int (*channel_sendv)(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt); /*optional*/
 BELLE_SIP_DECLARE_CUSTOM_VPTR_END
 
 /*
@@ -291,6 +314,4 @@ struct belle_tls_crypto_config {
 	void *postcheck_cb_data;
 };
 
-typedef struct _belle_sip_channel_bank belle_sip_channel_bank_t;
-
 #endif
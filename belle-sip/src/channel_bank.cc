@@ -18,41 +18,134 @@
  */
 
 #include <algorithm>
+#include <cctype>
 
 #include "channel_bank.hh"
 
 namespace bellesip {
 
+std::string ChannelBank::makeAddressKey(const struct sockaddr *addr) {
+	/* Same criteria as bctbx_sockaddr_equals(): family, address and port. */
+	std::string key(1, (char)addr->sa_family);
+	if (addr->sa_family == AF_INET) {
+		const struct sockaddr_in *sin = (const struct sockaddr_in *)addr;
+		key.append((const char *)&sin->sin_addr, sizeof(sin->sin_addr));
+		key.append((const char *)&sin->sin_port, sizeof(sin->sin_port));
+	} else if (addr->sa_family == AF_INET6) {
+		const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *)addr;
+		key.append((const char *)&sin6->sin6_addr, sizeof(sin6->sin6_addr));
+		key.append((const char *)&sin6->sin6_port, sizeof(sin6->sin6_port));
+	} else return std::string();
+	return key;
+}
+
+/* A port of 0 stands for any port. Names are lowercased: the index gives candidates, that are then checked with
+ * belle_sip_channel_matches(). */
+std::string ChannelBank::makeNameKey(const char *name, int port) {
+	std::string key(name);
+	std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)tolower(c); });
+	key += ':';
+	key += std::to_string(port);
+	return key;
+}
+
+void ChannelBank::addToIndex(ChannelIndex &index, const std::string &key, belle_sip_channel_t *channel) {
+	index[key].push_back(channel);
+}
+
+void ChannelBank::removeFromIndex(ChannelIndex &index, const std::string &key, belle_sip_channel_t *channel) {
+	auto it = index.find(key);
+	if (it == index.end()) return;
+	auto &channels = it->second;
+	auto pos = std::find(channels.begin(), channels.end(), channel);
+	if (pos != channels.end()) {
+		*pos = channels.back();
+		channels.pop_back();
+	}
+	if (channels.empty()) index.erase(it);
+}
+
+void ChannelBank::indexChannel(belle_sip_channel_t *channel, ChannelEntry &entry) {
+	if (channel->current_peer) {
+		entry.addressKey = makeAddressKey(channel->current_peer->ai_addr);
+		if (!entry.addressKey.empty()) addToIndex(mChannelsByAddress, entry.addressKey, channel);
+	}
+	if (channel->peer_name) {
+		/* A port given by a SRV record overrides the one of the hop, see belle_sip_channel_matches(). */
+		entry.nameKeys.push_back(makeNameKey(channel->peer_name, channel->srv_overrides_port ? 0 : channel->peer_port));
+	}
+	if (channel->current_peer_cname) {
+		entry.nameKeys.push_back(makeNameKey(channel->current_peer_cname, channel->peer_port));
+	}
+	for (auto &key : entry.nameKeys)
+		addToIndex(mChannelsByName, key, channel);
+}
+
+void ChannelBank::unindexChannel(belle_sip_channel_t *channel, ChannelEntry &entry) {
+	if (!entry.addressKey.empty()) removeFromIndex(mChannelsByAddress, entry.addressKey, channel);
+	entry.addressKey.clear();
+	for (auto &key : entry.nameKeys)
+		removeFromIndex(mChannelsByName, key, channel);
+	entry.nameKeys.clear();
+}
+
 void ChannelBank::addChannel(belle_sip_channel_t *channel) {
-	auto &l = mChannelsById[normalizeIdentifier(belle_sip_channel_get_bank_identifier(channel))];
+	auto &entry = mEntries[channel];
+	entry.identifier = normalizeIdentifier(belle_sip_channel_get_bank_identifier(channel));
+	auto &l = mChannelsById[entry.identifier];
 	/* The channel with names must be treated with higher priority by the get_channel() method so queued on front.
 	 * This is to prevent the UDP listening point to dispatch incoming messages to channels that were created by inbound
 	 * connection where name cannot be determined. When this arrives, there can be 2 channels for the same destination
 	 * IP and strange problems can occur where requests are sent through name qualified channel and response received
 	 * through name unqualified channel.
 	 */
-	if (channel->has_name) l.push_front(channel);
-	else l.push_back(channel);
+	if (channel->has_name) {
+		entry.position = l.insert(l.begin(), channel);
+		entry.order = --mFrontOrder;
+	} else {
+		entry.position = l.insert(l.end(), channel);
+		entry.order = ++mBackOrder;
+	}
+	indexChannel(channel, entry);
+	channel->bank = toC();
+}
+
+void ChannelBank::eraseChannel(std::unordered_map<belle_sip_channel_t *, ChannelEntry>::iterator it) {
+	belle_sip_channel_t *channel = it->first;
+	auto position = it->second.position;
+	std::string identifier = it->second.identifier;
+
+	unindexChannel(channel, it->second);
+	channel->bank = nullptr;
+	mEntries.erase(it);
+	mChannelsById[identifier].erase(position); /* may drop the last reference to the channel */
 }
 
 void ChannelBank::removeChannel(belle_sip_channel_t *channel) {
-	auto &l = mChannelsById[normalizeIdentifier(belle_sip_channel_get_bank_identifier(channel))];
-	auto it = std::find(l.begin(), l.end(), channel);
-	if (it != l.end()) {
-		l.erase(it);
+	auto it = mEntries.find(channel);
+	if (it != mEntries.end()) {
+		eraseChannel(it);
 	} else {
-		belle_sip_error("hannelBank::removeChannel(): no channel [%p]", channel);
+		belle_sip_error("ChannelBank::removeChannel(): no channel [%p]", channel);
 	}
 }
 
+void ChannelBank::updateChannel(belle_sip_channel_t *channel) {
+	auto it = mEntries.find(channel);
+	if (it == mEntries.end()) return;
+	unindexChannel(channel, it->second);
+	indexChannel(channel, it->second);
+}
+
 size_t ChannelBank::removeChannelIf(int (*func)(belle_sip_channel_t *, void *), void *user_data) {
 	size_t count = 0;
 	for (auto &p : mChannelsById) {
 		for (auto it = p.second.begin(); it != p.second.end();) {
-			if (func(it->get(), user_data)) {
-				it = p.second.erase(it);
+			belle_sip_channel_t *channel = (it++)->get();
+			if (func(channel, user_data)) {
+				eraseChannel(mEntries.find(channel));
 				++count;
-			} else ++it;
+			}
 		}
 	}
 	return count;
@@ -62,33 +155,48 @@ std::string ChannelBank::normalizeIdentifier(const char *identifier) const {
 	return identifier ? std::string(identifier) : "default";
 }
 
-belle_sip_channel_t *ChannelBank::findChannel(const std::list<SmartCPointer<belle_sip_channel_t>> &l,
-                                              const belle_sip_hop_t *hop,
-                                              const struct addrinfo *addr) const {
-	for (auto &chanPointer : l) {
-		belle_sip_channel_t *chan = chanPointer.get();
+/* Keeps in best the first usable channel matching the hop or the address, in the order of the lists. */
+void ChannelBank::findChannel(const std::vector<belle_sip_channel_t *> &candidates,
+                              const std::string *identifier,
+                              const belle_sip_hop_t *hop,
+                              const struct addrinfo *addr,
+                              const ChannelEntry **best) const {
+	for (belle_sip_channel_t *chan : candidates) {
+		const ChannelEntry &entry = mEntries.find(chan)->second;
+		if (identifier && entry.identifier != *identifier) continue;
+		if (*best) {
+			int cmp = entry.identifier.compare((*best)->identifier);
+			if (cmp > 0 || (cmp == 0 && entry.order >= (*best)->order)) continue;
+		}
 		if (chan->state == BELLE_SIP_CHANNEL_DISCONNECTED || chan->state == BELLE_SIP_CHANNEL_ERROR) continue;
 		if (!chan->about_to_be_closed && belle_sip_channel_matches(chan, hop, addr)) {
-			return chan;
+			*best = &entry;
 		}
 	}
-	return nullptr;
 }
 
 belle_sip_channel_t *ChannelBank::findChannel(const belle_sip_hop_t *hop, const struct addrinfo *addr) const {
-	if (hop) {
-		std::string channelIdentifier = normalizeIdentifier(belle_sip_hop_get_channel_bank_identifier(hop));
-		auto map_it = mChannelsById.find(channelIdentifier);
+	const ChannelEntry *best = nullptr;
+	std::string channelIdentifier;
 
-		if (map_it == mChannelsById.end()) return nullptr;
-		return findChannel(map_it->second, hop, addr);
+	if (hop) {
+		channelIdentifier = normalizeIdentifier(belle_sip_hop_get_channel_bank_identifier(hop));
+		if (mChannelsById.find(channelIdentifier) == mChannelsById.end()) return nullptr;
+		if (hop->host) {
+			for (int port : {hop->port, 0}) {
+				auto it = mChannelsByName.find(makeNameKey(hop->host, port));
+				if (it != mChannelsByName.end()) findChannel(it->second, &channelIdentifier, hop, addr, &best);
+			}
+		}
 	}
-	/* global search with hop, actually used only for incoming requests on UDP listening socket.*/
-	for (auto &p : mChannelsById) {
-		auto channel = findChannel(p.second, hop, addr);
-		if (channel) return channel;
+	/* without hop, the search is done in all the bank identifiers: this is actually used only for incoming requests on
+	 * UDP listening socket.*/
+	if (addr && addr->ai_addr) {
+		auto it = mChannelsByAddress.find(makeAddressKey(addr->ai_addr));
+		if (it != mChannelsByAddress.end())
+			findChannel(it->second, hop ? &channelIdentifier : nullptr, hop, addr, &best);
 	}
-	return nullptr;
+	return best ? best->position->get() : nullptr;
 }
 
 belle_sip_channel_t *ChannelBank::findChannel(const belle_sip_uri_t *uri) const {
@@ -124,18 +232,19 @@ void ChannelBank::forEach(void (*func)(belle_sip_channel_t *, void *), void *use
 }
 
 size_t ChannelBank::getCount() const {
-	size_t count = 0;
-	for (auto &p : mChannelsById)
-		count += p.second.size();
-	return count;
+	return mEntries.size();
 }
 
 void ChannelBank::clearAllChannels() {
 	for (auto &p : mChannelsById) {
 		for (auto &elem : p.second) {
+			elem.get()->bank = nullptr;
 			belle_sip_channel_force_close(elem.get());
 		}
 	}
+	mEntries.clear();
+	mChannelsByAddress.clear();
+	mChannelsByName.clear();
 	mChannelsById.clear();
 }
 
@@ -159,6 +268,10 @@ void belle_sip_channel_bank_remove_channel(belle_sip_channel_bank_t *obj, belle_
 	ChannelBank::toCpp(obj)->removeChannel(chan);
 }
 
+void belle_sip_channel_bank_update_channel(belle_sip_channel_bank_t *obj, belle_sip_channel_t *chan) {
+	ChannelBank::toCpp(obj)->updateChannel(chan);
+}
+
 size_t belle_sip_channel_bank_remove_if(belle_sip_channel_bank_t *obj,
                                         int (*func)(belle_sip_channel_t *, void *),
                                         void *user_data) {
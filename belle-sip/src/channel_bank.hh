@@ -25,8 +25,11 @@
 #ifdef __cplusplus
 
 #include "belle-sip/object++.hh"
+#include <list>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace bellesip {
 
@@ -63,6 +66,11 @@ struct SmartCPointer {
 	}
 };
 
+/*
+ * The channels are kept in one list per bank identifier, that gives the order in which they are looked up. They are
+ * also indexed by the address of their current peer, and by the names and ports they can be matched with, so that
+ * finding the channel of a destination does not require to go through all the channels of the bank.
+ */
 class ChannelBank : public HybridObject<belle_sip_channel_bank_t, ChannelBank> {
 public:
 	explicit ChannelBank() = default;
@@ -73,6 +81,8 @@ public:
 	belle_sip_channel_t *findChannel(const belle_sip_uri_t *local_uri) const;
 	void addChannel(belle_sip_channel_t *channel);
 	void removeChannel(belle_sip_channel_t *channel);
+	// indexes again a channel whose current peer, peer name or peer port has changed.
+	void updateChannel(belle_sip_channel_t *channel);
 	// removes a channel if predicate returns != 0, returns the number of removed channels.
 	size_t removeChannelIf(int (*func)(belle_sip_channel_t *, void *), void *user_data);
 	size_t getCount() const;
@@ -81,10 +91,33 @@ public:
 	std::string normalizeIdentifier(const char *identifier) const;
 
 private:
-	belle_sip_channel_t *findChannel(const std::list<SmartCPointer<belle_sip_channel_t>> &l,
-	                                 const belle_sip_hop_t *hop,
-	                                 const struct addrinfo *addr) const;
-	std::map<std::string, std::list<SmartCPointer<belle_sip_channel_t>>> mChannelsById;
+	using ChannelList = std::list<SmartCPointer<belle_sip_channel_t>>;
+	using ChannelIndex = std::unordered_map<std::string, std::vector<belle_sip_channel_t *>>;
+	struct ChannelEntry {
+		std::string identifier;
+		ChannelList::iterator position;
+		long long order; // rank of the channel in its list
+		std::string addressKey;
+		std::vector<std::string> nameKeys;
+	};
+	static std::string makeAddressKey(const struct sockaddr *addr);
+	static std::string makeNameKey(const char *name, int port);
+	static void addToIndex(ChannelIndex &index, const std::string &key, belle_sip_channel_t *channel);
+	static void removeFromIndex(ChannelIndex &index, const std::string &key, belle_sip_channel_t *channel);
+	void indexChannel(belle_sip_channel_t *channel, ChannelEntry &entry);
+	void unindexChannel(belle_sip_channel_t *channel, ChannelEntry &entry);
+	void eraseChannel(std::unordered_map<belle_sip_channel_t *, ChannelEntry>::iterator it);
+	void findChannel(const std::vector<belle_sip_channel_t *> &candidates,
+	                 const std::string *identifier,
+	                 const belle_sip_hop_t *hop,
+	                 const struct addrinfo *addr,
+	                 const ChannelEntry **best) const;
+	std::map<std::string, ChannelList> mChannelsById;
+	std::unordered_map<belle_sip_channel_t *, ChannelEntry> mEntries;
+	ChannelIndex mChannelsByAddress;
+	ChannelIndex mChannelsByName;
+	long long mFrontOrder = 0;
+	long long mBackOrder = 0;
 };
 
 } // namespace bellesip
@@ -92,29 +125,31 @@ private:
 extern "C" {
 #endif
 
-belle_sip_channel_bank_t *belle_sip_channel_bank_new(void);
+BELLESIP_EXPORT belle_sip_channel_bank_t *belle_sip_channel_bank_new(void);
+
+BELLESIP_EXPORT void belle_sip_channel_bank_add_channel(belle_sip_channel_bank_t *obj, belle_sip_channel_t *chan);
 
-void belle_sip_channel_bank_add_channel(belle_sip_channel_bank_t *obj, belle_sip_channel_t *chan);
+BELLESIP_EXPORT void belle_sip_channel_bank_remove_channel(belle_sip_channel_bank_t *obj, belle_sip_channel_t *chan);
 
-void belle_sip_channel_bank_remove_channel(belle_sip_channel_bank_t *obj, belle_sip_channel_t *chan);
+BELLESIP_EXPORT void belle_sip_channel_bank_update_channel(belle_sip_channel_bank_t *obj, belle_sip_channel_t *chan);
 
 size_t belle_sip_channel_bank_remove_if(belle_sip_channel_bank_t *obj,
                                         int (*func)(belle_sip_channel_t *, void *),
                                         void *user_data);
 
-void belle_sip_channel_bank_for_each(belle_sip_channel_bank_t *obj,
-                                     void (*func)(belle_sip_channel_t *, void *),
-                                     void *user_data);
+BELLESIP_EXPORT void belle_sip_channel_bank_for_each(belle_sip_channel_bank_t *obj,
+                                                     void (*func)(belle_sip_channel_t *, void *),
+                                                     void *user_data);
 
-size_t belle_sip_channel_bank_get_count(belle_sip_channel_bank_t *obj);
+BELLESIP_EXPORT size_t belle_sip_channel_bank_get_count(belle_sip_channel_bank_t *obj);
 
-void belle_sip_channel_bank_clear_all(belle_sip_channel_bank_t *obj);
+BELLESIP_EXPORT void belle_sip_channel_bank_clear_all(belle_sip_channel_bank_t *obj);
 
-belle_sip_channel_t *
+BELLESIP_EXPORT belle_sip_channel_t *
 belle_sip_channel_bank_find(belle_sip_channel_bank_t *obj, int ai_family, const belle_sip_hop_t *hop);
 
-belle_sip_channel_t *belle_sip_channel_bank_find_by_addrinfo(belle_sip_channel_bank_t *obj,
-                                                             const struct addrinfo *addr);
+BELLESIP_EXPORT belle_sip_channel_t *belle_sip_channel_bank_find_by_addrinfo(belle_sip_channel_bank_t *obj,
+                                                                             const struct addrinfo *addr);
 belle_sip_channel_t *belle_sip_channel_bank_find_by_local_uri(belle_sip_channel_bank_t *obj,
                                                               const belle_sip_uri_t *uri);
 
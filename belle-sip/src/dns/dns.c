@@ -7191,11 +7191,13 @@ exec:
 			 * options.recurse. See DNS_R_BIND.
 			 */
 			if (!R->resconf->options.recurse) {
+				/* Without search, this answer is the final one, even if empty */
+				if (!R->search_enabled) dgoto(R->sp, DNS_R_FINISH);
+
 				/* Make first answer our tentative answer */
 				if (!R->nodata) dns_p_movptr(&R->nodata, &F->answer);
 
-				if (R->search_enabled) dgoto(R->sp, DNS_R_SEARCH);
-				else dgoto(R->sp, DNS_R_FINISH);
+				dgoto(R->sp, DNS_R_SEARCH);
 			}
 
 			dns_rr_foreach(&rr, F->answer, .section = DNS_S_NS, .type = DNS_T_NS) {
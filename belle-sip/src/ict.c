@@ -139,7 +139,7 @@ static void ict_on_response(belle_sip_ict_t *obj, belle_sip_response_t *resp) {
 			break;
 		case BELLE_SIP_TRANSACTION_COMPLETED:
 			if (code >= 300 && obj->ack) {
-				belle_sip_channel_queue_message(base->channel, (belle_sip_message_t *)obj->ack);
+				belle_sip_channel_queue_retransmission(base->channel, (belle_sip_message_t *)obj->ack);
 			} else if (code >= 200 && code < 300) {
 				/* CANCEL / 200 OK race condition */
 				belle_sip_client_transaction_notify_response((belle_sip_client_transaction_t *)obj, resp);
@@ -161,7 +161,7 @@ static int ict_on_timer_A(belle_sip_ict_t *obj) {
 			/*reset the timer to twice the previous value, and retransmit */
 			int64_t prev_timeout = belle_sip_source_get_timeout_int64(obj->timer_A);
 			belle_sip_source_set_timeout_int64(obj->timer_A, 2 * prev_timeout);
-			belle_sip_channel_queue_message(base->channel, (belle_sip_message_t *)base->request);
+			belle_sip_channel_queue_retransmission(base->channel, (belle_sip_message_t *)base->request);
 		} break;
 		default:
 			break;
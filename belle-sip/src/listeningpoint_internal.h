@@ -63,13 +63,13 @@ BELLE_SIP_END_DECLS
 
 /**udp*/
 typedef struct belle_sip_udp_listening_point belle_sip_udp_listening_point_t;
-belle_sip_channel_t *belle_sip_channel_new_udp(belle_sip_stack_t *stack,
-                                               int sock,
-                                               const char *bindip,
-                                               int localport,
-                                               const char *peername,
-                                               int peerport,
-                                               int no_srv);
+BELLESIP_EXPORT belle_sip_channel_t *belle_sip_channel_new_udp(belle_sip_stack_t *stack,
+                                                               int sock,
+                                                               const char *bindip,
+                                                               int localport,
+                                                               const char *peername,
+                                                               int peerport,
+                                                               int no_srv);
 belle_sip_channel_t *belle_sip_channel_new_udp_with_addr(
     belle_sip_stack_t *stack, int sock, const char *bindip, int localport, const struct addrinfo *ai);
 belle_sip_listening_point_t *belle_sip_udp_listening_point_new(belle_sip_stack_t *s, const char *ipaddress, int port);
@@ -18,10 +18,12 @@
  */
 
 #include "belle_sip_internal.h"
+#include "sip/sip_fast_parser.hh"
 #include "sip/sip_parser.hh"
 
 typedef struct _headers_container {
 	char *name;
+	belle_sip_header_id_t id;
 	belle_sip_list_t *header_list;
 } headers_container_t;
 
@@ -78,9 +80,10 @@ static const char *expand_name(const char *name) {
 	return full_name;
 }
 
-static headers_container_t *belle_sip_message_headers_container_new(const char *name) {
+static headers_container_t *belle_sip_message_headers_container_new(const char *name, belle_sip_header_id_t id) {
 	headers_container_t *headers_container = belle_sip_new0(headers_container_t);
-	headers_container->name = belle_sip_strdup(expand_name(name));
+	headers_container->name = belle_sip_strdup(name);
+	headers_container->id = id;
 	return headers_container;
 }
 
@@ -95,6 +98,7 @@ static void belle_sip_message_destroy(belle_sip_message_t *msg) {
 	if (msg->body_handler) belle_sip_object_unref(msg->body_handler);
 	if (msg->multipart_body_cache) bctbx_free(msg->multipart_body_cache);
 	if (msg->channel_bank_identifier) bctbx_free(msg->channel_bank_identifier);
+	if (msg->marshalled_headers) belle_sip_free(msg->marshalled_headers);
 }
 
 /*very sub-optimal clone method */
@@ -123,7 +127,17 @@ belle_sip_message_t *belle_sip_message_parse(const char *value) {
 	return belle_sip_message_parse_raw(value, strlen(value), &message_length);
 }
 
+static bool_t fast_parser_enabled = TRUE;
+
+void belle_sip_message_enable_fast_parser(bool_t enable) {
+	fast_parser_enabled = enable;
+}
+
 belle_sip_message_t *belle_sip_message_parse_raw(const char *buff, size_t buff_length, size_t *message_length) {
+	if (fast_parser_enabled) {
+		belle_sip_message_t *message = bellesip::SIP::FastParser::parseMessage(buff, buff_length, message_length);
+		if (message) return message;
+	}
 	auto parser = bellesip::SIP::Parser::getInstance();
 	auto object = parser->parse(buff, "message", message_length);
 	if (object) {
@@ -160,37 +174,70 @@ belle_sip_message_t *belle_sip_message_parse_sipfrag(const char *value) {
 	return nullptr;
 }
 
-static int belle_sip_headers_container_comp_func(const headers_container_t *a, const char *b) {
-	return strcasecmp(a->name, b);
+void belle_sip_message_init(belle_sip_message_t *message) {
 }
 
-void belle_sip_message_init(belle_sip_message_t *message) {
+/*
+ * The containers of the well known headers are found from their slot, the name of the others is compared only with
+ * the ones of the containers that have no slot.
+ */
+static headers_container_t *
+headers_container_find(const belle_sip_message_t *message, const char *name, belle_sip_header_id_t id) {
+	const belle_sip_list_t *elem;
+	if (id != BELLE_SIP_HEADER_ID_OTHER) return message->header_slots[id];
+	for (elem = message->header_list; elem != NULL; elem = elem->next) {
+		headers_container_t *headers_container = (headers_container_t *)elem->data;
+		if (headers_container->id == BELLE_SIP_HEADER_ID_OTHER && strcasecmp(headers_container->name, name) == 0)
+			return headers_container;
+	}
+	return NULL;
 }
 
 headers_container_t *belle_sip_headers_container_get(const belle_sip_message_t *message, const char *header_name) {
-	belle_sip_list_t *result = belle_sip_list_find_custom(
-	    message->header_list, (belle_sip_compare_func)belle_sip_headers_container_comp_func, header_name);
-	return result ? (headers_container_t *)(result->data) : NULL;
+	const char *name = expand_name(header_name);
+	return headers_container_find(message, name, belle_sip_header_id_from_name(name));
 }
 
-headers_container_t *get_or_create_container(belle_sip_message_t *message, const char *header_name) {
-	// first check if already exist
-	headers_container_t *headers_container = belle_sip_headers_container_get(message, header_name);
+static headers_container_t *
+get_or_create_container_for_name(belle_sip_message_t *message, const char *name, belle_sip_header_id_t id) {
+	headers_container_t *headers_container = headers_container_find(message, name, id);
 	if (headers_container == NULL) {
-		headers_container = belle_sip_message_headers_container_new(header_name);
+		headers_container = belle_sip_message_headers_container_new(name, id);
 		message->header_list = belle_sip_list_append(message->header_list, headers_container);
+		if (id != BELLE_SIP_HEADER_ID_OTHER) message->header_slots[id] = headers_container;
 	}
 	return headers_container;
 }
 
+headers_container_t *get_or_create_container(belle_sip_message_t *message, const char *header_name) {
+	const char *name = expand_name(header_name);
+	return get_or_create_container_for_name(message, name, belle_sip_header_id_from_name(name));
+}
+
+/*uses the id computed when the name of the header was set, which spares the lookup of the name*/
+static headers_container_t *get_or_create_container_for_header(belle_sip_message_t *message,
+                                                               const belle_sip_header_t *header) {
+	if (header->id != BELLE_SIP_HEADER_ID_OTHER)
+		return get_or_create_container_for_name(message, header->name, header->id);
+	return get_or_create_container(message, header->name);
+}
+
+static void headers_container_remove(belle_sip_message_t *message, headers_container_t *headers_container) {
+	message->header_list = belle_sip_list_remove(message->header_list, headers_container);
+	if (headers_container->id != BELLE_SIP_HEADER_ID_OTHER) message->header_slots[headers_container->id] = NULL;
+	belle_sip_headers_container_delete(headers_container);
+}
+
 void belle_sip_message_add_first(belle_sip_message_t *message, belle_sip_header_t *header) {
-	headers_container_t *headers_container = get_or_create_container(message, belle_sip_header_get_name(header));
+	belle_sip_message_invalidate_marshalled_headers(message);
+	headers_container_t *headers_container = get_or_create_container_for_header(message, header);
 	headers_container->header_list =
 	    belle_sip_list_prepend(headers_container->header_list, belle_sip_object_ref(header));
 }
 
 extern "C" void belle_sip_message_add_header(belle_sip_message_t *message, belle_sip_header_t *header) {
-	headers_container_t *headers_container = get_or_create_container(message, belle_sip_header_get_name(header));
+	belle_sip_message_invalidate_marshalled_headers(message);
+	headers_container_t *headers_container = get_or_create_container_for_header(message, header);
 	headers_container->header_list =
 	    belle_sip_list_append(headers_container->header_list, belle_sip_object_ref(header));
 }
@@ -210,8 +257,9 @@ void belle_sip_message_add_headers(belle_sip_message_t *message, const belle_sip
 
 	if (header_list == NULL) return;
 
+	belle_sip_message_invalidate_marshalled_headers(message);
 	hname = belle_sip_header_get_name(BELLE_SIP_HEADER((header_list->data)));
-	headers_container = get_or_create_container(message, hname);
+	headers_container = get_or_create_container_for_header(message, BELLE_SIP_HEADER(header_list->data));
 
 	for (; header_list != NULL; header_list = header_list->next) {
 		belle_sip_header_t *h = BELLE_SIP_HEADER(header_list->data);
@@ -225,7 +273,8 @@ void belle_sip_message_add_headers(belle_sip_message_t *message, const belle_sip
 }
 
 void belle_sip_message_set_header(belle_sip_message_t *msg, belle_sip_header_t *header) {
-	headers_container_t *headers_container = get_or_create_container(msg, belle_sip_header_get_name(header));
+	belle_sip_message_invalidate_marshalled_headers(msg);
+	headers_container_t *headers_container = get_or_create_container_for_header(msg, header);
 	belle_sip_object_ref(header);
 	headers_container->header_list =
 	    belle_sip_list_free_with_data(headers_container->header_list, belle_sip_object_unref);
@@ -237,9 +286,28 @@ const belle_sip_list_t *belle_sip_message_get_headers(const belle_sip_message_t
 	return headers_container ? headers_container->header_list : NULL;
 }
 
+const belle_sip_list_t *belle_sip_message_get_headers_by_id(const belle_sip_message_t *message,
+                                                            belle_sip_header_id_t id) {
+	headers_container_t *headers_container = message->header_slots[id];
+	return headers_container ? headers_container->header_list : NULL;
+}
+
+belle_sip_header_t *belle_sip_message_get_header_by_id(const belle_sip_message_t *message, belle_sip_header_id_t id) {
+	headers_container_t *headers_container = message->header_slots[id];
+	return headers_container && headers_container->header_list
+	           ? (belle_sip_header_t *)headers_container->header_list->data
+	           : NULL;
+}
+
 belle_sip_object_t *_belle_sip_message_get_header_by_type_id(const belle_sip_message_t *message,
                                                              belle_sip_type_id_t id) {
 	const belle_sip_list_t *e1;
+	belle_sip_header_id_t header_id = belle_sip_header_id_from_type_id(id);
+	if (header_id != BELLE_SIP_HEADER_ID_OTHER) {
+		/*the headers of this type are normally in the slot of their name*/
+		belle_sip_object_t *ret = (belle_sip_object_t *)belle_sip_message_get_header_by_id(message, header_id);
+		if (ret && ret->vptr->id == id) return ret;
+	}
 	for (e1 = message->header_list; e1 != NULL; e1 = e1->next) {
 		headers_container_t *headers_container = (headers_container_t *)e1->data;
 		if (headers_container->header_list) {
@@ -251,6 +319,7 @@ belle_sip_object_t *_belle_sip_message_get_header_by_type_id(const belle_sip_mes
 }
 
 void belle_sip_message_remove_first(belle_sip_message_t *msg, const char *header_name) {
+	belle_sip_message_invalidate_marshalled_headers(msg);
 	headers_container_t *headers_container = belle_sip_headers_container_get(msg, header_name);
 	if (headers_container && headers_container->header_list) {
 		belle_sip_list_t *to_be_removed = headers_container->header_list;
@@ -260,6 +329,7 @@ void belle_sip_message_remove_first(belle_sip_message_t *msg, const char *header
 }
 
 void belle_sip_message_remove_last(belle_sip_message_t *msg, const char *header_name) {
+	belle_sip_message_invalidate_marshalled_headers(msg);
 	headers_container_t *headers_container = belle_sip_headers_container_get(msg, header_name);
 	if (headers_container && headers_container->header_list) {
 		belle_sip_list_t *to_be_removed = belle_sip_list_last_elem(headers_container->header_list);
@@ -269,23 +339,19 @@ void belle_sip_message_remove_last(belle_sip_message_t *msg, const char *header_
 }
 
 void belle_sip_message_remove_header(belle_sip_message_t *msg, const char *header_name) {
+	belle_sip_message_invalidate_marshalled_headers(msg);
 	headers_container_t *headers_container = belle_sip_headers_container_get(msg, header_name);
-	if (headers_container) {
-		msg->header_list = belle_sip_list_remove(msg->header_list, headers_container);
-		belle_sip_headers_container_delete(headers_container);
-	}
+	if (headers_container) headers_container_remove(msg, headers_container);
 }
 void belle_sip_message_remove_header_from_ptr(belle_sip_message_t *msg, belle_sip_header_t *header) {
+	belle_sip_message_invalidate_marshalled_headers(msg);
 	headers_container_t *headers_container = belle_sip_headers_container_get(msg, belle_sip_header_get_name(header));
 	belle_sip_list_t *it;
 	it = belle_sip_list_find(headers_container->header_list, header);
 	if (it) {
 		belle_sip_object_unref(header);
 		headers_container->header_list = belle_sip_list_delete_link(headers_container->header_list, it);
-		if (belle_sip_list_size(headers_container->header_list) == 0) {
-			msg->header_list = belle_sip_list_remove(msg->header_list, headers_container);
-			belle_sip_headers_container_delete(headers_container);
-		}
+		if (belle_sip_list_size(headers_container->header_list) == 0) headers_container_remove(msg, headers_container);
 	}
 }
 /*
@@ -454,6 +520,7 @@ void belle_sip_request_set_dialog(belle_sip_request_t *req, belle_sip_dialog_t *
 }
 
 void belle_sip_request_set_uri(belle_sip_request_t *request, belle_sip_uri_t *uri) {
+	belle_sip_message_invalidate_marshalled_headers((belle_sip_message_t *)request);
 	SET_OBJECT_PROPERTY(request, uri, uri);
 	if (request->absolute_uri && uri) {
 		belle_sip_warning("absolute uri [%p] already set for request [%p], cleaning it", request->absolute_uri,
@@ -467,6 +534,7 @@ belle_sip_uri_t *belle_sip_request_get_uri(const belle_sip_request_t *request) {
 }
 
 void belle_sip_request_set_absolute_uri(belle_sip_request_t *request, belle_generic_uri_t *absolute_uri) {
+	belle_sip_message_invalidate_marshalled_headers((belle_sip_message_t *)request);
 	SET_OBJECT_PROPERTY(request, absolute_uri, absolute_uri);
 	if (request->uri && absolute_uri) {
 		belle_sip_warning("sip  uri [%p] already set for request [%p], cleaning it", request->uri, request);
@@ -518,6 +586,34 @@ char *belle_sip_message_to_string(belle_sip_message_t *msg) {
 	return belle_sip_object_to_string(BELLE_SIP_OBJECT(msg));
 }
 
+void belle_sip_message_set_marshalled_headers(belle_sip_message_t *msg, const char *buffer, size_t size) {
+	if (size > msg->marshalled_headers_capacity) {
+		msg->marshalled_headers = (char *)belle_sip_realloc(msg->marshalled_headers, size);
+		msg->marshalled_headers_capacity = size;
+	}
+	memcpy(msg->marshalled_headers, buffer, size);
+	msg->marshalled_headers_size = size;
+}
+
+const char *belle_sip_message_get_marshalled_headers(const belle_sip_message_t *msg, size_t *size) {
+	if (msg->marshalled_headers_size == 0) return NULL;
+	*size = msg->marshalled_headers_size;
+	return msg->marshalled_headers;
+}
+
+void belle_sip_message_invalidate_marshalled_headers(belle_sip_message_t *msg) {
+	msg->marshalled_headers_size = 0;
+}
+
+void belle_sip_message_release_marshalled_headers(belle_sip_message_t *msg) {
+	if (msg->marshalled_headers) {
+		belle_sip_free(msg->marshalled_headers);
+		msg->marshalled_headers = NULL;
+	}
+	msg->marshalled_headers_size = 0;
+	msg->marshalled_headers_capacity = 0;
+}
+
 belle_sip_body_handler_t *belle_sip_message_get_body_handler(const belle_sip_message_t *msg) {
 	return msg->body_handler;
 }
@@ -529,6 +625,7 @@ void belle_sip_message_set_body_handler(belle_sip_message_t *msg, belle_sip_body
 	    belle_sip_message_get_header_by_type(msg, belle_sip_header_content_type_t);
 	const belle_sip_header_t *content_encoding_header = belle_sip_message_get_header(msg, "Content-Encoding");
 	const belle_sip_list_t *body_handler_headers = NULL;
+	belle_sip_message_invalidate_marshalled_headers(msg);
 	if (body_handler) body_handler_headers = belle_sip_body_handler_get_headers(body_handler);
 	/* In case of multipart message, we must add the message Content-Type header containing the boundary */
 	if (body_handler != NULL) {
@@ -885,11 +982,11 @@ belle_sip_response_t *belle_sip_response_create_from_request(belle_sip_request_t
 	if (status_code == 100 && (h = belle_sip_message_get_header((belle_sip_message_t *)req, "timestamp"))) {
 		belle_sip_message_add_header((belle_sip_message_t *)resp, h);
 	}
-	vias = belle_sip_message_get_headers((belle_sip_message_t *)req, "via");
+	vias = belle_sip_message_get_headers_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_VIA);
 	belle_sip_message_add_headers((belle_sip_message_t *)resp, vias);
-	h = belle_sip_message_get_header((belle_sip_message_t *)req, "from");
+	h = belle_sip_message_get_header_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_FROM);
 	if (h) belle_sip_message_add_header((belle_sip_message_t *)resp, h);
-	h = belle_sip_message_get_header((belle_sip_message_t *)req, "to");
+	h = belle_sip_message_get_header_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_TO);
 	if (h) {
 		if (status_code != 100) {
 			// so that to tag can be added
@@ -899,9 +996,9 @@ belle_sip_response_t *belle_sip_response_create_from_request(belle_sip_request_t
 		}
 		belle_sip_message_add_header((belle_sip_message_t *)resp, (belle_sip_header_t *)to);
 	}
-	h = belle_sip_message_get_header((belle_sip_message_t *)req, "call-id");
+	h = belle_sip_message_get_header_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_CALL_ID);
 	if (h) belle_sip_message_add_header((belle_sip_message_t *)resp, h);
-	h = belle_sip_message_get_header((belle_sip_message_t *)req, "cseq");
+	h = belle_sip_message_get_header_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_CSEQ);
 	if (h) {
 		belle_sip_message_add_header((belle_sip_message_t *)resp, h);
 	}
@@ -921,7 +1018,8 @@ belle_sip_response_t *belle_sip_response_create_from_request(belle_sip_request_t
    order of those values.
    */
 void belle_sip_response_fill_for_dialog(belle_sip_response_t *obj, belle_sip_request_t *req) {
-	const belle_sip_list_t *rr = belle_sip_message_get_headers((belle_sip_message_t *)req, BELLE_SIP_RECORD_ROUTE);
+	const belle_sip_list_t *rr =
+	    belle_sip_message_get_headers_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_RECORD_ROUTE);
 	belle_sip_header_contact_t *ct = belle_sip_message_get_header_by_type(obj, belle_sip_header_contact_t);
 	belle_sip_message_remove_header((belle_sip_message_t *)obj, BELLE_SIP_RECORD_ROUTE);
 	if (rr) belle_sip_message_add_headers((belle_sip_message_t *)obj, rr);
@@ -936,7 +1034,8 @@ void belle_sip_response_fill_for_dialog(belle_sip_response_t *obj, belle_sip_req
 }
 
 belle_sip_hop_t *belle_sip_response_get_return_hop(belle_sip_response_t *msg) {
-	belle_sip_header_via_t *via = BELLE_SIP_HEADER_VIA(belle_sip_message_get_header(BELLE_SIP_MESSAGE(msg), "via"));
+	belle_sip_header_via_t *via =
+	    BELLE_SIP_HEADER_VIA(belle_sip_message_get_header_by_id(BELLE_SIP_MESSAGE(msg), BELLE_SIP_HEADER_ID_VIA));
 	if (via) {
 		belle_sip_hop_t *hop;
 		const char *host = belle_sip_header_via_get_received(via) ? belle_sip_header_via_get_received(via)
@@ -91,7 +91,7 @@ static void nist_on_request_retransmission(belle_sip_nist_t *obj) {
 		case BELLE_SIP_TRANSACTION_PROCEEDING:
 		case BELLE_SIP_TRANSACTION_COMPLETED:
 			if (base->channel) {
-				belle_sip_channel_queue_message(base->channel, (belle_sip_message_t *)base->last_response);
+				belle_sip_channel_queue_retransmission(base->channel, (belle_sip_message_t *)base->last_response);
 			} else {
 				belle_sip_error("nist_on_request_retransmission(): no channel");
 			}
@@ -34,6 +34,7 @@ BELLE_SIP_BEGIN_DECLS
 #include <stdint.h>
 #include <strings.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #else
@@ -86,12 +86,16 @@ static void finalize_transaction(belle_sip_transaction_t *tr) {
 	}
 }
 
-static void finalize_transactions(const belle_sip_list_t *l) {
-	belle_sip_list_t *copy = belle_sip_list_copy(l);
+static void finalize_transactions(belle_sip_hash_index_t *transactions) {
+	belle_sip_list_t *copy = belle_sip_hash_index_get_all(transactions);
 	belle_sip_list_free_with_data(copy, (void (*)(void *))finalize_transaction);
+	belle_sip_hash_index_destroy(transactions);
 }
 
 static void belle_sip_provider_uninit(belle_sip_provider_t *p) {
+	belle_sip_hash_index_t *dialogs = p->dialogs;
+
+	/*the transactions remove themselves from the provider when terminated*/
 	finalize_transactions(p->client_transactions);
 	p->client_transactions = NULL;
 	finalize_transactions(p->server_transactions);
@@ -100,7 +104,9 @@ static void belle_sip_provider_uninit(belle_sip_provider_t *p) {
 	p->internal_listeners = belle_sip_list_free(p->internal_listeners);
 	p->auth_contexts =
 	    belle_sip_list_free_with_data(p->auth_contexts, (void (*)(void *))belle_sip_authorization_destroy);
-	p->dialogs = belle_sip_list_free_with_data(p->dialogs, belle_sip_object_unref);
+	p->dialogs = NULL;
+	belle_sip_list_free_with_data(belle_sip_hash_index_get_all(dialogs), belle_sip_object_unref);
+	belle_sip_hash_index_destroy(dialogs);
 	p->lps = belle_sip_list_free_with_data(p->lps, belle_sip_object_unref);
 }
 
@@ -130,14 +136,14 @@ static int notify_client_transaction_match(const void *transaction, const void *
 belle_sip_client_transaction_t *
 belle_sip_provider_find_matching_pending_subscribe_client_transaction_from_notify_req(belle_sip_provider_t *prov,
                                                                                       belle_sip_request_t *req) {
-	belle_sip_list_t *elem;
+	void *tr;
 	if (strcmp("NOTIFY", belle_sip_request_get_method(req)) != 0) {
 		belle_sip_error("belle_sip_provider_find_matching_pending_subscribe_client_transaction_from_notify_req "
 		                "requires a NOTIFY request, not a [%s], on prov [%p]",
 		                belle_sip_request_get_method(req), prov);
 	}
-	elem = belle_sip_list_find_custom(prov->client_transactions, notify_client_transaction_match, req);
-	return elem ? BELLE_SIP_CLIENT_TRANSACTION(elem->data) : NULL;
+	tr = belle_sip_hash_index_find_any(prov->client_transactions, notify_client_transaction_match, req);
+	return tr ? BELLE_SIP_CLIENT_TRANSACTION(tr) : NULL;
 }
 
 static void belle_sip_provider_dispatch_request(belle_sip_provider_t *prov, belle_sip_request_t *req) {
@@ -370,7 +376,7 @@ compute_hash_from_invariants(belle_sip_message_t *msg, char *branchid, size_t br
 	belle_sip_uri_t *requri = NULL;
 	belle_sip_header_via_t *via = NULL;
 	belle_sip_header_via_t *prev_via = NULL;
-	const belle_sip_list_t *vias = belle_sip_message_get_headers(msg, "via");
+	const belle_sip_list_t *vias = belle_sip_message_get_headers_by_id(msg, BELLE_SIP_HEADER_ID_VIA);
 	int is_request = belle_sip_message_is_request(msg);
 
 	if (vias) {
@@ -452,7 +458,8 @@ static char *compute_rfc2543_branch(belle_sip_request_t *req, char *branchid, si
 }
 
 static void fix_outgoing_via(belle_sip_provider_t *p, belle_sip_channel_t *chan, belle_sip_message_t *msg) {
-	belle_sip_header_via_t *via = BELLE_SIP_HEADER_VIA(belle_sip_message_get_header(msg, "via"));
+	belle_sip_header_via_t *via =
+	    BELLE_SIP_HEADER_VIA(belle_sip_message_get_header_by_id(msg, BELLE_SIP_HEADER_ID_VIA));
 	if (p->rport_enabled) belle_sip_parameters_set_parameter(BELLE_SIP_PARAMETERS(via), "rport", NULL);
 
 	belle_sip_header_via_set_host(via, chan->local_ip);
@@ -604,9 +611,20 @@ channel_state_changed, channel_on_message_headers, channel_on_message, channel_o
 
 BELLE_SIP_INSTANCIATE_VPTR(belle_sip_provider_t, belle_sip_object_t, belle_sip_provider_uninit, NULL, NULL, FALSE);
 
+static const char *transaction_get_branch_id(const void *t) {
+	return ((const belle_sip_transaction_t *)t)->branch_id;
+}
+
+static const char *dialog_get_call_id(const void *dialog) {
+	return belle_sip_header_call_id_get_call_id(((const belle_sip_dialog_t *)dialog)->call_id);
+}
+
 belle_sip_provider_t *belle_sip_provider_new(belle_sip_stack_t *s, belle_sip_listening_point_t *lp) {
 	belle_sip_provider_t *p = belle_sip_object_new(belle_sip_provider_t);
 	p->stack = s;
+	p->client_transactions = belle_sip_hash_index_new(transaction_get_branch_id);
+	p->server_transactions = belle_sip_hash_index_new(transaction_get_branch_id);
+	p->dialogs = belle_sip_hash_index_new(dialog_get_call_id);
 	p->rport_enabled = 1;
 	p->unconditional_answer = 480;
 	p->response_integrity_checking_enabled = TRUE;
@@ -731,31 +749,45 @@ belle_sip_dialog_t *belle_sip_provider_create_dialog_internal(belle_sip_provider
 	return dialog;
 }
 
+struct dialog_matcher {
+	const char *call_id;
+	const char *local_tag;
+	const char *remote_tag;
+	belle_sip_dialog_t *returned_dialog;
+};
+
+/*never reports a match, so that all the dialogs with the call-id are checked*/
+static int dialog_match(const void *p_dialog, const void *p_matcher) {
+	belle_sip_dialog_t *dialog = (belle_sip_dialog_t *)p_dialog;
+	struct dialog_matcher *matcher = (struct dialog_matcher *)p_matcher;
+	/*ignore dialog in state BELLE_SIP_DIALOG_NULL, is it really the correct things to do*/
+	if (belle_sip_dialog_get_state(dialog) != BELLE_SIP_DIALOG_NULL &&
+	    _belle_sip_dialog_match(dialog, matcher->call_id, matcher->local_tag, matcher->remote_tag)) {
+		if (!matcher->returned_dialog) matcher->returned_dialog = dialog;
+		else {
+			belle_sip_fatal("More than 1 dialog is matching, check your app");
+		}
+	}
+	return -1;
+}
+
 static belle_sip_dialog_t *_belle_sip_provider_find_dialog(const belle_sip_provider_t *prov,
                                                            const char *call_id,
                                                            const char *local_tag,
                                                            const char *remote_tag,
                                                            bool_t local_tag_mandatory) {
-	belle_sip_list_t *iterator;
-	belle_sip_dialog_t *returned_dialog = NULL;
+	struct dialog_matcher matcher;
 
 	if (call_id == NULL || (local_tag_mandatory && (local_tag == NULL)) || remote_tag == NULL) {
 		return NULL;
 	}
 
-	for (iterator = prov->dialogs; iterator != NULL; iterator = iterator->next) {
-		belle_sip_dialog_t *dialog = (belle_sip_dialog_t *)iterator->data;
-		dialog = (belle_sip_dialog_t *)iterator->data;
-		/*ignore dialog in state BELLE_SIP_DIALOG_NULL, is it really the correct things to do*/
-		if (belle_sip_dialog_get_state(dialog) != BELLE_SIP_DIALOG_NULL &&
-		    _belle_sip_dialog_match(dialog, call_id, local_tag, remote_tag)) {
-			if (!returned_dialog) returned_dialog = dialog;
-			else {
-				belle_sip_fatal("More than 1 dialog is matching, check your app");
-			}
-		}
-	}
-	return returned_dialog;
+	matcher.call_id = call_id;
+	matcher.local_tag = local_tag;
+	matcher.remote_tag = remote_tag;
+	matcher.returned_dialog = NULL;
+	belle_sip_hash_index_find_custom(prov->dialogs, call_id, dialog_match, &matcher);
+	return matcher.returned_dialog;
 }
 /*find a dialog given the call id, local-tag and to-tag*/
 belle_sip_dialog_t *belle_sip_provider_find_dialog(const belle_sip_provider_t *prov,
@@ -806,7 +838,7 @@ belle_sip_provider_find_dialog_from_message(belle_sip_provider_t *prov, belle_si
 }
 
 void belle_sip_provider_add_dialog(belle_sip_provider_t *prov, belle_sip_dialog_t *dialog) {
-	prov->dialogs = belle_sip_list_prepend(prov->dialogs, belle_sip_object_ref(dialog));
+	belle_sip_hash_index_add(prov->dialogs, belle_sip_object_ref(dialog));
 }
 
 static void notify_dialog_terminated(belle_sip_dialog_terminated_event_t *ev) {
@@ -820,7 +852,7 @@ void belle_sip_provider_remove_dialog(belle_sip_provider_t *prov, belle_sip_dial
 	ev->source = prov;
 	ev->dialog = dialog;
 	ev->is_expired = dialog->is_expired;
-	prov->dialogs = belle_sip_list_remove(prov->dialogs, dialog);
+	if (prov->dialogs) belle_sip_hash_index_remove(prov->dialogs, dialog);
 	belle_sip_main_loop_do_later(belle_sip_stack_get_main_loop(prov->stack),
 	                             (belle_sip_callback_t)notify_dialog_terminated, ev);
 }
@@ -953,7 +985,8 @@ void belle_sip_provider_send_response(belle_sip_provider_t *p, belle_sip_respons
 	belle_sip_hop_t *hop;
 	belle_sip_channel_t *chan;
 	belle_sip_header_to_t *to =
-	    (belle_sip_header_to_t *)belle_sip_message_get_header((belle_sip_message_t *)resp, "to");
+	    (belle_sip_header_to_t *)belle_sip_message_get_header_by_id((belle_sip_message_t *)resp,
+	                                                                BELLE_SIP_HEADER_ID_TO);
 
 	if (belle_sip_response_get_status_code(resp) != 100 && to && belle_sip_header_to_get_tag(to) == NULL) {
 		char token[BELLE_SIP_TAG_LENGTH];
@@ -986,7 +1019,7 @@ void belle_sip_provider_set_transaction_terminated(belle_sip_provider_t *p, bell
 }
 
 void belle_sip_provider_add_client_transaction(belle_sip_provider_t *prov, belle_sip_client_transaction_t *t) {
-	prov->client_transactions = belle_sip_list_prepend(prov->client_transactions, belle_sip_object_ref(t));
+	belle_sip_hash_index_add(prov->client_transactions, belle_sip_object_ref(t));
 }
 
 struct client_transaction_matcher {
@@ -1006,11 +1039,12 @@ belle_sip_client_transaction_t *belle_sip_provider_find_matching_client_transact
                                                                                     belle_sip_response_t *resp) {
 	struct client_transaction_matcher matcher;
 	belle_sip_header_via_t *via =
-	    (belle_sip_header_via_t *)belle_sip_message_get_header((belle_sip_message_t *)resp, "via");
+	    (belle_sip_header_via_t *)belle_sip_message_get_header_by_id((belle_sip_message_t *)resp,
+	                                                                 BELLE_SIP_HEADER_ID_VIA);
 	belle_sip_header_cseq_t *cseq =
-	    (belle_sip_header_cseq_t *)belle_sip_message_get_header((belle_sip_message_t *)resp, "cseq");
+	    (belle_sip_header_cseq_t *)belle_sip_message_get_header_by_id((belle_sip_message_t *)resp,
+	                                                                  BELLE_SIP_HEADER_ID_CSEQ);
 	belle_sip_client_transaction_t *ret = NULL;
-	belle_sip_list_t *elem;
 	if (via == NULL) {
 		belle_sip_warning("Response has no via.");
 		return NULL;
@@ -1030,18 +1064,16 @@ belle_sip_client_transaction_t *belle_sip_provider_find_matching_client_transact
 		belle_sip_warning("Response has missing method in cseq.");
 		return NULL;
 	}
-	elem = belle_sip_list_find_custom(prov->client_transactions, client_transaction_match, &matcher);
-	if (elem) {
-		ret = (belle_sip_client_transaction_t *)elem->data;
+	ret = belle_sip_hash_index_find_custom(prov->client_transactions, matcher.branchid, client_transaction_match,
+	                                       &matcher);
+	if (ret) {
 		belle_sip_message("Found transaction matching response.");
 	}
 	return ret;
 }
 
 void belle_sip_provider_remove_client_transaction(belle_sip_provider_t *prov, belle_sip_client_transaction_t *t) {
-	belle_sip_list_t *elem = belle_sip_list_find(prov->client_transactions, t);
-	if (elem) {
-		prov->client_transactions = belle_sip_list_delete_link(prov->client_transactions, elem);
+	if (prov->client_transactions && belle_sip_hash_index_remove(prov->client_transactions, t) == 0) {
 		belle_sip_object_unref(t);
 	} else {
 		belle_sip_error("trying to remove transaction [%p] not part of provider [%p]", t, prov);
@@ -1049,7 +1081,7 @@ void belle_sip_provider_remove_client_transaction(belle_sip_provider_t *prov, be
 }
 
 void belle_sip_provider_add_server_transaction(belle_sip_provider_t *prov, belle_sip_server_transaction_t *t) {
-	prov->server_transactions = belle_sip_list_prepend(prov->server_transactions, belle_sip_object_ref(t));
+	belle_sip_hash_index_add(prov->server_transactions, belle_sip_object_ref(t));
 }
 
 struct transaction_matcher {
@@ -1070,13 +1102,13 @@ static int transaction_match(const void *p_tr, const void *p_matcher) {
 	return -1;
 }
 
-belle_sip_transaction_t *belle_sip_provider_find_matching_transaction(belle_sip_list_t *transactions,
-                                                                      belle_sip_request_t *req) {
+static belle_sip_transaction_t *belle_sip_provider_find_matching_transaction(belle_sip_hash_index_t *transactions,
+                                                                             belle_sip_request_t *req) {
 	struct transaction_matcher matcher;
 	belle_sip_header_via_t *via =
-	    (belle_sip_header_via_t *)belle_sip_message_get_header((belle_sip_message_t *)req, "via");
+	    (belle_sip_header_via_t *)belle_sip_message_get_header_by_id((belle_sip_message_t *)req,
+	                                                                 BELLE_SIP_HEADER_ID_VIA);
 	belle_sip_transaction_t *ret = NULL;
-	belle_sip_list_t *elem = NULL;
 	const char *branch;
 	char token[BELLE_SIP_BRANCH_ID_LENGTH] = {0};
 
@@ -1093,10 +1125,9 @@ belle_sip_transaction_t *belle_sip_provider_find_matching_transaction(belle_sip_
 		belle_sip_message("Message from old RFC2543 stack, computed branch is %s", token);
 	}
 
-	elem = belle_sip_list_find_custom(transactions, transaction_match, &matcher);
+	ret = belle_sip_hash_index_find_custom(transactions, matcher.branchid, transaction_match, &matcher);
 
-	if (elem) {
-		ret = (belle_sip_transaction_t *)elem->data;
+	if (ret) {
 		belle_sip_message("Found transaction [%p] matching request.", ret);
 	}
 	return ret;
@@ -1113,7 +1144,7 @@ belle_sip_client_transaction_t *belle_sip_provider_find_matching_client_transact
 }
 
 void belle_sip_provider_remove_server_transaction(belle_sip_provider_t *prov, belle_sip_server_transaction_t *t) {
-	prov->server_transactions = belle_sip_list_remove(prov->server_transactions, t);
+	if (prov->server_transactions) belle_sip_hash_index_remove(prov->server_transactions, t);
 	belle_sip_object_unref(t);
 }
 
@@ -0,0 +1,628 @@
+/*
+ * Copyright (c) 2012-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "belle-sip/belle-sip.h"
+#include "belle_sip_internal.h"
+#include "sip/sip_fast_parser.hh"
+#include "sip/sip_parser.hh"
+
+using namespace std;
+
+/*
+ * The rules below follow sip.txt, including the way belr resolves alternatives (the longest match wins, the first
+ * alternative wins on a tie). Constructs that are not handled here (line folding, whitespace around '/' or ':',
+ * absolute uris...) make the header fall back to the grammar. So do the ones on which the grammar is known to behave
+ * unexpectedly, such as an empty uri parameter or an IPv6 reference as a Via parameter value.
+ */
+
+namespace {
+
+enum CharClass : uint16_t {
+	Alnum = 1 << 0,
+	Hex = 1 << 1,
+	Token = 1 << 2,      /* tchar */
+	Unreserved = 1 << 3, /* unreserved */
+	User = 1 << 4,       /* unreserved / user-unreserved */
+	Password = 1 << 5,   /* unreserved / "&" / "=" / "+" / "$" / "," */
+	Param = 1 << 6,      /* paramchar, without escaped */
+	UriHeader = 1 << 7,  /* hnv-unreserved / unreserved */
+	Word = 1 << 8,       /* word */
+	Reason = 1 << 9,     /* reason-phrase, without escaped and UTF8-NONASCII */
+	Ipv6 = 1 << 10       /* IPv6address */
+};
+
+class CharClasses {
+public:
+	CharClasses() {
+		memset(mTable, 0, sizeof(mTable));
+		for (int c = 0; c < 256; c++) {
+			if (isalnum(c)) add(c, Alnum | Token | Unreserved | User | Password | Param | UriHeader | Word | Reason);
+			if (isxdigit(c)) add(c, Hex | Ipv6);
+		}
+		add("!#$%&'*+-.^_`|~", Token);
+		add("-_.!~*'()", Unreserved | User | Password | Param | UriHeader | Reason);
+		add("&=+$,;?/", User);
+		add("&=+$,", Password);
+		add("[]/:&+$", Param);
+		add("[]/?:+$", UriHeader);
+		add("-.!%*_+`'~()<>:\\\"/[]?{}", Word);
+		add(";/?:@&=+$, \t", Reason);
+		add(":.", Ipv6);
+		for (int c = 0x80; c < 0xc0; c++)
+			add(c, Reason);
+	}
+	bool is(char c, uint16_t mask) const {
+		return (mTable[(unsigned char)c] & mask) != 0;
+	}
+
+private:
+	void add(int c, uint16_t mask) {
+		mTable[c] |= mask;
+	}
+	void add(const char *chars, uint16_t mask) {
+		for (; *chars != '\0'; chars++)
+			add((unsigned char)*chars, mask);
+	}
+	uint16_t mTable[256];
+};
+
+const CharClasses sCharClasses;
+
+/* Nul-terminated copy of a part of the input, kept on the stack unless it is unusually long. */
+class CString {
+public:
+	CString(const char *begin, const char *end) {
+		size_t length = (size_t)(end - begin);
+		mStr = length < sizeof(mBuffer) ? mBuffer : (char *)belle_sip_malloc(length + 1);
+		memcpy(mStr, begin, length);
+		mStr[length] = '\0';
+	}
+	~CString() {
+		if (mStr != mBuffer) belle_sip_free(mStr);
+	}
+	CString(const CString &) = delete;
+	CString &operator=(const CString &) = delete;
+	const char *c_str() const {
+		return mStr;
+	}
+	long long toInt() const {
+		return atoll(mStr);
+	}
+
+private:
+	char mBuffer[128];
+	char *mStr;
+};
+
+const char *scan(const char *p, const char *end, uint16_t mask, bool withEscaped = false) {
+	while (p < end) {
+		if (sCharClasses.is(*p, mask)) p++;
+		else if (withEscaped && *p == '%' && end - p >= 3 && sCharClasses.is(p[1], Hex) &&
+		         sCharClasses.is(p[2], Hex))
+			p += 3;
+		else break;
+	}
+	return p;
+}
+
+const char *scanDigits(const char *p, const char *end) {
+	while (p < end && *p >= '0' && *p <= '9')
+		p++;
+	return p;
+}
+
+const char *skipWsp(const char *p, const char *end) {
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+/* quoted-string, returns nullptr if it is not terminated */
+const char *scanQuotedString(const char *p, const char *end) {
+	for (p++; p < end; p++) {
+		unsigned char c = (unsigned char)*p;
+		if (c == '"') return p + 1;
+		if (c == '\\') {
+			if (++p == end) return nullptr;
+			c = (unsigned char)*p;
+		}
+		if (c != '\t' && (c < 0x20 || c == 0x7f)) return nullptr;
+	}
+	return nullptr;
+}
+
+/* host = hostname / IPv4address / IPv6reference, returns nullptr if there is none */
+const char *scanHost(const char *p, const char *end) {
+	const char *q = p;
+	if (q < end && *q == '[') {
+		q = scan(q + 1, end, Ipv6);
+		if (q == p + 1 || q == end || *q != ']') return nullptr;
+		return q + 1;
+	}
+	/* labels start and end with an alphanumeric character, a trailing dot is allowed */
+	while (q < end && sCharClasses.is(*q, Alnum)) {
+		while (q < end && (sCharClasses.is(*q, Alnum) || *q == '-'))
+			q++;
+		if (q[-1] == '-') return nullptr;
+		if (q == end || *q != '.') break;
+		q++;
+	}
+	return q == p ? nullptr : q;
+}
+
+/* gen-value = token / host / quoted-string */
+const char *scanGenericValue(const char *p, const char *end) {
+	if (p == end) return nullptr;
+	if (*p == '"') return scanQuotedString(p, end);
+	if (*p == '[') return scanHost(p, end);
+	const char *q = scan(p, end, Token);
+	return q == p ? nullptr : q;
+}
+
+void addParameter(belle_sip_parameters_t *params,
+                  const char *name,
+                  const char *nameEnd,
+                  const char *value,
+                  const char *valueEnd,
+                  bool escaped) {
+	const char *end = value ? valueEnd : nameEnd;
+	if (escaped && memchr(name, '%', (size_t)(end - name))) {
+		belle_sip_parameters_add_escaped(params, CString(name, end).c_str());
+	} else if (value) {
+		belle_sip_parameters_set_parameter(params, CString(name, nameEnd).c_str(), CString(value, valueEnd).c_str());
+	} else {
+		belle_sip_parameters_set_parameter(params, CString(name, nameEnd).c_str(), nullptr);
+	}
+}
+
+/*
+ * uri or paramless-uri: sip-uri-scheme [ userinfo ] hostport [ uri-parameters ] [ headers ]
+ * On success, p is moved to the first character following the uri.
+ */
+belle_sip_uri_t *parseUri(const char *&p, const char *end, bool withParameters) {
+	const char *q = p;
+	size_t schemeLength;
+	if (end - q >= 4 && strncasecmp(q, "sip:", 4) == 0) schemeLength = 4;
+	else if (end - q >= 5 && strncasecmp(q, "sips:", 5) == 0) schemeLength = 5;
+	else return nullptr;
+	q += schemeLength;
+
+	const char *user = q;
+	const char *userEnd = scan(q, end, User, true);
+	const char *password = nullptr;
+	const char *passwordEnd = nullptr;
+	const char *host = q;
+	if (userEnd != user) {
+		const char *r = userEnd;
+		if (r < end && *r == ':') {
+			password = r + 1;
+			r = passwordEnd = scan(password, end, Password, true);
+		}
+		if (r < end && *r == '@') {
+			host = r + 1;
+			/* the grammar may or may not report an empty password, let it decide */
+			if (password == passwordEnd && password) return nullptr;
+		} else {
+			user = userEnd = nullptr;
+			password = nullptr;
+		}
+	} else {
+		user = userEnd = nullptr;
+	}
+	const char *hostEnd = scanHost(host, end);
+	if (!hostEnd) return nullptr;
+	q = hostEnd;
+	const char *port = nullptr;
+	if (q < end && *q == ':') {
+		port = q + 1;
+		q = scanDigits(port, end);
+		if (q == port) return nullptr;
+	}
+
+	belle_sip_uri_t *uri = belle_sip_uri_new();
+	belle_sip_uri_set_scheme(uri, CString(p, p + schemeLength).c_str());
+	if (user) belle_sip_uri_set_escaped_user(uri, CString(user, userEnd).c_str());
+	if (password) belle_sip_uri_set_escaped_user_password(uri, CString(password, passwordEnd).c_str());
+	belle_sip_uri_set_host(uri, CString(host, hostEnd).c_str());
+	if (port) belle_sip_uri_set_port(uri, (int)CString(port, q).toInt());
+
+	while (withParameters && q < end && *q == ';') {
+		const char *name = q + 1;
+		const char *nameEnd = scan(name, end, Param, true);
+		/* the grammar tolerates a lone ';' in some places only */
+		if (name == nameEnd) goto error;
+		q = nameEnd;
+		const char *value = nullptr;
+		if (q < end && *q == '=') {
+			value = q + 1;
+			q = scan(value, end, Param, true);
+			if (q == value) goto error;
+		}
+		addParameter(BELLE_SIP_PARAMETERS(uri), name, nameEnd, value, q, true);
+	}
+	if (q < end && *q == '?') {
+		do {
+			const char *name = q + 1;
+			q = scan(name, end, UriHeader, true);
+			if (q == name || q == end || *q != '=') goto error;
+			q = scan(q + 1, end, UriHeader, true);
+			belle_sip_uri_add_escaped_header(uri, CString(name, q).c_str());
+		} while (q < end && *q == '&');
+	}
+	p = q;
+	return uri;
+
+error:
+	belle_sip_object_unref(uri);
+	return nullptr;
+}
+
+/*
+ * ( [ display-name ] LAQUOT uri RAQUOT ) / paramless-uri, as found in From, To and Contact headers.
+ * The uri of the first form cannot be surrounded by whitespace, the grammar handles this case.
+ */
+bool parseAddress(const char *&p, const char *end, belle_sip_header_address_t *address) {
+	const char *q = p;
+	const char *displayName = nullptr;
+	const char *displayNameEnd = nullptr;
+
+	if (q < end && *q == '"') {
+		displayName = q;
+		displayNameEnd = scanQuotedString(q, end);
+		if (!displayNameEnd) return false;
+		q = skipWsp(displayNameEnd, end);
+		if (q == end || *q != '<') return false;
+	} else if (q < end && *q != '<') {
+		/* token *( LWS token ), only if it is followed by '<' */
+		const char *tokensEnd = scan(q, end, Token);
+		if (tokensEnd != q) {
+			for (;;) {
+				const char *next = skipWsp(tokensEnd, end);
+				const char *nextEnd = scan(next, end, Token);
+				if (next == tokensEnd || nextEnd == next) break;
+				tokensEnd = nextEnd;
+			}
+			const char *laquot = skipWsp(tokensEnd, end);
+			if (laquot < end && *laquot == '<') {
+				displayName = q;
+				displayNameEnd = tokensEnd;
+				q = laquot;
+			}
+		}
+	}
+
+	if (q < end && *q == '<') {
+		q++;
+		if (displayName)
+			belle_sip_header_address_set_quoted_displayname_with_slashes(
+			    address, CString(displayName, displayNameEnd).c_str());
+		belle_sip_uri_t *uri = parseUri(q, end, true);
+		if (!uri) return false;
+		belle_sip_header_address_set_uri(address, uri);
+		if (q == end || *q != '>') return false;
+		q = skipWsp(q + 1, end);
+	} else {
+		belle_sip_uri_t *uri = parseUri(q, end, false);
+		if (!uri) return false;
+		belle_sip_header_address_set_uri(address, uri);
+		/* otherwise a generic uri could be longer than the sip one */
+		if (q < end && *q != ';' && *q != ',' && *q != ' ' && *q != '\t') return false;
+	}
+	p = q;
+	return true;
+}
+
+bool isParameterName(const char *name, const char *nameEnd, const char *expected) {
+	size_t length = (size_t)(nameEnd - name);
+	return length == strlen(expected) && strncasecmp(name, expected, length) == 0;
+}
+
+/*
+ * In a Via, via-ttl, via-maddr, via-received and via-branch are preferred to via-extension as soon as they match the
+ * beginning of the parameter. Only the values on which they agree with via-extension are accepted here.
+ */
+bool isPlainViaParameter(const char *name, const char *nameEnd, const char *value, const char *valueEnd) {
+	bool ttl = isParameterName(name, nameEnd, "ttl");
+	bool maddr = isParameterName(name, nameEnd, "maddr");
+	bool branch = isParameterName(name, nameEnd, "branch");
+	if (!ttl && !maddr && !branch) return true;
+	if (!value || value != nameEnd + 1) return false;
+	if (ttl) return valueEnd - value <= 3 && scanDigits(value, valueEnd) == valueEnd;
+	if (maddr) return scanHost(value, valueEnd) == valueEnd;
+	return *value != '"' && *value != '[';
+}
+
+/*
+ * *( SEMI generic-param ). For a Via, the received parameter is set apart as it is the via-received alternative of
+ * via-params.
+ */
+bool parseParameters(const char *&p,
+                     const char *end,
+                     belle_sip_parameters_t *params,
+                     bool escaped,
+                     belle_sip_header_via_t *via = nullptr) {
+	for (;;) {
+		const char *q = skipWsp(p, end);
+		if (q == end || *q != ';') return true;
+		const char *name = skipWsp(q + 1, end);
+		const char *nameEnd = scan(name, end, Token);
+		if (nameEnd == name) return false;
+		const char *value = nullptr;
+		const char *valueEnd = nullptr;
+		q = skipWsp(nameEnd, end);
+		if (q < end && *q == '=') {
+			value = skipWsp(q + 1, end);
+			valueEnd = scanGenericValue(value, end);
+		}
+		if (via && isParameterName(name, nameEnd, "received")) {
+			if (!value || value != nameEnd + 1) return false;
+			const char *address = value < end && *value == '[' ? scanHost(value, end) : scan(value, end, Ipv6);
+			if (!address || address == value || (valueEnd && valueEnd > address)) return false;
+			belle_sip_header_via_set_received(via, CString(value, address).c_str());
+			p = address;
+			continue;
+		}
+		if (value && !valueEnd) return false;
+		/* the grammar may take such a value for the sent-by host */
+		if (via && value && *value == '[') return false;
+		if (via && !isPlainViaParameter(name, nameEnd, value, valueEnd)) return false;
+		addParameter(params, name, nameEnd, value, valueEnd, escaped);
+		p = value ? valueEnd : nameEnd;
+	}
+}
+
+/* returns true and moves p after the comma if another element of a list follows */
+bool nextListElement(const char *&p, const char *end) {
+	const char *q = skipWsp(p, end);
+	if (q == end || *q != ',') return false;
+	p = skipWsp(q + 1, end);
+	return true;
+}
+
+belle_sip_header_t *parseVia(const char *p, const char *end) {
+	belle_sip_header_t *first = nullptr;
+	do {
+		belle_sip_header_via_t *via = belle_sip_header_via_new();
+		if (first) belle_sip_header_append(first, BELLE_SIP_HEADER(via));
+		else first = BELLE_SIP_HEADER(via);
+
+		/* sent-protocol LWS sent-by */
+		const char *name = p;
+		p = scan(p, end, Token);
+		if (p == name || p == end || *p != '/') goto error;
+		const char *version = p + 1;
+		p = scan(version, end, Token);
+		if (p == version || p == end || *p != '/') goto error;
+		const char *versionEnd = p;
+		const char *transport = p + 1;
+		p = scan(transport, end, Token);
+		if (p == transport) goto error;
+		const char *host = skipWsp(p, end);
+		if (host == p) goto error;
+		const char *hostEnd = scanHost(host, end);
+		if (!hostEnd) goto error;
+		belle_sip_header_via_set_protocol(via, CString(name, versionEnd).c_str());
+		belle_sip_header_via_set_transport(via, CString(transport, p).c_str());
+		belle_sip_header_via_set_host(via, CString(host, hostEnd).c_str());
+		p = hostEnd;
+		if (p < end && *p == ':') {
+			const char *port = p + 1;
+			p = scanDigits(port, end);
+			if (p == port) goto error;
+			belle_sip_header_via_set_port(via, (int)CString(port, p).toInt());
+		}
+		if (!parseParameters(p, end, BELLE_SIP_PARAMETERS(via), false, via)) goto error;
+	} while (nextListElement(p, end));
+	if (p == end) return first;
+
+error:
+	belle_sip_object_unref(first);
+	return nullptr;
+}
+
+belle_sip_header_t *parseFromTo(const char *p, const char *end, belle_sip_header_address_t *address) {
+	if (!parseAddress(p, end, address) || !parseParameters(p, end, BELLE_SIP_PARAMETERS(address), true) || p != end) {
+		belle_sip_object_unref(address);
+		return nullptr;
+	}
+	return BELLE_SIP_HEADER(address);
+}
+
+belle_sip_header_t *parseContact(const char *p, const char *end) {
+	belle_sip_header_t *first = nullptr;
+	if (p < end && *p == '*') {
+		if (skipWsp(p + 1, end) != end) return nullptr;
+		belle_sip_header_contact_t *contact = belle_sip_header_contact_new();
+		belle_sip_header_contact_set_string_wildcard(contact, CString(p, end).c_str());
+		return BELLE_SIP_HEADER(contact);
+	}
+	do {
+		belle_sip_header_contact_t *contact = belle_sip_header_contact_new();
+		if (first) belle_sip_header_append(first, BELLE_SIP_HEADER(contact));
+		else first = BELLE_SIP_HEADER(contact);
+		if (!parseAddress(p, end, BELLE_SIP_HEADER_ADDRESS(contact)) ||
+		    !parseParameters(p, end, BELLE_SIP_PARAMETERS(contact), false))
+			goto error;
+	} while (nextListElement(p, end));
+	if (p == end) return first;
+
+error:
+	belle_sip_object_unref(first);
+	return nullptr;
+}
+
+belle_sip_header_t *parseCallId(const char *p, const char *end) {
+	const char *q = scan(p, end, Word);
+	if (q == p) return nullptr;
+	if (q < end && *q == '@') {
+		const char *host = q + 1;
+		q = scan(host, end, Word);
+		if (q == host) return nullptr;
+	}
+	if (q != end) return nullptr;
+	belle_sip_header_call_id_t *call_id = belle_sip_header_call_id_new();
+	belle_sip_header_call_id_set_call_id(call_id, CString(p, end).c_str());
+	return BELLE_SIP_HEADER(call_id);
+}
+
+belle_sip_header_t *parseCSeq(const char *p, const char *end) {
+	const char *seqEnd = scanDigits(p, end);
+	const char *method = skipWsp(seqEnd, end);
+	if (seqEnd == p || method == seqEnd || method == end || scan(method, end, Token) != end) return nullptr;
+	belle_sip_header_cseq_t *cseq = belle_sip_header_cseq_new();
+	belle_sip_header_cseq_set_seq_number(cseq, (unsigned int)CString(p, seqEnd).toInt());
+	belle_sip_header_cseq_set_method(cseq, CString(method, end).c_str());
+	return BELLE_SIP_HEADER(cseq);
+}
+
+belle_sip_header_t *parseContentLength(const char *p, const char *end) {
+	if (p == end || scanDigits(p, end) != end) return nullptr;
+	belle_sip_header_content_length_t *content_length = belle_sip_header_content_length_new();
+	belle_sip_header_content_length_set_content_length(content_length, (size_t)CString(p, end).toInt());
+	return BELLE_SIP_HEADER(content_length);
+}
+
+belle_sip_header_t *parseMaxForwards(const char *p, const char *end) {
+	if (p == end || scanDigits(p, end) != end) return nullptr;
+	belle_sip_header_max_forwards_t *max_forwards = belle_sip_header_max_forwards_new();
+	belle_sip_header_max_forwards_set_max_forwards(max_forwards, (int)CString(p, end).toInt());
+	return BELLE_SIP_HEADER(max_forwards);
+}
+
+bool isHeaderName(const char *name, size_t length, const char *fullName, const char *compactName = nullptr) {
+	if (compactName && length == 1 && tolower((unsigned char)*name) == *compactName) return true;
+	return length == strlen(fullName) && strncasecmp(name, fullName, length) == 0;
+}
+
+/* returns nullptr for the headers that are not handled here or that are not in a form known by this parser */
+belle_sip_header_t *parseKnownHeader(const char *name, size_t nameLength, const char *value, const char *end) {
+	if (isHeaderName(name, nameLength, BELLE_SIP_VIA, "v")) return parseVia(value, end);
+	if (isHeaderName(name, nameLength, BELLE_SIP_FROM, "f"))
+		return parseFromTo(value, end, BELLE_SIP_HEADER_ADDRESS(belle_sip_header_from_new()));
+	if (isHeaderName(name, nameLength, BELLE_SIP_TO, "t"))
+		return parseFromTo(value, end, BELLE_SIP_HEADER_ADDRESS(belle_sip_header_to_new()));
+	if (isHeaderName(name, nameLength, BELLE_SIP_CALL_ID, "i")) return parseCallId(value, end);
+	if (isHeaderName(name, nameLength, BELLE_SIP_CSEQ)) return parseCSeq(value, end);
+	if (isHeaderName(name, nameLength, BELLE_SIP_CONTACT, "m")) return parseContact(value, end);
+	if (isHeaderName(name, nameLength, BELLE_SIP_CONTENT_LENGTH, "l")) return parseContentLength(value, end);
+	if (isHeaderName(name, nameLength, BELLE_SIP_MAX_FORWARDS)) return parseMaxForwards(value, end);
+	return nullptr;
+}
+
+bool parseHeaderLine(belle_sip_message_t *message, const char *line, const char *end, bool folded) {
+	if (!folded) {
+		const char *nameEnd = scan(line, end, Token);
+		const char *colon = skipWsp(nameEnd, end);
+		if (nameEnd != line && colon < end && *colon == ':') {
+			belle_sip_header_t *header =
+			    parseKnownHeader(line, (size_t)(nameEnd - line), skipWsp(colon + 1, end), end);
+			if (header) {
+				belle_sip_message_add_header(message, header);
+				return true;
+			}
+		}
+	}
+
+	string input(line, end);
+	size_t parsedSize;
+	auto context =
+	    BELLE_SIP_PARSER_CONTEXT(bellesip::SIP::Parser::getInstance()->parse(input, "message-header", &parsedSize));
+	if (!context) return false;
+	if (parsedSize != input.size()) {
+		if (context->obj) belle_sip_object_unref(context->obj);
+		belle_sip_object_unref(context);
+		return false;
+	}
+	belle_sip_message_add_header_from_parser_context(message, context);
+	return true;
+}
+
+/* Request-Line or Status-Line, of SIP/2.0 messages only */
+belle_sip_message_t *parseStartLine(const char *p, const char *end) {
+	static const char version[] = "SIP/2.0";
+	const size_t versionLength = sizeof(version) - 1;
+
+	if ((size_t)(end - p) > versionLength && strncmp(p, version, versionLength) == 0 && p[versionLength] == ' ') {
+		const char *code = p + versionLength + 1;
+		const char *codeEnd = scanDigits(code, end);
+		if (codeEnd - code != 3 || codeEnd == end || *codeEnd != ' ') return nullptr;
+		const char *reason = codeEnd + 1;
+		if (scan(reason, end, Reason, true) != end) return nullptr;
+		belle_sip_response_t *response = belle_sip_response_new();
+		belle_sip_response_set_status_code(response, (int)CString(code, codeEnd).toInt());
+		if (reason != end) belle_sip_response_set_reason_phrase(response, CString(reason, end).c_str());
+		return BELLE_SIP_MESSAGE(response);
+	}
+
+	const char *methodEnd = scan(p, end, Token);
+	if (methodEnd == p || methodEnd == end || *methodEnd != ' ') return nullptr;
+	const char *q = methodEnd + 1;
+	belle_sip_uri_t *uri = parseUri(q, end, true);
+	if (!uri) return nullptr;
+	if ((size_t)(end - q) != versionLength + 1 || *q != ' ' || strncmp(q + 1, version, versionLength) != 0) {
+		belle_sip_object_unref(uri);
+		return nullptr;
+	}
+	belle_sip_request_t *request = belle_sip_request_new();
+	belle_sip_request_set_method(request, CString(p, methodEnd).c_str());
+	belle_sip_request_set_uri(request, uri);
+	return BELLE_SIP_MESSAGE(request);
+}
+
+/* returns the position of the CRLF ending the line that begins at p, nullptr if there is none or if a bare LF is met */
+const char *findLineEnd(const char *p, const char *end) {
+	const char *lf = (const char *)memchr(p, '\n', (size_t)(end - p));
+	if (!lf || lf == p || lf[-1] != '\r') return nullptr;
+	return lf - 1;
+}
+
+} // namespace
+
+belle_sip_message_t *
+bellesip::SIP::FastParser::parseMessage(const char *buff, size_t buffLength, size_t *parsedSize) {
+	const char *end = buff + strnlen(buff, buffLength);
+	const char *lineEnd = findLineEnd(buff, end);
+	if (!lineEnd) return nullptr;
+	belle_sip_message_t *message = parseStartLine(buff, lineEnd);
+	if (!message) return nullptr;
+
+	const char *p = lineEnd + 2;
+	for (;;) {
+		if (end - p >= 2 && p[0] == '\r' && p[1] == '\n') {
+			*parsedSize = (size_t)(p + 2 - buff);
+			return message;
+		}
+		/* a header line goes on as long as the next one starts with whitespace */
+		bool folded = false;
+		lineEnd = findLineEnd(p, end);
+		while (lineEnd && end - lineEnd > 2 && (lineEnd[2] == ' ' || lineEnd[2] == '\t')) {
+			folded = true;
+			lineEnd = findLineEnd(lineEnd + 2, end);
+		}
+		if (!lineEnd || !parseHeaderLine(message, p, lineEnd, folded)) break;
+		p = lineEnd + 2;
+	}
+	belle_sip_object_unref(message);
+	return nullptr;
+}
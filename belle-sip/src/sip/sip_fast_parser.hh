@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2012-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef sip_fast_parser_hh
+#define sip_fast_parser_hh
+
+#include <cstddef>
+
+#include "belle-sip/types.h"
+
+namespace bellesip {
+namespace SIP {
+
+/*
+ * Hand-written parser for SIP messages, working directly on the receive buffer.
+ * It recognizes the start line and the most frequent headers (Via, From, To, Call-ID, CSeq, Contact, Content-Length
+ * and Max-Forwards) with simple loops, and hands every other header line to the belr grammar, one line at a time.
+ * It aims at building the same belle-sip objects as the belr grammar does for the whole message, but it is not a
+ * complete implementation of the grammar: whenever the input is not of the simple form it knows about, parseMessage()
+ * gives up and returns nullptr, and the caller shall then parse the message with the belr grammar.
+ */
+class FastParser {
+public:
+	static belle_sip_message_t *parseMessage(const char *buff, size_t buffLength, size_t *parsedSize);
+};
+
+} // namespace SIP
+} // namespace bellesip
+
+#endif /* sip_fast_parser_hh */
@@ -425,6 +425,10 @@ bellesip::SIP::Parser::Parser() {
 	_parser->setHandler("extension-header", make_fn(&belle_sip_header_new_dummy))
 	    ->setCollector("header-name", make_fn(&belle_sip_header_set_name))
 	    ->setCollector("header-value", make_fn(&belle_sip_header_extension_set_value));
+
+	/* These small rules are re-tried at the same position by many alternatives of the grammar. */
+	_parser->memoizeRule("domainlabel");
+	_parser->memoizeRule("lws");
 }
 
 void *bellesip::SIP::Parser::parse(const string &input, const string &rule, size_t *parsedSize, bool fullMatch) {
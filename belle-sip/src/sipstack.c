@@ -166,6 +166,7 @@ static void belle_sip_stack_destroy(belle_sip_stack_t *stack) {
 	belle_sip_message("stack [%p] destroyed.", stack);
 	if (stack->dns_user_hosts_file) belle_sip_free(stack->dns_user_hosts_file);
 	if (stack->dns_resolv_conf) belle_sip_free(stack->dns_resolv_conf);
+	belle_sip_dns_cache_destroy(stack->dns_cache);
 	belle_sip_object_unref(stack->ml);
 	belle_sip_object_unref(stack->digest_auth_policy);
 	if (stack->http_proxy_host) belle_sip_free(stack->http_proxy_host);
@@ -196,6 +197,8 @@ belle_sip_stack_t *belle_sip_stack_new(const char *properties) {
 	stack->dns_timeout = 15000;
 	stack->dns_srv_enabled = TRUE;
 	stack->dns_search_enabled = TRUE;
+	stack->dns_cache_enabled = TRUE;
+	stack->dns_cache = belle_sip_dns_cache_new(stack);
 	stack->inactive_transport_timeout = 3600; /*one hour*/
 	stack->pong_timeout = 10;                 /* 10 seconds*/
 	stack->ping_pong_verification = TRUE;
@@ -215,6 +218,7 @@ belle_sip_stack_t *belle_sip_stack_new(const char *properties) {
 
 void belle_sip_stack_add_user_host_entry(belle_sip_stack_t *stack, const char *ip, const char *hostname) {
 	stack->user_host_entries = bctbx_list_append(stack->user_host_entries, belle_sip_param_pair_new(ip, hostname));
+	belle_sip_dns_cache_flush(stack->dns_cache);
 }
 const belle_sip_timer_config_t *belle_sip_stack_get_timer_config(const belle_sip_stack_t *stack) {
 	return &stack->timer_config;
@@ -295,6 +299,16 @@ unsigned char belle_sip_stack_dns_search_enabled(const belle_sip_stack_t *stack)
 
 void belle_sip_stack_enable_dns_search(belle_sip_stack_t *stack, unsigned char enable) {
 	stack->dns_search_enabled = enable;
+	belle_sip_dns_cache_flush(stack->dns_cache);
+}
+
+unsigned char belle_sip_stack_dns_cache_enabled(const belle_sip_stack_t *stack) {
+	return stack->dns_cache_enabled;
+}
+
+void belle_sip_stack_enable_dns_cache(belle_sip_stack_t *stack, unsigned char enable) {
+	stack->dns_cache_enabled = enable;
+	if (!enable) belle_sip_dns_cache_flush(stack->dns_cache);
 }
 
 belle_sip_listening_point_t *
@@ -392,6 +406,7 @@ const char *belle_sip_stack_get_dns_user_hosts_file(const belle_sip_stack_t *sta
 void belle_sip_stack_set_dns_user_hosts_file(belle_sip_stack_t *stack, const char *hosts_file) {
 	if (stack->dns_user_hosts_file) belle_sip_free(stack->dns_user_hosts_file);
 	stack->dns_user_hosts_file = hosts_file ? belle_sip_strdup(hosts_file) : NULL;
+	belle_sip_dns_cache_flush(stack->dns_cache);
 }
 
 const char *belle_sip_stack_get_dns_resolv_conf_file(const belle_sip_stack_t *stack) {
@@ -401,6 +416,7 @@ const char *belle_sip_stack_get_dns_resolv_conf_file(const belle_sip_stack_t *st
 void belle_sip_stack_set_dns_resolv_conf_file(belle_sip_stack_t *stack, const char *resolv_conf_file) {
 	if (stack->dns_resolv_conf) belle_sip_free(stack->dns_resolv_conf);
 	stack->dns_resolv_conf = resolv_conf_file ? belle_sip_strdup(resolv_conf_file) : NULL;
+	belle_sip_dns_cache_flush(stack->dns_cache);
 }
 
 void belle_sip_stack_set_ip_version_preference(belle_sip_stack_t *stack, int family) {
@@ -419,6 +435,7 @@ void belle_sip_stack_set_dns_servers(belle_sip_stack_t *stack, const belle_sip_l
 		belle_sip_list_free_with_data(stack->dns_servers, belle_sip_free);
 	}
 	stack->dns_servers = newservers;
+	belle_sip_dns_cache_flush(stack->dns_cache);
 }
 
 const char *belle_sip_version_to_string(void) {
@@ -276,6 +276,9 @@ void belle_sip_transaction_terminate(belle_sip_transaction_t *t) {
 		                  belle_sip_request_get_method(belle_sip_transaction_get_request(t)), t);
 		BELLE_SIP_OBJECT_VPTR(t, belle_sip_transaction_t)->on_terminate(t);
 		belle_sip_provider_set_transaction_terminated(t->provider, t);
+		/*no more retransmissions, the headers kept for them can go*/
+		belle_sip_message_release_marshalled_headers((belle_sip_message_t *)t->request);
+		if (t->last_response) belle_sip_message_release_marshalled_headers((belle_sip_message_t *)t->last_response);
 	}
 	transaction_end_background_task(t);
 	belle_sip_object_unref(t);
@@ -347,7 +350,8 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_server_transaction_t){
                                            belle_sip_provider_t *prov,
                                            belle_sip_request_t *req) {
 	const char *branch;
-	belle_sip_header_via_t *via = BELLE_SIP_HEADER_VIA(belle_sip_message_get_header((belle_sip_message_t *)req, "via"));
+	belle_sip_header_via_t *via =
+	    BELLE_SIP_HEADER_VIA(belle_sip_message_get_header_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_VIA));
 	branch = belle_sip_header_via_get_branch(via);
 	if (branch == NULL || strncmp(branch, BELLE_SIP_BRANCH_MAGIC_COOKIE, strlen(BELLE_SIP_BRANCH_MAGIC_COOKIE)) != 0) {
 		branch = req->rfc2543_branch;
@@ -381,10 +385,16 @@ void _belle_sip_server_transaction_send_response(belle_sip_server_transaction_t
 	belle_sip_channel_queue_message(t->base.channel, (belle_sip_message_t *)resp);
 }
 
+void _belle_sip_server_transaction_resend_response(belle_sip_server_transaction_t *t, belle_sip_response_t *resp) {
+	if (belle_sip_server_transaction_check_channel(t, resp) == -1) return;
+	belle_sip_channel_queue_retransmission(t->base.channel, (belle_sip_message_t *)resp);
+}
+
 void belle_sip_server_transaction_send_response(belle_sip_server_transaction_t *t, belle_sip_response_t *resp) {
 	belle_sip_transaction_t *base = (belle_sip_transaction_t *)t;
 	belle_sip_header_to_t *to =
-	    (belle_sip_header_to_t *)belle_sip_message_get_header((belle_sip_message_t *)resp, "to");
+	    (belle_sip_header_to_t *)belle_sip_message_get_header_by_id((belle_sip_message_t *)resp,
+	                                                                BELLE_SIP_HEADER_ID_TO);
 	belle_sip_dialog_t *dialog = base->dialog;
 	int status_code;
 
@@ -687,7 +697,8 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_client_transaction_t){
     void belle_sip_client_transaction_init(belle_sip_client_transaction_t *obj,
                                            belle_sip_provider_t *prov,
                                            belle_sip_request_t *req) {
-	belle_sip_header_via_t *via = BELLE_SIP_HEADER_VIA(belle_sip_message_get_header((belle_sip_message_t *)req, "via"));
+	belle_sip_header_via_t *via =
+	    BELLE_SIP_HEADER_VIA(belle_sip_message_get_header_by_id((belle_sip_message_t *)req, BELLE_SIP_HEADER_ID_VIA));
 	char token[BELLE_SIP_BRANCH_ID_LENGTH];
 
 	if (!via) {
@@ -52,6 +52,34 @@ int stream_channel_send(belle_sip_stream_channel_t *obj, const void *buf, size_t
 	return err;
 }
 
+#ifndef _WIN32
+int stream_channel_sendv(belle_sip_stream_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt) {
+	belle_sip_socket_t sock = belle_sip_source_get_socket((belle_sip_source_t *)obj);
+	struct iovec iovs[belle_sip_max_iovec_count];
+	struct msghdr msg;
+	int err;
+	int i;
+	if (iovcnt > belle_sip_max_iovec_count) return -EINVAL;
+	memset(&msg, 0, sizeof(msg));
+	for (i = 0; i < iovcnt; i++) {
+		iovs[i].iov_base = (void *)iov[i].base;
+		iovs[i].iov_len = iov[i].len;
+	}
+	msg.msg_iov = iovs;
+	msg.msg_iovlen = iovcnt;
+	err = (int)sendmsg(sock, &msg, 0);
+	if (err == (belle_sip_socket_t)-1) {
+		int errnum = get_socket_error();
+		if (!belle_sip_error_code_is_would_block(errnum)) {
+			belle_sip_error("Could not send stream packet on channel [%p]: %s", obj,
+			                belle_sip_get_socket_error_string_from_code(errnum));
+		}
+		return -errnum;
+	}
+	return err;
+}
+#endif
+
 int stream_channel_recv(belle_sip_stream_channel_t *obj, void *buf, size_t buflen) {
 	belle_sip_socket_t sock = belle_sip_source_get_socket((belle_sip_source_t *)obj);
 	int err = (int)bctbx_recv(sock, buf, buflen, 0);
@@ -196,6 +224,11 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_stream_channel_t){
     (int (*)(belle_sip_channel_t *, const void *, size_t))stream_channel_send,
     (int (*)(belle_sip_channel_t *, void *, size_t))stream_channel_recv,
     (void (*)(belle_sip_channel_t *))stream_channel_close,
+#ifndef _WIN32
+    (int (*)(belle_sip_channel_t *, const belle_sip_iovec_t *, int))stream_channel_sendv,
+#else
+    NULL,
+#endif
 } BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_END
 
     int finalize_stream_connection(belle_sip_stream_channel_t *obj,
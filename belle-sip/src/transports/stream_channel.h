@@ -70,6 +70,9 @@ int finalize_stream_connection(belle_sip_stream_channel_t *obj,
                                struct sockaddr *addr,
                                socklen_t *slen);
 int stream_channel_send(belle_sip_stream_channel_t *obj, const void *buf, size_t buflen);
+#ifndef _WIN32
+int stream_channel_sendv(belle_sip_stream_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt);
+#endif
 int stream_channel_recv(belle_sip_stream_channel_t *obj, void *buf, size_t buflen);
 
 /*for testing purpose*/
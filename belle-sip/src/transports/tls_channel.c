@@ -491,7 +491,8 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_tls_channel_t) {
 		 (belle_sip_object_on_last_ref_t)NULL,
 		 BELLE_SIP_DEFAULT_BUFSIZE_HINT},
 		    "TLS", 1, /*is_reliable*/
-		    tls_channel_connect, tls_channel_send, tls_channel_recv, (void (*)(belle_sip_channel_t *))tls_channel_close
+		    tls_channel_connect, tls_channel_send, tls_channel_recv, (void (*)(belle_sip_channel_t *))tls_channel_close,
+		    NULL /*channel_sendv: the records are built by the ssl layer, the buffers are copied anyway*/
 	}
 }
 BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_END
@@ -72,6 +72,41 @@ static int udp_channel_send(belle_sip_channel_t *obj, const void *buf, size_t bu
 	return err;
 }
 
+#ifndef _WIN32
+static int udp_channel_sendv(belle_sip_channel_t *obj, const belle_sip_iovec_t *iov, int iovcnt) {
+	belle_sip_udp_channel_t *chan = (belle_sip_udp_channel_t *)obj;
+	struct iovec iovs[belle_sip_max_iovec_count];
+	struct msghdr msg;
+	int err;
+	int i;
+	belle_sip_socket_t sock = belle_sip_source_get_socket((belle_sip_source_t *)chan);
+	if (!sock) {
+		belle_sip_error("channel [%p]: no socket are available to send UDP packet because [%s]", obj,
+		                belle_sip_get_socket_error_string());
+		return -errno;
+	}
+	if (iovcnt > belle_sip_max_iovec_count) return -EINVAL;
+	memset(&msg, 0, sizeof(msg));
+	for (i = 0; i < iovcnt; i++) {
+		iovs[i].iov_base = (void *)iov[i].base;
+		iovs[i].iov_len = iov[i].len;
+	}
+	msg.msg_iov = iovs;
+	msg.msg_iovlen = iovcnt;
+	if (chan->shared_socket != SOCKET_NOT_SET) {
+		msg.msg_name = obj->current_peer->ai_addr;
+		msg.msg_namelen = (socklen_t)obj->current_peer->ai_addrlen;
+	} /*else there is no server socket, so we are in connected mode*/
+	err = (int)sendmsg(sock, &msg, 0);
+	if (err == -1) {
+		belle_sip_error("channel [%p]: could not send UDP packet because [%s]", obj,
+		                belle_sip_get_socket_error_string());
+		return -errno;
+	}
+	return err;
+}
+#endif
+
 static int udp_channel_recv(belle_sip_channel_t *obj, void *buf, size_t buflen) {
 	belle_sip_udp_channel_t *chan = (belle_sip_udp_channel_t *)obj;
 	int err;
@@ -149,7 +184,13 @@ BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_BEGIN(belle_sip_udp_channel_t){
     udp_channel_connect,
     udp_channel_send,
     udp_channel_recv,
-    udp_channel_close} BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_END
+    udp_channel_close,
+#ifndef _WIN32
+    udp_channel_sendv
+#else
+    NULL
+#endif
+} BELLE_SIP_INSTANCIATE_CUSTOM_VPTR_END
 
     belle_sip_channel_t *belle_sip_channel_new_udp(
         belle_sip_stack_t *stack, int sock, const char *bindip, int localport, const char *dest, int port, int no_srv) {
@@ -22,12 +22,15 @@
 #include "belle-sip/object.h"
 #include "belle_sip_internal.h"
 #include "belle_sip_tester.h"
+#include "channel_bank.hh"
 
 #include "register_tester.h"
 
 #ifndef _WIN32
 #include <inttypes.h>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif
 
 #define INT_TO_VOIDPTR(i) ((void *)(intptr_t)(i))
@@ -286,10 +289,472 @@ static void test_truncated_compressed_body(void) {
 	belle_sip_object_unref(mbh);
 }
 
+#ifndef _WIN32
+typedef struct fd_source_test {
+	int fds[2];
+	int notified;
+	int removed;
+} fd_source_test_t;
+
+static int fd_source_test_notify(void *data, unsigned int events) {
+	fd_source_test_t *test = (fd_source_test_t *)data;
+	char buf[16];
+	if (events & BELLE_SIP_EVENT_READ) {
+		test->notified++;
+		if (read(test->fds[0], buf, sizeof(buf)) < 0) belle_sip_error("read() failed: %s", strerror(errno));
+	}
+	return BELLE_SIP_CONTINUE;
+}
+
+static void fd_source_test_on_remove(belle_sip_source_t *s) {
+	((fd_source_test_t *)belle_sip_source_get_user_data(s))->removed++;
+}
+
+static belle_sip_source_t *fd_source_test_open(belle_sip_main_loop_t *ml, fd_source_test_t *test) {
+	belle_sip_source_t *s;
+	memset(test, 0, sizeof(*test));
+	BC_ASSERT_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, test->fds), 0, int, "%i");
+	s = belle_sip_socket_source_new(fd_source_test_notify, test, test->fds[0], BELLE_SIP_EVENT_READ, -1);
+	belle_sip_source_set_remove_cb(s, fd_source_test_on_remove);
+	belle_sip_main_loop_add_source(ml, s);
+	return s;
+}
+
+static void fd_source_test_write(fd_source_test_t *test) {
+	BC_ASSERT_EQUAL((int)write(test->fds[1], "x", 1), 1, int, "%i");
+}
+
+static void test_main_loop_fd_sources(belle_sip_main_loop_backend_t backend) {
+	belle_sip_main_loop_t *ml = belle_sip_main_loop_new_with_backend(backend);
+	fd_source_test_t test1, test2, test3;
+	belle_sip_source_t *s1, *s2, *s3;
+
+	if (backend != BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL)
+		BC_ASSERT_EQUAL(belle_sip_main_loop_get_backend(ml), backend, int, "%i");
+	s1 = fd_source_test_open(ml, &test1);
+	s2 = fd_source_test_open(ml, &test2);
+
+	fd_source_test_write(&test1);
+	belle_sip_main_loop_sleep(ml, 20);
+	BC_ASSERT_EQUAL(test1.notified, 1, int, "%i");
+	BC_ASSERT_EQUAL(test2.notified, 0, int, "%i");
+
+	/* events can be changed while the source is in the loop */
+	belle_sip_source_set_events(s1, 0);
+	fd_source_test_write(&test1);
+	belle_sip_main_loop_sleep(ml, 20);
+	BC_ASSERT_EQUAL(test1.notified, 1, int, "%i");
+	belle_sip_source_set_events(s1, BELLE_SIP_EVENT_READ);
+	belle_sip_main_loop_sleep(ml, 20);
+	BC_ASSERT_EQUAL(test1.notified, 2, int, "%i");
+
+	/* a cancelled source is removed at next iteration */
+	belle_sip_source_cancel(s2);
+	fd_source_test_write(&test2);
+	belle_sip_main_loop_sleep(ml, 20);
+	BC_ASSERT_EQUAL(test2.notified, 0, int, "%i");
+	BC_ASSERT_EQUAL(test2.removed, 1, int, "%i");
+
+	/* the socket of a source is closed while it is still in the loop, and its fd gets reused by another source */
+	close(test1.fds[0]);
+	belle_sip_source_reset(s1);
+	s3 = fd_source_test_open(ml, &test3);
+	fd_source_test_write(&test3);
+	belle_sip_main_loop_sleep(ml, 20);
+	BC_ASSERT_EQUAL(test3.notified, 1, int, "%i");
+	belle_sip_main_loop_remove_source(ml, s1);
+	BC_ASSERT_EQUAL(test1.removed, 1, int, "%i");
+	fd_source_test_write(&test3);
+	belle_sip_main_loop_sleep(ml, 20);
+	BC_ASSERT_EQUAL(test3.notified, 2, int, "%i");
+
+	belle_sip_main_loop_remove_source(ml, s3);
+	belle_sip_object_unref(s1);
+	belle_sip_object_unref(s2);
+	belle_sip_object_unref(s3);
+	close(test1.fds[1]);
+	close(test2.fds[0]);
+	close(test2.fds[1]);
+	close(test3.fds[0]);
+	close(test3.fds[1]);
+	belle_sip_object_unref(ml);
+}
+
+static void test_main_loop_fd_sources_poll(void) {
+	test_main_loop_fd_sources(BELLE_SIP_MAIN_LOOP_BACKEND_POLL);
+}
+
+static void test_main_loop_fd_sources_epoll(void) {
+	test_main_loop_fd_sources(BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL);
+}
+#endif
+
+typedef struct timer_stress_test {
+	int fired;
+	int errors;
+	uint64_t last_expire;
+} timer_stress_test_t;
+
+typedef struct timer_stress_timer {
+	timer_stress_test_t *test;
+	belle_sip_source_t *source;
+	int fired;
+} timer_stress_timer_t;
+
+static int timer_stress_notify(void *data, unsigned int events) {
+	timer_stress_timer_t *timer = (timer_stress_timer_t *)data;
+	timer_stress_test_t *test = timer->test;
+	/* timers must fire once, not before their expiration and in expiration order */
+	if (timer->fired || belle_sip_time_ms() < timer->source->expire_ms ||
+	    timer->source->expire_ms < test->last_expire) {
+		test->errors++;
+	}
+	test->last_expire = timer->source->expire_ms;
+	timer->fired++;
+	test->fired++;
+	return BELLE_SIP_STOP;
+}
+
+static void test_main_loop_timer_stress(void) {
+	const int count = 100000;
+	belle_sip_main_loop_t *ml = belle_sip_main_loop_new();
+	timer_stress_timer_t *timers = belle_sip_malloc0(count * sizeof(timer_stress_timer_t));
+	timer_stress_test_t test = {0};
+	uint64_t start;
+	int expected = 0;
+	int i;
+
+	start = belle_sip_time_ms();
+	for (i = 0; i < count; i++) {
+		timers[i].test = &test;
+		timers[i].source = belle_sip_main_loop_create_timeout(ml, timer_stress_notify, &timers[i], i % 500, "stress");
+	}
+	/* some timers are cancelled, others moved, including far in the future */
+	for (i = 0; i < count; i++) {
+		if (i % 4 == 0) {
+			belle_sip_source_cancel(timers[i].source);
+		} else if (i % 7 == 0) {
+			belle_sip_source_set_timeout_int64(timers[i].source, 3600000 + i);
+		} else {
+			if (i % 5 == 0) belle_sip_source_set_timeout_int64(timers[i].source, 100 + i % 200);
+			expected++;
+		}
+	}
+	belle_sip_message("%i timers added and updated in %llu ms", count,
+	                  (unsigned long long)(belle_sip_time_ms() - start));
+
+	belle_sip_main_loop_sleep(ml, 700);
+	BC_ASSERT_EQUAL(test.fired, expected, int, "%i");
+	BC_ASSERT_EQUAL(test.errors, 0, int, "%i");
+
+	for (i = 0; i < count; i++) {
+		belle_sip_main_loop_remove_source(ml, timers[i].source);
+		belle_sip_object_unref(timers[i].source);
+	}
+	belle_sip_free(timers);
+	belle_sip_object_unref(ml);
+}
+
+typedef struct channel_bank_scan {
+	const belle_sip_hop_t *hop;
+	const struct addrinfo *addr;
+	belle_sip_channel_t *found;
+} channel_bank_scan_t;
+
+/* the lookup as it was done before the channels were indexed: the first usable matching channel, in the bank order */
+static void channel_bank_scan(belle_sip_channel_t *chan, void *data) {
+	channel_bank_scan_t *scan = (channel_bank_scan_t *)data;
+	if (scan->found) return;
+	if (scan->hop) {
+		const char *chan_identifier = belle_sip_channel_get_bank_identifier(chan);
+		const char *hop_identifier = belle_sip_hop_get_channel_bank_identifier(scan->hop);
+		if (strcmp(chan_identifier ? chan_identifier : "default", hop_identifier ? hop_identifier : "default") != 0)
+			return;
+	}
+	if (chan->state == BELLE_SIP_CHANNEL_DISCONNECTED || chan->state == BELLE_SIP_CHANNEL_ERROR ||
+	    chan->about_to_be_closed)
+		return;
+	if (belle_sip_channel_matches(chan, scan->hop, scan->addr)) scan->found = chan;
+}
+
+static void check_channel_bank_result(belle_sip_channel_bank_t *bank,
+                                      const belle_sip_hop_t *hop,
+                                      const struct addrinfo *addr,
+                                      belle_sip_channel_t *found,
+                                      belle_sip_channel_t *expected) {
+	channel_bank_scan_t scan = {0};
+	scan.hop = hop;
+	scan.addr = addr;
+	belle_sip_channel_bank_for_each(bank, channel_bank_scan, &scan);
+	BC_ASSERT_PTR_EQUAL(found, scan.found);
+	BC_ASSERT_PTR_EQUAL(found, expected);
+}
+
+static void check_channel_bank_find_by_hop(belle_sip_channel_bank_t *bank,
+                                           const char *host,
+                                           int port,
+                                           const char *identifier,
+                                           belle_sip_channel_t *expected) {
+	belle_sip_hop_t *hop = (belle_sip_hop_t *)belle_sip_object_ref(belle_sip_hop_new("UDP", NULL, host, port));
+	struct addrinfo *addr = bctbx_ip_address_to_addrinfo(AF_INET, SOCK_STREAM, host, port);
+
+	if (identifier) belle_sip_hop_set_channel_bank_identifier(hop, identifier);
+	check_channel_bank_result(bank, hop, addr, belle_sip_channel_bank_find(bank, AF_INET, hop), expected);
+	if (addr) bctbx_freeaddrinfo(addr);
+	belle_sip_object_unref(hop);
+}
+
+static void check_channel_bank_find_by_address(belle_sip_channel_bank_t *bank,
+                                               const char *ip,
+                                               int port,
+                                               belle_sip_channel_t *expected) {
+	struct addrinfo *addr = bctbx_ip_address_to_addrinfo(AF_INET, SOCK_DGRAM, ip, port);
+	check_channel_bank_result(bank, NULL, addr, belle_sip_channel_bank_find_by_addrinfo(bank, addr), expected);
+	bctbx_freeaddrinfo(addr);
+}
+
+/* a channel to name:port, connected to ip:port when ip is given */
+static belle_sip_channel_t *channel_bank_test_add(belle_sip_stack_t *stack,
+                                                  belle_sip_channel_bank_t *bank,
+                                                  const char *name,
+                                                  int port,
+                                                  const char *ip,
+                                                  const char *identifier) {
+	belle_sip_channel_t *chan = belle_sip_channel_new_udp(stack, -1, NULL, 5060, name, port, TRUE);
+	if (ip) {
+		chan->peer_list = chan->current_peer = chan->static_peer_list =
+		    bctbx_ip_address_to_addrinfo(AF_INET, SOCK_DGRAM, ip, port);
+	}
+	if (identifier) belle_sip_channel_set_bank_identifier(chan, identifier);
+	belle_sip_channel_bank_add_channel(bank, chan);
+	belle_sip_object_unref(chan);
+	return chan;
+}
+
+static void test_channel_bank_lookup(void) {
+	belle_sip_stack_t *stack = belle_sip_stack_new(NULL);
+	belle_sip_channel_bank_t *bank = belle_sip_channel_bank_new();
+	belle_sip_channel_t *named = channel_bank_test_add(stack, bank, "sip.example.org", 5060, "192.0.2.1", NULL);
+	belle_sip_channel_t *other_bank = channel_bank_test_add(stack, bank, "sip.example.org", 5060, "192.0.2.1", "alt");
+	belle_sip_channel_t *srv = channel_bank_test_add(stack, bank, "srv.example.org", 5060, "192.0.2.2", NULL);
+	belle_sip_channel_t *cname = channel_bank_test_add(stack, bank, "service.example.org", 5060, "192.0.2.3", NULL);
+	belle_sip_channel_t *inbound = channel_bank_test_add(stack, bank, "192.0.2.10", 5060, "192.0.2.10", NULL);
+	belle_sip_channel_t *named_same_address =
+	    channel_bank_test_add(stack, bank, "named.example.org", 5060, "192.0.2.10", NULL);
+	belle_sip_channel_t *named_first =
+	    channel_bank_test_add(stack, bank, "first.example.org", 5060, "192.0.2.11", NULL);
+	belle_sip_channel_t *inbound_last = channel_bank_test_add(stack, bank, "192.0.2.11", 5060, "192.0.2.11", NULL);
+
+	/* names */
+	check_channel_bank_find_by_hop(bank, "sip.example.org", 5060, NULL, named);
+	check_channel_bank_find_by_hop(bank, "sip.example.org", 5070, NULL, NULL);
+	check_channel_bank_find_by_hop(bank, "unknown.example.org", 5060, NULL, NULL);
+
+	/* the port given by a SRV record replaces the one of the hop */
+	check_channel_bank_find_by_hop(bank, "srv.example.org", 5070, NULL, NULL);
+	srv->peer_port = 5080;
+	srv->srv_overrides_port = TRUE;
+	belle_sip_channel_bank_update_channel(bank, srv);
+	check_channel_bank_find_by_hop(bank, "srv.example.org", 5060, NULL, srv);
+	check_channel_bank_find_by_hop(bank, "srv.example.org", 5070, NULL, srv);
+
+	/* the name of the SRV target the channel is connected to */
+	check_channel_bank_find_by_hop(bank, "node1.example.org", 5060, NULL, NULL);
+	cname->current_peer_cname = "node1.example.org";
+	belle_sip_channel_bank_update_channel(bank, cname);
+	check_channel_bank_find_by_hop(bank, "node1.example.org", 5060, NULL, cname);
+	check_channel_bank_find_by_hop(bank, "NODE1.example.org", 5060, NULL, cname);
+	check_channel_bank_find_by_hop(bank, "node1.example.org", 5070, NULL, NULL);
+	check_channel_bank_find_by_hop(bank, "service.example.org", 5060, NULL, cname);
+
+	/* a channel with a name wins over the one created by an inbound connection from the same address */
+	check_channel_bank_find_by_address(bank, "192.0.2.10", 5060, named_same_address);
+	check_channel_bank_find_by_hop(bank, "192.0.2.10", 5060, NULL, named_same_address);
+	check_channel_bank_find_by_address(bank, "192.0.2.10", 5070, NULL);
+	check_channel_bank_find_by_address(bank, "192.0.2.11", 5060, named_first);
+	check_channel_bank_find_by_hop(bank, "192.0.2.11", 5060, NULL, named_first);
+	belle_sip_channel_bank_remove_channel(bank, named_first);
+	check_channel_bank_find_by_address(bank, "192.0.2.11", 5060, inbound_last);
+	belle_sip_channel_bank_remove_channel(bank, named_same_address);
+	check_channel_bank_find_by_address(bank, "192.0.2.10", 5060, inbound);
+	check_channel_bank_find_by_hop(bank, "192.0.2.10", 5060, NULL, inbound);
+
+	/* a hop only matches the channels of its bank identifier, an address the channels of all of them */
+	check_channel_bank_find_by_hop(bank, "sip.example.org", 5060, "alt", other_bank);
+	check_channel_bank_find_by_hop(bank, "sip.example.org", 5060, "other", NULL);
+	check_channel_bank_find_by_hop(bank, "srv.example.org", 5060, "alt", NULL);
+	check_channel_bank_find_by_address(bank, "192.0.2.1", 5060, other_bank);
+
+	/* unusable channels are skipped */
+	named->state = BELLE_SIP_CHANNEL_ERROR;
+	check_channel_bank_find_by_hop(bank, "sip.example.org", 5060, NULL, NULL);
+	named->state = BELLE_SIP_CHANNEL_INIT;
+
+	BC_ASSERT_EQUAL((int)belle_sip_channel_bank_get_count(bank), 6, int, "%d");
+	belle_sip_channel_bank_clear_all(bank);
+	belle_sip_object_unref(bank);
+	belle_sip_object_unref(stack);
+}
+
+static void test_channel_bank_update(void) {
+	belle_sip_stack_t *stack = belle_sip_stack_new(NULL);
+	belle_sip_channel_bank_t *bank = belle_sip_channel_bank_new();
+	belle_sip_channel_t *chan = channel_bank_test_add(stack, bank, "127.0.0.1", 45422, NULL, NULL);
+	int i;
+
+	/* not resolved yet, it has no address */
+	check_channel_bank_find_by_address(bank, "127.0.0.1", 45422, NULL);
+	check_channel_bank_find_by_hop(bank, "127.0.0.1", 45422, NULL, chan);
+
+	/* the resolution sets the current peer, the channel is indexed again with its address */
+	belle_sip_object_ref(chan);
+	belle_sip_channel_prepare(chan);
+	for (i = 0; i < 100 && chan->current_peer == NULL; i++)
+		belle_sip_stack_sleep(stack, 10);
+	BC_ASSERT_PTR_NOT_NULL(chan->current_peer);
+	check_channel_bank_find_by_address(bank, "127.0.0.1", 45422, chan);
+	check_channel_bank_find_by_hop(bank, "127.0.0.1", 45422, NULL, chan);
+
+	belle_sip_channel_bank_remove_channel(bank, chan);
+	BC_ASSERT_PTR_NULL(chan->bank);
+	check_channel_bank_find_by_address(bank, "127.0.0.1", 45422, NULL);
+	belle_sip_channel_force_close(chan);
+	belle_sip_object_unref(chan);
+	belle_sip_object_unref(bank);
+	belle_sip_object_unref(stack);
+}
+
+#define HASH_INDEX_TEST_OBJECTS 1000
+#define HASH_INDEX_TEST_KEYS 300
+
+typedef struct hash_index_test_obj {
+	char key[16];
+	int id;
+} hash_index_test_obj_t;
+
+static const char *hash_index_test_get_key(const void *obj) {
+	return ((const hash_index_test_obj_t *)obj)->key;
+}
+
+static int hash_index_test_is_obj(const void *obj, const void *user_data) {
+	return obj != user_data;
+}
+
+static int hash_index_test_has_id(const void *obj, const void *user_data) {
+	return ((const hash_index_test_obj_t *)obj)->id != *(const int *)user_data;
+}
+
+typedef struct hash_index_test_walk {
+	const char *key;
+	int last_id;
+	int count;
+	int misordered;
+} hash_index_test_walk_t;
+
+/* never matches, but checks that the objects with the key are visited from the last added to the first added */
+static int hash_index_test_walk(const void *obj, const void *user_data) {
+	const hash_index_test_obj_t *o = (const hash_index_test_obj_t *)obj;
+	hash_index_test_walk_t *walk = (hash_index_test_walk_t *)user_data;
+	if (strcmp(o->key, walk->key) == 0) {
+		if (walk->count > 0 && o->id >= walk->last_id) walk->misordered++;
+		walk->last_id = o->id;
+		walk->count++;
+	}
+	return 1;
+}
+
+/* checks that every object is found, with those of the same key from the last added to the first added */
+static void check_hash_index(belle_sip_hash_index_t *index,
+                             hash_index_test_obj_t *objs,
+                             const bool_t *present,
+                             size_t expected_count) {
+	belle_sip_list_t *all = belle_sip_hash_index_get_all(index);
+	int not_found = 0, found_removed = 0, misordered = 0, wrong_count = 0;
+	int i;
+
+	BC_ASSERT_EQUAL(belle_sip_hash_index_get_count(index), expected_count, size_t, "%zu");
+	BC_ASSERT_EQUAL(belle_sip_list_size(all), (int)expected_count, int, "%d");
+	for (i = 0; i < HASH_INDEX_TEST_OBJECTS; i++) {
+		void *found = belle_sip_hash_index_find_custom(index, objs[i].key, hash_index_test_is_obj, &objs[i]);
+		if (present[i] && found != &objs[i]) not_found++;
+		if (!present[i] && found != NULL) found_removed++;
+		if (present[i] != (belle_sip_list_find(all, &objs[i]) != NULL)) not_found++;
+	}
+	for (i = 0; i < HASH_INDEX_TEST_KEYS; i++) {
+		hash_index_test_walk_t walk = {objs[i].key, 0, 0, 0};
+		int j, expected = 0;
+		for (j = i; j < HASH_INDEX_TEST_OBJECTS; j += HASH_INDEX_TEST_KEYS)
+			if (present[j]) expected++;
+		belle_sip_hash_index_find_custom(index, objs[i].key, hash_index_test_walk, &walk);
+		misordered += walk.misordered;
+		if (walk.count != expected) wrong_count++;
+	}
+	BC_ASSERT_EQUAL(not_found, 0, int, "%d");
+	BC_ASSERT_EQUAL(found_removed, 0, int, "%d");
+	BC_ASSERT_EQUAL(misordered, 0, int, "%d");
+	BC_ASSERT_EQUAL(wrong_count, 0, int, "%d");
+	belle_sip_list_free(all);
+}
+
+static void test_hash_index(void) {
+	belle_sip_hash_index_t *index = belle_sip_hash_index_new(hash_index_test_get_key);
+	hash_index_test_obj_t *objs = belle_sip_malloc0(HASH_INDEX_TEST_OBJECTS * sizeof(hash_index_test_obj_t));
+	bool_t present[HASH_INDEX_TEST_OBJECTS] = {0};
+	size_t count = 0;
+	int id = 700;
+	int i;
+
+	/* several objects per key, added in the order of their ids, so that the buckets are rehashed several times
+	 * with duplicate keys in them */
+	for (i = 0; i < HASH_INDEX_TEST_OBJECTS; i++) {
+		snprintf(objs[i].key, sizeof(objs[i].key), "z9hG4bK%i", i % HASH_INDEX_TEST_KEYS);
+		objs[i].id = i;
+		belle_sip_hash_index_add(index, &objs[i]);
+		present[i] = TRUE;
+		count++;
+		if (i == 63 || i == 64 || i == 129) check_hash_index(index, objs, present, count);
+	}
+	check_hash_index(index, objs, present, count);
+	BC_ASSERT_PTR_EQUAL(belle_sip_hash_index_find_any(index, hash_index_test_has_id, &id), &objs[id]);
+	BC_ASSERT_PTR_NULL(belle_sip_hash_index_find_custom(index, "z9hG4bKnone", hash_index_test_is_obj, &objs[0]));
+
+	/* removing objects, among which the first and last added of some keys, keeps the order of the others */
+	for (i = 0; i < HASH_INDEX_TEST_OBJECTS; i += 3) {
+		BC_ASSERT_EQUAL(belle_sip_hash_index_remove(index, &objs[i]), 0, int, "%d");
+		present[i] = FALSE;
+		count--;
+	}
+	check_hash_index(index, objs, present, count);
+	BC_ASSERT_EQUAL(belle_sip_hash_index_remove(index, &objs[0]), -1, int, "%d");
+	BC_ASSERT_EQUAL(belle_sip_hash_index_get_count(index), count, size_t, "%zu");
+	BC_ASSERT_PTR_NULL(belle_sip_hash_index_find_any(index, hash_index_test_has_id, &(int){999}));
+
+	/* and the objects added again come first */
+	for (i = 0; i < HASH_INDEX_TEST_OBJECTS; i += 3) {
+		objs[i].id += HASH_INDEX_TEST_OBJECTS;
+		belle_sip_hash_index_add(index, &objs[i]);
+		present[i] = TRUE;
+		count++;
+	}
+	check_hash_index(index, objs, present, count);
+
+	belle_sip_hash_index_destroy(index);
+	belle_sip_free(objs);
+}
+
 static test_t core_tests[] = {TEST_NO_TAG("Object Data", test_object_data),
                               TEST_NO_TAG("Presence marshal", test_presence_marshal),
                               TEST_NO_TAG("Compressed body", test_compressed_body),
-                              TEST_NO_TAG("Truncated compressed body", test_truncated_compressed_body)};
+                              TEST_NO_TAG("Truncated compressed body", test_truncated_compressed_body),
+                              TEST_NO_TAG("Main loop timer stress", test_main_loop_timer_stress),
+                              TEST_NO_TAG("Channel bank lookup", test_channel_bank_lookup),
+                              TEST_NO_TAG("Channel bank update", test_channel_bank_update),
+                              TEST_NO_TAG("Hash index", test_hash_index),
+#ifndef _WIN32
+                              TEST_NO_TAG("Main loop fd sources with poll", test_main_loop_fd_sources_poll),
+                              TEST_NO_TAG("Main loop fd sources with epoll", test_main_loop_fd_sources_epoll),
+#endif
+};
 
 test_suite_t core_test_suite = {"Core",
                                 NULL,
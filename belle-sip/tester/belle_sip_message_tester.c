@@ -22,6 +22,13 @@
 #include "belle_sip_internal.h"
 #include "belle_sip_tester.h"
 
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
 static void check_uri_and_headers(belle_sip_message_t *message) {
 	if (belle_sip_message_is_request(message)) {
 		BC_ASSERT_TRUE(belle_sip_request_get_uri(BELLE_SIP_REQUEST(message)) ||
@@ -1232,6 +1239,361 @@ static void testHop(void) {
 	belle_sip_object_unref(hop);
 }
 
+static void check_fast_parser(const char *raw, const char *expected_via) {
+	size_t grammar_length = 0, fast_length = 0;
+	belle_sip_message_t *grammar_msg;
+	belle_sip_message_t *fast_msg;
+	char *grammar_str;
+	char *fast_str;
+
+	belle_sip_message_enable_fast_parser(FALSE);
+	grammar_msg = belle_sip_message_parse_raw(raw, strlen(raw), &grammar_length);
+	belle_sip_message_enable_fast_parser(TRUE);
+	fast_msg = belle_sip_message_parse_raw(raw, strlen(raw), &fast_length);
+	if (!BC_ASSERT_PTR_NOT_NULL(grammar_msg) || !BC_ASSERT_PTR_NOT_NULL(fast_msg)) goto end;
+	belle_sip_object_ref(grammar_msg);
+	belle_sip_object_ref(fast_msg);
+
+	BC_ASSERT_EQUAL((unsigned int)fast_length, (unsigned int)grammar_length, unsigned int, "%u");
+	grammar_str = belle_sip_object_to_string(grammar_msg);
+	fast_str = belle_sip_object_to_string(fast_msg);
+	BC_ASSERT_STRING_EQUAL(fast_str, grammar_str);
+	belle_sip_free(grammar_str);
+	belle_sip_free(fast_str);
+	if (BELLE_SIP_OBJECT_IS_INSTANCE_OF(grammar_msg, belle_sip_response_t)) {
+		const char *grammar_reason = belle_sip_response_get_reason_phrase(BELLE_SIP_RESPONSE(grammar_msg));
+		const char *fast_reason = belle_sip_response_get_reason_phrase(BELLE_SIP_RESPONSE(fast_msg));
+		/*an empty reason phrase is left unset by both parsers*/
+		if (grammar_reason) BC_ASSERT_STRING_EQUAL(fast_reason, grammar_reason);
+		else BC_ASSERT_PTR_NULL(fast_reason);
+	}
+
+	if (expected_via) {
+		belle_sip_header_via_t *via = belle_sip_message_get_header_by_type(fast_msg, belle_sip_header_via_t);
+		if (BC_ASSERT_PTR_NOT_NULL(via)) BC_ASSERT_STRING_EQUAL(belle_sip_header_via_get_branch(via), expected_via);
+	} else {
+		BC_ASSERT_PTR_NULL(belle_sip_message_get_header(fast_msg, "Via"));
+	}
+end:
+	if (grammar_msg) belle_sip_object_unref(grammar_msg);
+	if (fast_msg) belle_sip_object_unref(fast_msg);
+}
+
+static void testFastParser(void) {
+	const char *raw;
+	size_t length = 0;
+
+	/*headers handled by the fast parser, with a few less common forms*/
+	check_fast_parser("INVITE sip:bob@sip.example.org;transport=tcp SIP/2.0\r\n"
+	                  "Via: SIP/2.0/TCP 192.168.1.8:5060;branch=z9hG4bK.abc;rport, SIP/2.0/UDP [2001:db8::1]:5062;"
+	                  "branch=z9hG4bK.def;received=81.56.113.2\r\n"
+	                  "v: SIP/2.0/UDP proxy.example.org;branch=z9hG4bK.ghi\r\n"
+	                  "From: \"Alice \\\"A\\\"\" <sip:alice@sip.example.org>;tag=1234\r\n"
+	                  "t: Bob <sips:bob%20b@sip.example.org:5061?Subject=hi>\r\n"
+	                  "Call-ID: a84b4c76e66710@pc33.example.org\r\n"
+	                  "CSeq: 314159 INVITE\r\n"
+	                  "Contact: <sip:alice@192.168.1.8:5060>;expires=3600;q=0.7, sip:alice@10.0.0.1\r\n"
+	                  "Max-Forwards: 70\r\n"
+	                  "Subject: folded\r\n"
+	                  " subject\r\n"
+	                  "Content-Length: 0\r\n"
+	                  "\r\n",
+	                  "z9hG4bK.abc");
+	check_fast_parser("SIP/2.0 200 Ok\r\n"
+	                  "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.xyz\r\n"
+	                  "From: <sip:alice@sip.example.org>;tag=1234\r\n"
+	                  "To: <sip:alice@sip.example.org>;tag=5678\r\n"
+	                  "Call-ID: 1234\r\n"
+	                  "CSeq: 1 REGISTER\r\n"
+	                  "Contact: *\r\n"
+	                  "X-Custom: whatever\r\n"
+	                  "l: 0\r\n"
+	                  "\r\n",
+	                  "z9hG4bK.xyz");
+	/*empty reason phrase*/
+	check_fast_parser("SIP/2.0 200 \r\n"
+	                  "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.xyz\r\n"
+	                  "From: <sip:alice@sip.example.org>;tag=1234\r\n"
+	                  "To: <sip:alice@sip.example.org>;tag=5678\r\n"
+	                  "Call-ID: 1234\r\n"
+	                  "CSeq: 1 REGISTER\r\n"
+	                  "Content-Length: 0\r\n"
+	                  "\r\n",
+	                  "z9hG4bK.xyz");
+	/*forms that are left to the grammar, which drops the malformed Via*/
+	check_fast_parser("OPTIONS sip:bob@sip.example.org SIP/2.0\r\n"
+	                  "Via: SIP/2.0/UDP 192.168.1.8:5060;ttl=1234;branch=z9hG4bK.xyz\r\n"
+	                  "From: <sip:alice@sip.example.org>;tag=1234\r\n"
+	                  "To: <sip:bob@sip.example.org>\r\n"
+	                  "Call-ID: 1234\r\n"
+	                  "CSeq: 1 OPTIONS\r\n"
+	                  "Max-Forwards: 70\r\n"
+	                  "\r\n",
+	                  NULL);
+	/*IPv6 reference as the value of a Via generic parameter*/
+	check_fast_parser("OPTIONS sip:bob@sip.example.org SIP/2.0\r\n"
+	                  "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.xyz;x-addr=[2001:db8::1]\r\n"
+	                  "From: <sip:alice@sip.example.org>;tag=1234\r\n"
+	                  "To: <sip:bob@sip.example.org>\r\n"
+	                  "Call-ID: 1234\r\n"
+	                  "CSeq: 1 OPTIONS\r\n"
+	                  "\r\n",
+	                  "z9hG4bK.xyz");
+	/*lone ';' in the uris, tolerated by the grammar in the headers...*/
+	check_fast_parser("OPTIONS sip:bob@sip.example.org SIP/2.0\r\n"
+	                  "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.xyz\r\n"
+	                  "From: <sip:alice@sip.example.org;>;tag=1234\r\n"
+	                  "To: <sip:bob@sip.example.org;;transport=udp;>\r\n"
+	                  "Call-ID: 1234\r\n"
+	                  "CSeq: 1 OPTIONS\r\n"
+	                  "\r\n",
+	                  "z9hG4bK.xyz");
+	/*...but not at the end of the request uri*/
+	raw = "OPTIONS sip:bob@sip.example.org; SIP/2.0\r\n"
+	      "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.xyz\r\n"
+	      "Call-ID: 1234\r\n"
+	      "CSeq: 1 OPTIONS\r\n"
+	      "\r\n";
+	belle_sip_message_enable_fast_parser(TRUE);
+	BC_ASSERT_PTR_NULL(belle_sip_message_parse_raw(raw, strlen(raw), &length));
+}
+
+static void testHeaderLookup(void) {
+	const char *raw = "INVITE sip:bob@sip.example.org SIP/2.0\r\n"
+	                  "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.abc\r\n"
+	                  "Via: SIP/2.0/UDP 10.0.0.1:5060;branch=z9hG4bK.def\r\n"
+	                  "From: <sip:alice@sip.example.org>;tag=1234\r\n"
+	                  "To: <sip:bob@sip.example.org>\r\n"
+	                  "CALL-ID: 1234\r\n"
+	                  "CSeq: 1 INVITE\r\n"
+	                  "X-Custom: whatever\r\n"
+	                  "Max-Forwards: 70\r\n"
+	                  "\r\n";
+	belle_sip_message_t *msg = belle_sip_message_parse(raw);
+	belle_sip_header_t *via;
+	char *str;
+
+	if (!BC_ASSERT_PTR_NOT_NULL(msg)) return;
+	/*the well known and the other headers are found whatever the case of their name*/
+	BC_ASSERT_PTR_NOT_NULL(belle_sip_message_get_header(msg, "call-id"));
+	BC_ASSERT_PTR_NOT_NULL(belle_sip_message_get_header_by_type(msg, belle_sip_header_call_id_t));
+	BC_ASSERT_PTR_NOT_NULL(belle_sip_message_get_header(msg, "x-custom"));
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_header(msg, "Route"));
+	BC_ASSERT_EQUAL((int)bctbx_list_size(belle_sip_message_get_headers(msg, "VIA")), 2, int, "%i");
+
+	/*once removed, a header goes back at the end of the message*/
+	via = BELLE_SIP_HEADER(belle_sip_object_ref(belle_sip_message_get_header(msg, BELLE_SIP_VIA)));
+	belle_sip_message_remove_header(msg, "via");
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_header_by_type(msg, belle_sip_header_via_t));
+	belle_sip_message_add_header(msg, via);
+	belle_sip_object_unref(via);
+	BC_ASSERT_PTR_EQUAL(belle_sip_message_get_header_by_type(msg, belle_sip_header_via_t), via);
+	str = belle_sip_object_to_string(msg);
+	BC_ASSERT_PTR_NOT_NULL(strstr(str, "Max-Forwards: 70\r\nVia: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.abc\r\n"));
+	belle_sip_free(str);
+
+	belle_sip_message_remove_header_from_ptr(msg, belle_sip_message_get_header(msg, "X-Custom"));
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_header(msg, "X-Custom"));
+	belle_sip_object_unref(msg);
+}
+
+static void testMarshalledHeaders(void) {
+	belle_sip_message_t *msg = belle_sip_message_parse("MESSAGE sip:bob@sip.example.org SIP/2.0\r\n"
+	                                                   "Via: SIP/2.0/UDP 192.168.1.8:5060;branch=z9hG4bK.abc\r\n"
+	                                                   "From: <sip:alice@sip.example.org>;tag=1234\r\n"
+	                                                   "To: <sip:bob@sip.example.org>\r\n"
+	                                                   "Call-ID: 1234\r\n"
+	                                                   "CSeq: 1 MESSAGE\r\n"
+	                                                   "\r\n");
+	belle_sip_message_t *clone;
+	char *str;
+	size_t size = 0;
+
+	if (!BC_ASSERT_PTR_NOT_NULL(msg)) return;
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_marshalled_headers(msg, &size));
+	str = belle_sip_object_to_string(msg);
+	belle_sip_message_set_marshalled_headers(msg, str, strlen(str));
+	BC_ASSERT_PTR_NOT_NULL(belle_sip_message_get_marshalled_headers(msg, &size));
+	BC_ASSERT_EQUAL((int)size, (int)strlen(str), int, "%i");
+	belle_sip_free(str);
+
+	/*a clone has to be marshalled again*/
+	clone = BELLE_SIP_MESSAGE(belle_sip_object_clone(BELLE_SIP_OBJECT(msg)));
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_marshalled_headers(clone, &size));
+	belle_sip_object_unref(clone);
+
+	/*adding a header, or changing the body invalidate the marshalled headers*/
+	belle_sip_message_add_header(msg, belle_sip_header_create("X-Custom", "whatever"));
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_marshalled_headers(msg, &size));
+	belle_sip_message_set_marshalled_headers(msg, "whatever", 8);
+	belle_sip_message_set_body(msg, "hello", 5);
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_marshalled_headers(msg, &size));
+	belle_sip_message_set_marshalled_headers(msg, "whatever", 8);
+	belle_sip_message_remove_header(msg, "X-Custom");
+	BC_ASSERT_PTR_NULL(belle_sip_message_get_marshalled_headers(msg, &size));
+	belle_sip_object_unref(msg);
+}
+
+#ifndef _WIN32
+/*a non blocking socket bound to a random port of the loopback, standing for the remote party*/
+static int open_peer_socket(int type, int *port) {
+	struct sockaddr_in addr;
+	socklen_t addrlen = sizeof(addr);
+	int sock = socket(AF_INET, type, 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (sock == -1 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+	    (type == SOCK_STREAM && listen(sock, 1) != 0) ||
+	    getsockname(sock, (struct sockaddr *)&addr, &addrlen) != 0) {
+		if (sock != -1) close(sock);
+		return -1;
+	}
+	bctbx_socket_set_non_blocking(sock);
+	*port = ntohs(addr.sin_port);
+	return sock;
+}
+
+static int wait_for_datagram(belle_sip_stack_t *stack, int sock, char *buffer, size_t size, int timeout_ms) {
+	int elapsed;
+	for (elapsed = 0; elapsed < timeout_ms; elapsed += 10) {
+		ssize_t ret = recv(sock, buffer, size, 0);
+		if (ret > 0) return (int)ret;
+		belle_sip_stack_sleep(stack, 10);
+	}
+	return -1;
+}
+
+static void testMarshalledHeadersRetransmission(void) {
+	belle_sip_stack_t *stack = belle_sip_stack_new(NULL);
+	belle_sip_listening_point_t *lp =
+	    belle_sip_stack_create_listening_point(stack, "127.0.0.1", BELLE_SIP_LISTENING_POINT_RANDOM_PORT, "UDP");
+	belle_sip_provider_t *prov = belle_sip_provider_new(stack, lp);
+	belle_sip_timer_config_t timers = *belle_sip_stack_get_timer_config(stack);
+	belle_sip_header_from_t *from = belle_sip_header_from_create2("sip:alice@127.0.0.1", "1234");
+	belle_sip_client_transaction_t *t;
+	belle_sip_request_t *req;
+	char first[2048];
+	char second[2048];
+	char uri[64];
+	int first_len, second_len;
+	int port;
+	int sock = open_peer_socket(SOCK_DGRAM, &port);
+
+	if (!BC_ASSERT_TRUE(sock != -1)) goto end;
+	/*timer E first fires after T1*/
+	timers.T1 = 100;
+	belle_sip_stack_set_timer_config(stack, &timers);
+	snprintf(uri, sizeof(uri), "sip:bob@127.0.0.1:%i", port);
+	req = belle_sip_request_create(belle_sip_uri_parse(uri), "MESSAGE", belle_sip_provider_create_call_id(prov),
+	                               belle_sip_header_cseq_create(1, "MESSAGE"), from,
+	                               belle_sip_header_to_parse("To: sip:bob@127.0.0.1"), belle_sip_header_via_new(), 70);
+	belle_sip_message_set_body(BELLE_SIP_MESSAGE(req), "hello", 5);
+	t = (belle_sip_client_transaction_t *)belle_sip_object_ref(belle_sip_provider_create_client_transaction(prov, req));
+	BC_ASSERT_EQUAL(belle_sip_client_transaction_send_request(t), 0, int, "%d");
+
+	first_len = wait_for_datagram(stack, sock, first, sizeof(first), 2000);
+	BC_ASSERT_GREATER(first_len, 5, int, "%d");
+	/*changes made to the header objects are not tracked, the retransmission is the kept copy of the first send*/
+	belle_sip_header_from_set_tag(from, "5678");
+	second_len = wait_for_datagram(stack, sock, second, sizeof(second), 2000);
+	BC_ASSERT_EQUAL(second_len, first_len, int, "%d");
+	if (first_len > 0 && second_len == first_len) {
+		BC_ASSERT_TRUE(memcmp(first, second, first_len) == 0);
+		BC_ASSERT_TRUE(memcmp(first + first_len - 5, "hello", 5) == 0);
+	}
+	BC_ASSERT_PTR_NOT_NULL(BELLE_SIP_MESSAGE(req)->marshalled_headers);
+
+	/*no more retransmissions once terminated, the kept copy is freed*/
+	belle_sip_transaction_terminate(BELLE_SIP_TRANSACTION(t));
+	BC_ASSERT_PTR_NULL(BELLE_SIP_MESSAGE(req)->marshalled_headers);
+	belle_sip_object_unref(t);
+	close(sock);
+end:
+	belle_sip_object_unref(prov);
+	belle_sip_object_unref(stack);
+}
+
+static void testSendBodyAfterPartialWrite(void) {
+	belle_sip_stack_t *stack = belle_sip_stack_new(NULL);
+	belle_sip_listening_point_t *lp =
+	    belle_sip_stack_create_listening_point(stack, "127.0.0.1", BELLE_SIP_LISTENING_POINT_RANDOM_PORT, "TCP");
+	belle_sip_provider_t *prov = belle_sip_provider_new(stack, lp);
+	/*much larger than the socket buffers of the loopback, so that the channel can't send it at once*/
+	const size_t body_size = 16 * 1024 * 1024;
+	const size_t max_size = body_size + 4096;
+	char *body = belle_sip_malloc(body_size);
+	char *received = belle_sip_malloc(max_size);
+	const char *body_start;
+	size_t received_size = 0;
+	belle_sip_channel_t *chan = NULL;
+	belle_sip_hop_t *hop;
+	belle_sip_request_t *req;
+	char uri[64];
+	int elapsed;
+	int port;
+	int peer = -1;
+	int sock = open_peer_socket(SOCK_STREAM, &port);
+	size_t i;
+
+	if (!BC_ASSERT_TRUE(sock != -1)) goto end;
+	for (i = 0; i < body_size; i++)
+		body[i] = 'a' + (char)(i % 26);
+	snprintf(uri, sizeof(uri), "sip:bob@127.0.0.1:%i;transport=tcp", port);
+	req = belle_sip_request_create(belle_sip_uri_parse(uri), "MESSAGE", belle_sip_provider_create_call_id(prov),
+	                               belle_sip_header_cseq_create(1, "MESSAGE"),
+	                               belle_sip_header_from_create2("sip:alice@127.0.0.1", "1234"),
+	                               belle_sip_header_to_parse("To: sip:bob@127.0.0.1"), belle_sip_header_via_new(), 70);
+	belle_sip_message_set_body(BELLE_SIP_MESSAGE(req), body, body_size);
+	hop = belle_sip_hop_new("TCP", NULL, "127.0.0.1", port);
+	chan = belle_sip_provider_get_channel(prov, hop);
+	belle_sip_object_unref(hop);
+	if (!BC_ASSERT_PTR_NOT_NULL(chan)) goto end;
+	belle_sip_object_ref(chan);
+	/*the body is sent in place, next to the headers*/
+	BC_ASSERT_TRUE(belle_sip_channel_can_sendv(chan));
+	belle_sip_channel_queue_message(chan, BELLE_SIP_MESSAGE(req));
+
+	/*nothing is read until the channel got EWOULDBLOCK and kept the unsent part*/
+	for (elapsed = 0; elapsed < 5000 && chan->ewouldblock_buffer == NULL; elapsed += 10) {
+		if (peer == -1) peer = accept(sock, NULL, NULL);
+		belle_sip_stack_sleep(stack, 10);
+	}
+	BC_ASSERT_PTR_NOT_NULL(chan->ewouldblock_buffer);
+	if (!BC_ASSERT_TRUE(peer != -1)) goto end;
+	bctbx_socket_set_non_blocking(peer);
+
+	for (elapsed = 0; elapsed < 10000 && received_size < max_size; elapsed++) {
+		ssize_t ret = recv(peer, received + received_size, max_size - received_size, 0);
+		if (ret > 0) received_size += (size_t)ret;
+		else if (chan->ewouldblock_buffer == NULL) break;
+		belle_sip_stack_sleep(stack, 1);
+	}
+	/*drain what was sent since the last read*/
+	for (elapsed = 0; elapsed < 100; elapsed++) {
+		ssize_t ret = recv(peer, received + received_size, max_size - received_size, 0);
+		if (ret > 0) received_size += (size_t)ret;
+		else belle_sip_stack_sleep(stack, 1);
+	}
+	BC_ASSERT_PTR_NULL(chan->ewouldblock_buffer);
+	body_start = received_size > body_size ? received + received_size - body_size : NULL;
+	if (BC_ASSERT_PTR_NOT_NULL(body_start)) {
+		BC_ASSERT_TRUE(body_start - received >= 4 && memcmp(body_start - 4, "\r\n\r\n", 4) == 0);
+		BC_ASSERT_TRUE(memcmp(body_start, body, body_size) == 0);
+	}
+
+end:
+	if (peer != -1) close(peer);
+	if (sock != -1) close(sock);
+	if (chan) belle_sip_object_unref(chan);
+	belle_sip_free(received);
+	belle_sip_free(body);
+	belle_sip_object_unref(prov);
+	belle_sip_object_unref(stack);
+}
+#endif
+
 /* NOTE - ORDER IS IMPORTANT - MUST TEST fread() AFTER fprintf() */
 static test_t message_tests[] = {
     TEST_NO_TAG("REGISTER", testRegisterMessage),
@@ -1264,7 +1626,15 @@ static test_t message_tests[] = {
     TEST_NO_TAG("HTTP 200 Ok", testHttp200Ok),
     TEST_NO_TAG("Channel parser for HTTP reponse", channel_parser_http_response),
     TEST_NO_TAG("Get body size", testGetBody),
-    TEST_NO_TAG("Create hop from uri", testHop)};
+    TEST_NO_TAG("Create hop from uri", testHop),
+    TEST_NO_TAG("Fast parser", testFastParser),
+    TEST_NO_TAG("Header lookup", testHeaderLookup),
+    TEST_NO_TAG("Marshalled headers", testMarshalledHeaders),
+#ifndef _WIN32
+    TEST_NO_TAG("Marshalled headers retransmission", testMarshalledHeadersRetransmission),
+    TEST_NO_TAG("Send body after partial write", testSendBodyAfterPartialWrite),
+#endif
+};
 
 test_suite_t belle_sip_message_test_suite = {"Message",
                                              NULL,
@@ -175,6 +175,8 @@ static void a_query_cancelled_engine(unsigned char dns_engine, bool_t destroy_st
 	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, timeout));
 	BC_ASSERT_PTR_NOT_NULL(client->ai_list);
 
+	/* The next queries must be sent to the DNS server to be cancelled while pending, not answered from the cache */
+	belle_sip_stack_enable_dns_cache(client->stack, FALSE);
 	/* Then run 50 times a query and cancel it(just to try some race conditions) */
 	for (i = 0; i < 50; i++) {
 		reset_endpoint(client);
@@ -234,6 +236,8 @@ static void srv_query_cancelled_engine(unsigned char dns_engine, bool_t destroy_
 		BC_ASSERT_EQUAL(belle_sip_dns_srv_get_port(result_srv), SIP_PORT, int, "%d");
 	}
 
+	/* The next queries must be sent to the DNS server to be cancelled while pending, not answered from the cache */
+	belle_sip_stack_enable_dns_cache(client->stack, FALSE);
 	/* Then run 50 times a query and cancel it(just to try some race conditions) */
 	for (i = 0; i < 50; i++) {
 		reset_endpoint(client);
@@ -287,6 +291,8 @@ static void srv_a_query_cancelled_engine(unsigned char dns_engine, bool_t destro
 	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, timeout));
 	BC_ASSERT_PTR_NOT_NULL(client->ai_list);
 
+	/* The next queries must be sent to the DNS server to be cancelled while pending, not answered from the cache */
+	belle_sip_stack_enable_dns_cache(client->stack, FALSE);
 	/* Then run 50 times a query and cancel it(just to try some race conditions) */
 	for (i = 0; i < 50; i++) {
 		reset_endpoint(client);
@@ -348,6 +354,8 @@ static void aaaa_query_cancelled_engine(unsigned char dns_engine, bool_t destroy
 	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, timeout));
 	BC_ASSERT_PTR_NOT_NULL(client->ai_list);
 
+	/* The next queries must be sent to the DNS server to be cancelled while pending, not answered from the cache */
+	belle_sip_stack_enable_dns_cache(client->stack, FALSE);
 	/* Then run 50 times a query and cancel it(just to try some race conditions) */
 	for (i = 0; i < 50; i++) {
 		reset_endpoint(client);
@@ -1151,6 +1159,388 @@ static void mdns_queries(void) {
 }
 #endif
 
+/*
+ * Minimal DNS server on the loopback interface for the DNS cache tests. It counts the queries it receives and answers
+ * them with dns_stub_records, with a NXDOMAIN and the SOA record of the zone for the unknown names.
+ */
+#define DNS_STUB_TYPE_A 1
+#define DNS_STUB_TYPE_SOA 6
+#define DNS_STUB_TYPE_SRV 33
+#define DNS_STUB_NEGATIVE_TTL 600
+
+typedef struct dns_stub_record {
+	const char *name;
+	int type;
+	uint32_t ttl;
+	const char *data; /* IPv4 address of the A records, target of the SRV records */
+	unsigned short port;
+} dns_stub_record_t;
+
+static const dns_stub_record_t dns_stub_records[] = {
+    {"sip.cache.test", DNS_STUB_TYPE_A, 3600, "192.0.2.1", 0},
+    {"short.cache.test", DNS_STUB_TYPE_A, 1, "192.0.2.2", 0},
+    {"_sip._udp.cache.test", DNS_STUB_TYPE_SRV, 3600, "sip.cache.test", 5070},
+};
+
+typedef struct dns_stub {
+	belle_sip_socket_t sock;
+	belle_sip_source_t *source;
+	char server[32];
+	int queries;
+} dns_stub_t;
+
+static size_t dns_stub_put_u16(uint8_t *p, unsigned int value) {
+	p[0] = (uint8_t)(value >> 8);
+	p[1] = (uint8_t)value;
+	return 2;
+}
+
+static size_t dns_stub_put_u32(uint8_t *p, uint32_t value) {
+	dns_stub_put_u16(p, value >> 16);
+	return 2 + dns_stub_put_u16(p + 2, value & 0xffff);
+}
+
+static size_t dns_stub_put_name(uint8_t *p, const char *name) {
+	size_t size = 0;
+	while (*name != '\0') {
+		const char *dot = strchr(name, '.');
+		size_t len = dot ? (size_t)(dot - name) : strlen(name);
+		p[size++] = (uint8_t)len;
+		memcpy(p + size, name, len);
+		size += len;
+		name += dot ? len + 1 : len;
+	}
+	p[size++] = 0;
+	return size;
+}
+
+/* appends a record whose name is the one of the question, compressed */
+static size_t dns_stub_put_record(uint8_t *p, int type, uint32_t ttl, const uint8_t *rdata, size_t rdata_size) {
+	size_t size = dns_stub_put_u16(p, 0xc00c);
+	size += dns_stub_put_u16(p + size, type);
+	size += dns_stub_put_u16(p + size, 1 /* IN */);
+	size += dns_stub_put_u32(p + size, ttl);
+	size += dns_stub_put_u16(p + size, (unsigned int)rdata_size);
+	memcpy(p + size, rdata, rdata_size);
+	return size + rdata_size;
+}
+
+static int dns_stub_process(dns_stub_t *stub, unsigned int revents) {
+	uint8_t query[512], answer[1024], rdata[256];
+	struct sockaddr_storage from;
+	socklen_t fromlen = sizeof(from);
+	char name[256] = {0};
+	size_t pos = 12, name_len = 0, size, i;
+	int type, answers = 0, name_found = FALSE;
+	ssize_t len = bctbx_recvfrom(stub->sock, query, sizeof(query), 0, (struct sockaddr *)&from, &fromlen);
+
+	if (len < 12) return BELLE_SIP_CONTINUE;
+	while (pos < (size_t)len && query[pos] != 0) {
+		size_t label_len = query[pos];
+		if (pos + 1 + label_len >= (size_t)len || name_len + label_len + 1 >= sizeof(name)) return BELLE_SIP_CONTINUE;
+		if (name_len > 0) name[name_len++] = '.';
+		memcpy(name + name_len, query + pos + 1, label_len);
+		name_len += label_len;
+		pos += 1 + label_len;
+	}
+	if (pos + 5 > (size_t)len) return BELLE_SIP_CONTINUE;
+	type = (query[pos + 1] << 8) | query[pos + 2];
+	pos += 5; /* end of the question */
+	stub->queries++;
+
+	memcpy(answer, query, pos);
+	size = pos;
+	for (i = 0; i < sizeof(dns_stub_records) / sizeof(dns_stub_records[0]); i++) {
+		const dns_stub_record_t *record = &dns_stub_records[i];
+		size_t rdata_size = 0;
+		if (strcasecmp(record->name, name) != 0) continue;
+		name_found = TRUE;
+		if (record->type != type) continue;
+		if (type == DNS_STUB_TYPE_A) {
+			inet_pton(AF_INET, record->data, rdata);
+			rdata_size = 4;
+		} else {
+			rdata_size += dns_stub_put_u16(rdata, 10);  /* priority */
+			rdata_size += dns_stub_put_u16(rdata + rdata_size, 50); /* weight */
+			rdata_size += dns_stub_put_u16(rdata + rdata_size, record->port);
+			rdata_size += dns_stub_put_name(rdata + rdata_size, record->data);
+		}
+		size += dns_stub_put_record(answer + size, type, record->ttl, rdata, rdata_size);
+		answers++;
+	}
+	if (answers == 0) {
+		size_t rdata_size = dns_stub_put_name(rdata, "ns.cache.test");
+		rdata_size += dns_stub_put_name(rdata + rdata_size, "admin.cache.test");
+		rdata_size += dns_stub_put_u32(rdata + rdata_size, 1);     /* serial */
+		rdata_size += dns_stub_put_u32(rdata + rdata_size, 3600);  /* refresh */
+		rdata_size += dns_stub_put_u32(rdata + rdata_size, 600);   /* retry */
+		rdata_size += dns_stub_put_u32(rdata + rdata_size, 86400); /* expire */
+		rdata_size += dns_stub_put_u32(rdata + rdata_size, DNS_STUB_NEGATIVE_TTL);
+		size += dns_stub_put_record(answer + size, DNS_STUB_TYPE_SOA, 3600, rdata, rdata_size);
+	}
+	answer[2] = 0x84 | (query[2] & 0x01);  /* response, authoritative, recursion desired copied from the query */
+	answer[3] = name_found ? 0 : 3;        /* NXDOMAIN */
+	dns_stub_put_u16(answer + 4, 1);       /* question */
+	dns_stub_put_u16(answer + 6, answers); /* answers */
+	dns_stub_put_u16(answer + 8, answers ? 0 : 1);
+	dns_stub_put_u16(answer + 10, 0);
+	bctbx_sendto(stub->sock, answer, size, 0, (struct sockaddr *)&from, fromlen);
+	return BELLE_SIP_CONTINUE;
+}
+
+static dns_stub_t *dns_stub_new(belle_sip_stack_t *stack) {
+	dns_stub_t *stub = belle_sip_new0(dns_stub_t);
+	struct sockaddr_in addr;
+	socklen_t addrlen = sizeof(addr);
+	belle_sip_list_t *servers;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	stub->sock = (belle_sip_socket_t)bctbx_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	BC_ASSERT_EQUAL(bctbx_bind(stub->sock, (struct sockaddr *)&addr, sizeof(addr)), 0, int, "%d");
+	BC_ASSERT_EQUAL(bctbx_getsockname(stub->sock, (struct sockaddr *)&addr, &addrlen), 0, int, "%d");
+	snprintf(stub->server, sizeof(stub->server), "[127.0.0.1]:%i", ntohs(addr.sin_port));
+	stub->source = belle_sip_socket_source_new((belle_sip_source_func_t)dns_stub_process, stub, stub->sock,
+	                                           BELLE_SIP_EVENT_READ, -1);
+	belle_sip_main_loop_add_source(belle_sip_stack_get_main_loop(stack), stub->source);
+
+	servers = belle_sip_list_append(NULL, stub->server);
+	belle_sip_stack_set_dns_servers(stack, servers);
+	belle_sip_list_free(servers);
+	belle_sip_stack_enable_dns_search(stack, FALSE);
+	return stub;
+}
+
+static void dns_stub_destroy(belle_sip_stack_t *stack, dns_stub_t *stub) {
+	belle_sip_main_loop_remove_source(belle_sip_stack_get_main_loop(stack), stub->source);
+	belle_sip_object_unref(stub->source);
+	belle_sip_close_socket(stub->sock);
+	belle_sip_free(stub);
+}
+
+static void check_dns_stub_address(const struct addrinfo *ai, const char *ip, int port) {
+	char host[NI_MAXHOST];
+	char serv[10];
+	if (!BC_ASSERT_PTR_NOT_NULL(ai)) return;
+	bctbx_getnameinfo(ai->ai_addr, (socklen_t)ai->ai_addrlen, host, sizeof(host), serv, sizeof(serv),
+	                  NI_NUMERICHOST | NI_NUMERICSERV);
+	BC_ASSERT_STRING_EQUAL(host, ip);
+	BC_ASSERT_EQUAL(atoi(serv), port, int, "%d");
+}
+
+static void dns_cache(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	dns_stub_t *stub = dns_stub_new(client->stack);
+	belle_sip_dns_cache_stats_t stats;
+
+	/* The first resolution sends a query, the next ones are answered synchronously from the cache */
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "sip.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_PTR_NOT_NULL(client->resolver_ctx);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	check_dns_stub_address(client->ai_list, "192.0.2.1", SIP_PORT);
+	BC_ASSERT_EQUAL(stub->queries, 1, int, "%d");
+
+	reset_endpoint(client);
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "SIP.cache.test.", 5070, AF_INET, a_resolve_done, client);
+	BC_ASSERT_PTR_NULL(client->resolver_ctx);
+	BC_ASSERT_TRUE(client->resolve_done);
+	check_dns_stub_address(client->ai_list, "192.0.2.1", 5070);
+	if (client->results) BC_ASSERT_TRUE(belle_sip_resolver_results_get_ttl(client->results) <= 3600);
+	BC_ASSERT_EQUAL(stub->queries, 1, int, "%d");
+
+	/* The answer is not kept after its TTL */
+	reset_endpoint(client);
+	belle_sip_stack_resolve_a(client->stack, "short.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	check_dns_stub_address(client->ai_list, "192.0.2.2", SIP_PORT);
+	reset_endpoint(client);
+	belle_sip_stack_resolve_a(client->stack, "short.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_TRUE(client->resolve_done);
+	BC_ASSERT_EQUAL(stub->queries, 2, int, "%d");
+	belle_sip_stack_sleep(client->stack, 1100);
+	reset_endpoint(client);
+	belle_sip_stack_resolve_a(client->stack, "short.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	check_dns_stub_address(client->ai_list, "192.0.2.2", SIP_PORT);
+	BC_ASSERT_EQUAL(stub->queries, 3, int, "%d");
+
+	/* The absence of record is kept as well */
+	reset_endpoint(client);
+	belle_sip_stack_resolve_a(client->stack, "unknown.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	BC_ASSERT_TRUE(client->resolve_ko);
+	reset_endpoint(client);
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "unknown.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_PTR_NULL(client->resolver_ctx);
+	BC_ASSERT_TRUE(client->resolve_ko);
+	if (client->results) {
+		BC_ASSERT_TRUE(belle_sip_resolver_results_get_ttl(client->results) <= DNS_STUB_NEGATIVE_TTL);
+	}
+	BC_ASSERT_EQUAL(stub->queries, 4, int, "%d");
+
+	/* A flush empties the cache */
+	belle_sip_stack_flush_dns_cache(client->stack);
+	reset_endpoint(client);
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "sip.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_PTR_NOT_NULL(client->resolver_ctx);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	BC_ASSERT_EQUAL(stub->queries, 5, int, "%d");
+
+	belle_sip_stack_get_dns_cache_stats(client->stack, &stats);
+	BC_ASSERT_EQUAL(stats.hits, 3, unsigned int, "%u");
+	BC_ASSERT_EQUAL(stats.misses, 5, unsigned int, "%u");
+	BC_ASSERT_EQUAL(stats.coalesced, 0, unsigned int, "%u");
+	BC_ASSERT_EQUAL(stats.entries, 1, unsigned int, "%u");
+
+	dns_stub_destroy(client->stack, stub);
+	destroy_endpoint(client);
+}
+
+static void dns_cache_concurrent_queries(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	resolver_endpoint_t *other = belle_sip_new0(resolver_endpoint_t);
+	resolver_endpoint_t *cancelled = belle_sip_new0(resolver_endpoint_t);
+	dns_stub_t *stub = dns_stub_new(client->stack);
+	belle_sip_dns_cache_stats_t stats;
+
+	/* The three resolutions wait for the same query, whose answer is still given to the others when the one that
+	 * sent it is cancelled */
+	cancelled->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "sip.cache.test", SIP_PORT, AF_INET, a_resolve_done, cancelled);
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "sip.cache.test", SIP_PORT, AF_INET, a_resolve_done, client);
+	other->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, "sip.cache.test", 5070, AF_INET6, a_resolve_done, other);
+	BC_ASSERT_PTR_NOT_NULL(cancelled->resolver_ctx);
+	BC_ASSERT_PTR_NOT_NULL(client->resolver_ctx);
+	BC_ASSERT_PTR_NOT_NULL(other->resolver_ctx);
+	if (cancelled->resolver_ctx) belle_sip_resolver_context_cancel(cancelled->resolver_ctx);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	BC_ASSERT_TRUE(wait_for(client->stack, &other->resolve_done, 1, 2000));
+	check_dns_stub_address(client->ai_list, "192.0.2.1", SIP_PORT);
+	BC_ASSERT_FALSE(cancelled->resolve_done);
+
+	belle_sip_stack_get_dns_cache_stats(client->stack, &stats);
+	BC_ASSERT_EQUAL(stats.coalesced, 2, unsigned int, "%u");
+
+	/* The SRV and A answers of a full resolution are cached as well */
+	reset_endpoint(client);
+	client->resolver_ctx = belle_sip_stack_resolve(client->stack, "sip", "udp", "cache.test", SIP_PORT, AF_INET,
+	                                               a_resolve_done, client);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	check_dns_stub_address(client->ai_list, "192.0.2.1", 5070);
+	reset_endpoint(client);
+	client->resolver_ctx = belle_sip_stack_resolve(client->stack, "sip", "udp", "cache.test", SIP_PORT, AF_INET,
+	                                               a_resolve_done, client);
+	BC_ASSERT_PTR_NULL(client->resolver_ctx);
+	check_dns_stub_address(client->ai_list, "192.0.2.1", 5070);
+
+	dns_stub_destroy(client->stack, stub);
+	reset_endpoint(other);
+	reset_endpoint(cancelled);
+	belle_sip_free(other);
+	belle_sip_free(cancelled);
+	destroy_endpoint(client);
+}
+
+static void dns_cache_prewarm(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	dns_stub_t *stub = dns_stub_new(client->stack);
+	int queries;
+
+	/* The SRV queries of the three transports, the A and AAAA queries of the domain and of the SRV target */
+	belle_sip_stack_prewarm_dns_cache(client->stack, "cache.test");
+	BC_ASSERT_TRUE(wait_for(client->stack, &stub->queries, 7, 2000));
+	belle_sip_stack_sleep(client->stack, 100);
+	queries = stub->queries;
+	BC_ASSERT_EQUAL(queries, 7, int, "%d");
+
+	client->resolver_ctx = belle_sip_stack_resolve(client->stack, "sip", "udp", "cache.test", SIP_PORT, AF_INET6,
+	                                               a_resolve_done, client);
+	BC_ASSERT_PTR_NULL(client->resolver_ctx);
+	BC_ASSERT_TRUE(client->resolve_done);
+	BC_ASSERT_PTR_NOT_NULL(client->ai_list);
+	BC_ASSERT_EQUAL(stub->queries, queries, int, "%d");
+
+	dns_stub_destroy(client->stack, stub);
+	destroy_endpoint(client);
+}
+
+static void resolve_a_from_dns_stub(resolver_endpoint_t *client, const char *name) {
+	reset_endpoint(client);
+	client->resolver_ctx = belle_sip_stack_resolve_a(client->stack, name, SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+}
+
+static void dns_cache_max_entries(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	resolver_endpoint_t *others[4];
+	dns_stub_t *stub = dns_stub_new(client->stack);
+	belle_sip_dns_cache_stats_t stats;
+	int i;
+
+	belle_sip_dns_cache_set_max_entries(client->stack->dns_cache, 3);
+
+	/* The fourth answer evicts the first one */
+	resolve_a_from_dns_stub(client, "sip.cache.test");
+	resolve_a_from_dns_stub(client, "one.cache.test");
+	resolve_a_from_dns_stub(client, "two.cache.test");
+	resolve_a_from_dns_stub(client, "three.cache.test");
+	BC_ASSERT_EQUAL(stub->queries, 4, int, "%d");
+	belle_sip_stack_get_dns_cache_stats(client->stack, &stats);
+	BC_ASSERT_EQUAL(stats.entries, 3, unsigned int, "%u");
+	BC_ASSERT_EQUAL(stats.evicted, 1, unsigned int, "%u");
+
+	resolve_a_from_dns_stub(client, "three.cache.test");
+	BC_ASSERT_EQUAL(stub->queries, 4, int, "%d");
+	resolve_a_from_dns_stub(client, "sip.cache.test");
+	check_dns_stub_address(client->ai_list, "192.0.2.1", SIP_PORT);
+	BC_ASSERT_EQUAL(stub->queries, 5, int, "%d");
+
+	/* The oldest answers are evicted, whatever their use since */
+	resolve_a_from_dns_stub(client, "two.cache.test");
+	BC_ASSERT_EQUAL(stub->queries, 5, int, "%d");
+	resolve_a_from_dns_stub(client, "one.cache.test");
+	BC_ASSERT_EQUAL(stub->queries, 6, int, "%d");
+	resolve_a_from_dns_stub(client, "three.cache.test");
+	BC_ASSERT_EQUAL(stub->queries, 6, int, "%d");
+	resolve_a_from_dns_stub(client, "two.cache.test");
+	BC_ASSERT_EQUAL(stub->queries, 7, int, "%d");
+
+	/* The pending queries are not evicted, even above the maximum */
+	for (i = 0; i < 4; i++) {
+		char name[32];
+		others[i] = belle_sip_new0(resolver_endpoint_t);
+		snprintf(name, sizeof(name), "pending%i.cache.test", i);
+		others[i]->resolver_ctx =
+		    belle_sip_stack_resolve_a(client->stack, name, SIP_PORT, AF_INET, a_resolve_done, others[i]);
+		BC_ASSERT_PTR_NOT_NULL(others[i]->resolver_ctx);
+	}
+	belle_sip_stack_get_dns_cache_stats(client->stack, &stats);
+	BC_ASSERT_EQUAL(stats.entries, 4, unsigned int, "%u");
+	for (i = 0; i < 4; i++) {
+		BC_ASSERT_TRUE(wait_for(client->stack, &others[i]->resolve_done, 1, 2000));
+		BC_ASSERT_TRUE(others[i]->resolve_ko);
+		reset_endpoint(others[i]);
+		belle_sip_free(others[i]);
+	}
+	BC_ASSERT_EQUAL(stub->queries, 11, int, "%d");
+
+	/* and the next query brings the cache back under its maximum */
+	resolve_a_from_dns_stub(client, "sip.cache.test");
+	belle_sip_stack_get_dns_cache_stats(client->stack, &stats);
+	BC_ASSERT_EQUAL(stats.entries, 3, unsigned int, "%u");
+	BC_ASSERT_EQUAL(stub->queries, 12, int, "%d");
+
+	dns_stub_destroy(client->stack, stub);
+	destroy_endpoint(client);
+}
+
 static test_t resolver_tests[] = {
     TEST_NO_TAG("A query (IPv4)", ipv4_a_query),
     TEST_NO_TAG("A query (IPv4) with CNAME", ipv4_cname_a_query),
@@ -1178,6 +1568,10 @@ static test_t resolver_tests[] = {
     TEST_NO_TAG("SRV + A query cancelled", srv_a_query_cancelled),
     TEST_NO_TAG("AAAA query cancelled", aaaa_query_cancelled),
     TEST_NO_TAG("A query in time out cancelled", timeout_query_cancelled),
+    TEST_NO_TAG("DNS cache", dns_cache),
+    TEST_NO_TAG("DNS cache with concurrent queries", dns_cache_concurrent_queries),
+    TEST_NO_TAG("DNS cache prewarm", dns_cache_prewarm),
+    TEST_NO_TAG("DNS cache with a maximum of entries", dns_cache_max_entries),
 #ifdef HAVE_MDNS
     TEST_NO_TAG("MDNS query", mdns_query),
     TEST_NO_TAG("MDNS query with ipv6", mdns_query_ipv6),
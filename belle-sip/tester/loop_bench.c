@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2012-2019 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the latency of a main loop iteration that handles one active connection, against the number of idle
+ * connections watched by the main loop, for each available backend.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "belle-sip/belle-sip.h"
+
+#ifdef _WIN32
+
+int main(int argc, char *argv[]) {
+	fprintf(stderr, "%s is not supported on Windows.\n", argv[0]);
+	return -1;
+}
+
+#else
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef struct connection {
+	int fds[2];
+	belle_sip_source_t *source;
+} connection_t;
+
+static uint64_t get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static int on_readable(void *data, unsigned int events) {
+	connection_t *conn = (connection_t *)data;
+	char buf[16];
+	if (events & BELLE_SIP_EVENT_READ) {
+		if (read(conn->fds[0], buf, sizeof(buf)) < 0) fprintf(stderr, "read() failed\n");
+	}
+	return BELLE_SIP_CONTINUE;
+}
+
+static int open_connections(belle_sip_main_loop_t *ml, connection_t *conns, int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, conns[i].fds) != 0) {
+			fprintf(stderr, "socketpair() failed after %i connections: %s\n", i, strerror(errno));
+			return i;
+		}
+		conns[i].source =
+		    belle_sip_socket_source_new(on_readable, &conns[i], conns[i].fds[0], BELLE_SIP_EVENT_READ, -1);
+		belle_sip_main_loop_add_source(ml, conns[i].source);
+	}
+	return count;
+}
+
+static void close_connections(belle_sip_main_loop_t *ml, connection_t *conns, int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		belle_sip_main_loop_remove_source(ml, conns[i].source);
+		belle_sip_object_unref(conns[i].source);
+		close(conns[i].fds[0]);
+		close(conns[i].fds[1]);
+	}
+}
+
+/* returns the mean duration of an iteration in microseconds */
+static double run_bench(belle_sip_main_loop_backend_t backend, int idle_count, int iterations) {
+	belle_sip_main_loop_t *ml = belle_sip_main_loop_new_with_backend(backend);
+	connection_t *conns = belle_sip_malloc0((idle_count + 1) * sizeof(connection_t));
+	connection_t *active = &conns[idle_count];
+	int opened = open_connections(ml, conns, idle_count + 1);
+	uint64_t start;
+	uint64_t elapsed = 0;
+	int i;
+
+	if (opened == idle_count + 1) {
+		/* warm up */
+		belle_sip_main_loop_sleep(ml, 0);
+		start = get_time_us();
+		for (i = 0; i < iterations; i++) {
+			if (write(active->fds[1], "x", 1) != 1) fprintf(stderr, "write() failed\n");
+			belle_sip_main_loop_sleep(ml, 0);
+		}
+		elapsed = get_time_us() - start;
+	}
+	close_connections(ml, conns, opened);
+	belle_sip_free(conns);
+	belle_sip_object_unref(ml);
+	return opened == idle_count + 1 ? (double)elapsed / iterations : -1;
+}
+
+static void raise_fd_limit(void) {
+	struct rlimit rl;
+	if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+		rl.rlim_cur = rl.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &rl);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	static const int idle_counts[] = {0, 10, 100, 1000, 5000, 10000};
+	int iterations = 2000;
+	size_t i;
+
+	if (argc > 1) iterations = atoi(argv[1]);
+	if (iterations <= 0) {
+		fprintf(stderr, "Usage:\n%s [iterations]\n", argv[0]);
+		return -1;
+	}
+	raise_fd_limit();
+	belle_sip_set_log_level(BELLE_SIP_LOG_ERROR);
+
+	printf("%-18s %14s %14s\n", "idle connections", "poll (us)", "epoll (us)");
+	for (i = 0; i < sizeof(idle_counts) / sizeof(idle_counts[0]); i++) {
+		double poll_us = run_bench(BELLE_SIP_MAIN_LOOP_BACKEND_POLL, idle_counts[i], iterations);
+		double epoll_us = run_bench(BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL, idle_counts[i], iterations);
+		if (poll_us < 0 || epoll_us < 0) break;
+		printf("%-18i %14.2f %14.2f\n", idle_counts[i], poll_us, epoll_us);
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2012-2019 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the time needed to parse the messages of a typical registration, call and presence flow, with the grammar
+ * only and with the hand-written parser of the frequent headers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "belle-sip/belle-sip.h"
+#include "belle_sip_internal.h"
+
+typedef struct bench_message {
+	const char *name;
+	const char *raw;
+} bench_message_t;
+
+static const bench_message_t messages[] = {
+    {"REGISTER", "REGISTER sip:sip.example.org SIP/2.0\r\n"
+                 "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.3LzAykDBQ;rport\r\n"
+                 "From: <sip:alice@sip.example.org>;tag=NkOhfV9eD\r\n"
+                 "To: sip:alice@sip.example.org\r\n"
+                 "CSeq: 21 REGISTER\r\n"
+                 "Call-ID: Ta3UmDbsTi\r\n"
+                 "Max-Forwards: 70\r\n"
+                 "Supported: replaces, outbound, gruu, path\r\n"
+                 "Accept: application/sdp, text/plain, application/vnd.gsma.rcs-ft-http+xml\r\n"
+                 "Contact: <sip:alice@192.168.1.8:43256;transport=tls>;+sip.instance=\"<urn:uuid:f71ad7c1-3e1b-4b36-"
+                 "9c1b-5c9b0e9f5e0e>\";+org.linphone.specs=\"conference/1.0,ephemeral/1.1,groupchat/1.1,lime\"\r\n"
+                 "Expires: 3600\r\n"
+                 "User-Agent: Linphone-Desktop/5.2.0 (belledonne) ubuntu/22.04 Qt/5.15.2 LinphoneSDK/5.3.0\r\n"
+                 "Content-Length: 0\r\n"
+                 "\r\n"},
+    {"401 Unauthorized", "SIP/2.0 401 Unauthorized\r\n"
+                         "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.3LzAykDBQ;rport=43256;"
+                         "received=81.56.113.2\r\n"
+                         "From: <sip:alice@sip.example.org>;tag=NkOhfV9eD\r\n"
+                         "To: <sip:alice@sip.example.org>;tag=Bv3ZjXeQ4jaDg\r\n"
+                         "Call-ID: Ta3UmDbsTi\r\n"
+                         "CSeq: 21 REGISTER\r\n"
+                         "WWW-Authenticate: Digest realm=\"sip.example.org\", "
+                         "nonce=\"DfZVfwAAAADUdu/8AADuGcPgtOYAAAAA\", "
+                         "opaque=\"+GNywA==\", algorithm=SHA-256, qop=\"auth\"\r\n"
+                         "Content-Length: 0\r\n"
+                         "\r\n"},
+    {"INVITE", "INVITE sip:bob@sip.example.org SIP/2.0\r\n"
+               "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Nvf3f7pVW;rport\r\n"
+               "Record-Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+               "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+               "To: \"Bob\" <sip:bob@sip.example.org>\r\n"
+               "CSeq: 20 INVITE\r\n"
+               "Call-ID: wvp3y~3iBd\r\n"
+               "Max-Forwards: 70\r\n"
+               "Supported: replaces, outbound, gruu, path\r\n"
+               "Allow: INVITE, ACK, CANCEL, OPTIONS, BYE, REFER, NOTIFY, MESSAGE, SUBSCRIBE, INFO, PRACK, UPDATE\r\n"
+               "Content-Type: application/sdp\r\n"
+               "Contact: <sip:alice@sip.example.org;gr=urn:uuid:f71ad7c1-3e1b-4b36-9c1b-5c9b0e9f5e0e>;"
+               "+org.linphone.specs=\"conference/1.0,ephemeral/1.1,groupchat/1.1,lime\"\r\n"
+               "User-Agent: Linphone-Desktop/5.2.0 (belledonne) ubuntu/22.04 Qt/5.15.2 LinphoneSDK/5.3.0\r\n"
+               "Content-Length: 512\r\n"
+               "\r\n"},
+    {"100 Trying", "SIP/2.0 100 Trying\r\n"
+                   "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Nvf3f7pVW;rport=43256;"
+                   "received=81.56.113.2\r\n"
+                   "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+                   "To: \"Bob\" <sip:bob@sip.example.org>\r\n"
+                   "Call-ID: wvp3y~3iBd\r\n"
+                   "CSeq: 20 INVITE\r\n"
+                   "Server: Flexisip/2.3.0 (sofia-sip-nta/2.0)\r\n"
+                   "Content-Length: 0\r\n"
+                   "\r\n"},
+    {"180 Ringing", "SIP/2.0 180 Ringing\r\n"
+                    "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Nvf3f7pVW;rport=43256;"
+                    "received=81.56.113.2\r\n"
+                    "Record-Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+                    "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+                    "To: \"Bob\" <sip:bob@sip.example.org>;tag=4HzvjyHtO\r\n"
+                    "Call-ID: wvp3y~3iBd\r\n"
+                    "CSeq: 20 INVITE\r\n"
+                    "Contact: <sip:bob@sip.example.org;gr=urn:uuid:0b2f3e84-9a52-4c1d-8cd3-3a2a5b51c0d1>\r\n"
+                    "User-Agent: LinphoneAndroid/5.2.0 (Pixel 7) LinphoneSDK/5.3.0\r\n"
+                    "Content-Length: 0\r\n"
+                    "\r\n"},
+    {"200 Ok (INVITE)", "SIP/2.0 200 Ok\r\n"
+                        "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Nvf3f7pVW;rport=43256;"
+                        "received=81.56.113.2\r\n"
+                        "Record-Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+                        "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+                        "To: \"Bob\" <sip:bob@sip.example.org>;tag=4HzvjyHtO\r\n"
+                        "Call-ID: wvp3y~3iBd\r\n"
+                        "CSeq: 20 INVITE\r\n"
+                        "Contact: <sip:bob@sip.example.org;gr=urn:uuid:0b2f3e84-9a52-4c1d-8cd3-3a2a5b51c0d1>\r\n"
+                        "Supported: replaces, outbound, gruu, path\r\n"
+                        "Allow: INVITE, ACK, CANCEL, OPTIONS, BYE, REFER, NOTIFY, MESSAGE, SUBSCRIBE, INFO, UPDATE\r\n"
+                        "Content-Type: application/sdp\r\n"
+                        "Content-Length: 478\r\n"
+                        "\r\n"},
+    {"ACK", "ACK sip:bob@sip.example.org;gr=urn:uuid:0b2f3e84-9a52-4c1d-8cd3-3a2a5b51c0d1 SIP/2.0\r\n"
+            "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Wh6ZmBhnS;rport\r\n"
+            "Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+            "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+            "To: \"Bob\" <sip:bob@sip.example.org>;tag=4HzvjyHtO\r\n"
+            "CSeq: 20 ACK\r\n"
+            "Call-ID: wvp3y~3iBd\r\n"
+            "Max-Forwards: 70\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n"},
+    {"BYE", "BYE sip:bob@sip.example.org;gr=urn:uuid:0b2f3e84-9a52-4c1d-8cd3-3a2a5b51c0d1 SIP/2.0\r\n"
+            "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.m7vX~9Yqv;rport\r\n"
+            "Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+            "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+            "To: \"Bob\" <sip:bob@sip.example.org>;tag=4HzvjyHtO\r\n"
+            "CSeq: 21 BYE\r\n"
+            "Call-ID: wvp3y~3iBd\r\n"
+            "Max-Forwards: 70\r\n"
+            "User-Agent: Linphone-Desktop/5.2.0 (belledonne) ubuntu/22.04 Qt/5.15.2 LinphoneSDK/5.3.0\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n"},
+    {"SUBSCRIBE", "SUBSCRIBE sip:alice@sip.example.org SIP/2.0\r\n"
+                  "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.vdRpEA9~i;rport\r\n"
+                  "From: <sip:alice@sip.example.org>;tag=0DglXbedv\r\n"
+                  "To: <sip:alice@sip.example.org>\r\n"
+                  "CSeq: 20 SUBSCRIBE\r\n"
+                  "Call-ID: 50qVGs8IbH\r\n"
+                  "Max-Forwards: 70\r\n"
+                  "Supported: replaces, outbound, gruu, path\r\n"
+                  "Event: presence\r\n"
+                  "Expires: 600\r\n"
+                  "Accept: application/pidf+xml, application/rlmi+xml, multipart/related\r\n"
+                  "Contact: <sip:alice@sip.example.org;gr=urn:uuid:f71ad7c1-3e1b-4b36-9c1b-5c9b0e9f5e0e>\r\n"
+                  "Content-Length: 0\r\n"
+                  "\r\n"},
+    {"NOTIFY", "NOTIFY sip:alice@sip.example.org;gr=urn:uuid:f71ad7c1-3e1b-4b36-9c1b-5c9b0e9f5e0e SIP/2.0\r\n"
+               "Via: SIP/2.0/TLS 51.15.100.1:5061;branch=z9hG4bK.p4tEUSBQf;rport\r\n"
+               "From: <sip:alice@sip.example.org>;tag=Bv3ZjXeQ4jaDg\r\n"
+               "To: <sip:alice@sip.example.org>;tag=0DglXbedv\r\n"
+               "CSeq: 102 NOTIFY\r\n"
+               "Call-ID: 50qVGs8IbH\r\n"
+               "Max-Forwards: 70\r\n"
+               "Event: presence\r\n"
+               "Subscription-State: active;expires=599\r\n"
+               "Content-Type: application/pidf+xml\r\n"
+               "Contact: <sip:51.15.100.1:5061;transport=tls>\r\n"
+               "Content-Length: 1024\r\n"
+               "\r\n"},
+    {"MESSAGE", "MESSAGE sip:bob@sip.example.org SIP/2.0\r\n"
+                "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.9kQ0bHfXt;rport\r\n"
+                "From: <sip:alice@sip.example.org>;tag=XvH6Wj5Ob\r\n"
+                "To: sip:bob@sip.example.org\r\n"
+                "CSeq: 20 MESSAGE\r\n"
+                "Call-ID: 3sP~xNqg7Q\r\n"
+                "Max-Forwards: 70\r\n"
+                "Supported: replaces, outbound, gruu, path\r\n"
+                "Date: Mon, 06 May 2024 09:41:12 GMT\r\n"
+                "Content-Type: message/cpim\r\n"
+                "Content-Length: 312\r\n"
+                "\r\n"},
+};
+
+static uint64_t get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* returns the mean duration of a parsing in microseconds */
+static double run_bench(const char *raw, int iterations, bool_t fast) {
+	size_t length = strlen(raw);
+	uint64_t start;
+	int i;
+
+	belle_sip_message_enable_fast_parser(fast);
+	start = get_time_us();
+	for (i = 0; i < iterations; i++) {
+		size_t message_length;
+		belle_sip_message_t *msg = belle_sip_message_parse_raw(raw, length, &message_length);
+		if (!msg) {
+			fprintf(stderr, "Could not parse message:\n%s\n", raw);
+			return -1;
+		}
+		belle_sip_object_unref(msg);
+	}
+	return (double)(get_time_us() - start) / iterations;
+}
+
+int main(int argc, char *argv[]) {
+	int iterations = 200;
+	double total_grammar = 0;
+	double total_fast = 0;
+	size_t i;
+
+	if (argc > 1) iterations = atoi(argv[1]);
+	if (iterations <= 0) {
+		fprintf(stderr, "Usage:\n%s [iterations]\n", argv[0]);
+		return -1;
+	}
+	belle_sip_set_log_level(BELLE_SIP_LOG_ERROR);
+
+	printf("%-18s %14s %14s %10s\n", "message", "grammar (us)", "fast (us)", "speedup");
+	for (i = 0; i < sizeof(messages) / sizeof(messages[0]); i++) {
+		double grammar_us = run_bench(messages[i].raw, iterations, FALSE);
+		double fast_us = run_bench(messages[i].raw, iterations, TRUE);
+		if (grammar_us < 0 || fast_us < 0) return -1;
+		printf("%-18s %14.2f %14.2f %9.1fx\n", messages[i].name, grammar_us, fast_us, grammar_us / fast_us);
+		total_grammar += grammar_us;
+		total_fast += fast_us;
+	}
+	printf("%-18s %14.2f %14.2f %9.1fx\n", "all", total_grammar, total_fast, total_grammar / total_fast);
+	belle_sip_message_enable_fast_parser(TRUE);
+	return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2012-2019 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the time needed by a provider to find the dialog of a message and the client transaction of a response,
+ * for an increasing number of established dialogs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "belle-sip/belle-sip.h"
+#include "belle_sip_internal.h"
+
+typedef struct bench_call {
+	belle_sip_request_t *request;
+	belle_sip_response_t *response;
+	belle_sip_dialog_t *dialog;
+	char call_id[32];
+	char local_tag[16];
+	char remote_tag[16];
+} bench_call_t;
+
+/* parsed once and cloned for each request, the parsing would take most of the setup time otherwise */
+static belle_sip_uri_t *request_uri;
+static belle_sip_header_from_t *from_header;
+static belle_sip_header_to_t *to_header;
+
+static uint64_t get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static belle_sip_request_t *create_invite(bench_call_t *call) {
+	belle_sip_header_call_id_t *call_id = belle_sip_header_call_id_new();
+	belle_sip_header_from_t *from = BELLE_SIP_HEADER_FROM(belle_sip_object_clone(BELLE_SIP_OBJECT(from_header)));
+	belle_sip_header_call_id_set_call_id(call_id, call->call_id);
+	belle_sip_header_from_set_tag(from, call->local_tag);
+	return belle_sip_request_create(BELLE_SIP_URI(belle_sip_object_clone(BELLE_SIP_OBJECT(request_uri))), "INVITE",
+	                                call_id, belle_sip_header_cseq_create(20, "INVITE"), from,
+	                                BELLE_SIP_HEADER_TO(belle_sip_object_clone(BELLE_SIP_OBJECT(to_header))),
+	                                belle_sip_header_via_create("192.168.1.8", 5060, "UDP", NULL), 70);
+}
+
+/* creates a client transaction and a confirmed dialog for each call */
+static void setup_calls(belle_sip_provider_t *prov, bench_call_t *calls, int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		bench_call_t *call = &calls[i];
+		belle_sip_client_transaction_t *t;
+		belle_sip_header_to_t *to;
+
+		belle_sip_random_token(call->call_id, 20);
+		belle_sip_random_token(call->local_tag, 10);
+		belle_sip_random_token(call->remote_tag, 10);
+		call->request = (belle_sip_request_t *)belle_sip_object_ref(create_invite(call));
+		t = belle_sip_provider_create_client_transaction(prov, call->request);
+		belle_sip_provider_add_client_transaction(prov, t); /*done when the request is sent*/
+		call->dialog = belle_sip_provider_create_dialog(prov, BELLE_SIP_TRANSACTION(t));
+		call->dialog->remote_tag = belle_sip_strdup(call->remote_tag);
+		call->dialog->state = BELLE_SIP_DIALOG_CONFIRMED;
+
+		call->response = (belle_sip_response_t *)belle_sip_object_ref(
+		    belle_sip_response_create_from_request(call->request, 200));
+		to = belle_sip_message_get_header_by_type(call->response, belle_sip_header_to_t);
+		belle_sip_header_to_set_tag(to, call->remote_tag);
+	}
+}
+
+static void release_calls(bench_call_t *calls, int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		belle_sip_object_unref(calls[i].request);
+		belle_sip_object_unref(calls[i].response);
+	}
+}
+
+static void run_bench(belle_sip_stack_t *stack, int count, int lookups) {
+	belle_sip_provider_t *prov = belle_sip_stack_create_provider(stack, NULL);
+	bench_call_t *calls = belle_sip_malloc0(count * sizeof(bench_call_t));
+	uint64_t dialog_us, transaction_us, start;
+	int found = 0;
+	int i;
+
+	setup_calls(prov, calls, count);
+
+	start = get_time_us();
+	for (i = 0; i < lookups; i++) {
+		bench_call_t *call = &calls[(i * 7919) % count];
+		if (belle_sip_provider_find_dialog(prov, call->call_id, call->local_tag, call->remote_tag) == call->dialog)
+			found++;
+	}
+	dialog_us = get_time_us() - start;
+
+	start = get_time_us();
+	for (i = 0; i < lookups; i++) {
+		bench_call_t *call = &calls[(i * 7919) % count];
+		if (belle_sip_provider_find_matching_client_transaction(prov, call->response)) found++;
+	}
+	transaction_us = get_time_us() - start;
+
+	printf("%-10i %18.3f %22.3f %10s\n", count, (double)dialog_us / lookups, (double)transaction_us / lookups,
+	       found == 2 * lookups ? "ok" : "MISMATCH");
+
+	belle_sip_object_unref(prov);
+	release_calls(calls, count);
+	belle_sip_free(calls);
+}
+
+int main(int argc, char *argv[]) {
+	static const int counts[] = {100, 1000, 10000, 50000};
+	int lookups = 20000;
+	belle_sip_stack_t *stack;
+	size_t i;
+
+	if (argc > 1) lookups = atoi(argv[1]);
+	if (lookups <= 0) {
+		fprintf(stderr, "Usage:\n%s [lookups]\n", argv[0]);
+		return -1;
+	}
+	belle_sip_set_log_level(BELLE_SIP_LOG_ERROR);
+	stack = belle_sip_stack_new(NULL);
+	request_uri = (belle_sip_uri_t *)belle_sip_object_ref(belle_sip_uri_parse("sip:bob@sip.example.org"));
+	from_header = (belle_sip_header_from_t *)belle_sip_object_ref(
+	    belle_sip_header_from_create2("sip:alice@sip.example.org", NULL));
+	to_header =
+	    (belle_sip_header_to_t *)belle_sip_object_ref(belle_sip_header_to_create2("sip:bob@sip.example.org", NULL));
+
+	printf("%-10s %18s %22s %10s\n", "dialogs", "dialog lookup (us)", "transaction lookup (us)", "result");
+	for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+		run_bench(stack, counts[i], lookups);
+	}
+	belle_sip_object_unref(request_uri);
+	belle_sip_object_unref(from_header);
+	belle_sip_object_unref(to_header);
+	belle_sip_object_unref(stack);
+	return 0;
+}
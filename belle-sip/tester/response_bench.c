@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2012-2019 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the time needed to build the response of a request, and to look up the headers that the transaction and
+ * dialog layers read from each message.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "belle-sip/belle-sip.h"
+
+typedef struct bench_request {
+	const char *name;
+	int status_code;
+	const char *raw;
+} bench_request_t;
+
+static const bench_request_t requests[] = {
+    {"REGISTER", 200,
+     "REGISTER sip:sip.example.org SIP/2.0\r\n"
+     "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.3LzAykDBQ;rport\r\n"
+     "From: <sip:alice@sip.example.org>;tag=NkOhfV9eD\r\n"
+     "To: sip:alice@sip.example.org\r\n"
+     "CSeq: 21 REGISTER\r\n"
+     "Call-ID: Ta3UmDbsTi\r\n"
+     "Max-Forwards: 70\r\n"
+     "Supported: replaces, outbound, gruu, path\r\n"
+     "Accept: application/sdp, text/plain, application/vnd.gsma.rcs-ft-http+xml\r\n"
+     "Contact: <sip:alice@192.168.1.8:43256;transport=tls>;+sip.instance=\"<urn:uuid:f71ad7c1-3e1b-4b36-"
+     "9c1b-5c9b0e9f5e0e>\"\r\n"
+     "Expires: 3600\r\n"
+     "User-Agent: Linphone-Desktop/5.2.0 (belledonne) ubuntu/22.04 Qt/5.15.2 LinphoneSDK/5.3.0\r\n"
+     "Content-Length: 0\r\n"
+     "\r\n"},
+    {"INVITE (100)", 100,
+     "INVITE sip:bob@sip.example.org SIP/2.0\r\n"
+     "Via: SIP/2.0/TLS 10.0.0.2:5061;branch=z9hG4bK.kP4D2nBxq;rport\r\n"
+     "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Nvf3f7pVW;rport=43256;received=81.56.113.2\r\n"
+     "Record-Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+     "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+     "To: \"Bob\" <sip:bob@sip.example.org>\r\n"
+     "CSeq: 20 INVITE\r\n"
+     "Call-ID: wvp3y~3iBd\r\n"
+     "Max-Forwards: 69\r\n"
+     "Supported: replaces, outbound, gruu, path\r\n"
+     "Allow: INVITE, ACK, CANCEL, OPTIONS, BYE, REFER, NOTIFY, MESSAGE, SUBSCRIBE, INFO, PRACK, UPDATE\r\n"
+     "Content-Type: application/sdp\r\n"
+     "Contact: <sip:alice@sip.example.org;gr=urn:uuid:f71ad7c1-3e1b-4b36-9c1b-5c9b0e9f5e0e>\r\n"
+     "User-Agent: Linphone-Desktop/5.2.0 (belledonne) ubuntu/22.04 Qt/5.15.2 LinphoneSDK/5.3.0\r\n"
+     "Content-Length: 0\r\n"
+     "\r\n"},
+    {"INVITE (180)", 180,
+     "INVITE sip:bob@sip.example.org SIP/2.0\r\n"
+     "Via: SIP/2.0/TLS 10.0.0.2:5061;branch=z9hG4bK.kP4D2nBxq;rport\r\n"
+     "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.Nvf3f7pVW;rport=43256;received=81.56.113.2\r\n"
+     "Record-Route: <sip:proxy.example.org:5061;transport=tls;lr>\r\n"
+     "From: \"Alice\" <sip:alice@sip.example.org>;tag=kGn6rHTS9\r\n"
+     "To: \"Bob\" <sip:bob@sip.example.org>\r\n"
+     "CSeq: 20 INVITE\r\n"
+     "Call-ID: wvp3y~3iBd\r\n"
+     "Max-Forwards: 69\r\n"
+     "Supported: replaces, outbound, gruu, path\r\n"
+     "Allow: INVITE, ACK, CANCEL, OPTIONS, BYE, REFER, NOTIFY, MESSAGE, SUBSCRIBE, INFO, PRACK, UPDATE\r\n"
+     "Content-Type: application/sdp\r\n"
+     "Contact: <sip:alice@sip.example.org;gr=urn:uuid:f71ad7c1-3e1b-4b36-9c1b-5c9b0e9f5e0e>\r\n"
+     "User-Agent: Linphone-Desktop/5.2.0 (belledonne) ubuntu/22.04 Qt/5.15.2 LinphoneSDK/5.3.0\r\n"
+     "Content-Length: 0\r\n"
+     "\r\n"},
+    {"MESSAGE", 202,
+     "MESSAGE sip:bob@sip.example.org SIP/2.0\r\n"
+     "Via: SIP/2.0/TLS 192.168.1.8:43256;alias;branch=z9hG4bK.9kQ0bHfXt;rport\r\n"
+     "From: <sip:alice@sip.example.org>;tag=XvH6Wj5Ob\r\n"
+     "To: sip:bob@sip.example.org\r\n"
+     "CSeq: 20 MESSAGE\r\n"
+     "Call-ID: 3sP~xNqg7Q\r\n"
+     "Max-Forwards: 70\r\n"
+     "Supported: replaces, outbound, gruu, path\r\n"
+     "Date: Mon, 06 May 2024 09:41:12 GMT\r\n"
+     "Content-Type: message/cpim\r\n"
+     "Content-Length: 0\r\n"
+     "\r\n"},
+};
+
+static uint64_t get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* the headers read by the provider to match a message with its transaction and dialog */
+static int lookup_headers(belle_sip_message_t *msg) {
+	int found = 0;
+	if (belle_sip_message_get_header_by_type(msg, belle_sip_header_via_t)) found++;
+	if (belle_sip_message_get_header_by_type(msg, belle_sip_header_cseq_t)) found++;
+	if (belle_sip_message_get_header_by_type(msg, belle_sip_header_call_id_t)) found++;
+	if (belle_sip_message_get_header_by_type(msg, belle_sip_header_from_t)) found++;
+	if (belle_sip_message_get_header_by_type(msg, belle_sip_header_to_t)) found++;
+	if (belle_sip_message_get_header(msg, "Content-Length")) found++;
+	return found;
+}
+
+static void run_bench(const bench_request_t *r, int iterations) {
+	size_t length = strlen(r->raw);
+	size_t message_length;
+	belle_sip_message_t *req = belle_sip_message_parse_raw(r->raw, length, &message_length);
+	uint64_t response_us, lookup_us, start;
+	int found = 0;
+	int i;
+
+	if (!req) {
+		fprintf(stderr, "Could not parse message:\n%s\n", r->raw);
+		exit(-1);
+	}
+	belle_sip_object_ref(req);
+
+	start = get_time_us();
+	for (i = 0; i < iterations; i++) {
+		belle_sip_response_t *resp = belle_sip_response_create_from_request(BELLE_SIP_REQUEST(req), r->status_code);
+		belle_sip_object_unref(resp);
+	}
+	response_us = get_time_us() - start;
+
+	start = get_time_us();
+	for (i = 0; i < iterations; i++) {
+		found += lookup_headers(req);
+	}
+	lookup_us = get_time_us() - start;
+
+	printf("%-14s %14.3f %20.3f %10s\n", r->name, (double)response_us / iterations, (double)lookup_us / iterations,
+	       found == 6 * iterations ? "ok" : "MISMATCH");
+	belle_sip_object_unref(req);
+}
+
+int main(int argc, char *argv[]) {
+	int iterations = 100000;
+	size_t i;
+
+	if (argc > 1) iterations = atoi(argv[1]);
+	if (iterations <= 0) {
+		fprintf(stderr, "Usage:\n%s [iterations]\n", argv[0]);
+		return -1;
+	}
+	belle_sip_set_log_level(BELLE_SIP_LOG_ERROR);
+
+	printf("%-14s %14s %20s %10s\n", "request", "response (us)", "header lookups (us)", "result");
+	for (i = 0; i < sizeof(requests) / sizeof(requests[0]); i++) {
+		run_bench(&requests[i], iterations);
+	}
+	return 0;
+}
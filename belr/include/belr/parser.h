@@ -21,17 +21,14 @@
 #define _PARSER_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
-#define BELR_USE_ATOMIC 1
-
-#if BELR_USE_ATOMIC
-#include <atomic>
-#endif
-
 #include "bctoolbox/defs.h"
 
 #include "belr.h"
@@ -148,6 +145,9 @@ class HandlerContext;
 template <typename _parserElementT>
 class Parser;
 
+template <typename _parserElementT>
+class ParserContext;
+
 class HandlerContextBase;
 
 /*
@@ -164,26 +164,20 @@ public:
 	/* Invoke the creation of the object that will represent an element being parsed */
 	virtual _parserElementT invoke(const std::string &input, size_t begin, size_t count) = 0;
 
-	std::shared_ptr<HandlerContext<_parserElementT>> createContext();
 	inline const std::string &getRulename() const {
 		return mRulename;
 	}
 
 protected:
-	void releaseContext(const std::shared_ptr<HandlerContext<_parserElementT>> &ctx);
-	ParserHandlerBase(const Parser<_parserElementT> &parser, const std::string &name);
+	ParserHandlerBase(Parser<_parserElementT> &parser, const std::string &name);
 	/* Install a collector for sub-element */
 	void installCollector(const std::string &rulename, CollectorBase<_parserElementT> *collector);
 	CollectorBase<_parserElementT> *getCollector(unsigned int rule_id) const;
 
 private:
 	std::map<unsigned int, std::unique_ptr<CollectorBase<_parserElementT>>> mCollectors;
-	const Parser<_parserElementT> &mParser;
+	Parser<_parserElementT> &mParser;
 	std::string mRulename;
-	std::shared_ptr<HandlerContext<_parserElementT>> mCachedContext;
-#if BELR_USE_ATOMIC
-	std::atomic_flag mCacheLocked = ATOMIC_FLAG_INIT;
-#endif
 };
 
 /*
@@ -194,7 +188,7 @@ template <typename _createElementFn, typename _parserElementT>
 class ParserHandler : public ParserHandlerBase<_parserElementT> {
 public:
 	typedef typename _createElementFn::result_type _derivedParserElementT;
-	ParserHandler(const Parser<_parserElementT> &parser, const std::string &rulename, _createElementFn create)
+	ParserHandler(Parser<_parserElementT> &parser, const std::string &rulename, _createElementFn create)
 	    : ParserHandlerBase<_parserElementT>(parser, rulename), mHandlerCreateFunc(create) {
 	}
 	_parserElementT invoke(const std::string &input, size_t begin, size_t count) override;
@@ -231,22 +225,27 @@ private:
  */
 template <typename _parserElementT>
 class Assignment {
+	friend class ParserContext<_parserElementT>;
+
 public:
 	Assignment(CollectorBase<_parserElementT> *c,
+	           unsigned int rule_id,
 	           size_t begin,
 	           size_t count,
-	           const std::shared_ptr<HandlerContext<_parserElementT>> &child)
-	    : mCollector(c), mBegin(begin), mCount(count), mChild(child) {
+	           HandlerContext<_parserElementT> *child)
+	    : mCollector(c), mRuleId(rule_id), mBegin(begin), mCount(count), mChild(child) {
 	}
 
 	/* Invoke the assignment of a sub-lement to a parent object */
 	void invoke(_parserElementT parent, const std::string &input);
 
 private:
-	CollectorBase<_parserElementT> *mCollector; // not a shared_ptr for optimization, the collector cannot disapear
+	CollectorBase<_parserElementT> *mCollector; // not a shared_ptr for optimization, the collector cannot disapear.
+	                                            // May be null, see HandlerContext::setChild().
+	unsigned int mRuleId;
 	size_t mBegin;
 	size_t mCount;
-	std::shared_ptr<HandlerContext<_parserElementT>> mChild;
+	HandlerContext<_parserElementT> *mChild; // not a shared_ptr for optimization, it belongs to the ParserArena.
 };
 
 /*
@@ -254,7 +253,7 @@ private:
  * the action of creating an application-specified object (through the ParserHandler)
  * during the parsing process.
  */
-class HandlerContextBase : public std::enable_shared_from_this<HandlerContextBase> {
+class HandlerContextBase {
 public:
 	BELR_PUBLIC virtual ~HandlerContextBase() = default;
 };
@@ -264,40 +263,104 @@ class HandlerContext : public HandlerContextBase {
 public:
 	HandlerContext(ParserHandlerBase<_parserElementT> *handler);
 
-	/* Set a child to the element, by adding an Assignment. */
-	void setChild(unsigned int subrule_id, size_t begin, size_t count, const std::shared_ptr<HandlerContext> &child);
+	/* Set a child to the element, by adding an Assignment.
+	 * If the handler has no collector for the child, the Assignment is added only if keepUncollected is true: this is
+	 * used while recognizing a memoized rule, whose assignments may be replayed later in the context of another
+	 * handler. */
+	void setChild(unsigned int subrule_id,
+	              size_t begin,
+	              size_t count,
+	              HandlerContext *child,
+	              bool keepUncollected = false);
 	/* Create the object representing the element, and perform the assignments. */
 	_parserElementT realize(const std::string &input, size_t begin, size_t count);
-	/* Create a HandlerContext in order to try a new path of the automaton.
-	 * This HandlerContext may be kept if the parsing was succesfull, in which case merge() must be called.
-	 * If not succesfull, recyle() must be used.
-	 */
-	std::shared_ptr<HandlerContext<_parserElementT>> branch();
-	void merge(const std::shared_ptr<HandlerContext<_parserElementT>> &other);
+	/* Take the assignments of a branch that was succesfully parsed. */
+	void merge(const HandlerContext<_parserElementT> *other);
 	size_t getLastIterator() const;
 	void undoAssignments(size_t pos);
-	void recycle();
+	/* Prepare the HandlerContext to be used (again) for an element of the given handler. */
+	void reset(ParserHandlerBase<_parserElementT> *handler);
+	ParserHandlerBase<_parserElementT> *getHandler() const {
+		return mHandler;
+	}
+	const std::vector<Assignment<_parserElementT>> &getAssignments() const {
+		return mAssignments;
+	}
 
 private:
-	ParserHandlerBase<_parserElementT> &mHandler;
+	ParserHandlerBase<_parserElementT> *mHandler;
 	std::vector<Assignment<_parserElementT>> mAssignments;
 };
 
+/*
+ * The ParserArena holds the memory used by a parsing: the HandlerContexts, the stack of HandlerContexts and the
+ * memoized results of the recognizers. Nothing is freed at the end of the parsing: the arena is reset and given back
+ * to the Parser, that will use it again for a next parsing. This way, once the arena has grown to the size required
+ * by the inputs, parsing no longer allocates memory for its HandlerContexts.
+ */
+template <typename _parserElementT>
+class ParserArena {
+public:
+	struct MemoEntry {
+		size_t mCount;
+		size_t mFirstAssignment;
+		size_t mLastAssignment;
+	};
+
+	/* Get a HandlerContext, either a new one or one that is no longer in use. */
+	HandlerContext<_parserElementT> *createContext(ParserHandlerBase<_parserElementT> *handler);
+	/* Give back a HandlerContext that is no longer referenced, so that it can be reused within the same parsing. */
+	void releaseContext(HandlerContext<_parserElementT> *ctx);
+	std::vector<HandlerContext<_parserElementT> *> &getHandlerStack() {
+		return mHandlerStack;
+	}
+
+	/* Prepare the tables of memoized results, for a number of memoized rules and the length of the input. */
+	void prepareMemo(int slotCount, size_t inputLength);
+	const MemoEntry *findMemo(int slot, size_t pos) const;
+	/* Memoize the result of a recognition at the given position, that is the count of characters matched and the
+	 * assignments made to the parent context from the given assignment position. */
+	void storeMemo(int slot,
+	               size_t pos,
+	               size_t count,
+	               const HandlerContext<_parserElementT> &parent,
+	               size_t assignmentPos);
+	const Assignment<_parserElementT> &getMemoAssignment(size_t index) const {
+		return mMemoAssignments[index];
+	}
+
+	void reset();
+	/* Whether the arena has grown so much that it isn't worth keeping it for a next parsing. */
+	bool isOversized() const;
+
+private:
+	std::deque<HandlerContext<_parserElementT>> mContexts; // a deque so that the HandlerContexts never move.
+	size_t mUsedContexts = 0;
+	std::vector<HandlerContext<_parserElementT> *> mFreeContexts;
+	std::vector<HandlerContext<_parserElementT> *> mHandlerStack;
+	size_t mInputLength = 0;
+	std::vector<uint32_t> mMemoIndex; // index + 1 of the MemoEntry for a slot and a position, 0 if none.
+	std::vector<MemoEntry> mMemoEntries;
+	std::vector<Assignment<_parserElementT>> mMemoAssignments;
+};
+
 /*
  * The ParserLocalContext is instanciated in Recognizers in order to hold
  * the current HandlerContext (representing a rule and an object to create), and the recognizer
  * that recognizes the rule.
  */
 struct ParserLocalContext {
-	void set(const std::shared_ptr<HandlerContextBase> &hc, const std::shared_ptr<Recognizer> &rec, size_t pos) {
+	void set(HandlerContextBase *hc, Recognizer *rec, size_t pos) {
 		mHandlerContext = hc;
-		mRecognizer = rec.get();
+		mRecognizer = rec;
 		mAssignmentPos = pos;
 	}
-	std::shared_ptr<HandlerContextBase> mHandlerContext;
+	HandlerContextBase *mHandlerContext = nullptr; // not a shared ptr to optimize, it belongs to the ParserArena.
 	Recognizer *mRecognizer =
 	    nullptr; // not a shared ptr to optimize, the object can't disapear in the context of use of ParserLocalContext.
 	size_t mAssignmentPos = 0;
+	int mMemoSlot = -1; // set when the result of the recognition is to be memoized.
+	size_t mMemoAssignmentPos = 0;
 };
 
 /*
@@ -308,17 +371,19 @@ class ParserContextBase {
 public:
 	virtual ~ParserContextBase() = default;
 
-	/* Called when a Recognizer is about to process an input. */
-	virtual void beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec) = 0;
+	/* Called when a Recognizer is about to process an input at a given position.
+	 * Returns true if the result of the recognition is already known (memoized), in which case it is set in 'match'
+	 * and the Recognizer must not process the input. */
+	virtual bool beginParse(ParserLocalContext &ctx, Recognizer *rec, size_t pos, size_t &match) = 0;
 	/* Called when the Recognizer has finished to process an input, and notifies the position and number of characters
 	 * parsed. */
 	virtual void endParse(const ParserLocalContext &ctx, const std::string &input, size_t begin, size_t count) = 0;
 	/* Called when creating a branch, in order to explore a branch of the automaton tree. */
-	virtual std::shared_ptr<HandlerContextBase> branch() = 0;
+	virtual HandlerContextBase *branch() = 0;
 	/* If the branch succesfully parsed characters, it is merged.*/
-	virtual void merge(const std::shared_ptr<HandlerContextBase> &other) = 0;
+	virtual void merge(HandlerContextBase *other) = 0;
 	/* Otherwise, it is removed. */
-	virtual void removeBranch(const std::shared_ptr<HandlerContextBase> &other) = 0;
+	virtual void removeBranch(HandlerContextBase *other) = 0;
 };
 
 /*
@@ -328,26 +393,31 @@ public:
 template <typename _parserElementT>
 class ParserContext : public ParserContextBase {
 public:
-	ParserContext(Parser<_parserElementT> &parser);
+	ParserContext(Parser<_parserElementT> &parser, ParserArena<_parserElementT> &arena);
 	_parserElementT createRootObject(const std::string &input, size_t count);
 
 protected:
-	void beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec) override;
+	bool beginParse(ParserLocalContext &ctx, Recognizer *rec, size_t pos, size_t &match) override;
 	void endParse(const ParserLocalContext &ctx, const std::string &input, size_t begin, size_t count) override;
-	std::shared_ptr<HandlerContextBase> branch() override;
-	void merge(const std::shared_ptr<HandlerContextBase> &other) override;
-	void removeBranch(const std::shared_ptr<HandlerContextBase> &other) override;
+	HandlerContextBase *branch() override;
+	void merge(HandlerContextBase *other) override;
+	void removeBranch(HandlerContextBase *other) override;
 
-	void _beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec);
+	bool _beginParse(ParserLocalContext &ctx, Recognizer *rec, size_t pos, size_t &match);
 	void _endParse(const ParserLocalContext &ctx, const std::string &input, size_t begin, size_t count);
-	std::shared_ptr<HandlerContext<_parserElementT>> _branch();
-	void _merge(const std::shared_ptr<HandlerContext<_parserElementT>> &other);
-	void _removeBranch(const std::shared_ptr<HandlerContext<_parserElementT>> &other);
+	HandlerContext<_parserElementT> *_branch();
+	void _merge(HandlerContext<_parserElementT> *other);
+	void _removeBranch(HandlerContext<_parserElementT> *other);
 
 private:
+	/* Redo the assignments of a memoized recognition. Returns false if there is no memoized result. */
+	bool replayMemo(int slot, size_t pos, size_t &match);
+
 	Parser<_parserElementT> &mParser;
-	std::list<std::shared_ptr<HandlerContext<_parserElementT>>> mHandlerStack;
-	std::shared_ptr<HandlerContext<_parserElementT>> mRoot;
+	ParserArena<_parserElementT> &mArena;
+	std::vector<HandlerContext<_parserElementT> *> &mHandlerStack;
+	HandlerContext<_parserElementT> *mRoot = nullptr;
+	int mMemoizing = 0; // number of memoized rules being recognized.
 };
 
 /**
@@ -372,16 +442,31 @@ public:
 		installHandler(ret);
 		return ret;
 	}
+	/* Enable the memoization of a rule (packrat parsing): the result of its recognition at a given position of the
+	 * input is kept during the parsing, so that it is not recognized again when the parser backtracks and tries
+	 * another path that starts with the same rule. This is worth for rules that are frequently backtracked, typically
+	 * when they begin several of the choices of a selector. */
+	void memoizeRule(const std::string &rulename);
 	_parserElementT
 	parseInput(const std::string &rulename, const std::string &input, size_t *parsed_size, bool full_match = false);
 
 private:
 	ParserHandlerBase<_parserElementT> *getHandler(unsigned int);
 	void installHandler(ParserHandlerBase<_parserElementT> *handler);
+	int getMemoSlot(unsigned int rule_id) const;
+	void setCollected(unsigned int rule_id);
+	bool isCollected(unsigned int rule_id) const;
+	std::unique_ptr<ParserArena<_parserElementT>> acquireArena();
+	void releaseArena(std::unique_ptr<ParserArena<_parserElementT>> arena);
 	std::shared_ptr<Grammar> mGrammar;
 	std::map<unsigned int, std::unique_ptr<ParserHandlerBase<_parserElementT>>> mHandlers;
 	std::unique_ptr<ParserHandlerBase<_parserElementT>> mNullHandler;
 	std::unique_ptr<CollectorBase<_parserElementT>> mNullCollector;
+	std::vector<int> mMemoSlots;       // memoization slot for each rule id, -1 if not memoized.
+	int mMemoSlotCount = 0;
+	std::vector<bool> mCollectedRules; // whether a rule id is collected by any handler.
+	std::mutex mArenasMutex;
+	std::vector<std::unique_ptr<ParserArena<_parserElementT>>> mArenas;
 };
 
 class DebugElement {
@@ -403,6 +488,7 @@ class DebugParser : protected Parser<std::shared_ptr<DebugElement>> {
 public:
 	BELR_PUBLIC DebugParser(const std::shared_ptr<Grammar> &grammar);
 	BELR_PUBLIC void setObservedRules(const std::list<std::string> &rules);
+	BELR_PUBLIC void setMemoizedRules(const std::list<std::string> &rules);
 	BELR_PUBLIC std::shared_ptr<DebugElement>
 	parseInput(const std::string &rulename, const std::string &input, size_t *parsed_size);
 };
@@ -473,6 +559,7 @@ void ParserCollector<_functorT, _parserElementT>::invokeWithValue(_parserElement
 
 template <typename _parserElementT>
 void Assignment<_parserElementT>::invoke(_parserElementT parent, const std::string &input) {
+	if (!mCollector) return;
 	if (mChild) {
 		mCollector->invokeWithChild(parent, mChild->realize(input, mBegin, mCount));
 	} else {
@@ -485,23 +572,24 @@ void Assignment<_parserElementT>::invoke(_parserElementT parent, const std::stri
 //
 
 template <typename _parserElementT>
-HandlerContext<_parserElementT>::HandlerContext(ParserHandlerBase<_parserElementT> *handler) : mHandler(*handler) {
+HandlerContext<_parserElementT>::HandlerContext(ParserHandlerBase<_parserElementT> *handler) : mHandler(handler) {
 }
 
 template <typename _parserElementT>
 void HandlerContext<_parserElementT>::setChild(unsigned int subrule_id,
                                                size_t begin,
                                                size_t count,
-                                               const std::shared_ptr<HandlerContext<_parserElementT>> &child) {
-	auto collector = mHandler.getCollector(subrule_id);
-	if (collector) {
-		mAssignments.push_back(Assignment<_parserElementT>(collector, begin, count, child));
+                                               HandlerContext<_parserElementT> *child,
+                                               bool keepUncollected) {
+	auto collector = mHandler->getCollector(subrule_id);
+	if (collector || keepUncollected) {
+		mAssignments.emplace_back(collector, subrule_id, begin, count, child);
 	}
 }
 
 template <typename _parserElementT>
 _parserElementT HandlerContext<_parserElementT>::realize(const std::string &input, size_t begin, size_t count) {
-	_parserElementT ret = mHandler.invoke(input, begin, count);
+	_parserElementT ret = mHandler->invoke(input, begin, count);
 	for (auto it = mAssignments.begin(); it != mAssignments.end(); ++it) {
 		(*it).invoke(ret, input);
 	}
@@ -509,15 +597,8 @@ _parserElementT HandlerContext<_parserElementT>::realize(const std::string &inpu
 }
 
 template <typename _parserElementT>
-std::shared_ptr<HandlerContext<_parserElementT>> HandlerContext<_parserElementT>::branch() {
-	return mHandler.createContext();
-}
-
-template <typename _parserElementT>
-void HandlerContext<_parserElementT>::merge(const std::shared_ptr<HandlerContext<_parserElementT>> &other) {
-	for (auto it = other->mAssignments.begin(); it != other->mAssignments.end(); ++it) {
-		mAssignments.emplace_back(*it);
-	}
+void HandlerContext<_parserElementT>::merge(const HandlerContext<_parserElementT> *other) {
+	mAssignments.insert(mAssignments.end(), other->mAssignments.begin(), other->mAssignments.end());
 }
 
 template <typename _parserElementT>
@@ -531,9 +612,78 @@ void HandlerContext<_parserElementT>::undoAssignments(size_t pos) {
 }
 
 template <typename _parserElementT>
-void HandlerContext<_parserElementT>::recycle() {
+void HandlerContext<_parserElementT>::reset(ParserHandlerBase<_parserElementT> *handler) {
+	mHandler = handler;
 	mAssignments.clear();
-	mHandler.releaseContext(std::static_pointer_cast<HandlerContext<_parserElementT>>(shared_from_this()));
+}
+
+//
+// ParserArena template class implementation
+//
+
+template <typename _parserElementT>
+HandlerContext<_parserElementT> *
+ParserArena<_parserElementT>::createContext(ParserHandlerBase<_parserElementT> *handler) {
+	HandlerContext<_parserElementT> *ctx;
+	if (!mFreeContexts.empty()) {
+		ctx = mFreeContexts.back();
+		mFreeContexts.pop_back();
+		ctx->reset(handler);
+	} else if (mUsedContexts < mContexts.size()) {
+		ctx = &mContexts[mUsedContexts++];
+		ctx->reset(handler);
+	} else {
+		mContexts.emplace_back(handler);
+		ctx = &mContexts.back();
+		mUsedContexts++;
+	}
+	return ctx;
+}
+
+template <typename _parserElementT>
+void ParserArena<_parserElementT>::releaseContext(HandlerContext<_parserElementT> *ctx) {
+	mFreeContexts.push_back(ctx);
+}
+
+template <typename _parserElementT>
+void ParserArena<_parserElementT>::prepareMemo(int slotCount, size_t inputLength) {
+	mInputLength = inputLength;
+	/* a recognizer may be fed with the position right after the last character of the input. */
+	mMemoIndex.assign(slotCount * (inputLength + 1), 0);
+}
+
+template <typename _parserElementT>
+const typename ParserArena<_parserElementT>::MemoEntry *ParserArena<_parserElementT>::findMemo(int slot,
+                                                                                               size_t pos) const {
+	uint32_t index = mMemoIndex[slot * (mInputLength + 1) + pos];
+	return index != 0 ? &mMemoEntries[index - 1] : nullptr;
+}
+
+template <typename _parserElementT>
+void ParserArena<_parserElementT>::storeMemo(
+    int slot, size_t pos, size_t count, const HandlerContext<_parserElementT> &parent, size_t assignmentPos) {
+	const auto &assignments = parent.getAssignments();
+	MemoEntry entry;
+	entry.mCount = count;
+	entry.mFirstAssignment = mMemoAssignments.size();
+	mMemoAssignments.insert(mMemoAssignments.end(), assignments.begin() + (long)assignmentPos, assignments.end());
+	entry.mLastAssignment = mMemoAssignments.size();
+	mMemoEntries.push_back(entry);
+	mMemoIndex[slot * (mInputLength + 1) + pos] = (uint32_t)mMemoEntries.size();
+}
+
+template <typename _parserElementT>
+void ParserArena<_parserElementT>::reset() {
+	mUsedContexts = 0;
+	mFreeContexts.clear();
+	mHandlerStack.clear();
+	mMemoEntries.clear();
+	mMemoAssignments.clear();
+}
+
+template <typename _parserElementT>
+bool ParserArena<_parserElementT>::isOversized() const {
+	return mContexts.size() > 4096 || mMemoIndex.capacity() > 65536;
 }
 
 //
@@ -541,8 +691,8 @@ void HandlerContext<_parserElementT>::recycle() {
 //
 
 template <typename _parserElementT>
-ParserHandlerBase<_parserElementT>::ParserHandlerBase(const Parser<_parserElementT> &parser, const std::string &name)
-    : mParser(parser), mRulename(tolower(name)), mCachedContext(nullptr) {
+ParserHandlerBase<_parserElementT>::ParserHandlerBase(Parser<_parserElementT> &parser, const std::string &name)
+    : mParser(parser), mRulename(tolower(name)) {
 }
 
 template <typename _parserElementT>
@@ -556,6 +706,7 @@ void ParserHandlerBase<_parserElementT>::installCollector(const std::string &rul
 		return;
 	}
 	mCollectors[rec->getId()].reset(collector);
+	mParser.setCollected(rec->getId());
 }
 
 template <typename _parserElementT>
@@ -565,41 +716,6 @@ CollectorBase<_parserElementT> *ParserHandlerBase<_parserElementT>::getCollector
 	return mParser.mNullCollector.get();
 }
 
-template <typename _parserElementT>
-void ParserHandlerBase<_parserElementT>::releaseContext(const std::shared_ptr<HandlerContext<_parserElementT>> &ctx) {
-#if BELR_USE_ATOMIC
-	if (mCacheLocked.test_and_set(std::memory_order_relaxed) == false) {
-		mCachedContext = ctx;
-		mCacheLocked.clear(std::memory_order_relaxed);
-	}
-#else
-	mCachedContext = ctx;
-#endif
-}
-
-template <typename _parserElementT>
-std::shared_ptr<HandlerContext<_parserElementT>> ParserHandlerBase<_parserElementT>::createContext() {
-#if BELR_USE_ATOMIC
-	std::shared_ptr<HandlerContext<_parserElementT>> ret;
-	if (mCacheLocked.test_and_set(std::memory_order_relaxed) == false) {
-		if (mCachedContext) {
-			ret = mCachedContext;
-			mCachedContext.reset();
-		}
-		mCacheLocked.clear(std::memory_order_relaxed);
-	}
-	if (!ret) ret = std::make_shared<HandlerContext<_parserElementT>>(this);
-	return ret;
-#else
-	if (mCachedContext) {
-		std::shared_ptr<HandlerContext<_parserElementT>> ret = mCachedContext;
-		mCachedContext.reset();
-		return ret;
-	}
-	return std::make_shared<HandlerContext<_parserElementT>>(this);
-#endif
-}
-
 //
 // ParserHandler template implementation
 //
@@ -615,23 +731,50 @@ ParserHandler<_createElementFn, _parserElementT>::invoke(const std::string &inpu
 //
 
 template <typename _parserElementT>
-ParserContext<_parserElementT>::ParserContext(Parser<_parserElementT> &parser) : mParser(parser) {
+ParserContext<_parserElementT>::ParserContext(Parser<_parserElementT> &parser, ParserArena<_parserElementT> &arena)
+    : mParser(parser), mArena(arena), mHandlerStack(arena.getHandlerStack()) {
 }
 
 template <typename _parserElementT>
-inline void ParserContext<_parserElementT>::_beginParse(ParserLocalContext &lctx,
-                                                        const std::shared_ptr<Recognizer> &rec) {
-	std::shared_ptr<HandlerContextBase> ctx;
+bool ParserContext<_parserElementT>::replayMemo(int slot, size_t pos, size_t &match) {
+	auto entry = mArena.findMemo(slot, pos);
+	if (!entry) return false;
+
+	/* the assignments are done again, so that the collectors of the current handler are used. */
+	HandlerContext<_parserElementT> *parent = mHandlerStack.back();
+	for (size_t i = entry->mFirstAssignment; i < entry->mLastAssignment; ++i) {
+		const Assignment<_parserElementT> &assignment = mArena.getMemoAssignment(i);
+		parent->setChild(assignment.mRuleId, assignment.mBegin, assignment.mCount, assignment.mChild, mMemoizing > 0);
+	}
+	match = entry->mCount;
+	return true;
+}
+
+template <typename _parserElementT>
+inline bool
+ParserContext<_parserElementT>::_beginParse(ParserLocalContext &lctx, Recognizer *rec, size_t pos, size_t &match) {
+	HandlerContext<_parserElementT> *ctx = nullptr;
+
+	if (rec->getId() != 0 && !mHandlerStack.empty()) {
+		int slot = mParser.getMemoSlot(rec->getId());
+		if (slot >= 0) {
+			if (replayMemo(slot, pos, match)) return true;
+			lctx.mMemoSlot = slot;
+			lctx.mMemoAssignmentPos = mHandlerStack.back()->getLastIterator();
+			mMemoizing++;
+		}
+	}
 
 	auto h = mParser.getHandler(rec->getId());
 	if (h) {
-		ctx = h->createContext();
-		mHandlerStack.push_back(std::static_pointer_cast<HandlerContext<_parserElementT>>(ctx));
+		ctx = mArena.createContext(h);
+		mHandlerStack.push_back(ctx);
 	}
 	if (mHandlerStack.empty()) {
 		fatal("Cannot parse when mHandlerStack is empty. You must define a top-level rule handler.");
 	}
 	lctx.set(ctx, rec, mHandlerStack.back()->getLastIterator());
+	return false;
 }
 
 template <typename _parserElementT>
@@ -639,32 +782,38 @@ inline void ParserContext<_parserElementT>::_endParse(const ParserLocalContext &
                                                       const std::string &,
                                                       size_t begin,
                                                       size_t count) {
+	unsigned int id = localctx.mRecognizer->getId();
+	bool keepUncollected = mMemoizing > 0 && mParser.isCollected(id);
+
 	if (localctx.mHandlerContext) {
+		auto ctx = static_cast<HandlerContext<_parserElementT> *>(localctx.mHandlerContext);
 		mHandlerStack.pop_back();
 		if (count != std::string::npos && count > 0) {
 			if (!mHandlerStack.empty()) {
 				/*assign object to parent */
-				mHandlerStack.back()->setChild(
-				    localctx.mRecognizer->getId(), begin, count,
-				    std::static_pointer_cast<HandlerContext<_parserElementT>>(localctx.mHandlerContext));
+				mHandlerStack.back()->setChild(id, begin, count, ctx, keepUncollected);
 
 			} else {
 				/*no parent, this is our root object*/
-				mRoot = std::static_pointer_cast<HandlerContext<_parserElementT>>(localctx.mHandlerContext);
+				mRoot = ctx;
 			}
 		} else {
 			// no match
-			std::static_pointer_cast<HandlerContext<_parserElementT>>(localctx.mHandlerContext)->recycle();
+			mArena.releaseContext(ctx);
 		}
 	} else {
 		if (count != std::string::npos && count > 0) {
 			/*assign std::string to parent */
-			if (localctx.mRecognizer->getId() != 0)
-				mHandlerStack.back()->setChild(localctx.mRecognizer->getId(), begin, count, nullptr);
+			if (id != 0) mHandlerStack.back()->setChild(id, begin, count, nullptr, keepUncollected);
 		} else {
 			mHandlerStack.back()->undoAssignments(localctx.mAssignmentPos);
 		}
 	}
+
+	if (localctx.mMemoSlot >= 0) {
+		mMemoizing--;
+		mArena.storeMemo(localctx.mMemoSlot, begin, count, *mHandlerStack.back(), localctx.mMemoAssignmentPos);
+	}
 }
 
 template <typename _parserElementT>
@@ -673,28 +822,27 @@ _parserElementT ParserContext<_parserElementT>::createRootObject(const std::stri
 }
 
 template <typename _parserElementT>
-inline std::shared_ptr<HandlerContext<_parserElementT>> ParserContext<_parserElementT>::_branch() {
+inline HandlerContext<_parserElementT> *ParserContext<_parserElementT>::_branch() {
 	if (mHandlerStack.empty()) {
 		fatal("Cannot branch while stack is empty");
 	}
-	std::shared_ptr<HandlerContext<_parserElementT>> ret = mHandlerStack.back()->branch();
+	HandlerContext<_parserElementT> *ret = mArena.createContext(mHandlerStack.back()->getHandler());
 	mHandlerStack.push_back(ret);
 	return ret;
 }
 
 template <typename _parserElementT>
-inline void ParserContext<_parserElementT>::_merge(const std::shared_ptr<HandlerContext<_parserElementT>> &other) {
+inline void ParserContext<_parserElementT>::_merge(HandlerContext<_parserElementT> *other) {
 	if (mHandlerStack.back() != other) {
 		fatal("The branch being merged is not the last one of the stack !");
 	}
 	mHandlerStack.pop_back();
 	mHandlerStack.back()->merge(other);
-	other->recycle();
+	mArena.releaseContext(other);
 }
 
 template <typename _parserElementT>
-inline void
-ParserContext<_parserElementT>::_removeBranch(const std::shared_ptr<HandlerContext<_parserElementT>> &other) {
+inline void ParserContext<_parserElementT>::_removeBranch(HandlerContext<_parserElementT> *other) {
 	auto it = find(mHandlerStack.rbegin(), mHandlerStack.rend(), other);
 	if (it == mHandlerStack.rend()) {
 		fatal("A branch could not be found in the stack while removing it !");
@@ -702,12 +850,12 @@ ParserContext<_parserElementT>::_removeBranch(const std::shared_ptr<HandlerConte
 		advance(it, 1);
 		mHandlerStack.erase(it.base());
 	}
-	other->recycle();
+	mArena.releaseContext(other);
 }
 
 template <typename _parserElementT>
-void ParserContext<_parserElementT>::beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec) {
-	_beginParse(ctx, rec);
+bool ParserContext<_parserElementT>::beginParse(ParserLocalContext &ctx, Recognizer *rec, size_t pos, size_t &match) {
+	return _beginParse(ctx, rec, pos, match);
 }
 
 template <typename _parserElementT>
@@ -719,18 +867,18 @@ void ParserContext<_parserElementT>::endParse(const ParserLocalContext &localctx
 }
 
 template <typename _parserElementT>
-std::shared_ptr<HandlerContextBase> ParserContext<_parserElementT>::branch() {
+HandlerContextBase *ParserContext<_parserElementT>::branch() {
 	return _branch();
 }
 
 template <typename _parserElementT>
-void ParserContext<_parserElementT>::merge(const std::shared_ptr<HandlerContextBase> &other) {
-	_merge(std::static_pointer_cast<HandlerContext<_parserElementT>>(other));
+void ParserContext<_parserElementT>::merge(HandlerContextBase *other) {
+	_merge(static_cast<HandlerContext<_parserElementT> *>(other));
 }
 
 template <typename _parserElementT>
-void ParserContext<_parserElementT>::removeBranch(const std::shared_ptr<HandlerContextBase> &other) {
-	_removeBranch(std::static_pointer_cast<HandlerContext<_parserElementT>>(other));
+void ParserContext<_parserElementT>::removeBranch(HandlerContextBase *other) {
+	_removeBranch(static_cast<HandlerContext<_parserElementT> *>(other));
 }
 
 //
@@ -763,6 +911,57 @@ void Parser<_parserElementT>::installHandler(ParserHandlerBase<_parserElementT>
 	mHandlers[rec->getId()].reset(handler);
 }
 
+template <typename _parserElementT>
+void Parser<_parserElementT>::memoizeRule(const std::string &rulename) {
+	std::shared_ptr<Recognizer> rec = mGrammar->findRule(rulename);
+	if (!rec) {
+		std::ostringstream str;
+		str << "There is no rule '" << rulename << "' in the grammar.";
+		fatal(str.str().c_str());
+		return;
+	}
+	if (rec->getId() >= mMemoSlots.size()) mMemoSlots.resize(rec->getId() + 1, -1);
+	if (mMemoSlots[rec->getId()] == -1) mMemoSlots[rec->getId()] = mMemoSlotCount++;
+}
+
+template <typename _parserElementT>
+int Parser<_parserElementT>::getMemoSlot(unsigned int rule_id) const {
+	return rule_id < mMemoSlots.size() ? mMemoSlots[rule_id] : -1;
+}
+
+template <typename _parserElementT>
+void Parser<_parserElementT>::setCollected(unsigned int rule_id) {
+	if (rule_id >= mCollectedRules.size()) mCollectedRules.resize(rule_id + 1, false);
+	mCollectedRules[rule_id] = true;
+}
+
+template <typename _parserElementT>
+bool Parser<_parserElementT>::isCollected(unsigned int rule_id) const {
+	return rule_id < mCollectedRules.size() && mCollectedRules[rule_id];
+}
+
+template <typename _parserElementT>
+std::unique_ptr<ParserArena<_parserElementT>> Parser<_parserElementT>::acquireArena() {
+	std::unique_ptr<ParserArena<_parserElementT>> arena;
+	{
+		std::lock_guard<std::mutex> lock(mArenasMutex);
+		if (!mArenas.empty()) {
+			arena = std::move(mArenas.back());
+			mArenas.pop_back();
+		}
+	}
+	if (!arena) arena.reset(new ParserArena<_parserElementT>());
+	return arena;
+}
+
+template <typename _parserElementT>
+void Parser<_parserElementT>::releaseArena(std::unique_ptr<ParserArena<_parserElementT>> arena) {
+	if (arena->isOversized()) return;
+	arena->reset();
+	std::lock_guard<std::mutex> lock(mArenasMutex);
+	mArenas.push_back(std::move(arena));
+}
+
 template <typename _parserElementT>
 _parserElementT Parser<_parserElementT>::parseInput(const std::string &rulename,
                                                     const std::string &input,
@@ -770,7 +969,7 @@ _parserElementT Parser<_parserElementT>::parseInput(const std::string &rulename,
                                                     bool full_match) {
 	size_t parsed;
 	std::shared_ptr<Recognizer> rec = mGrammar->getRule(rulename);
-	ParserContext<_parserElementT> pctx(*this);
+	_parserElementT ret = nullptr;
 
 	auto h = getHandler(rec->getId());
 	if (!h) {
@@ -779,17 +978,21 @@ _parserElementT Parser<_parserElementT>::parseInput(const std::string &rulename,
 		fatal(str.str().c_str());
 	}
 
-	// auto t_start = std::chrono::high_resolution_clock::now();
-	parsed = rec->feed(pctx, input, 0);
-	// auto t_end = std::chrono::high_resolution_clock::now();
-	// cout<<"Recognition done in "<<std::chrono::duration<double, std::milli>(t_end-t_start).count()<<"
-	// milliseconds"<<std::endl;
-	if (parsed_size) *parsed_size = parsed;
-
-	// If a full match has been asked and all the input has not been consumed, this is an error.
-	if (full_match && (parsed != input.length())) return nullptr;
+	std::unique_ptr<ParserArena<_parserElementT>> arena = acquireArena();
+	arena->prepareMemo(mMemoSlotCount, input.size());
+	{
+		ParserContext<_parserElementT> pctx(*this, *arena);
+		// auto t_start = std::chrono::high_resolution_clock::now();
+		parsed = rec->feed(pctx, input, 0);
+		// auto t_end = std::chrono::high_resolution_clock::now();
+		// cout<<"Recognition done in "<<std::chrono::duration<double, std::milli>(t_end-t_start).count()<<"
+		// milliseconds"<<std::endl;
+		if (parsed_size) *parsed_size = parsed;
 
-	auto ret = pctx.createRootObject(input, parsed);
+		// If a full match has been asked and all the input has not been consumed, this is an error.
+		if (!full_match || parsed == input.length()) ret = pctx.createRootObject(input, parsed);
+	}
+	releaseArena(std::move(arena));
 	return ret;
 }
 } // namespace belr
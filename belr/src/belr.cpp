@@ -43,20 +43,23 @@ void fatal(const char *message) {
  * instanciating anything.*/
 class DummyParserContext : public ParserContextBase {
 public:
-	virtual void beginParse(BCTBX_UNUSED(ParserLocalContext &ctx),
-	                        BCTBX_UNUSED(const std::shared_ptr<Recognizer> &rec)) override {
+	virtual bool beginParse(BCTBX_UNUSED(ParserLocalContext &ctx),
+	                        BCTBX_UNUSED(Recognizer *rec),
+	                        BCTBX_UNUSED(size_t pos),
+	                        BCTBX_UNUSED(size_t &match)) override {
+		return false;
 	}
 	virtual void endParse(BCTBX_UNUSED(const ParserLocalContext &ctx),
 	                      BCTBX_UNUSED(const std::string &input),
 	                      BCTBX_UNUSED(size_t begin),
 	                      BCTBX_UNUSED(size_t count)) override {
 	}
-	virtual std::shared_ptr<HandlerContextBase> branch() override {
+	virtual HandlerContextBase *branch() override {
 		return nullptr;
 	}
-	virtual void merge(BCTBX_UNUSED(const std::shared_ptr<HandlerContextBase> &other)) override {
+	virtual void merge(BCTBX_UNUSED(HandlerContextBase *other)) override {
 	}
-	virtual void removeBranch(BCTBX_UNUSED(const std::shared_ptr<HandlerContextBase> &other)) override {
+	virtual void removeBranch(BCTBX_UNUSED(HandlerContextBase *other)) override {
 	}
 };
 
@@ -205,7 +208,7 @@ size_t Recognizer::feed(ParserContextBase &ctx, const string &input, size_t pos)
 #endif
 
 	ParserLocalContext hctx;
-	ctx.beginParse(hctx, shared_from_this());
+	if (ctx.beginParse(hctx, this, pos, match)) return match;
 	match = _feed(ctx, input, pos);
 	if (match != string::npos && match > 0) {
 #ifdef BELR_DEBUG
@@ -319,11 +322,10 @@ size_t Selector::_feed(ParserContextBase &ctx, const string &input, size_t pos)
 
 	size_t matched = 0;
 	size_t bestmatch = string::npos;
-	shared_ptr<HandlerContextBase> bestBranch;
+	HandlerContextBase *bestBranch = nullptr;
 
 	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
-		shared_ptr<HandlerContextBase> br;
-		br = ctx.branch();
+		HandlerContextBase *br = ctx.branch();
 		matched = (*it)->feed(ctx, input, pos);
 		/* Matching 0 characters is considered as a valid match (string::npos is returned in case of no match) */
 		if (matched != string::npos && (matched > bestmatch || bestmatch == string::npos)) {
@@ -92,4 +92,10 @@ void DebugParser::setObservedRules(const list<string> &rules) {
 	}
 }
 
+void DebugParser::setMemoizedRules(const list<string> &rules) {
+	for (auto it = rules.begin(); it != rules.end(); ++it) {
+		memoizeRule(*it);
+	}
+}
+
 } // namespace belr
@@ -286,7 +286,88 @@ static void parser_with_inheritance(void) {
 	BC_ASSERT_TRUE(dynamic_pointer_cast<SipFrom>(holder->getHeader()) != nullptr);
 }
 
+//
+// Parser with memoized rules.
+//
+
+class Entity : public Object {
+public:
+	void setName(const string &name) {
+		mName = name;
+	}
+	const string &getName() const {
+		return mName;
+	}
+
+private:
+	string mName;
+};
+
+class Person : public Entity {};
+
+class Company : public Entity {};
+
+class Sentence : public Object {
+public:
+	void setEntity(const shared_ptr<Entity> &entity) {
+		mEntity = entity;
+	}
+	shared_ptr<Entity> getEntity() const {
+		return mEntity;
+	}
+
+private:
+	shared_ptr<Entity> mEntity;
+};
+
+static void parser_with_memoized_rules(void) {
+	/* "person" and "company" both begin with "name", that is recognized twice at the same position when the
+	 * sentence is about a company: the second time, its memoized result is used, but for another handler. */
+	string abnf = "sentence = person / company\r\n"
+	              "person = name \" is a person\"\r\n"
+	              "company = name \" is a company\"\r\n"
+	              "name = 1*ALPHA\r\n";
+
+	ABNFGrammarBuilder builder;
+	shared_ptr<Grammar> grammar = builder.createFromAbnf(abnf, make_shared<CoreRules>());
+	BC_ASSERT_FALSE(!grammar);
+	if (!grammar) return;
+
+	shared_ptr<Parser<shared_ptr<Object>>> parser = make_shared<Parser<shared_ptr<Object>>>(grammar);
+	parser->setHandler("sentence", make_fn<Sentence>())
+	    ->setCollector("person", make_sfn(&Sentence::setEntity))
+	    ->setCollector("company", make_sfn(&Sentence::setEntity));
+	parser->setHandler("person", make_fn<Person>())->setCollector("name", make_sfn(&Entity::setName));
+	parser->setHandler("company", make_fn<Company>())->setCollector("name", make_sfn(&Entity::setName));
+	parser->memoizeRule("name");
+
+	/* parse several times, so that the memory of the previous parsings is reused. */
+	for (int i = 0; i < 3; ++i) {
+		size_t pos = 0;
+		string input = "Belledonne is a company";
+		shared_ptr<Object> elem = parser->parseInput("sentence", input, &pos);
+		BC_ASSERT_EQUAL(pos, input.size(), size_t, "%zu");
+		shared_ptr<Sentence> sentence = dynamic_pointer_cast<Sentence>(elem);
+		BC_ASSERT_TRUE(sentence != nullptr);
+		if (!sentence) return;
+		shared_ptr<Company> company = dynamic_pointer_cast<Company>(sentence->getEntity());
+		BC_ASSERT_TRUE(company != nullptr);
+		if (company) BC_ASSERT_STRING_EQUAL(company->getName().c_str(), "Belledonne");
+
+		input = "Simon is a person";
+		elem = parser->parseInput("sentence", input, &pos);
+		BC_ASSERT_EQUAL(pos, input.size(), size_t, "%zu");
+		sentence = dynamic_pointer_cast<Sentence>(elem);
+		BC_ASSERT_TRUE(sentence != nullptr);
+		if (!sentence) return;
+		shared_ptr<Person> person = dynamic_pointer_cast<Person>(sentence->getEntity());
+		BC_ASSERT_TRUE(person != nullptr);
+		if (person) BC_ASSERT_STRING_EQUAL(person->getName().c_str(), "Simon");
+	}
+}
+
 static test_t tests[] = {TEST_NO_TAG("Parser connected to C functions", parser_connected_to_c_functions),
-                         TEST_NO_TAG("Parser with inheritance", parser_with_inheritance)};
+                         TEST_NO_TAG("Parser with inheritance", parser_with_inheritance),
+                         TEST_NO_TAG("Parser with memoized rules", parser_with_memoized_rules)};
 
 test_suite_t parser_suite = {"Parser", NULL, NULL, NULL, NULL, sizeof(tests) / sizeof(tests[0]), tests, 0, 0};
@@ -36,13 +36,14 @@ int main(int argc, char *argv[]) {
 	int rules_first = 0;
 	int i;
 	int repeat_count = 1;
+	list<string> memoized_rules;
 	if (argc < 2) {
 		cerr << argv[0]
 		     << " [--repeat <count>] [--debug] <grammar file to load> - test an abnf and instanciate the parser"
 		     << endl;
 		cerr << argv[0]
-		     << " [--repeat <count>] [--debug] <grammar file to load> <input file to parse> <entry rule> [rule1] "
-		        "[rule2]..."
+		     << " [--repeat <count>] [--memoize <rule>]... [--debug] <grammar file to load> <input file to parse> "
+		        "<entry rule> [rule1] [rule2]..."
 		     << endl;
 		cerr << argv[0]
 		     << " The grammar file may be either an ABNF grammar text file, or a compiled grammar generated by "
@@ -56,6 +57,11 @@ int main(int argc, char *argv[]) {
 			if (i < argc) {
 				repeat_count = atoi(argv[i]);
 			}
+		} else if (strcmp(argv[i], "--memoize") == 0) {
+			++i;
+			if (i < argc) {
+				memoized_rules.push_back(argv[i]);
+			}
 		} else if (strcmp(argv[i], "--debug") == 0) {
 			bctbx_set_log_level(NULL, BCTBX_LOG_DEBUG);
 		} else {
@@ -110,6 +116,7 @@ int main(int argc, char *argv[]) {
 			rules.push_back(argv[i]);
 		}
 		parser.setObservedRules(rules);
+		parser.setMemoizedRules(memoized_rules);
 		size_t parsed;
 		shared_ptr<DebugElement> ret;
 		auto t_start = std::chrono::high_resolution_clock::now();
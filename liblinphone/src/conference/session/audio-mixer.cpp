@@ -31,7 +31,7 @@
 LINPHONE_BEGIN_NAMESPACE
 
 MS2AudioMixer::MS2AudioMixer(MixerSession &session) : StreamMixer(session) {
-	MSAudioConferenceParams ms_conf_params;
+	MSAudioConferenceParams ms_conf_params = {0};
 	ms_conf_params.samplerate = linphone_config_get_int(mSession.getCCore()->config, "sound", "conference_rate", 16000);
 	ms_conf_params.active_talker_callback = &MS2AudioMixer::sOnActiveTalkerChanged;
 	ms_conf_params.security_level = StreamMixer::securityLevelToMsSecurityLevel(session.getSecurityLevel());
@@ -40,6 +40,7 @@ MS2AudioMixer::MS2AudioMixer(MixerSession &session) : StreamMixer(session) {
 	    linphone_config_get_int(config, "sound", "conference_mode",
 	                            MSConferenceModeMixer)); // this core setting is also used in MS2AudioStream::render
 	ms_conf_params.user_data = this;
+	ms_conf_params.max_speakers = linphone_config_get_int(config, "sound", "conference_max_speakers", 0);
 	mConference = ms_audio_conference_new(&ms_conf_params, mSession.getCCore()->factory);
 }
 
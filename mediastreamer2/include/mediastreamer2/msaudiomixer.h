@@ -40,4 +40,8 @@ typedef struct MSAudioMixerCtl {
 #define MS_AUDIO_MIXER_SET_MASTER_CHANNEL MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 3, int)
 
 #define MS_AUDIO_MIXER_ENABLE_OUTPUT MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 4, MSAudioMixerCtl)
+
+/**In conference mode, limits the mix to the given number of speakers, the loudest ones. 0 (the default) mixes all the
+ * channels.*/
+#define MS_AUDIO_MIXER_SET_MAX_SPEAKERS MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 5, int)
 #endif
@@ -67,7 +67,8 @@ typedef enum {
 } MSConferenceMode;
 
 /**
- * Structure that holds audio conference parameters
+ * Structure that holds audio conference parameters.
+ * It must be zero-initialized before being filled, so that the fields unknown to the caller keep their default value.
  **/
 struct _MSAudioConferenceParams {
 	int samplerate; /**< Conference audio sampling rate in Hz: 8000, 16000 ...*/
@@ -75,6 +76,8 @@ struct _MSAudioConferenceParams {
 	MSStreamSecurityLevel security_level;
 	MSConferenceMode mode;
 	void *user_data;
+	int max_speakers; /**< Maximum number of participants heard at once, the loudest ones. 0 for the default: all of
+	                     them in mixer mode, 3 in router full packet mode. */
 };
 
 /**
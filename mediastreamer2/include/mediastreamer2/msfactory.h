@@ -50,6 +50,7 @@ struct _MSFactory {
 	char *image_resources_dir;
 	char *echo_canceller_filtername;
 	int expected_video_bandwidth;
+	struct _MSFramePool *frame_pool;
 };
 
 typedef struct _MSFactory MSFactory;
@@ -301,6 +302,11 @@ MS2_PUBLIC char *ms_factory_get_platform_tags_as_string(MSFactory *obj);
 
 MS2_PUBLIC struct _MSVideoPresetsManager *ms_factory_get_video_presets_manager(MSFactory *factory);
 
+/**
+ * Get the pool of frame buffers shared by the video filters created by this factory.
+ **/
+MS2_PUBLIC struct _MSFramePool *ms_factory_get_frame_pool(MSFactory *factory);
+
 MS2_PUBLIC void ms_factory_init_plugins(MSFactory *obj);
 
 /**
@@ -205,7 +205,8 @@ struct _MSFilter {
 	MSList *notify_callbacks;
 	uint32_t last_tick;
 	MSFilterStats *stats;
-	int postponed_task; /*number of postponed tasks*/
+	int postponed_task;                            /*number of postponed tasks*/
+	struct _MSTickerProfilerEntry *profiler_entry; /*statistics of the instance, while its ticker is profiled*/
 	bool_t seen;
 };
 
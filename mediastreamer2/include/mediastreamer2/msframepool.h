@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef msframepool_h
+#define msframepool_h
+
+#include <mediastreamer2/mscommon.h>
+
+/**
+ * @file msframepool.h
+ * @brief Pool of frame buffers shared by the video filters.
+ *
+ * The buffers are grouped by size: a mblk_t freed by the last of its users gives its buffer back to the pool, and the
+ * next request of the same size is served with it instead of a new allocation. Each MSFactory has its own pool, that
+ * the MSYuvBufAllocator created with ms_yuv_buf_allocator_new_with_pool() draw from.
+ * The pool is thread safe: frames may be allocated and freed from any ticker.
+ */
+
+typedef struct _MSFramePool MSFramePool;
+
+typedef struct _MSFramePoolStats {
+	int live_frames;      /**< frames currently in use */
+	size_t live_bytes;    /**< size of the frames currently in use */
+	int free_frames;      /**< frames kept in the pool for reuse */
+	size_t free_bytes;    /**< size of the frames kept in the pool for reuse */
+	uint64_t allocations; /**< number of frames that had to be allocated */
+	uint64_t reuses;      /**< number of frames served from the pool */
+} MSFramePoolStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+MS2_PUBLIC MSFramePool *ms_frame_pool_new(void);
+
+MS2_PUBLIC MSFramePool *ms_frame_pool_ref(MSFramePool *pool);
+
+/**
+ * Releases a reference on the pool. The pool is destroyed once it is not referenced anymore and all its frames have
+ * been freed.
+ */
+MS2_PUBLIC void ms_frame_pool_unref(MSFramePool *pool);
+
+/**
+ * Sets the maximum amount of memory kept in the pool by the frames that are not in use. When a frame is freed above
+ * this limit, the buffers that have not been reused for the longest time are released first.
+ */
+MS2_PUBLIC void ms_frame_pool_set_max_free_bytes(MSFramePool *pool, size_t max_free_bytes);
+
+/**
+ * Returns a mblk_t with a buffer of at least size bytes, taken from the pool if possible.
+ * Its buffer goes back to the pool when the mblk_t and all its duplicates are freed.
+ */
+MS2_PUBLIC mblk_t *ms_frame_pool_alloc(MSFramePool *pool, size_t size);
+
+/**
+ * Same as ms_frame_pool_alloc(), with a function called with owner as argument once the buffer has gone back to the
+ * pool. It lets the owner count its frames in use, and outlive them if needed.
+ */
+MS2_PUBLIC mblk_t *
+ms_frame_pool_alloc_with_owner(MSFramePool *pool, size_t size, void (*on_free)(void *owner), void *owner);
+
+/**
+ * Releases all the frames that are not in use.
+ */
+MS2_PUBLIC void ms_frame_pool_flush(MSFramePool *pool);
+
+MS2_PUBLIC void ms_frame_pool_get_stats(MSFramePool *pool, MSFramePoolStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
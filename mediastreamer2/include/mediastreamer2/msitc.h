@@ -22,6 +22,17 @@
 
 #include <mediastreamer2/msfilter.h>
 
+/**
+ * Statistics of the queue between a MSItcSink and its MSItcSource.
+ */
+typedef struct _MSItcStats {
+	int queued;     /**< number of buffers waiting for the source */
+	int max_queued; /**< highest number of buffers that have been waiting for the source */
+	int dropped;    /**< number of buffers dropped because the queue was full or no source was connected */
+	int capacity;   /**< maximum number of buffers in the queue */
+} MSItcStats;
+
 #define MS_ITC_SINK_CONNECT MS_FILTER_METHOD(MS_ITC_SINK_ID, 0, MSFilter)
+#define MS_ITC_SINK_GET_STATS MS_FILTER_METHOD(MS_ITC_SINK_ID, 1, MSItcStats)
 
 #endif
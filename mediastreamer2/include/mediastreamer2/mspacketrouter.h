@@ -52,6 +52,8 @@ typedef struct _MSPacketRouterPinControl {
 #define MS_PACKET_ROUTER_SET_AS_LOCAL_MEMBER MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 4, MSPacketRouterPinControl)
 
 #define MS_PACKET_ROUTER_GET_ACTIVE_SPEAKER_PIN MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 8, int)
+// Audio full packet mode: number of speakers forwarded at once, chosen from the client to mixer audio levels (RFC 6464)
+#define MS_PACKET_ROUTER_SET_MAX_SPEAKERS MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 11, int)
 
 #ifdef VIDEO_ENABLED
 #define MS_PACKET_ROUTER_SET_FOCUS MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 5, int)
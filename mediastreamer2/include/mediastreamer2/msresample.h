@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef msresample_h
+#define msresample_h
+
+#include <mediastreamer2/msfilter.h>
+
+/**
+ * The MSResample filter converts the sample rate and the number of channels of an audio stream.
+ * When the number of channels changes, the first input channel is copied to all the output channels: only this channel
+ * is resampled.
+ **/
+
+typedef enum _MSResampleQuality {
+	MS_RESAMPLE_QUALITY_DEFAULT, /**< speex "voip" quality (lowered on ARM cpus without NEON) */
+	MS_RESAMPLE_QUALITY_FAST     /**< lowest speex quality, for servers resampling a large number of streams */
+} MSResampleQuality;
+
+/* sets the quality of the resampling, as a MSResampleQuality */
+#define MS_RESAMPLE_SET_QUALITY MS_FILTER_METHOD(MS_RESAMPLE_ID, 0, int)
+
+#endif
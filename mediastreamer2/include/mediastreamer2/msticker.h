@@ -70,6 +70,50 @@ struct _MSTickerLateEvent {
 
 typedef struct _MSTickerLateEvent MSTickerLateEvent;
 
+/**
+ * Statistics of an independent graph (connected component) of a ticker running in parallel mode.
+ * @see ms_ticker_set_worker_count()
+ **/
+struct _MSTickerComponentStats {
+	MSFilter *source; /**< the first source filter of the component, that identifies it */
+	int filter_count; /**< number of filters in the component */
+	float av_load;    /**< average processing time of the component, as a percentage of the tick interval */
+	int lateMs;       /**< late of the component at the time of the last late event, in milliseconds */
+	uint64_t time;    /**< time of the last late event, in milliseconds */
+	int late_ticks;   /**< number of ticks at which the component completed after the end of the tick */
+};
+
+typedef struct _MSTickerComponentStats MSTickerComponentStats;
+
+/**
+ * Processing statistics of a filter instance, collected while the profiling of its ticker is enabled.
+ * @see ms_ticker_enable_profiling()
+ **/
+struct _MSFilterProfile {
+	MSFilter *filter;       /**< the filter instance */
+	const char *name;       /**< name of the filter */
+	MSFilter *graph_source; /**< the source filter of the graph the filter is run from, that identifies the stream */
+	uint64_t count;         /**< number of process() and postponed task calls */
+	uint64_t total_ns;      /**< total processing time, in nanoseconds */
+	uint64_t max_ns;        /**< longest processing time, in nanoseconds */
+	uint64_t p99_ns;        /**< 99th percentile of the processing time, in nanoseconds (to within 12.5%) */
+};
+
+typedef struct _MSFilterProfile MSFilterProfile;
+
+/**
+ * Output formats of the profiling report of a ticker.
+ **/
+enum _MSTickerProfileFormat {
+	MS_TICKER_PROFILE_JSON,        /**< the filter statistics and the slowest ticks as a JSON document */
+	MS_TICKER_PROFILE_CHROME_TRACE /**< the slowest ticks in the Trace Event Format of chrome://tracing or Perfetto */
+};
+
+typedef enum _MSTickerProfileFormat MSTickerProfileFormat;
+
+struct _MSTickerWorkerPool;
+struct _MSTickerProfiler;
+
 struct _MSTicker {
 	ms_mutex_t lock; /*main lock protecting the filter execution list */
 	ms_cond_t cond;
@@ -94,7 +138,13 @@ struct _MSTicker {
 	void *wait_next_tick_data;
 	MSTickerLateEvent late_event;
 	unsigned long thread_id;
-	bool_t run; /* flag to indicate whether the ticker must be run or not */
+	ms_mutex_t task_lock;                /* protects the task_list, which can be filled by the workers */
+	MSList *components;                  /* independent graphs run by the workers, when worker_count > 0 */
+	struct _MSTickerWorkerPool *workers; /* the pool of threads running the components */
+	int worker_count;                    /* number of threads helping the ticker thread, 0 to disable parallel mode */
+	struct _MSTickerProfiler *profiler;  /* per filter timings, NULL unless profiling is enabled */
+	bool_t components_dirty;             /* the components have to be recomputed from the execution list */
+	bool_t run;                          /* flag to indicate whether the ticker must be run or not */
 };
 
 /**
@@ -248,6 +298,70 @@ MS2_PUBLIC float ms_ticker_get_average_load(MSTicker *ticker);
  **/
 MS2_PUBLIC void ms_ticker_get_last_late_tick(MSTicker *ticker, MSTickerLateEvent *ev);
 
+/**
+ * Enable parallel execution of the graphs attached to the ticker.
+ * When count is greater than zero, the ticker splits its graphs into independent connected components, and runs them
+ * on the ticker thread plus count worker threads, which steal components from each other when idle. All components
+ * are done before the ticker waits for the next tick.
+ * As a consequence, filters of different components may run concurrently, and so may the notification callbacks
+ * they invoke synchronously: only enable this mode when filters of distinct graphs don't share state.
+ * @param ticker the MSTicker
+ * @param count number of worker threads, 0 to run all graphs sequentially on the ticker thread (the default).
+ **/
+MS2_PUBLIC void ms_ticker_set_worker_count(MSTicker *ticker, int count);
+
+/**
+ * Get the statistics of the independent graphs run by a ticker in parallel mode.
+ * @param ticker the MSTicker
+ * @param stats an array filled in return with the statistics of at most max_count components.
+ * @param max_count the size of the stats array.
+ * @return the number of components, which may be greater than max_count. It is 0 if parallel mode is disabled.
+ * @see ms_ticker_set_worker_count()
+ **/
+MS2_PUBLIC int ms_ticker_get_component_stats(MSTicker *ticker, MSTickerComponentStats *stats, int max_count);
+
+/**
+ * Enable the profiling of the filters run by the ticker.
+ * While enabled, the processing time of every filter instance is measured, and the slowest ticks are kept with the
+ * timing of all the filters run during them. This costs two clock readings per filter call.
+ * Disabling the profiling discards the collected data.
+ * @param ticker the MSTicker
+ * @param enabled TRUE to enable profiling, FALSE to disable it.
+ **/
+MS2_PUBLIC void ms_ticker_enable_profiling(MSTicker *ticker, bool_t enabled);
+
+/**
+ * Tell whether the profiling of the ticker's filters is enabled.
+ * @param ticker the MSTicker
+ **/
+MS2_PUBLIC bool_t ms_ticker_profiling_enabled(MSTicker *ticker);
+
+/**
+ * Restart the profiling of the ticker's filters from scratch.
+ * @param ticker the MSTicker
+ **/
+MS2_PUBLIC void ms_ticker_reset_profiling(MSTicker *ticker);
+
+/**
+ * Get the processing statistics of the filter instances attached to the ticker.
+ * @param ticker the MSTicker
+ * @param profiles an array filled in return with the statistics of at most max_count filters.
+ * @param max_count the size of the profiles array.
+ * @return the number of profiled filters, which may be greater than max_count. It is 0 if profiling is disabled.
+ * @see ms_ticker_enable_profiling()
+ **/
+MS2_PUBLIC int ms_ticker_get_filter_profiles(MSTicker *ticker, MSFilterProfile *profiles, int max_count);
+
+/**
+ * Dump the profiling data of the ticker: the statistics of the filter instances and the slowest ticks with the timing
+ * of the filters run during them.
+ * @param ticker the MSTicker
+ * @param format the output format.
+ * @return the report, to be freed with ms_free(), or NULL if profiling is disabled.
+ * @see ms_ticker_enable_profiling()
+ **/
+MS2_PUBLIC char *ms_ticker_get_profiling_report(MSTicker *ticker, MSTickerProfileFormat format);
+
 /**
  * Round a time in milliseconds to the internal ticker interval.
  * @param[in] ms The time in milliseconds to round
@@ -306,6 +420,9 @@ MS2_PUBLIC void ms_ticker_synchronizer_resync(MSTickerSynchronizer *ts);
  */
 MS2_PUBLIC void ms_ticker_synchronizer_destroy(MSTickerSynchronizer *ts);
 
+/*private methods*/
+void ms_ticker_profiler_record(MSFilter *f, const MSTimeSpec *begin, const MSTimeSpec *end);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,7 @@
 #define msvideo_h
 
 #include <mediastreamer2/msfilter.h>
+#include <mediastreamer2/msframepool.h>
 
 /* some global constants for video MSFilter(s) */
 #define MS_VIDEO_SIZE_UNKNOWN_W 0
@@ -287,7 +288,7 @@ typedef struct _MSPicture {
 
 typedef struct _MSPicture YuvBuf; /*for backward compatibility*/
 
-typedef msgb_allocator_t MSYuvBufAllocator;
+typedef struct _MSYuvBufAllocator MSYuvBufAllocator;
 
 #ifdef __cplusplus
 extern "C" {
@@ -328,8 +329,12 @@ MS2_PUBLIC void rgb24_revert(uint8_t *buf, int w, int h, int linesize);
 MS2_PUBLIC void rgb24_copy_revert(uint8_t *dstbuf, int dstlsz, const uint8_t *srcbuf, int srclsz, MSVideoSize roi);
 
 MS2_PUBLIC MSYuvBufAllocator *ms_yuv_buf_allocator_new(void);
+/* Creates a YuvBufAllocator whose frames are taken from and given back to the supplied pool, usually the one of the
+ * factory returned by ms_factory_get_frame_pool(). The frames can then be reused by the other filters of the factory.
+ */
+MS2_PUBLIC MSYuvBufAllocator *ms_yuv_buf_allocator_new_with_pool(MSFramePool *pool);
 /* Set a maximum number of frames mananaged by the YuvBufAllocator.
- * Only frames satisfying the w / h size request are counted.
+ * All the frames of the allocator that are still in use are counted, whatever their size.
  */
 MS2_PUBLIC void ms_yuv_buf_allocator_set_max_frames(MSYuvBufAllocator *obj, int max_frames);
 MS2_PUBLIC mblk_t *ms_yuv_allocator_get(MSYuvBufAllocator *obj, int size, int w, int h);
@@ -26,16 +26,38 @@
 #define alloca _alloca
 #endif
 
-#define MIXER_MAX_CHANNELS 50
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXER_HAVE_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER) || (defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 5))
+#define MIXER_HAVE_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MIXER_AVX2_FUNC
+#else
+#define MIXER_AVX2_FUNC __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+#if MS_HAS_ARM_NEON
+#include <arm_neon.h>
+#ifdef __ANDROID__
+#include "cpu-features.h"
+#endif
+#endif
+
+#define MIXER_MAX_CHANNELS 128
 #define ALWAYS_STREAMOUT 1
 #define BYPASS_MODE_TIMEOUT 1000
 
-static void accumulate(int32_t *sum, int16_t *contrib, int nwords) {
-	int i;
-	for (i = 0; i < nwords; ++i) {
-		sum[i] += contrib[i];
-	}
-}
+/* Speaker selection, when the number of speakers mixed is limited (see MS_AUDIO_MIXER_SET_MAX_SPEAKERS).
+ * A selected speaker is kept for SPEAKER_HOLD_TIME ms at least, and is then replaced by a louder channel only if its
+ * level is SPEAKER_SWITCH_RATIO times above its own (3 dB), so that the mix does not flap between close voices.*/
+#define SPEAKER_HOLD_TIME 500
+#define SPEAKER_SWITCH_RATIO 2
+#define SPEAKER_MIN_LEVEL 1024 /*mean square of the samples, about -60 dBFS*/
 
 static MS2_INLINE int16_t saturate(int32_t s) {
 	if (s > 32767) return 32767;
@@ -43,6 +65,15 @@ static MS2_INLINE int16_t saturate(int32_t s) {
 	return (int16_t)s;
 }
 
+/* The mixing kernels. Each one has a portable implementation, used for the tail of vectorized ones. */
+
+static void accumulate(int32_t *sum, const int16_t *contrib, int nwords) {
+	int i;
+	for (i = 0; i < nwords; ++i) {
+		sum[i] += contrib[i];
+	}
+}
+
 static void apply_gain(int16_t *samples, int nsamples, float gain) {
 	int i;
 	for (i = 0; i < nsamples; ++i) {
@@ -50,6 +81,281 @@ static void apply_gain(int16_t *samples, int nsamples, float gain) {
 	}
 }
 
+/*writes the saturated sum, minus the own contribution of the channel if not NULL*/
+static void mix_out(int16_t *out, const int32_t *sum, const int16_t *own, int nwords) {
+	int i;
+	if (own) {
+		for (i = 0; i < nwords; ++i) {
+			out[i] = saturate(sum[i] - (int32_t)own[i]);
+		}
+	} else {
+		for (i = 0; i < nwords; ++i) {
+			out[i] = saturate(sum[i]);
+		}
+	}
+}
+
+/*returns the sum of the squares of the samples*/
+static uint64_t energy(const int16_t *samples, int nsamples) {
+	uint64_t sum = 0;
+	int i;
+	for (i = 0; i < nsamples; ++i) {
+		sum += (uint64_t)((int32_t)samples[i] * samples[i]);
+	}
+	return sum;
+}
+
+#if MIXER_HAVE_SSE2
+
+#define sse2_widen_lo(v) _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)
+#define sse2_widen_hi(v) _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)
+
+static void accumulate_sse2(int32_t *sum, const int16_t *contrib, int nwords) {
+	int i;
+	for (i = 0; i + 8 <= nwords; i += 8) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(contrib + i));
+		__m128i *s = (__m128i *)(sum + i);
+		_mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s), sse2_widen_lo(c)));
+		_mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), sse2_widen_hi(c)));
+	}
+	accumulate(sum + i, contrib + i, nwords - i);
+}
+
+static void apply_gain_sse2(int16_t *samples, int nsamples, float gain) {
+	const __m128 g = _mm_set1_ps(gain);
+	const __m128i min = _mm_set1_epi16(-32767);
+	int i;
+	for (i = 0; i + 8 <= nsamples; i += 8) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(samples + i));
+		__m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sse2_widen_lo(c)), g));
+		__m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sse2_widen_hi(c)), g));
+		_mm_storeu_si128((__m128i *)(samples + i), _mm_max_epi16(_mm_packs_epi32(lo, hi), min));
+	}
+	apply_gain(samples + i, nsamples - i, gain);
+}
+
+static void mix_out_sse2(int16_t *out, const int32_t *sum, const int16_t *own, int nwords) {
+	const __m128i min = _mm_set1_epi16(-32767);
+	int i;
+	for (i = 0; i + 8 <= nwords; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(sum + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(sum + i + 4));
+		if (own) {
+			__m128i c = _mm_loadu_si128((const __m128i *)(own + i));
+			lo = _mm_sub_epi32(lo, sse2_widen_lo(c));
+			hi = _mm_sub_epi32(hi, sse2_widen_hi(c));
+		}
+		_mm_storeu_si128((__m128i *)(out + i), _mm_max_epi16(_mm_packs_epi32(lo, hi), min));
+	}
+	mix_out(out + i, sum + i, own ? own + i : NULL, nwords - i);
+}
+
+/*_mm_madd_epi16() gives the sum of two squares, which fits in an unsigned 32 bit integer, then widened to 64 bits*/
+static uint64_t energy_sse2(const int16_t *samples, int nsamples) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+	uint64_t lanes[2];
+	int i;
+	for (i = 0; i + 8 <= nsamples; i += 8) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(samples + i));
+		__m128i squares = _mm_madd_epi16(c, c);
+		acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(squares, zero));
+		acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(squares, zero));
+	}
+	_mm_storeu_si128((__m128i *)lanes, acc);
+	return lanes[0] + lanes[1] + energy(samples + i, nsamples - i);
+}
+
+#endif /* MIXER_HAVE_SSE2 */
+
+#if MIXER_HAVE_AVX2
+
+MIXER_AVX2_FUNC static void accumulate_avx2(int32_t *sum, const int16_t *contrib, int nwords) {
+	int i;
+	for (i = 0; i + 16 <= nwords; i += 16) {
+		__m256i *s = (__m256i *)(sum + i);
+		__m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(contrib + i)));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(contrib + i + 8)));
+		_mm256_storeu_si256(s, _mm256_add_epi32(_mm256_loadu_si256(s), lo));
+		_mm256_storeu_si256(s + 1, _mm256_add_epi32(_mm256_loadu_si256(s + 1), hi));
+	}
+	accumulate(sum + i, contrib + i, nwords - i);
+}
+
+/*packs two vectors of 8 int32 to 16 saturated int16, in order (_mm256_packs_epi32() works on 128 bit lanes)*/
+MIXER_AVX2_FUNC static MS2_INLINE __m256i avx2_pack_saturate(__m256i lo, __m256i hi) {
+	__m256i r = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+	return _mm256_max_epi16(r, _mm256_set1_epi16(-32767));
+}
+
+MIXER_AVX2_FUNC static void apply_gain_avx2(int16_t *samples, int nsamples, float gain) {
+	const __m256 g = _mm256_set1_ps(gain);
+	int i;
+	for (i = 0; i + 16 <= nsamples; i += 16) {
+		__m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(samples + i)));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(samples + i + 8)));
+		lo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), g));
+		hi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), g));
+		_mm256_storeu_si256((__m256i *)(samples + i), avx2_pack_saturate(lo, hi));
+	}
+	apply_gain(samples + i, nsamples - i, gain);
+}
+
+MIXER_AVX2_FUNC static void mix_out_avx2(int16_t *out, const int32_t *sum, const int16_t *own, int nwords) {
+	int i;
+	for (i = 0; i + 16 <= nwords; i += 16) {
+		__m256i lo = _mm256_loadu_si256((const __m256i *)(sum + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i *)(sum + i + 8));
+		if (own) {
+			lo = _mm256_sub_epi32(lo, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(own + i))));
+			hi = _mm256_sub_epi32(hi, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(own + i + 8))));
+		}
+		_mm256_storeu_si256((__m256i *)(out + i), avx2_pack_saturate(lo, hi));
+	}
+	mix_out(out + i, sum + i, own ? own + i : NULL, nwords - i);
+}
+
+MIXER_AVX2_FUNC static uint64_t energy_avx2(const int16_t *samples, int nsamples) {
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+	uint64_t lanes[4];
+	int i;
+	for (i = 0; i + 16 <= nsamples; i += 16) {
+		__m256i c = _mm256_loadu_si256((const __m256i *)(samples + i));
+		__m256i squares = _mm256_madd_epi16(c, c);
+		acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(squares, zero));
+		acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(squares, zero));
+	}
+	_mm256_storeu_si256((__m256i *)lanes, acc);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + energy(samples + i, nsamples - i);
+}
+
+static bool_t cpu_has_avx2(void) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	/* AVX registers must be enabled by the OS (OSXSAVE and XCR0 bits) */
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return FALSE;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif /* MIXER_HAVE_AVX2 */
+
+#if MS_HAS_ARM_NEON
+
+static void accumulate_neon(int32_t *sum, const int16_t *contrib, int nwords) {
+	int i;
+	for (i = 0; i + 8 <= nwords; i += 8) {
+		int16x8_t c = vld1q_s16(contrib + i);
+		vst1q_s32(sum + i, vaddw_s16(vld1q_s32(sum + i), vget_low_s16(c)));
+		vst1q_s32(sum + i + 4, vaddw_s16(vld1q_s32(sum + i + 4), vget_high_s16(c)));
+	}
+	accumulate(sum + i, contrib + i, nwords - i);
+}
+
+static void apply_gain_neon(int16_t *samples, int nsamples, float gain) {
+	const int16x8_t min = vdupq_n_s16(-32767);
+	int i;
+	for (i = 0; i + 8 <= nsamples; i += 8) {
+		int16x8_t c = vld1q_s16(samples + i);
+		int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(c))), gain));
+		int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(c))), gain));
+		vst1q_s16(samples + i, vmaxq_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)), min));
+	}
+	apply_gain(samples + i, nsamples - i, gain);
+}
+
+static void mix_out_neon(int16_t *out, const int32_t *sum, const int16_t *own, int nwords) {
+	const int16x8_t min = vdupq_n_s16(-32767);
+	int i;
+	for (i = 0; i + 8 <= nwords; i += 8) {
+		int32x4_t lo = vld1q_s32(sum + i);
+		int32x4_t hi = vld1q_s32(sum + i + 4);
+		if (own) {
+			int16x8_t c = vld1q_s16(own + i);
+			lo = vsubw_s16(lo, vget_low_s16(c));
+			hi = vsubw_s16(hi, vget_high_s16(c));
+		}
+		vst1q_s16(out + i, vmaxq_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)), min));
+	}
+	mix_out(out + i, sum + i, own ? own + i : NULL, nwords - i);
+}
+
+static uint64_t energy_neon(const int16_t *samples, int nsamples) {
+	uint64x2_t acc = vdupq_n_u64(0);
+	int i;
+	for (i = 0; i + 8 <= nsamples; i += 8) {
+		int16x8_t c = vld1q_s16(samples + i);
+		acc = vpadalq_u32(acc, vreinterpretq_u32_s32(vmull_s16(vget_low_s16(c), vget_low_s16(c))));
+		acc = vpadalq_u32(acc, vreinterpretq_u32_s32(vmull_s16(vget_high_s16(c), vget_high_s16(c))));
+	}
+	return vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1) + energy(samples + i, nsamples - i);
+}
+
+static bool_t cpu_has_neon(void) {
+#ifdef __ANDROID__
+	return ((android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM) &&
+	        ((android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0)) ||
+	       (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM64);
+#else
+	return TRUE;
+#endif
+}
+
+#endif /* MS_HAS_ARM_NEON */
+
+typedef struct MixerKernels {
+	const char *name;
+	void (*accumulate)(int32_t *sum, const int16_t *contrib, int nwords);
+	void (*apply_gain)(int16_t *samples, int nsamples, float gain);
+	void (*mix_out)(int16_t *out, const int32_t *sum, const int16_t *own, int nwords);
+	uint64_t (*energy)(const int16_t *samples, int nsamples);
+} MixerKernels;
+
+static const MixerKernels mixer_kernels_c = {"c", accumulate, apply_gain, mix_out, energy};
+#if MIXER_HAVE_SSE2
+static const MixerKernels mixer_kernels_sse2 = {"sse2", accumulate_sse2, apply_gain_sse2, mix_out_sse2, energy_sse2};
+#endif
+#if MIXER_HAVE_AVX2
+static const MixerKernels mixer_kernels_avx2 = {"avx2", accumulate_avx2, apply_gain_avx2, mix_out_avx2, energy_avx2};
+#endif
+#if MS_HAS_ARM_NEON
+static const MixerKernels mixer_kernels_neon = {"neon", accumulate_neon, apply_gain_neon, mix_out_neon, energy_neon};
+#endif
+
+/* returns the best kernels supported by the cpu. The MS2_AUDIO_MIXER_SIMD environment variable can force lower ones
+ * ("c", "sse2"...), for testing and benchmarking.*/
+static const MixerKernels *select_kernels(void) {
+	const MixerKernels *available[4];
+	const char *env = getenv("MS2_AUDIO_MIXER_SIMD");
+	int count = 0;
+	int i;
+
+#if MIXER_HAVE_AVX2
+	if (cpu_has_avx2()) available[count++] = &mixer_kernels_avx2;
+#endif
+#if MIXER_HAVE_SSE2
+	available[count++] = &mixer_kernels_sse2;
+#endif
+#if MS_HAS_ARM_NEON
+	if (cpu_has_neon()) available[count++] = &mixer_kernels_neon;
+#endif
+	available[count++] = &mixer_kernels_c;
+
+	if (env != NULL) {
+		for (i = 0; i < count; ++i) {
+			if (strcmp(available[i]->name, env) == 0) return available[i];
+		}
+		ms_warning("MSAudioMixer: mixing kernels [%s] are not available.", env);
+	}
+	return available[0];
+}
+
 typedef struct Channel {
 	MSBufferizer bufferizer;
 	int16_t *input; /*the channel contribution, for removal at output*/
@@ -57,8 +363,11 @@ typedef struct Channel {
 	int min_fullness;
 	uint64_t last_flow_control;
 	uint64_t last_activity;
+	uint64_t level;          /*smoothed mean square of the samples, when speakers are selected*/
+	uint64_t selection_time; /*time at which the channel was selected as a speaker*/
 	bool_t active;
 	bool_t output_enabled;
+	bool_t selected; /*the channel is one of the speakers mixed*/
 } Channel;
 
 static void channel_init(Channel *chan) {
@@ -73,22 +382,36 @@ static void channel_prepare(Channel *chan, int bytes_per_tick) {
 	chan->input = ms_malloc0(bytes_per_tick);
 	chan->last_flow_control = (uint64_t)-1;
 	chan->last_activity = (uint64_t)-1;
+	chan->level = 0;
+	chan->selected = FALSE;
 }
 
-static int channel_process_in(Channel *chan, MSQueue *q, int32_t *sum, int nsamples) {
+/*reads the contribution of the channel for this tick, with its gain applied*/
+static int channel_read_in(Channel *chan, const MixerKernels *kernels, MSQueue *q, int nsamples) {
 	ms_bufferizer_put_from_queue(&chan->bufferizer, q);
 	if (ms_bufferizer_read(&chan->bufferizer, (uint8_t *)chan->input, nsamples * 2) != 0) {
-		if (chan->active) {
-			if (chan->gain != 1.0) {
-				apply_gain(chan->input, nsamples, chan->gain);
-			}
-			accumulate(sum, chan->input, nsamples);
+		if (chan->active && chan->gain != 1.0) {
+			kernels->apply_gain(chan->input, nsamples, chan->gain);
 		}
 		return nsamples;
 	} else memset(chan->input, 0, nsamples * 2);
 	return 0;
 }
 
+static int
+channel_process_in(Channel *chan, const MixerKernels *kernels, MSQueue *q, int32_t *sum, int nsamples) {
+	int ret = channel_read_in(chan, kernels, q, nsamples);
+	if (ret != 0 && chan->active) kernels->accumulate(sum, chan->input, nsamples);
+	return ret;
+}
+
+/*the level rises with the signal and decays by an eighth per tick, so that the pauses between words are bridged*/
+static void channel_update_level(Channel *chan, const MixerKernels *kernels, int nsamples, bool_t got_input) {
+	uint64_t mean_square = (got_input && chan->active) ? kernels->energy(chan->input, nsamples) / nsamples : 0;
+	chan->level -= chan->level >> 3;
+	if (mean_square > chan->level) chan->level = mean_square;
+}
+
 static int channel_flow_control(Channel *chan, int threshold, uint64_t time) {
 	int size;
 	int skip = 0;
@@ -110,27 +433,17 @@ static int channel_flow_control(Channel *chan, int threshold, uint64_t time) {
 	return skip;
 }
 
-static mblk_t *channel_process_out(Channel *chan, int32_t *sum, int nsamples) {
-	int i;
+static mblk_t *channel_process_out(Channel *chan, const MixerKernels *kernels, int32_t *sum, int nsamples) {
 	mblk_t *om = allocb(nsamples * 2, 0);
-	int16_t *out = (int16_t *)om->b_wptr;
 
-	if (chan->active) {
-		/*remove own contribution from sum*/
-		for (i = 0; i < nsamples; ++i) {
-			out[i] = saturate(sum[i] - (int32_t)chan->input[i]);
-		}
-	} else {
-		for (i = 0; i < nsamples; ++i) {
-			out[i] = saturate(sum[i]);
-		}
-	}
+	/*the sum of all inputs is computed once, each output only removes its own contribution from it*/
+	kernels->mix_out((int16_t *)om->b_wptr, sum, chan->active ? chan->input : NULL, nsamples);
 	om->b_wptr += nsamples * 2;
 	return om;
 }
 
 static void channel_unprepare(Channel *chan) {
-	ms_free(chan->input);
+	if (chan->input) ms_free(chan->input);
 	chan->input = NULL;
 }
 
@@ -143,10 +456,12 @@ typedef struct MixerState {
 	int rate;
 	int bytespertick;
 	Channel channels[MIXER_MAX_CHANNELS];
+	const MixerKernels *kernels;
 	int32_t *sum;
 	int conf_mode;
 	int skip_threshold;
 	int master_channel;
+	int max_speakers; /*0 if all the channels are mixed*/
 	bool_t bypass_mode;
 	bool_t single_output;
 } MixerState;
@@ -161,6 +476,7 @@ static void mixer_init(MSFilter *f) {
 	for (i = 0; i < MIXER_MAX_CHANNELS; ++i) {
 		channel_init(&s->channels[i]);
 	}
+	s->kernels = select_kernels();
 	f->data = s;
 }
 
@@ -189,8 +505,11 @@ static void mixer_preprocess(MSFilter *f) {
 
 	s->bytespertick = (2 * s->nchannels * s->rate * f->ticker->interval) / 1000;
 	s->sum = (int32_t *)ms_malloc0((s->bytespertick / 2) * sizeof(int32_t));
-	for (i = 0; i < MIXER_MAX_CHANNELS; ++i)
-		channel_prepare(&s->channels[i], s->bytespertick);
+	for (i = 0; i < MIXER_MAX_CHANNELS; ++i) {
+		/*the contribution buffer is only needed for connected inputs*/
+		if (f->inputs[i]) channel_prepare(&s->channels[i], s->bytespertick);
+	}
+	ms_message("MSAudioMixer [%p] is using [%s] mixing kernels.", f, s->kernels->name);
 	/*ms_message("bytespertick=%i, purgeoffset=%i",s->bytespertick,s->purgeoffset);*/
 	s->skip_threshold = s->bytespertick * 2;
 	s->bypass_mode = FALSE;
@@ -207,12 +526,10 @@ static void mixer_postprocess(MSFilter *f) {
 		channel_unprepare(&s->channels[i]);
 }
 
-static mblk_t *make_output(int32_t *sum, int nwords) {
+static mblk_t *make_output(const MixerKernels *kernels, int32_t *sum, int nwords) {
 	mblk_t *om = allocb(nwords * 2, 0);
-	int i;
-	for (i = 0; i < nwords; ++i, om->b_wptr += 2) {
-		*(int16_t *)om->b_wptr = saturate(sum[i]);
-	}
+	kernels->mix_out((int16_t *)om->b_wptr, sum, NULL, nwords);
+	om->b_wptr += nwords * 2;
 	return om;
 }
 
@@ -285,6 +602,80 @@ static bool_t mixer_check_bypass(MSFilter *f, MixerState *s) {
 	return TRUE;
 }
 
+/* Updates the set of channels mixed: a free place goes to the loudest channel, otherwise the loudest channel replaces
+ * the quietest speaker if it is loud enough and if this one has been selected for long enough. One change is made per
+ * tick at most.*/
+static void mixer_select_speakers(MSFilter *f, MixerState *s) {
+	uint64_t time = f->ticker->time;
+	Channel *quietest = NULL;
+	Channel *loudest = NULL;
+	int selected = 0;
+	int i;
+
+	for (i = 0; i < f->desc->ninputs; ++i) {
+		Channel *chan = &s->channels[i];
+		if (f->inputs[i] == NULL) continue;
+		if (chan->selected && !chan->active) chan->selected = FALSE;
+		if (chan->selected) {
+			selected++;
+			if (time - chan->selection_time >= SPEAKER_HOLD_TIME && (quietest == NULL || chan->level < quietest->level))
+				quietest = chan;
+		} else if (chan->active && chan->level >= SPEAKER_MIN_LEVEL &&
+		           (loudest == NULL || chan->level > loudest->level)) {
+			loudest = chan;
+		}
+	}
+	if (loudest == NULL) return;
+	if (selected >= s->max_speakers) {
+		if (quietest == NULL || loudest->level <= quietest->level * SPEAKER_SWITCH_RATIO) return;
+		quietest->selected = FALSE;
+	}
+	loudest->selected = TRUE;
+	loudest->selection_time = time;
+}
+
+/* Conference mode with a limited number of speakers: only the selected channels are summed. Their outputs remove their
+ * own contribution, all the others get the same mix. Each one gets its own copy of it, as some outputs are processed in
+ * place further down the graph (such as the local one by the equalizer) and must not alter what the others get.*/
+static void mixer_process_speakers(MSFilter *f, MixerState *s, int nwords) {
+	mblk_t *om = NULL;
+	int skip;
+	int i;
+
+	for (i = 0; i < f->desc->ninputs; ++i) {
+		MSQueue *q = f->inputs[i];
+		if (q) {
+			Channel *chan = &s->channels[i];
+			channel_update_level(chan, s->kernels, nwords, channel_read_in(chan, s->kernels, q, nwords) != 0);
+			if ((skip = channel_flow_control(chan, s->skip_threshold, f->ticker->time)) > 0) {
+				ms_warning("Too much data in channel %i, %i ms in excess dropped", i,
+				           (skip * 1000) / (2 * s->nchannels * s->rate));
+			}
+		}
+	}
+	mixer_select_speakers(f, s);
+	for (i = 0; i < f->desc->ninputs; ++i) {
+		Channel *chan = &s->channels[i];
+		if (f->inputs[i] && chan->selected) s->kernels->accumulate(s->sum, chan->input, nwords);
+	}
+
+	for (i = 0; i < MIXER_MAX_CHANNELS; ++i) {
+		MSQueue *q = f->outputs[i];
+		Channel *chan = &s->channels[i];
+		if (q == NULL || !chan->output_enabled) continue;
+		if (f->inputs[i] && chan->selected) {
+			ms_queue_put(q, channel_process_out(chan, s->kernels, s->sum, nwords));
+		} else {
+			if (om == NULL) {
+				om = make_output(s->kernels, s->sum, nwords);
+				ms_queue_put(q, om);
+			} else {
+				ms_queue_put(q, copyb(om));
+			}
+		}
+	}
+}
+
 static void mixer_process(MSFilter *f) {
 	MixerState *s = (MixerState *)f->data;
 	int i;
@@ -300,12 +691,18 @@ static void mixer_process(MSFilter *f) {
 
 	memset(s->sum, 0, nwords * sizeof(int32_t));
 
+	if (s->conf_mode && s->max_speakers > 0) {
+		mixer_process_speakers(f, s, nwords);
+		ms_filter_unlock(f);
+		return;
+	}
+
 	/* read from all inputs and sum everybody */
 	for (i = 0; i < f->desc->ninputs; ++i) {
 		MSQueue *q = f->inputs[i];
 
 		if (q) {
-			if (channel_process_in(&s->channels[i], q, s->sum, nwords)) got_something = TRUE;
+			if (channel_process_in(&s->channels[i], s->kernels, q, s->sum, nwords)) got_something = TRUE;
 			if ((skip = channel_flow_control(&s->channels[i], s->skip_threshold, f->ticker->time)) > 0) {
 				ms_warning("Too much data in channel %i, %i ms in excess dropped", i,
 				           (skip * 1000) / (2 * s->nchannels * s->rate));
@@ -325,7 +722,7 @@ static void mixer_process(MSFilter *f) {
 				Channel *chan = &s->channels[i];
 				if (q && chan->output_enabled) {
 					if (om == NULL) {
-						om = make_output(s->sum, nwords);
+						om = make_output(s->kernels, s->sum, nwords);
 					} else {
 						om = dupb(om);
 					}
@@ -337,7 +734,7 @@ static void mixer_process(MSFilter *f) {
 				MSQueue *q = f->outputs[i];
 				Channel *chan = &s->channels[i];
 				if (q && chan->output_enabled) {
-					ms_queue_put(q, channel_process_out(&s->channels[i], s->sum, nwords));
+					ms_queue_put(q, channel_process_out(&s->channels[i], s->kernels, s->sum, nwords));
 				}
 			}
 		}
@@ -411,6 +808,19 @@ static int mixer_set_conference_mode(MSFilter *f, void *data) {
 	return 0;
 }
 
+static int mixer_set_max_speakers(MSFilter *f, void *data) {
+	MixerState *s = (MixerState *)f->data;
+	int i;
+	ms_filter_lock(f);
+	s->max_speakers = *(int *)data;
+	/*the selection restarts from scratch, it takes a few ticks*/
+	for (i = 0; i < MIXER_MAX_CHANNELS; ++i) {
+		s->channels[i].selected = FALSE;
+	}
+	ms_filter_unlock(f);
+	return 0;
+}
+
 /*not implemented yet. A master channel is a channel that is used as a reference to mix other inputs. Samples from the
  * master channel should never be dropped*/
 static int mixer_set_master_channel(MSFilter *f, void *data) {
@@ -428,6 +838,7 @@ static MSFilterMethod methods[] = {{MS_FILTER_SET_NCHANNELS, mixer_set_nchannels
                                    {MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, mixer_set_conference_mode},
                                    {MS_AUDIO_MIXER_SET_MASTER_CHANNEL, mixer_set_master_channel},
                                    {MS_AUDIO_MIXER_ENABLE_OUTPUT, mixer_enable_output},
+                                   {MS_AUDIO_MIXER_SET_MAX_SPEAKERS, mixer_set_max_speakers},
                                    {0, NULL}};
 
 #ifdef _MSC_VER
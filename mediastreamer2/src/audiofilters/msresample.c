@@ -19,6 +19,7 @@
  */
 
 #include "mediastreamer2/msfilter.h"
+#include "mediastreamer2/msresample.h"
 
 #ifdef _MSC_VER
 #include <malloc.h>
@@ -27,10 +28,210 @@
 #include <speex/speex.h>
 #include <speex/speex_resampler.h>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLE_HAVE_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER) || (defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 5))
+#define RESAMPLE_HAVE_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RESAMPLE_AVX2_FUNC
+#else
+#define RESAMPLE_AVX2_FUNC __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+#if MS_HAS_ARM_NEON
+#include <arm_neon.h>
+#endif
+
 #ifdef __ANDROID__
 #include "cpu-features.h"
 #endif
 
+/* The channel adaptation kernels. When the number of channels changes, the first input channel is copied to all the
+ * output channels, so that only this channel needs to be resampled: it is extracted before the resampling, and
+ * duplicated after. The vectorized kernels handle the usual stereo <-> mono case, and use the portable ones for the
+ * tail. */
+
+static void extract_first_channel(int16_t *dst, const int16_t *src, int nframes, int in_nchannels) {
+	int i;
+	for (i = 0; i < nframes; ++i) {
+		dst[i] = src[i * in_nchannels];
+	}
+}
+
+static void duplicate_channel(int16_t *dst, const int16_t *src, int nframes, int out_nchannels) {
+	int i, c;
+	for (i = 0; i < nframes; ++i) {
+		for (c = 0; c < out_nchannels; ++c)
+			dst[i * out_nchannels + c] = src[i];
+	}
+}
+
+#if RESAMPLE_HAVE_SSE2
+
+/* keeps the low int16 of each int32, sign extended, so that _mm_packs_epi32() does not saturate */
+#define sse2_first_channel(v) _mm_srai_epi32(_mm_slli_epi32(v, 16), 16)
+
+static void extract_first_channel_sse2(int16_t *dst, const int16_t *src, int nframes, int in_nchannels) {
+	int i = 0;
+	if (in_nchannels == 2) {
+		for (; i + 8 <= nframes; i += 8) {
+			__m128i lo = sse2_first_channel(_mm_loadu_si128((const __m128i *)(src + 2 * i)));
+			__m128i hi = sse2_first_channel(_mm_loadu_si128((const __m128i *)(src + 2 * i + 8)));
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+		}
+	}
+	extract_first_channel(dst + i, src + i * in_nchannels, nframes - i, in_nchannels);
+}
+
+static void duplicate_channel_sse2(int16_t *dst, const int16_t *src, int nframes, int out_nchannels) {
+	int i = 0;
+	if (out_nchannels == 2) {
+		for (; i + 8 <= nframes; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			_mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi16(v, v));
+			_mm_storeu_si128((__m128i *)(dst + 2 * i + 8), _mm_unpackhi_epi16(v, v));
+		}
+	}
+	duplicate_channel(dst + i * out_nchannels, src + i, nframes - i, out_nchannels);
+}
+
+#endif /* RESAMPLE_HAVE_SSE2 */
+
+#if RESAMPLE_HAVE_AVX2
+
+RESAMPLE_AVX2_FUNC static void
+extract_first_channel_avx2(int16_t *dst, const int16_t *src, int nframes, int in_nchannels) {
+	int i = 0;
+	if (in_nchannels == 2) {
+		for (; i + 16 <= nframes; i += 16) {
+			__m256i lo = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+			__m256i hi = _mm256_loadu_si256((const __m256i *)(src + 2 * i + 16));
+			lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+			hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+			/* _mm256_packs_epi32() works on 128 bit lanes */
+			_mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8));
+		}
+	}
+	extract_first_channel_sse2(dst + i, src + i * in_nchannels, nframes - i, in_nchannels);
+}
+
+RESAMPLE_AVX2_FUNC static void
+duplicate_channel_avx2(int16_t *dst, const int16_t *src, int nframes, int out_nchannels) {
+	int i = 0;
+	if (out_nchannels == 2) {
+		for (; i + 16 <= nframes; i += 16) {
+			__m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+			__m256i lo = _mm256_unpacklo_epi16(v, v);
+			__m256i hi = _mm256_unpackhi_epi16(v, v);
+			_mm256_storeu_si256((__m256i *)(dst + 2 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256((__m256i *)(dst + 2 * i + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+	}
+	duplicate_channel_sse2(dst + i * out_nchannels, src + i, nframes - i, out_nchannels);
+}
+
+static bool_t cpu_has_avx2(void) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	/* AVX registers must be enabled by the OS (OSXSAVE and XCR0 bits) */
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return FALSE;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif /* RESAMPLE_HAVE_AVX2 */
+
+#if MS_HAS_ARM_NEON
+
+static void extract_first_channel_neon(int16_t *dst, const int16_t *src, int nframes, int in_nchannels) {
+	int i = 0;
+	if (in_nchannels == 2) {
+		for (; i + 8 <= nframes; i += 8) {
+			vst1q_s16(dst + i, vld2q_s16(src + 2 * i).val[0]);
+		}
+	}
+	extract_first_channel(dst + i, src + i * in_nchannels, nframes - i, in_nchannels);
+}
+
+static void duplicate_channel_neon(int16_t *dst, const int16_t *src, int nframes, int out_nchannels) {
+	int i = 0;
+	if (out_nchannels == 2) {
+		for (; i + 8 <= nframes; i += 8) {
+			int16x8x2_t v;
+			v.val[0] = v.val[1] = vld1q_s16(src + i);
+			vst2q_s16(dst + 2 * i, v);
+		}
+	}
+	duplicate_channel(dst + i * out_nchannels, src + i, nframes - i, out_nchannels);
+}
+
+static bool_t cpu_has_neon(void) {
+#ifdef __ANDROID__
+	return ((android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM) &&
+	        ((android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0)) ||
+	       (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM64);
+#else
+	return TRUE;
+#endif
+}
+
+#endif /* MS_HAS_ARM_NEON */
+
+typedef struct ResampleKernels {
+	const char *name;
+	void (*extract_first_channel)(int16_t *dst, const int16_t *src, int nframes, int in_nchannels);
+	void (*duplicate_channel)(int16_t *dst, const int16_t *src, int nframes, int out_nchannels);
+} ResampleKernels;
+
+static const ResampleKernels resample_kernels_c = {"c", extract_first_channel, duplicate_channel};
+#if RESAMPLE_HAVE_SSE2
+static const ResampleKernels resample_kernels_sse2 = {"sse2", extract_first_channel_sse2, duplicate_channel_sse2};
+#endif
+#if RESAMPLE_HAVE_AVX2
+static const ResampleKernels resample_kernels_avx2 = {"avx2", extract_first_channel_avx2, duplicate_channel_avx2};
+#endif
+#if MS_HAS_ARM_NEON
+static const ResampleKernels resample_kernels_neon = {"neon", extract_first_channel_neon, duplicate_channel_neon};
+#endif
+
+/* returns the best kernels supported by the cpu. The MS2_RESAMPLE_SIMD environment variable can force lower ones
+ * ("c", "sse2"...), for testing and benchmarking.*/
+static const ResampleKernels *select_kernels(void) {
+	const ResampleKernels *available[4];
+	const char *env = getenv("MS2_RESAMPLE_SIMD");
+	int count = 0;
+	int i;
+
+#if RESAMPLE_HAVE_AVX2
+	if (cpu_has_avx2()) available[count++] = &resample_kernels_avx2;
+#endif
+#if RESAMPLE_HAVE_SSE2
+	available[count++] = &resample_kernels_sse2;
+#endif
+#if MS_HAS_ARM_NEON
+	if (cpu_has_neon()) available[count++] = &resample_kernels_neon;
+#endif
+	available[count++] = &resample_kernels_c;
+
+	if (env != NULL) {
+		for (i = 0; i < count; ++i) {
+			if (strcmp(available[i]->name, env) == 0) return available[i];
+		}
+		ms_warning("MSResample: channel kernels [%s] are not available.", env);
+	}
+	return available[0];
+}
+
 typedef struct _ResampleData {
 	MSBufferizer *bz;
 	uint32_t ts;
@@ -38,8 +239,12 @@ typedef struct _ResampleData {
 	uint32_t output_rate;
 	int in_nchannels;
 	int out_nchannels;
+	int quality;
 	SpeexResamplerState *handle;
 	int cpuFeatures; /*store because there is no SPEEX_LIB_GET_CPU_FEATURES*/
+	const ResampleKernels *kernels;
+	int16_t *scratch; /* the first channel, before or after the resampling */
+	size_t scratch_size;
 } ResampleData;
 
 static ResampleData *resample_data_new(void) {
@@ -50,16 +255,33 @@ static ResampleData *resample_data_new(void) {
 	obj->output_rate = 16000;
 	obj->handle = NULL;
 	obj->in_nchannels = obj->out_nchannels = 1;
+	obj->quality = MS_RESAMPLE_QUALITY_DEFAULT;
 	obj->cpuFeatures = 0;
+	obj->kernels = select_kernels();
 	return obj;
 }
 
 static void resample_data_destroy(ResampleData *obj) {
 	if (obj->handle != NULL) speex_resampler_destroy(obj->handle);
+	if (obj->scratch != NULL) ms_free(obj->scratch);
 	ms_bufferizer_destroy(obj->bz);
 	ms_free(obj);
 }
 
+static int16_t *resample_get_scratch(ResampleData *dt, size_t nsamples) {
+	if (dt->scratch_size < nsamples) {
+		if (dt->scratch != NULL) ms_free(dt->scratch);
+		dt->scratch = (int16_t *)ms_malloc(nsamples * sizeof(int16_t));
+		dt->scratch_size = nsamples;
+	}
+	return dt->scratch;
+}
+
+/* the number of channels given to the resampler */
+static int resample_nchannels(const ResampleData *dt) {
+	return dt->in_nchannels == dt->out_nchannels ? dt->in_nchannels : 1;
+}
+
 static void resample_init(MSFilter *obj) {
 	ResampleData *data = resample_data_new();
 #ifdef SPEEX_LIB_SET_CPU_FEATURES
@@ -84,19 +306,24 @@ static void resample_uninit(MSFilter *obj) {
 	resample_data_destroy((ResampleData *)obj->data);
 }
 
-static int resample_channel_adapt(int in_nchannels, int out_nchannels, mblk_t *im, mblk_t **om) {
-	if(out_nchannels != in_nchannels) {
-		size_t msgsize = msgdsize(im) * out_nchannels / in_nchannels ;	// Allocate memory for all out channels.
-		*om = allocb(msgsize, 0);
-		// Copy first input channel into all output channels. We don't care about other input channels because stereo is not fully supported (because of echo canceller, volume controller, ...)
-		for (; im->b_rptr < im->b_wptr; im->b_rptr += sizeof(int16_t)*in_nchannels, (*om)->b_wptr += sizeof(int16_t)*out_nchannels) {
-			for(int i = 0 ; i < out_nchannels ; ++i)
-				((int16_t *)(*om)->b_wptr)[i] = *(int16_t *)im->b_rptr;
-		}
-		mblk_meta_copy(im, *om);
-		return 1;
+/* same rate: the first input channel is copied to all the output channels in a single pass */
+static mblk_t *resample_channel_adapt(ResampleData *dt, mblk_t *im) {
+	int nframes = (int)((im->b_wptr - im->b_rptr) / (2 * dt->in_nchannels));
+	mblk_t *om = allocb(nframes * 2 * dt->out_nchannels, 0);
+	const int16_t *src = (const int16_t *)im->b_rptr;
+
+	if (dt->out_nchannels == 1) {
+		dt->kernels->extract_first_channel((int16_t *)om->b_wptr, src, nframes, dt->in_nchannels);
+	} else if (dt->in_nchannels == 1) {
+		dt->kernels->duplicate_channel((int16_t *)om->b_wptr, src, nframes, dt->out_nchannels);
+	} else {
+		int16_t *mono = resample_get_scratch(dt, nframes);
+		dt->kernels->extract_first_channel(mono, src, nframes, dt->in_nchannels);
+		dt->kernels->duplicate_channel((int16_t *)om->b_wptr, mono, nframes, dt->out_nchannels);
 	}
-	return 0;
+	om->b_wptr += nframes * 2 * dt->out_nchannels;
+	mblk_meta_copy(im, om);
+	return om;
 }
 
 static void resample_init_speex(ResampleData *dt) {
@@ -109,9 +336,11 @@ static void resample_init_speex(ResampleData *dt) {
 	quality = SPEEX_RESAMPLER_QUALITY_MIN;
 #endif /*SPEEX_LIB_SET_CPU_FEATURES*/
 #endif /*MS_HAS_ARM*/
-	ms_message("Initializing speex resampler in mode [%s] from %d channels",
-	           (quality==SPEEX_RESAMPLER_QUALITY_VOIP?"voip":"min"), dt->in_nchannels);
-	dt->handle = speex_resampler_init(dt->in_nchannels, dt->input_rate, dt->output_rate, quality, &err);
+	if (dt->quality == MS_RESAMPLE_QUALITY_FAST) quality = SPEEX_RESAMPLER_QUALITY_MIN;
+	ms_message("Initializing speex resampler in mode [%s] from %d to %d channels, with [%s] channel kernels",
+	           (quality == SPEEX_RESAMPLER_QUALITY_VOIP ? "voip" : "min"), dt->in_nchannels, dt->out_nchannels,
+	           dt->kernels->name);
+	dt->handle = speex_resampler_init(resample_nchannels(dt), dt->input_rate, dt->output_rate, quality, &err);
 }
 
 static void resample_preprocess(MSFilter *obj) {
@@ -121,14 +350,15 @@ static void resample_preprocess(MSFilter *obj) {
 
 static void resample_process_ms2(MSFilter *obj) {
 	ResampleData *dt = (ResampleData *)obj->data;
-	mblk_t *im, *om = NULL, *om_chan = NULL;
+	mblk_t *im, *om = NULL;
+	int nchannels;
 
 	if (dt->output_rate == dt->input_rate) {
 		while ((im = ms_queue_get(obj->inputs[0])) != NULL) {
-			if (resample_channel_adapt(dt->in_nchannels, dt->out_nchannels, im, &om) == 0) {
+			if (dt->in_nchannels == dt->out_nchannels) {
 				ms_queue_put(obj->outputs[0], im);
 			} else {
-				ms_queue_put(obj->outputs[0], om);
+				ms_queue_put(obj->outputs[0], resample_channel_adapt(dt, im));
 				freemsg(im);
 			}
 		}
@@ -146,33 +376,45 @@ static void resample_process_ms2(MSFilter *obj) {
 	if (dt->handle == NULL) {
 		resample_init_speex(dt);
 	}
+	nchannels = resample_nchannels(dt);
 
 	while ((im = ms_queue_get(obj->inputs[0])) != NULL) {
 		spx_uint32_t inlen = (spx_uint32_t)((im->b_wptr - im->b_rptr) / (2 * dt->in_nchannels));
 		spx_uint32_t outlen = (spx_uint32_t)(((inlen * dt->output_rate) / dt->input_rate) + 1);
 		spx_uint32_t inlen_orig = inlen;
-		om = allocb(outlen * 2 * dt->in_nchannels, 0);
+		const int16_t *in = (const int16_t *)im->b_rptr;
+		int16_t *out;
+
+		om = allocb(outlen * 2 * dt->out_nchannels, 0);
 		mblk_meta_copy(im, om);
-		if (dt->in_nchannels == 1) {
-			speex_resampler_process_int(dt->handle, 0, (spx_int16_t *)im->b_rptr, &inlen, (spx_int16_t *)om->b_wptr,
-			                            &outlen);
+		out = (int16_t *)om->b_wptr;
+		if (nchannels != dt->in_nchannels || nchannels != dt->out_nchannels) {
+			/* only the first channel is resampled: it is extracted from im to the scratch buffer if im has more
+			 * channels, and resampled to the scratch buffer if om has more channels */
+			int16_t *scratch = resample_get_scratch(dt, inlen + outlen);
+			if (dt->in_nchannels > nchannels) {
+				dt->kernels->extract_first_channel(scratch, in, (int)inlen, dt->in_nchannels);
+				in = scratch;
+			}
+			if (dt->out_nchannels > nchannels) out = scratch + inlen;
+		}
+		if (nchannels == 1) {
+			speex_resampler_process_int(dt->handle, 0, (const spx_int16_t *)in, &inlen, (spx_int16_t *)out, &outlen);
 		} else {
-			speex_resampler_process_interleaved_int(dt->handle, (int16_t *)im->b_rptr, &inlen, (int16_t *)om->b_wptr,
+			speex_resampler_process_interleaved_int(dt->handle, (const spx_int16_t *)in, &inlen, (spx_int16_t *)out,
 			                                        &outlen);
 		}
 		if (inlen_orig != inlen) {
 			ms_error("Bug in resampler ! only %u samples consumed instead of %u, out=%u", (unsigned int)inlen,
 			         (unsigned int)inlen_orig, (unsigned int)outlen);
 		}
-		om->b_wptr += outlen * 2 * dt->in_nchannels;
+		if (dt->out_nchannels > nchannels) {
+			dt->kernels->duplicate_channel((int16_t *)om->b_wptr, out, (int)outlen, dt->out_nchannels);
+		}
+		om->b_wptr += outlen * 2 * dt->out_nchannels;
 		mblk_set_timestamp_info(om, dt->ts);
 		dt->ts += outlen;
-		if (resample_channel_adapt(dt->in_nchannels, dt->out_nchannels, om, &om_chan) == 0) {
-			ms_queue_put(obj->outputs[0], om);
-		} else {
-			ms_queue_put(obj->outputs[0], om_chan);
-			freemsg(om);
-		}
+		ms_queue_put(obj->outputs[0], om);
 		freemsg(im);
 	}
 	ms_filter_unlock(obj);
@@ -221,15 +463,34 @@ static int set_output_nchannels(MSFilter *f, void *arg) {
 	ResampleData *dt = (ResampleData *)f->data;
 	int chans = *(int *)arg;
 	ms_filter_lock(f);
+	/* the number of resampled channels depends on the output channels too */
+	if (dt->out_nchannels != chans && dt->handle != NULL) {
+		speex_resampler_destroy(dt->handle);
+		dt->handle = NULL;
+	}
 	dt->out_nchannels = chans;
 	ms_filter_unlock(f);
 	return 0;
 }
 
+static int set_quality(MSFilter *f, void *arg) {
+	ResampleData *dt = (ResampleData *)f->data;
+	int quality = *(int *)arg;
+	ms_filter_lock(f);
+	if (dt->quality != quality && dt->handle != NULL) {
+		speex_resampler_destroy(dt->handle);
+		dt->handle = NULL;
+	}
+	dt->quality = quality;
+	ms_filter_unlock(f);
+	return 0;
+}
+
 static MSFilterMethod methods[] = {{MS_FILTER_SET_SAMPLE_RATE, ms_resample_set_sr},
                                    {MS_FILTER_SET_OUTPUT_SAMPLE_RATE, ms_resample_set_output_sr},
                                    {MS_FILTER_SET_NCHANNELS, set_input_nchannels},
                                    {MS_FILTER_SET_OUTPUT_NCHANNELS, set_output_nchannels},
+                                   {MS_RESAMPLE_SET_QUALITY, set_quality},
                                    {0, NULL}};
 
 #ifdef _MSC_VER
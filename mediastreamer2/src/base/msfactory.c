@@ -36,6 +36,7 @@
 #include "basedescs.h"
 #include "mediastreamer2/mseventqueue.h"
 #include "mediastreamer2/msfilter.h"
+#include "mediastreamer2/msframepool.h"
 #include "mediastreamer2/msvideo.h"
 #include "mediastreamer2/mswebcam.h"
 
@@ -153,6 +154,10 @@ struct _MSVideoPresetsManager *ms_factory_get_video_presets_manager(MSFactory *f
 	return factory->video_presets_manager;
 }
 
+MSFramePool *ms_factory_get_frame_pool(MSFactory *factory) {
+	return factory->frame_pool;
+}
+
 static int compare_stats_with_name(const MSFilterStats *stat, const char *name) {
 	return strcmp(stat->name, name);
 }
@@ -248,6 +253,7 @@ void ms_factory_init(MSFactory *obj) {
 	ms_free(tags);
 
 	obj->image_resources_dir = bctbx_strdup_printf("%s/images", PACKAGE_DATA_DIR);
+	obj->frame_pool = ms_frame_pool_new();
 }
 
 MSFactory *ms_factory_new(void) {
@@ -1139,6 +1145,8 @@ void ms_factory_destroy(MSFactory *factory) {
 	if (factory->plugins_dir) ms_free(factory->plugins_dir);
 	if (factory->image_resources_dir) ms_free(factory->image_resources_dir);
 	if (factory->wbcmanager) ms_web_cam_manager_destroy(factory->wbcmanager);
+	/* the frames still in use keep the pool alive */
+	if (factory->frame_pool) ms_frame_pool_unref(factory->frame_pool);
 	ms_free(factory);
 	if (factory == fallback_factory) fallback_factory = NULL;
 }
@@ -229,14 +229,19 @@ void ms_filter_destroy(MSFilter *f) {
 void ms_filter_process(MSFilter *f) {
 	MSTimeSpec start, stop;
 	uint64_t elapsed_time;
+	bool_t profiled = f->ticker != NULL && f->ticker->profiler != NULL;
 
 	ms_debug("Executing process of filter %s:%p", f->desc->name, f);
 
-	if (f->stats) ms_get_cur_time(&start);
+	if (f->stats || profiled) ms_get_cur_time(&start);
 
 	f->desc->process(f);
-	if (f->stats) {
+	if (f->stats || profiled) {
 		ms_get_cur_time(&stop);
+		/* the filter may have disabled the profiling */
+		if (profiled && f->ticker->profiler != NULL) ms_ticker_profiler_record(f, &start, &stop);
+	}
+	if (f->stats) {
 		elapsed_time = (stop.tv_sec - start.tv_sec) * 1000000000LL + (stop.tv_nsec - start.tv_nsec);
 		ms_u_box_plot_add_value(&f->stats->bp_elapsed, elapsed_time);
 		/*
@@ -249,14 +254,18 @@ void ms_filter_process(MSFilter *f) {
 void ms_filter_task_process(MSFilterTask *task) {
 	MSTimeSpec start, stop;
 	MSFilter *f = task->f;
+	bool_t profiled = f->ticker != NULL && f->ticker->profiler != NULL;
 	/*ms_message("Executing task of filter %s:%p",f->desc->name,f);*/
 
-	if (f->stats) ms_get_cur_time(&start);
+	if (f->stats || profiled) ms_get_cur_time(&start);
 
 	task->taskfunc(f);
+	if (f->stats || profiled) {
+		ms_get_cur_time(&stop);
+		if (profiled && f->ticker->profiler != NULL) ms_ticker_profiler_record(f, &start, &stop);
+	}
 	if (f->stats) {
 		uint64_t elapsed_time;
-		ms_get_cur_time(&stop);
 		elapsed_time = (stop.tv_sec - start.tv_sec) * 1000000000LL + (stop.tv_nsec - start.tv_nsec);
 		ms_u_box_plot_add_value(&f->stats->bp_elapsed, elapsed_time);
 	}
@@ -296,7 +305,9 @@ void ms_filter_postpone_task(MSFilter *f, MSFilterFunc taskfunc) {
 	task = ms_new0(MSFilterTask, 1);
 	task->f = f;
 	task->taskfunc = taskfunc;
+	ms_mutex_lock(&ticker->task_lock);
 	ticker->task_list = bctbx_list_prepend(ticker->task_list, task);
+	ms_mutex_unlock(&ticker->task_lock);
 	f->postponed_task++;
 }
 
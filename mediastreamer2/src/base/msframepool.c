@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(HAVE_CONFIG_H)
+#include "mediastreamer-config.h"
+#endif
+
+#include "mediastreamer2/msframepool.h"
+
+/*
+ * Every buffer is preceded by a MSFrameHeader, and given to esballoc() with frame_pool_release() as free function:
+ * this is how a buffer finds its way back to its pool once the last reference on its data block is dropped.
+ * The requested sizes are rounded up to MS_FRAME_POOL_GRANULARITY, and the free buffers are kept in one bucket per
+ * rounded size. A video pipeline uses few different sizes, so that a handful of buckets is enough; when a new size
+ * shows up, it takes the bucket that has been used the least recently.
+ */
+
+#define MS_FRAME_POOL_BUCKETS 16
+#define MS_FRAME_POOL_GRANULARITY 4096
+#define MS_FRAME_POOL_DEFAULT_MAX_FREE_BYTES (64 * 1024 * 1024)
+#define MS_FRAME_HEADER_SIZE 64 /* keeps the alignment of the buffers given by ms_malloc() */
+
+typedef struct _MSFrameHeader {
+	MSFramePool *pool;
+	void (*on_free)(void *owner);
+	void *owner;
+	struct _MSFrameHeader *next; /* in the free list of its bucket */
+	size_t size;
+} MSFrameHeader;
+
+typedef struct _MSFramePoolBucket {
+	size_t size; /* 0 if the bucket is not used */
+	MSFrameHeader *free_frames;
+	int count;
+	uint64_t last_use;
+} MSFramePoolBucket;
+
+struct _MSFramePool {
+	ms_mutex_t lock;
+	int refcnt; /* references by the users of the pool and by the frames in use */
+	size_t max_free_bytes;
+	uint64_t use_counter;
+	MSFramePoolStats stats;
+	MSFramePoolBucket buckets[MS_FRAME_POOL_BUCKETS];
+};
+
+MSFramePool *ms_frame_pool_new(void) {
+	MSFramePool *pool = ms_new0(MSFramePool, 1);
+	ms_mutex_init(&pool->lock, NULL);
+	pool->refcnt = 1;
+	pool->max_free_bytes = MS_FRAME_POOL_DEFAULT_MAX_FREE_BYTES;
+	return pool;
+}
+
+static void frame_pool_free_list(MSFrameHeader *frame) {
+	while (frame != NULL) {
+		MSFrameHeader *next = frame->next;
+		ms_free(frame);
+		frame = next;
+	}
+}
+
+static void frame_pool_destroy(MSFramePool *pool) {
+	int i;
+	for (i = 0; i < MS_FRAME_POOL_BUCKETS; i++) {
+		frame_pool_free_list(pool->buckets[i].free_frames);
+	}
+	ms_mutex_destroy(&pool->lock);
+	ms_free(pool);
+}
+
+MSFramePool *ms_frame_pool_ref(MSFramePool *pool) {
+	ms_mutex_lock(&pool->lock);
+	pool->refcnt++;
+	ms_mutex_unlock(&pool->lock);
+	return pool;
+}
+
+void ms_frame_pool_unref(MSFramePool *pool) {
+	bool_t destroy;
+	ms_mutex_lock(&pool->lock);
+	destroy = --pool->refcnt == 0;
+	ms_mutex_unlock(&pool->lock);
+	if (destroy) frame_pool_destroy(pool);
+}
+
+/* The functions below are called with the lock held. */
+
+static MSFramePoolBucket *frame_pool_find_bucket(MSFramePool *pool, size_t size) {
+	int i;
+	for (i = 0; i < MS_FRAME_POOL_BUCKETS; i++) {
+		if (pool->buckets[i].size == size) return &pool->buckets[i];
+	}
+	return NULL;
+}
+
+/* Removes a frame from the bucket that has been used the least recently, returns NULL if the pool is empty */
+static MSFrameHeader *frame_pool_evict(MSFramePool *pool) {
+	MSFramePoolBucket *oldest = NULL;
+	MSFrameHeader *frame;
+	int i;
+	for (i = 0; i < MS_FRAME_POOL_BUCKETS; i++) {
+		MSFramePoolBucket *bucket = &pool->buckets[i];
+		if (bucket->free_frames != NULL && (oldest == NULL || bucket->last_use < oldest->last_use)) oldest = bucket;
+	}
+	if (oldest == NULL) return NULL;
+	frame = oldest->free_frames;
+	oldest->free_frames = frame->next;
+	oldest->count--;
+	pool->stats.free_frames--;
+	pool->stats.free_bytes -= frame->size;
+	return frame;
+}
+
+/* Returns the bucket for this size, taking an unused one or the least recently used one if there is none yet */
+static MSFramePoolBucket *frame_pool_get_bucket(MSFramePool *pool, size_t size, MSFrameHeader **evicted) {
+	MSFramePoolBucket *bucket = frame_pool_find_bucket(pool, size);
+	int i;
+	if (bucket != NULL) return bucket;
+	for (i = 0; i < MS_FRAME_POOL_BUCKETS; i++) {
+		MSFramePoolBucket *candidate = &pool->buckets[i];
+		if (candidate->size == 0) {
+			bucket = candidate;
+			break;
+		}
+		if (bucket == NULL || candidate->last_use < bucket->last_use) bucket = candidate;
+	}
+	while (bucket->free_frames != NULL) {
+		MSFrameHeader *frame = bucket->free_frames;
+		bucket->free_frames = frame->next;
+		pool->stats.free_frames--;
+		pool->stats.free_bytes -= frame->size;
+		frame->next = *evicted;
+		*evicted = frame;
+	}
+	bucket->size = size;
+	bucket->count = 0;
+	return bucket;
+}
+
+static void frame_pool_release(void *buffer) {
+	MSFrameHeader *frame = (MSFrameHeader *)((uint8_t *)buffer - MS_FRAME_HEADER_SIZE);
+	MSFramePool *pool = frame->pool;
+	void (*on_free)(void *) = frame->on_free;
+	void *owner = frame->owner;
+	MSFrameHeader *evicted = NULL;
+	bool_t destroy;
+
+	ms_mutex_lock(&pool->lock);
+	pool->stats.live_frames--;
+	pool->stats.live_bytes -= frame->size;
+	if (frame->size <= pool->max_free_bytes) {
+		MSFramePoolBucket *bucket;
+		while (pool->stats.free_bytes + frame->size > pool->max_free_bytes) {
+			MSFrameHeader *oldest = frame_pool_evict(pool);
+			oldest->next = evicted;
+			evicted = oldest;
+		}
+		bucket = frame_pool_get_bucket(pool, frame->size, &evicted);
+		frame->next = bucket->free_frames;
+		bucket->free_frames = frame;
+		bucket->count++;
+		bucket->last_use = ++pool->use_counter;
+		pool->stats.free_frames++;
+		pool->stats.free_bytes += frame->size;
+	} else {
+		frame->next = evicted;
+		evicted = frame;
+	}
+	destroy = --pool->refcnt == 0;
+	ms_mutex_unlock(&pool->lock);
+
+	frame_pool_free_list(evicted);
+	if (on_free) on_free(owner);
+	if (destroy) frame_pool_destroy(pool);
+}
+
+mblk_t *ms_frame_pool_alloc_with_owner(MSFramePool *pool, size_t size, void (*on_free)(void *owner), void *owner) {
+	size_t rounded = (size + MS_FRAME_POOL_GRANULARITY - 1) & ~((size_t)MS_FRAME_POOL_GRANULARITY - 1);
+	MSFrameHeader *frame = NULL;
+	MSFramePoolBucket *bucket;
+
+	if (rounded == 0) rounded = MS_FRAME_POOL_GRANULARITY;
+	ms_mutex_lock(&pool->lock);
+	bucket = frame_pool_find_bucket(pool, rounded);
+	if (bucket != NULL && bucket->free_frames != NULL) {
+		frame = bucket->free_frames;
+		bucket->free_frames = frame->next;
+		bucket->count--;
+		bucket->last_use = ++pool->use_counter;
+		pool->stats.free_frames--;
+		pool->stats.free_bytes -= rounded;
+		pool->stats.reuses++;
+	} else {
+		pool->stats.allocations++;
+	}
+	pool->stats.live_frames++;
+	pool->stats.live_bytes += rounded;
+	pool->refcnt++;
+	ms_mutex_unlock(&pool->lock);
+
+	if (frame == NULL) {
+		frame = (MSFrameHeader *)ms_malloc(MS_FRAME_HEADER_SIZE + rounded);
+		frame->pool = pool;
+		frame->size = rounded;
+	}
+	frame->next = NULL;
+	frame->on_free = on_free;
+	frame->owner = owner;
+	return esballoc((uint8_t *)frame + MS_FRAME_HEADER_SIZE, rounded, 0, frame_pool_release);
+}
+
+mblk_t *ms_frame_pool_alloc(MSFramePool *pool, size_t size) {
+	return ms_frame_pool_alloc_with_owner(pool, size, NULL, NULL);
+}
+
+void ms_frame_pool_set_max_free_bytes(MSFramePool *pool, size_t max_free_bytes) {
+	MSFrameHeader *evicted = NULL;
+	ms_mutex_lock(&pool->lock);
+	pool->max_free_bytes = max_free_bytes;
+	while (pool->stats.free_bytes > max_free_bytes) {
+		MSFrameHeader *oldest = frame_pool_evict(pool);
+		oldest->next = evicted;
+		evicted = oldest;
+	}
+	ms_mutex_unlock(&pool->lock);
+	frame_pool_free_list(evicted);
+}
+
+void ms_frame_pool_flush(MSFramePool *pool) {
+	MSFrameHeader *evicted = NULL;
+	MSFrameHeader *frame;
+	ms_mutex_lock(&pool->lock);
+	while ((frame = frame_pool_evict(pool)) != NULL) {
+		frame->next = evicted;
+		evicted = frame;
+	}
+	ms_mutex_unlock(&pool->lock);
+	frame_pool_free_list(evicted);
+}
+
+void ms_frame_pool_get_stats(MSFramePool *pool, MSFramePoolStats *stats) {
+	ms_mutex_lock(&pool->lock);
+	*stats = pool->stats;
+	ms_mutex_unlock(&pool->lock);
+}
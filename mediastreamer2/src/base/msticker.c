@@ -45,10 +45,27 @@ static const double smooth_coef = 0.9;
 
 #define TICKER_INTERVAL 10
 
+#ifdef _MSC_VER
+#define TICKER_THREAD_LOCAL __declspec(thread)
+#else
+#define TICKER_THREAD_LOCAL __thread
+#endif
+
+/* the ticker whose graphs are run by the current thread, if it is a worker thread */
+static TICKER_THREAD_LOCAL MSTicker *worker_ticker = NULL;
+/* the source of the graph being run by the current thread, to attribute the filters to it when profiling */
+static TICKER_THREAD_LOCAL MSFilter *profiled_graph_source = NULL;
+
+typedef struct _MSTickerComponent MSTickerComponent;
+typedef struct _MSTickerProfiler MSTickerProfiler;
+
 static void *ms_ticker_run(void *s);
 static uint64_t get_cur_time_ms(void *);
 static int wait_next_tick(void *, uint64_t virt_ticker_time);
 static void remove_tasks_for_filter(MSTicker *ticker, MSFilter *f);
+static void ms_ticker_component_destroy(MSTickerComponent *c);
+static void ms_ticker_profiler_destroy(MSTickerProfiler *profiler);
+static void ms_ticker_profiler_remove_filter(MSTickerProfiler *profiler, MSFilter *f);
 
 static void ms_ticker_start(MSTicker *s) {
 	s->run = TRUE;
@@ -58,8 +75,14 @@ static void ms_ticker_start(MSTicker *s) {
 static void ms_ticker_init(MSTicker *ticker, const MSTickerParams *params) {
 	ms_mutex_init(&ticker->lock, NULL);
 	ms_mutex_init(&ticker->cur_time_lock, NULL);
+	ms_mutex_init(&ticker->task_lock, NULL);
 	ticker->execution_list = NULL;
 	ticker->task_list = NULL;
+	ticker->components = NULL;
+	ticker->workers = NULL;
+	ticker->worker_count = 0;
+	ticker->components_dirty = FALSE;
+	ticker->profiler = NULL;
 	ticker->ticks = 1;
 	ticker->time = 0;
 	ticker->interval = TICKER_INTERVAL;
@@ -117,8 +140,11 @@ static void ms_ticker_uninit(MSTicker *ticker) {
 		bctbx_log_tags_destroy(ticker->creator_tags);
 		ticker->creator_tags = NULL;
 	}
+	bctbx_list_free_with_data(ticker->components, (bctbx_list_free_func)ms_ticker_component_destroy);
+	if (ticker->profiler) ms_ticker_profiler_destroy(ticker->profiler);
 	ms_mutex_destroy(&ticker->lock);
 	ms_mutex_destroy(&ticker->cur_time_lock);
+	ms_mutex_destroy(&ticker->task_lock);
 }
 
 void ms_ticker_destroy(MSTicker *ticker) {
@@ -179,6 +205,7 @@ int ms_ticker_attach_multiple(MSTicker *ticker, MSFilter *f, ...) {
 	if (total_sources) {
 		ms_mutex_lock(&ticker->lock);
 		ticker->execution_list = bctbx_list_concat(ticker->execution_list, total_sources);
+		ticker->components_dirty = TRUE;
 		ms_mutex_unlock(&ticker->lock);
 	}
 	return 0;
@@ -220,6 +247,12 @@ int ms_ticker_detach(MSTicker *ticker, MSFilter *f) {
 	for (it = sources; it != NULL; it = bctbx_list_next(it)) {
 		ticker->execution_list = bctbx_list_remove(ticker->execution_list, it->data);
 	}
+	if (ticker->profiler) {
+		for (it = filters; it != NULL; it = bctbx_list_next(it)) {
+			ms_ticker_profiler_remove_filter(ticker->profiler, (MSFilter *)it->data);
+		}
+	}
+	ticker->components_dirty = TRUE;
 	ms_mutex_unlock(&ticker->lock);
 	bctbx_list_for_each(filters, (void (*)(void *))call_postprocess);
 	bctbx_list_free(filters);
@@ -285,6 +318,7 @@ static void run_graphs(MSTicker *s, bctbx_list_t *execution_list, bool_t force_s
 	bctbx_list_t *it;
 	bctbx_list_t *unschedulable = NULL;
 	for (it = execution_list; it != NULL; it = it->next) {
+		if (!force_schedule) profiled_graph_source = (MSFilter *)it->data;
 		run_graph((MSFilter *)it->data, s, &unschedulable, force_schedule);
 	}
 	/* filters that are part of a loop haven't been called in process() because one of their input refers to a filter
@@ -300,7 +334,14 @@ static void run_graphs(MSTicker *s, bctbx_list_t *execution_list, bool_t force_s
 
 static void run_tasks(MSTicker *ticker) {
 	bctbx_list_t *elem, *prevelem = NULL;
-	for (elem = ticker->task_list; elem != NULL;) {
+	bctbx_list_t *task_list;
+
+	/* tasks may be postponed concurrently by filters run on worker threads */
+	ms_mutex_lock(&ticker->task_lock);
+	task_list = ticker->task_list;
+	ticker->task_list = NULL;
+	ms_mutex_unlock(&ticker->task_lock);
+	for (elem = task_list; elem != NULL;) {
 		MSFilterTask *t = (MSFilterTask *)elem->data;
 		ms_filter_task_process(t);
 		ms_free(t);
@@ -308,11 +349,11 @@ static void run_tasks(MSTicker *ticker) {
 		elem = elem->next;
 		ms_free(prevelem);
 	}
-	ticker->task_list = NULL;
 }
 
 static void remove_tasks_for_filter(MSTicker *ticker, MSFilter *f) {
 	bctbx_list_t *elem, *nextelem;
+	ms_mutex_lock(&ticker->task_lock);
 	for (elem = ticker->task_list; elem != NULL; elem = nextelem) {
 		MSFilterTask *t = (MSFilterTask *)elem->data;
 		nextelem = elem->next;
@@ -321,6 +362,7 @@ static void remove_tasks_for_filter(MSTicker *ticker, MSFilter *f) {
 			ms_free(t);
 		}
 	}
+	ms_mutex_unlock(&ticker->task_lock);
 }
 
 static uint64_t get_cur_time_ms(BCTBX_UNUSED(void *unused)) {
@@ -444,6 +486,646 @@ static int wait_next_tick(void *data, BCTBX_UNUSED(uint64_t virt_ticker_time)) {
 	return late;
 }
 
+/*
+ * Parallel mode: the graphs attached to the ticker are split into independent connected components, which are
+ * distributed round-robin on per-thread queues at each tick. A thread pops the components from the head of its own
+ * queue, then steals from the tail of the other queues. The ticker thread takes part as worker 0, and waits for all
+ * components to be done before ending the tick.
+ */
+
+struct _MSTickerComponent {
+	bctbx_list_t *sources; /* the source filters of the component, in execution list order */
+	MSTickerComponentStats stats;
+	int max_late; /* max late since last log */
+};
+
+typedef struct _MSTickerWorker {
+	struct _MSTickerWorkerPool *pool;
+	ms_thread_t thread;
+	ms_mutex_t lock; /* protects the queue */
+	MSTickerComponent **queue;
+	int head;
+	int tail;
+	int index;
+} MSTickerWorker;
+
+typedef struct _MSTickerWorkerPool {
+	MSTicker *ticker;
+	MSTickerWorker *workers; /* workers[0] is the ticker thread itself */
+	int count;
+	int capacity; /* allocated size of the queues */
+	ms_mutex_t lock;
+	ms_cond_t cond;      /* signaled when a tick starts or when the pool is stopped */
+	ms_cond_t done_cond; /* signaled when all the components of the tick are done */
+	MSTimeSpec tick_begin;
+	uint64_t last_log_time;
+	uint32_t generation; /* incremented at each tick */
+	int pending;         /* number of components not done yet for the current tick */
+	bool_t running;
+} MSTickerWorkerPool;
+
+static int64_t get_elapsed_us(const MSTimeSpec *begin, const MSTimeSpec *end) {
+	return (end->tv_sec - begin->tv_sec) * 1000000LL + (end->tv_nsec - begin->tv_nsec) / 1000LL;
+}
+
+static void ms_ticker_component_destroy(MSTickerComponent *c) {
+	bctbx_list_free(c->sources);
+	ms_free(c);
+}
+
+static MSTickerComponent *find_component(bctbx_list_t *components, MSFilter *source) {
+	for (; components != NULL; components = components->next) {
+		MSTickerComponent *c = (MSTickerComponent *)components->data;
+		if (bctbx_list_find(c->sources, source) != NULL) return c;
+	}
+	return NULL;
+}
+
+/* groups the sources of the execution list that belong to the same graph. Statistics of the components are kept
+ * across updates, as long as their first source is still attached. */
+static void update_components(MSTicker *s) {
+	bctbx_list_t *remaining = bctbx_list_copy(s->execution_list);
+	bctbx_list_t *components = NULL;
+
+	while (remaining != NULL) {
+		MSFilter *first = (MSFilter *)remaining->data;
+		bctbx_list_t *filters = ms_filter_find_neighbours(first);
+		MSTickerComponent *previous = find_component(s->components, first);
+		MSTickerComponent *c = ms_new0(MSTickerComponent, 1);
+		bctbx_list_t *it, *next;
+
+		if (previous) c->stats = previous->stats;
+		c->stats.source = first;
+		c->stats.filter_count = (int)bctbx_list_size(filters);
+		for (it = remaining; it != NULL; it = next) {
+			next = it->next;
+			if (bctbx_list_find(filters, it->data) != NULL) {
+				c->sources = bctbx_list_append(c->sources, it->data);
+				remaining = bctbx_list_erase_link(remaining, it);
+			}
+		}
+		bctbx_list_free(filters);
+		components = bctbx_list_append(components, c);
+	}
+	bctbx_list_free_with_data(s->components, (bctbx_list_free_func)ms_ticker_component_destroy);
+	s->components = components;
+	s->components_dirty = FALSE;
+}
+
+static void run_component(MSTickerWorkerPool *pool, MSTickerComponent *c) {
+	MSTicker *s = pool->ticker;
+	MSTimeSpec begin, end;
+	int late;
+
+	ms_get_cur_time(&begin);
+	run_graphs(s, c->sources, FALSE);
+	ms_get_cur_time(&end);
+#if TICKER_MEASUREMENTS
+	{
+		double iload = get_elapsed_us(&begin, &end) / (10.0 * s->interval);
+		c->stats.av_load = (float)((smooth_coef * c->stats.av_load) + ((1.0 - smooth_coef) * iload));
+	}
+#endif
+	/* the component is late if it completed after the end of the tick */
+	late = (int)(get_elapsed_us(&pool->tick_begin, &end) / 1000LL) - s->interval;
+	if (late > 0) {
+		c->stats.late_ticks++;
+		c->stats.lateMs = late;
+		c->stats.time = ms_get_cur_time_ms();
+		if (late > c->max_late) c->max_late = late;
+	}
+}
+
+static MSTickerComponent *ms_ticker_worker_pop(MSTickerWorkerPool *pool, int index) {
+	MSTickerWorker *w = &pool->workers[index];
+	MSTickerComponent *c = NULL;
+	int i;
+
+	ms_mutex_lock(&w->lock);
+	if (w->head < w->tail) c = w->queue[w->head++];
+	ms_mutex_unlock(&w->lock);
+	for (i = 1; c == NULL && i < pool->count; i++) {
+		MSTickerWorker *victim = &pool->workers[(index + i) % pool->count];
+		ms_mutex_lock(&victim->lock);
+		if (victim->head < victim->tail) c = victim->queue[--victim->tail];
+		ms_mutex_unlock(&victim->lock);
+	}
+	return c;
+}
+
+static void ms_ticker_worker_run_components(MSTickerWorkerPool *pool, int index) {
+	MSTickerComponent *c;
+	while ((c = ms_ticker_worker_pop(pool, index)) != NULL) {
+		run_component(pool, c);
+		ms_mutex_lock(&pool->lock);
+		if (--pool->pending == 0) ms_cond_signal(&pool->done_cond);
+		ms_mutex_unlock(&pool->lock);
+	}
+}
+
+static void *ms_ticker_worker_run(void *arg) {
+	MSTickerWorker *w = (MSTickerWorker *)arg;
+	MSTickerWorkerPool *pool = w->pool;
+	uint32_t generation = 0;
+	int precision;
+
+	bctbx_set_self_thread_name(pool->ticker->name);
+	precision = set_high_prio(pool->ticker);
+	worker_ticker = pool->ticker;
+	ms_mutex_lock(&pool->lock);
+	while (pool->running) {
+		if (generation != pool->generation) {
+			generation = pool->generation;
+			ms_mutex_unlock(&pool->lock);
+			ms_ticker_worker_run_components(pool, w->index);
+			ms_mutex_lock(&pool->lock);
+		} else {
+			ms_cond_wait(&pool->cond, &pool->lock);
+		}
+	}
+	ms_mutex_unlock(&pool->lock);
+	worker_ticker = NULL;
+	unset_high_prio(precision);
+	ms_thread_exit(NULL);
+	return NULL;
+}
+
+static MSTickerWorkerPool *ms_ticker_worker_pool_new(MSTicker *s, int worker_count) {
+	MSTickerWorkerPool *pool = ms_new0(MSTickerWorkerPool, 1);
+	int i;
+
+	pool->ticker = s;
+	pool->count = worker_count + 1;
+	pool->workers = ms_new0(MSTickerWorker, pool->count);
+	ms_mutex_init(&pool->lock, NULL);
+	ms_cond_init(&pool->cond, NULL);
+	ms_cond_init(&pool->done_cond, NULL);
+	pool->running = TRUE;
+	for (i = 0; i < pool->count; i++) {
+		MSTickerWorker *w = &pool->workers[i];
+		w->pool = pool;
+		w->index = i;
+		ms_mutex_init(&w->lock, NULL);
+		if (i > 0) ms_thread_create(&w->thread, NULL, ms_ticker_worker_run, w);
+	}
+	ms_message("%s: running independent graphs on %i worker threads.", s->name, worker_count);
+	return pool;
+}
+
+static void ms_ticker_worker_pool_destroy(MSTickerWorkerPool *pool) {
+	int i;
+
+	ms_mutex_lock(&pool->lock);
+	pool->running = FALSE;
+	ms_cond_broadcast(&pool->cond);
+	ms_mutex_unlock(&pool->lock);
+	for (i = 0; i < pool->count; i++) {
+		MSTickerWorker *w = &pool->workers[i];
+		if (i > 0) ms_thread_join(w->thread, NULL);
+		ms_mutex_destroy(&w->lock);
+		if (w->queue) ms_free(w->queue);
+	}
+	ms_cond_destroy(&pool->cond);
+	ms_cond_destroy(&pool->done_cond);
+	ms_mutex_destroy(&pool->lock);
+	ms_free(pool->workers);
+	ms_free(pool);
+}
+
+/* (re)creates the worker pool when the requested worker count has changed */
+static void update_worker_pool(MSTicker *s) {
+	int current_count = s->workers ? s->workers->count - 1 : 0;
+
+	if (current_count == s->worker_count) return;
+	if (s->workers) {
+		ms_ticker_worker_pool_destroy(s->workers);
+		s->workers = NULL;
+	}
+	if (s->worker_count > 0) {
+		s->workers = ms_ticker_worker_pool_new(s, s->worker_count);
+		s->components_dirty = TRUE;
+	} else {
+		s->components = bctbx_list_free_with_data(s->components, (bctbx_list_free_func)ms_ticker_component_destroy);
+	}
+}
+
+static void log_late_components(MSTicker *s) {
+	bctbx_list_t *it;
+	uint64_t current_time = ms_get_cur_time_ms();
+
+	if (current_time < s->workers->last_log_time + 1000) return; /* like ticker's late, print max late each 1s */
+	s->workers->last_log_time = current_time;
+	for (it = s->components; it != NULL; it = it->next) {
+		MSTickerComponent *c = (MSTickerComponent *)it->data;
+		if (c->max_late > 0) {
+			ms_warning("%s: graph of %s:%p is late of %d miliseconds.", s->name, c->stats.source->desc->name,
+			           c->stats.source, c->max_late);
+			c->max_late = 0;
+		}
+	}
+}
+
+static void run_components(MSTicker *s) {
+	MSTickerWorkerPool *pool = s->workers;
+	int count;
+	int i;
+	bctbx_list_t *it;
+
+	if (s->components_dirty) update_components(s);
+	count = (int)bctbx_list_size(s->components);
+	if (count == 0) return;
+	if (count > pool->capacity) {
+		for (i = 0; i < pool->count; i++) {
+			MSTickerWorker *w = &pool->workers[i];
+			ms_mutex_lock(&w->lock);
+			w->queue = (MSTickerComponent **)ms_realloc(w->queue, count * sizeof(MSTickerComponent *));
+			ms_mutex_unlock(&w->lock);
+		}
+		pool->capacity = count;
+	}
+	/* a worker late from the previous tick may already steal components while they are queued: the tick must be
+	 * set up before */
+	ms_mutex_lock(&pool->lock);
+	pool->pending = count;
+	ms_get_cur_time(&pool->tick_begin);
+	ms_mutex_unlock(&pool->lock);
+	for (it = s->components, i = 0; it != NULL; it = it->next, i++) {
+		MSTickerWorker *w = &pool->workers[i % pool->count];
+		ms_mutex_lock(&w->lock);
+		if (i < pool->count) w->head = w->tail = 0;
+		w->queue[w->tail++] = (MSTickerComponent *)it->data;
+		ms_mutex_unlock(&w->lock);
+	}
+	ms_mutex_lock(&pool->lock);
+	pool->generation++;
+	ms_cond_broadcast(&pool->cond);
+	ms_mutex_unlock(&pool->lock);
+
+	ms_ticker_worker_run_components(pool, 0);
+
+	ms_mutex_lock(&pool->lock);
+	while (pool->pending > 0)
+		ms_cond_wait(&pool->done_cond, &pool->lock);
+	ms_mutex_unlock(&pool->lock);
+	log_late_components(s);
+}
+
+/*
+ * Profiling: every filter instance run while the profiler is enabled gets an entry with its timing statistics. The
+ * processing times are accumulated in a log-linear histogram (8 buckets per power of two) from which the percentiles
+ * are computed. The filter calls of the current tick are also logged, and the log of the slowest ticks kept aside in
+ * a flight recorder, so that the cause of a late tick can be found afterwards.
+ * Entries are updated by the thread running the filter, which only ever runs one filter at a time, while the tick log
+ * and the list of entries, that are shared by the worker threads, are protected by the profiler's lock.
+ */
+
+#define PROFILER_SUB_BUCKET_BITS 3
+#define PROFILER_SUB_BUCKETS (1 << PROFILER_SUB_BUCKET_BITS)
+#define PROFILER_MAX_EXPONENT 40 /* about 18 minutes, in nanoseconds */
+#define PROFILER_BUCKETS ((PROFILER_MAX_EXPONENT - PROFILER_SUB_BUCKET_BITS + 1) * PROFILER_SUB_BUCKETS)
+#define PROFILER_SLOW_TICKS 16       /* number of ticks kept by the flight recorder */
+#define PROFILER_TICK_MAX_EVENTS 512 /* number of filter calls logged per tick */
+
+#define PROFILER_MAX_THREADS 64      /* number of threads told apart in the reports */
+
+typedef struct _MSTickerProfilerEntry {
+	MSFilterProfile profile;
+	const char *graph_name; /* the name of the graph source, which may be destroyed first */
+	uint32_t histogram[PROFILER_BUCKETS];
+} MSTickerProfilerEntry;
+
+typedef struct _MSTickerProfilerEvent {
+	MSFilter *filter;
+	const char *name;
+	uint64_t begin_ns; /* since the beginning of the tick */
+	uint64_t duration_ns;
+	unsigned long thread_id;
+} MSTickerProfilerEvent;
+
+typedef struct _MSTickerProfilerTick {
+	uint32_t tick;
+	MSTimeSpec begin;
+	uint64_t duration_ns;
+	MSTickerProfilerEvent *events; /* PROFILER_TICK_MAX_EVENTS of them */
+	int event_count;
+	int dropped_events; /* not logged for lack of room */
+} MSTickerProfilerTick;
+
+typedef struct _MSTickerProfiler {
+	ms_mutex_t lock;
+	bctbx_list_t *entries;
+	uint64_t tick_count;
+	MSTickerProfilerTick current;
+	MSTickerProfilerTick slowest[PROFILER_SLOW_TICKS];
+	int slowest_count;
+} MSTickerProfiler;
+
+static uint64_t get_elapsed_ns(const MSTimeSpec *begin, const MSTimeSpec *end) {
+	return (uint64_t)((end->tv_sec - begin->tv_sec) * 1000000000LL + (end->tv_nsec - begin->tv_nsec));
+}
+
+static int profiler_bucket(uint64_t ns) {
+	int exponent = PROFILER_SUB_BUCKET_BITS;
+
+	if (ns < PROFILER_SUB_BUCKETS) return (int)ns;
+	if (ns >> PROFILER_MAX_EXPONENT) return PROFILER_BUCKETS - 1;
+	while (ns >> (exponent + 1))
+		exponent++;
+	return (exponent - PROFILER_SUB_BUCKET_BITS + 1) * PROFILER_SUB_BUCKETS +
+	       (int)((ns >> (exponent - PROFILER_SUB_BUCKET_BITS)) & (PROFILER_SUB_BUCKETS - 1));
+}
+
+/* the highest value falling in a bucket */
+static uint64_t profiler_bucket_limit(int bucket) {
+	int shift = bucket / PROFILER_SUB_BUCKETS - 1;
+	uint64_t mantissa = PROFILER_SUB_BUCKETS + bucket % PROFILER_SUB_BUCKETS;
+
+	if (shift < 0) return (uint64_t)bucket;
+	return ((mantissa + 1) << shift) - 1;
+}
+
+static uint64_t profiler_entry_percentile(const MSTickerProfilerEntry *entry, double percentile) {
+	uint64_t target = (uint64_t)(entry->profile.count * percentile + 0.5);
+	uint64_t cumulated = 0;
+	int i;
+
+	for (i = 0; i < PROFILER_BUCKETS; i++) {
+		cumulated += entry->histogram[i];
+		if (cumulated >= target && cumulated > 0) {
+			uint64_t limit = profiler_bucket_limit(i);
+			return limit < entry->profile.max_ns ? limit : entry->profile.max_ns;
+		}
+	}
+	return entry->profile.max_ns;
+}
+
+static MSTickerProfiler *ms_ticker_profiler_new(void) {
+	MSTickerProfiler *profiler = ms_new0(MSTickerProfiler, 1);
+	ms_mutex_init(&profiler->lock, NULL);
+	profiler->current.events = ms_new0(MSTickerProfilerEvent, PROFILER_TICK_MAX_EVENTS);
+	return profiler;
+}
+
+static void ms_ticker_profiler_entry_destroy(MSTickerProfilerEntry *entry) {
+	entry->profile.filter->profiler_entry = NULL;
+	ms_free(entry);
+}
+
+static void ms_ticker_profiler_reset(MSTickerProfiler *profiler) {
+	bctbx_list_t *it;
+	int i;
+
+	for (it = profiler->entries; it != NULL; it = it->next) {
+		MSTickerProfilerEntry *entry = (MSTickerProfilerEntry *)it->data;
+		entry->profile.count = entry->profile.total_ns = entry->profile.max_ns = 0;
+		memset(entry->histogram, 0, sizeof(entry->histogram));
+	}
+	for (i = 0; i < profiler->slowest_count; i++) {
+		profiler->slowest[i].event_count = 0;
+		profiler->slowest[i].duration_ns = 0;
+	}
+	profiler->slowest_count = 0;
+	profiler->tick_count = 0;
+}
+
+static void ms_ticker_profiler_destroy(MSTickerProfiler *profiler) {
+	int i;
+
+	bctbx_list_free_with_data(profiler->entries, (bctbx_list_free_func)ms_ticker_profiler_entry_destroy);
+	for (i = 0; i < PROFILER_SLOW_TICKS; i++) {
+		if (profiler->slowest[i].events) ms_free(profiler->slowest[i].events);
+	}
+	ms_free(profiler->current.events);
+	ms_mutex_destroy(&profiler->lock);
+	ms_free(profiler);
+}
+
+/* to be called with the ticker's lock, when the filter leaves the ticker */
+static void ms_ticker_profiler_remove_filter(MSTickerProfiler *profiler, MSFilter *f) {
+	MSTickerProfilerEntry *entry = f->profiler_entry;
+
+	if (entry == NULL) return;
+	profiler->entries = bctbx_list_remove(profiler->entries, entry);
+	ms_ticker_profiler_entry_destroy(entry);
+}
+
+static void ms_ticker_profiler_begin_tick(MSTickerProfiler *profiler, uint32_t tick) {
+	profiler->current.tick = tick;
+	profiler->current.event_count = 0;
+	profiler->current.dropped_events = 0;
+	ms_get_cur_time(&profiler->current.begin);
+}
+
+/* keeps the log of the tick that has just ended if it is one of the slowest */
+static void ms_ticker_profiler_end_tick(MSTickerProfiler *profiler) {
+	MSTickerProfilerTick *slot = NULL;
+	MSTickerProfilerEvent *events;
+	MSTimeSpec end;
+	int i;
+
+	ms_get_cur_time(&end);
+	profiler->current.duration_ns = get_elapsed_ns(&profiler->current.begin, &end);
+	profiler->tick_count++;
+	if (profiler->slowest_count < PROFILER_SLOW_TICKS) {
+		slot = &profiler->slowest[profiler->slowest_count++];
+	} else {
+		for (i = 0; i < PROFILER_SLOW_TICKS; i++) {
+			if (slot == NULL || profiler->slowest[i].duration_ns < slot->duration_ns) slot = &profiler->slowest[i];
+		}
+		if (slot->duration_ns >= profiler->current.duration_ns) return;
+	}
+	/* the logs are swapped, not copied */
+	events = slot->events ? slot->events : ms_new0(MSTickerProfilerEvent, PROFILER_TICK_MAX_EVENTS);
+	*slot = profiler->current;
+	profiler->current.events = events;
+}
+
+void ms_ticker_profiler_record(MSFilter *f, const MSTimeSpec *begin, const MSTimeSpec *end) {
+	MSTickerProfiler *profiler = f->ticker->profiler;
+	MSTickerProfilerEntry *entry = f->profiler_entry;
+	uint64_t elapsed = get_elapsed_ns(begin, end);
+
+	if (entry == NULL) {
+		entry = ms_new0(MSTickerProfilerEntry, 1);
+		entry->profile.filter = f;
+		entry->profile.name = f->desc->name;
+		entry->profile.graph_source = profiled_graph_source;
+		entry->graph_name = profiled_graph_source ? profiled_graph_source->desc->name : "";
+		f->profiler_entry = entry;
+		ms_mutex_lock(&profiler->lock);
+		profiler->entries = bctbx_list_append(profiler->entries, entry);
+		ms_mutex_unlock(&profiler->lock);
+	}
+	entry->profile.count++;
+	entry->profile.total_ns += elapsed;
+	if (elapsed > entry->profile.max_ns) entry->profile.max_ns = elapsed;
+	entry->histogram[profiler_bucket(elapsed)]++;
+
+	ms_mutex_lock(&profiler->lock);
+	if (profiler->current.event_count < PROFILER_TICK_MAX_EVENTS) {
+		MSTickerProfilerEvent *ev = &profiler->current.events[profiler->current.event_count++];
+		ev->filter = f;
+		ev->name = f->desc->name;
+		ev->begin_ns = get_elapsed_ns(&profiler->current.begin, begin);
+		ev->duration_ns = elapsed;
+		ev->thread_id = ms_thread_self();
+	} else {
+		profiler->current.dropped_events++;
+	}
+	ms_mutex_unlock(&profiler->lock);
+}
+
+static int ms_ticker_profiler_get_profiles(MSTickerProfiler *profiler, MSFilterProfile *profiles, int max_count) {
+	bctbx_list_t *it;
+	int count = 0;
+
+	for (it = profiler->entries; it != NULL; it = it->next, count++) {
+		MSTickerProfilerEntry *entry = (MSTickerProfilerEntry *)it->data;
+		if (count < max_count) {
+			profiles[count] = entry->profile;
+			profiles[count].p99_ns = profiler_entry_percentile(entry, 0.99);
+		}
+	}
+	return count;
+}
+
+static char *json_strcat_string(char *report, const char *str) {
+	report = ms_strcat_printf(report, "\"");
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\') report = ms_strcat_printf(report, "\\%c", *str);
+		else if ((unsigned char)*str < 0x20) report = ms_strcat_printf(report, "\\u%04x", (unsigned int)*str);
+		else report = ms_strcat_printf(report, "%c", *str);
+	}
+	return ms_strcat_printf(report, "\"");
+}
+
+static int compare_entries_by_total(const void *a, const void *b) {
+	uint64_t ta = (*(MSTickerProfilerEntry *const *)a)->profile.total_ns;
+	uint64_t tb = (*(MSTickerProfilerEntry *const *)b)->profile.total_ns;
+	return ta < tb ? 1 : (ta > tb ? -1 : 0);
+}
+
+static int compare_ticks_by_duration(const void *a, const void *b) {
+	uint64_t da = (*(MSTickerProfilerTick *const *)a)->duration_ns;
+	uint64_t db = (*(MSTickerProfilerTick *const *)b)->duration_ns;
+	return da < db ? 1 : (da > db ? -1 : 0);
+}
+
+/* the slowest ticks, the slowest first */
+static int get_slowest_ticks(MSTickerProfiler *profiler, MSTickerProfilerTick **ticks) {
+	int i;
+	for (i = 0; i < profiler->slowest_count; i++)
+		ticks[i] = &profiler->slowest[i];
+	qsort(ticks, profiler->slowest_count, sizeof(MSTickerProfilerTick *), compare_ticks_by_duration);
+	return profiler->slowest_count;
+}
+
+/* numbers the threads seen in the logs, the ticker thread being 0 */
+static int get_thread_index(unsigned long *threads, int *thread_count, unsigned long thread_id) {
+	int i;
+	for (i = 0; i < *thread_count; i++) {
+		if (threads[i] == thread_id) return i;
+	}
+	if (*thread_count == PROFILER_MAX_THREADS) return PROFILER_MAX_THREADS - 1;
+	threads[*thread_count] = thread_id;
+	return (*thread_count)++;
+}
+
+static char *ms_ticker_profiler_to_json(MSTicker *ticker, MSTickerProfiler *profiler) {
+	MSTickerProfilerTick *ticks[PROFILER_SLOW_TICKS];
+	int count = (int)bctbx_list_size(profiler->entries);
+	MSTickerProfilerEntry **entries = ms_new0(MSTickerProfilerEntry *, count > 0 ? count : 1);
+	unsigned long threads[PROFILER_MAX_THREADS];
+	int thread_count = 0;
+	int tick_count;
+	bctbx_list_t *it;
+	char *report;
+	int i, j;
+
+	get_thread_index(threads, &thread_count, ticker->thread_id);
+	for (it = profiler->entries, i = 0; it != NULL; it = it->next, i++)
+		entries[i] = (MSTickerProfilerEntry *)it->data;
+	qsort(entries, count, sizeof(MSTickerProfilerEntry *), compare_entries_by_total);
+
+	report = ms_strdup("{\"ticker\":");
+	report = json_strcat_string(report, ticker->name);
+	report = ms_strcat_printf(report, ",\"interval_ms\":%i,\"ticks\":%llu,\"filters\":[", ticker->interval,
+	                          (unsigned long long)profiler->tick_count);
+	for (i = 0; i < count; i++) {
+		const MSFilterProfile *p = &entries[i]->profile;
+		report = ms_strcat_printf(report, "%s{\"filter\":\"%p\",\"name\":", i > 0 ? "," : "", p->filter);
+		report = json_strcat_string(report, p->name);
+		report = ms_strcat_printf(report, ",\"graph\":\"%p\",\"graph_name\":", p->graph_source);
+		report = json_strcat_string(report, entries[i]->graph_name);
+		report = ms_strcat_printf(
+		    report, ",\"count\":%llu,\"total_us\":%.1f,\"mean_us\":%.1f,\"max_us\":%.1f,\"p99_us\":%.1f}",
+		    (unsigned long long)p->count, p->total_ns / 1000.0, p->count ? p->total_ns / 1000.0 / p->count : 0.0,
+		    p->max_ns / 1000.0, profiler_entry_percentile(entries[i], 0.99) / 1000.0);
+	}
+	report = ms_strcat_printf(report, "],\"slowest_ticks\":[");
+	tick_count = get_slowest_ticks(profiler, ticks);
+	for (i = 0; i < tick_count; i++) {
+		MSTickerProfilerTick *t = ticks[i];
+		report = ms_strcat_printf(report,
+		                          "%s{\"tick\":%u,\"duration_us\":%.1f,\"late\":%s,\"dropped_events\":%i,\"filters\":[",
+		                          i > 0 ? "," : "", t->tick, t->duration_ns / 1000.0,
+		                          t->duration_ns > (uint64_t)ticker->interval * 1000000ULL ? "true" : "false",
+		                          t->dropped_events);
+		for (j = 0; j < t->event_count; j++) {
+			MSTickerProfilerEvent *ev = &t->events[j];
+			report = ms_strcat_printf(report, "%s{\"filter\":\"%p\",\"name\":", j > 0 ? "," : "", ev->filter);
+			report = json_strcat_string(report, ev->name);
+			report = ms_strcat_printf(report, ",\"start_us\":%.1f,\"duration_us\":%.1f,\"thread\":%i}",
+			                          ev->begin_ns / 1000.0, ev->duration_ns / 1000.0,
+			                          get_thread_index(threads, &thread_count, ev->thread_id));
+		}
+		report = ms_strcat_printf(report, "]}");
+	}
+	report = ms_strcat_printf(report, "]}");
+	ms_free(entries);
+	return report;
+}
+
+static char *ms_ticker_profiler_to_chrome_trace(MSTicker *ticker, MSTickerProfiler *profiler) {
+	MSTickerProfilerTick *ticks[PROFILER_SLOW_TICKS];
+	unsigned long threads[PROFILER_MAX_THREADS];
+	int thread_count = 0;
+	int tick_count;
+	char *report;
+	int i, j;
+
+	get_thread_index(threads, &thread_count, ticker->thread_id);
+	report = ms_strdup("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+	                   "\"args\":{\"name\":");
+	report = json_strcat_string(report, ticker->name);
+	report = ms_strcat_printf(report, "}}");
+	tick_count = get_slowest_ticks(profiler, ticks);
+	for (i = 0; i < tick_count; i++) {
+		MSTickerProfilerTick *t = ticks[i];
+		double begin_us = t->begin.tv_sec * 1000000.0 + t->begin.tv_nsec / 1000.0;
+
+		report = ms_strcat_printf(report,
+		                          ",{\"name\":\"tick %u\",\"cat\":\"tick\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+		                          "\"pid\":1,\"tid\":0,\"args\":{\"dropped_events\":%i}}",
+		                          t->tick, begin_us, t->duration_ns / 1000.0, t->dropped_events);
+		for (j = 0; j < t->event_count; j++) {
+			MSTickerProfilerEvent *ev = &t->events[j];
+			report = ms_strcat_printf(report, ",{\"name\":");
+			report = json_strcat_string(report, ev->name);
+			report = ms_strcat_printf(report,
+			                          ",\"cat\":\"filter\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%i,"
+			                          "\"args\":{\"filter\":\"%p\"}}",
+			                          begin_us + ev->begin_ns / 1000.0, ev->duration_ns / 1000.0,
+			                          get_thread_index(threads, &thread_count, ev->thread_id), ev->filter);
+		}
+	}
+	return ms_strcat_printf(report, "]}");
+}
+
+static bool_t runs_in_current_thread(MSTicker *ticker) {
+	return ms_thread_self() == ticker->thread_id || worker_ticker == ticker;
+}
+
 /*the ticker thread function that executes the filters */
 void *ms_ticker_run(void *arg) {
 	MSTicker *s = (MSTicker *)arg;
@@ -481,8 +1163,12 @@ void *ms_ticker_run(void *arg) {
 
 			ms_get_cur_time(&begin);
 #endif
+			if (s->profiler) ms_ticker_profiler_begin_tick(s->profiler, s->ticks);
 			run_tasks(s);
-			run_graphs(s, s->execution_list, FALSE);
+			update_worker_pool(s);
+			if (s->workers) run_components(s);
+			else run_graphs(s, s->execution_list, FALSE);
+			if (s->profiler) ms_ticker_profiler_end_tick(s->profiler);
 #if TICKER_MEASUREMENTS
 			ms_get_cur_time(&end);
 			iload = 100 * ((end.tv_sec - begin.tv_sec) * 1000.0 + (end.tv_nsec - begin.tv_nsec) / 1000000.0) /
@@ -514,6 +1200,10 @@ void *ms_ticker_run(void *arg) {
 		}
 		s->late_event.current_late_ms = late;
 	}
+	if (s->workers) {
+		ms_ticker_worker_pool_destroy(s->workers);
+		s->workers = NULL;
+	}
 	ms_mutex_unlock(&s->lock);
 	unset_high_prio(precision);
 	ms_message("%s thread exiting", s->name);
@@ -605,12 +1295,83 @@ float ms_ticker_get_average_load(MSTicker *ticker) {
 }
 
 void ms_ticker_get_last_late_tick(MSTicker *ticker, MSTickerLateEvent *ev) {
-	bool_t need_lock = ms_thread_self() != ticker->thread_id;
+	bool_t need_lock = !runs_in_current_thread(ticker);
 	if (need_lock) ms_mutex_lock(&ticker->lock);
 	memcpy(ev, &ticker->late_event, sizeof(MSTickerLateEvent));
 	if (need_lock) ms_mutex_unlock(&ticker->lock);
 }
 
+void ms_ticker_set_worker_count(MSTicker *ticker, int count) {
+	if (count < 0) count = 0;
+	ms_mutex_lock(&ticker->lock);
+	ticker->worker_count = count;
+	ms_mutex_unlock(&ticker->lock);
+}
+
+int ms_ticker_get_component_stats(MSTicker *ticker, MSTickerComponentStats *stats, int max_count) {
+	bool_t need_lock = !runs_in_current_thread(ticker);
+	bctbx_list_t *it;
+	int count = 0;
+
+	if (need_lock) ms_mutex_lock(&ticker->lock);
+	for (it = ticker->components; it != NULL; it = it->next, count++) {
+		if (count < max_count) stats[count] = ((MSTickerComponent *)it->data)->stats;
+	}
+	if (need_lock) ms_mutex_unlock(&ticker->lock);
+	return count;
+}
+
+void ms_ticker_enable_profiling(MSTicker *ticker, bool_t enabled) {
+	bool_t need_lock = !runs_in_current_thread(ticker);
+
+	if (need_lock) ms_mutex_lock(&ticker->lock);
+	if (enabled && ticker->profiler == NULL) {
+		ticker->profiler = ms_ticker_profiler_new();
+		ms_message("%s: filter profiling enabled.", ticker->name);
+	} else if (!enabled && ticker->profiler != NULL) {
+		ms_ticker_profiler_destroy(ticker->profiler);
+		ticker->profiler = NULL;
+		ms_message("%s: filter profiling disabled.", ticker->name);
+	}
+	if (need_lock) ms_mutex_unlock(&ticker->lock);
+}
+
+bool_t ms_ticker_profiling_enabled(MSTicker *ticker) {
+	return ticker->profiler != NULL;
+}
+
+void ms_ticker_reset_profiling(MSTicker *ticker) {
+	bool_t need_lock = !runs_in_current_thread(ticker);
+
+	if (need_lock) ms_mutex_lock(&ticker->lock);
+	if (ticker->profiler) ms_ticker_profiler_reset(ticker->profiler);
+	if (need_lock) ms_mutex_unlock(&ticker->lock);
+}
+
+int ms_ticker_get_filter_profiles(MSTicker *ticker, MSFilterProfile *profiles, int max_count) {
+	bool_t need_lock = !runs_in_current_thread(ticker);
+	int count = 0;
+
+	if (need_lock) ms_mutex_lock(&ticker->lock);
+	if (ticker->profiler) count = ms_ticker_profiler_get_profiles(ticker->profiler, profiles, max_count);
+	if (need_lock) ms_mutex_unlock(&ticker->lock);
+	return count;
+}
+
+char *ms_ticker_get_profiling_report(MSTicker *ticker, MSTickerProfileFormat format) {
+	bool_t need_lock = !runs_in_current_thread(ticker);
+	char *report = NULL;
+
+	if (need_lock) ms_mutex_lock(&ticker->lock);
+	if (ticker->profiler) {
+		if (format == MS_TICKER_PROFILE_CHROME_TRACE)
+			report = ms_ticker_profiler_to_chrome_trace(ticker, ticker->profiler);
+		else report = ms_ticker_profiler_to_json(ticker, ticker->profiler);
+	}
+	if (need_lock) ms_mutex_unlock(&ticker->lock);
+	return report;
+}
+
 static void ms_ticker_synchronizer_reset(MSTickerSynchronizer *ts) {
 	memset(ts, 0, sizeof(*ts));
 }
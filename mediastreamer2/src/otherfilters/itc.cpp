@@ -18,16 +18,33 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+
 #include "mediastreamer2/msitc.h"
 
+/* Must be a power of two, so that the indexes of the ring can wrap around. */
+#define ITC_QUEUE_SIZE 256
+
+/*
+ * The buffers go from the sink to the source through a bounded ring. The sink's ticker is the single producer: only it
+ * writes the tail. The source's ticker is the single consumer: only it writes the head. The producer never waits for
+ * the consumer. The consumer drains the ring under the mutex that protects the connection state, so that a source
+ * being replaced by another one cannot consume at the same time as the new one; the mutex is otherwise only taken on
+ * connection changes. When the source does not consume the buffers fast enough, the ring fills up and the sink drops
+ * the new ones.
+ */
 typedef struct SharedState {
 	ms_mutex_t mutex;
 	int refcnt;
 	int rate;
 	int nchannels;
-	MSQueue q;
 	const MSFmtDescriptor *fmt;
-	MSFilter *source;
+	std::atomic<MSFilter *> source;
+	mblk_t *ring[ITC_QUEUE_SIZE];
+	alignas(64) std::atomic<unsigned int> head; /* next buffer to be read by the source */
+	alignas(64) std::atomic<unsigned int> tail; /* next slot to be written by the sink */
+	std::atomic<int> max_queued;
+	std::atomic<int> dropped;
 } SharedState;
 
 static SharedState *itc_get_shared_state(MSFilter *f) {
@@ -36,21 +53,47 @@ static SharedState *itc_get_shared_state(MSFilter *f) {
 }
 
 static SharedState *shared_state_new(void) {
-	SharedState *s = ms_new0(SharedState, 1);
+	SharedState *s = new SharedState();
 	ms_mutex_init(&s->mutex, NULL);
-	ms_queue_init(&s->q);
 	return s;
 }
 
+/* Producer side: returns FALSE if the ring is full. */
+static bool_t shared_state_put(SharedState *s, mblk_t *m) {
+	unsigned int tail = s->tail.load(std::memory_order_relaxed);
+	int queued = (int)(tail - s->head.load(std::memory_order_acquire));
+
+	if (queued == ITC_QUEUE_SIZE) return FALSE;
+	s->ring[tail & (ITC_QUEUE_SIZE - 1)] = m;
+	s->tail.store(tail + 1, std::memory_order_release);
+	if (queued + 1 > s->max_queued.load(std::memory_order_relaxed))
+		s->max_queued.store(queued + 1, std::memory_order_relaxed);
+	return TRUE;
+}
+
+/* Consumer side: moves all the buffers available to the queue q. */
+static void shared_state_get_all(SharedState *s, MSQueue *q) {
+	unsigned int head = s->head.load(std::memory_order_relaxed);
+	unsigned int tail = s->tail.load(std::memory_order_acquire);
+
+	for (; head != tail; head++) {
+		ms_queue_put(q, s->ring[head & (ITC_QUEUE_SIZE - 1)]);
+	}
+	s->head.store(head, std::memory_order_release);
+}
+
 static void shared_state_release(SharedState *s) {
 	ms_mutex_lock(&s->mutex);
 	s->refcnt--;
 	ms_mutex_unlock(&s->mutex);
 
 	if (s->refcnt == 0) {
+		unsigned int head;
 		ms_mutex_destroy(&s->mutex);
-		ms_queue_flush(&s->q);
-		ms_free(s);
+		for (head = s->head.load(); head != s->tail.load(); head++) {
+			freemsg(s->ring[head & (ITC_QUEUE_SIZE - 1)]);
+		}
+		delete s;
 	}
 }
 
@@ -141,18 +184,13 @@ static int itc_source_get_out_fmt(MSFilter *f, void *data) {
 
 static void itc_source_process(MSFilter *f) {
 	SharedState *ss;
-	mblk_t *m;
 
 	ms_filter_lock(f);
 	ss = itc_get_shared_state(f);
-
 	if (ss) {
+		/* a source replaced by another one is no longer allowed to consume */
 		ms_mutex_lock(&ss->mutex);
-		while ((m = ms_queue_get(&ss->q)) != NULL) {
-			ms_mutex_unlock(&ss->mutex);
-			ms_queue_put(f->outputs[0], m);
-			ms_mutex_lock(&ss->mutex);
-		}
+		if (ss->source.load(std::memory_order_relaxed) == f) shared_state_get_all(ss, f->outputs[0]);
 		ms_mutex_unlock(&ss->mutex);
 	}
 	ms_filter_unlock(f);
@@ -163,6 +201,8 @@ static MSFilterMethod source_methods[] = {{MS_FILTER_GET_SAMPLE_RATE, itc_source
                                           {MS_FILTER_GET_OUTPUT_FMT, itc_source_get_out_fmt},
                                           {0, NULL}};
 
+extern "C" {
+
 #ifdef _MSC_VER
 
 MSFilterDesc ms_itc_source_desc = {MS_ITC_SOURCE_ID,
@@ -194,6 +234,8 @@ MSFilterDesc ms_itc_source_desc = {.id = MS_ITC_SOURCE_ID,
 
 #endif
 
+} // extern "C"
+
 static void itc_sink_init(MSFilter *f) {
 	itc_assign(f, shared_state_new(), FALSE);
 }
@@ -221,15 +263,17 @@ static void itc_sink_process(MSFilter *f) {
 	s = itc_get_shared_state(f);
 	ms_filter_unlock(f);
 
-	ms_mutex_lock(&s->mutex);
 	while ((im = ms_queue_get(f->inputs[0])) != NULL) {
-		if (s->source == NULL) {
+		if (s->source.load(std::memory_order_relaxed) == NULL) {
+			s->dropped.fetch_add(1, std::memory_order_relaxed);
+			freemsg(im);
+		} else if (!shared_state_put(s, im)) {
+			if (s->dropped.fetch_add(1, std::memory_order_relaxed) % 100 == 0)
+				ms_warning("MSItcSink[%p]: queue to the source is full, %i buffers dropped so far.", f,
+				           s->dropped.load(std::memory_order_relaxed));
 			freemsg(im);
-		} else {
-			ms_queue_put(&s->q, im);
 		}
 	}
-	ms_mutex_unlock(&s->mutex);
 }
 
 static int itc_sink_connect(MSFilter *f, void *data) {
@@ -287,14 +331,30 @@ static int itc_sink_set_fmt(MSFilter *f, void *data) {
 	return 0;
 }
 
+static int itc_sink_get_stats(MSFilter *f, void *data) {
+	SharedState *s;
+	MSItcStats *stats = (MSItcStats *)data;
+	ms_filter_lock(f);
+	s = itc_get_shared_state(f);
+	stats->queued = (int)(s->tail.load() - s->head.load());
+	stats->max_queued = s->max_queued.load(std::memory_order_relaxed);
+	stats->dropped = s->dropped.load(std::memory_order_relaxed);
+	stats->capacity = ITC_QUEUE_SIZE;
+	ms_filter_unlock(f);
+	return 0;
+}
+
 static MSFilterMethod sink_methods[] = {{MS_ITC_SINK_CONNECT, itc_sink_connect},
                                         {MS_FILTER_SET_NCHANNELS, itc_sink_set_nchannels},
                                         {MS_FILTER_SET_SAMPLE_RATE, itc_sink_set_sr},
                                         {MS_FILTER_GET_NCHANNELS, itc_sink_get_nchannels},
                                         {MS_FILTER_GET_SAMPLE_RATE, itc_sink_get_sr},
                                         {MS_FILTER_SET_INPUT_FMT, itc_sink_set_fmt},
+                                        {MS_ITC_SINK_GET_STATS, itc_sink_get_stats},
                                         {0, NULL}};
 
+extern "C" {
+
 #ifdef _MSC_VER
 
 MSFilterDesc ms_itc_sink_desc = {MS_ITC_SINK_ID,
@@ -327,5 +387,7 @@ MSFilterDesc ms_itc_sink_desc = {.id = MS_ITC_SINK_ID,
 
 #endif
 
+} // extern "C"
+
 MS_FILTER_DESC_EXPORT(ms_itc_source_desc)
 MS_FILTER_DESC_EXPORT(ms_itc_sink_desc)
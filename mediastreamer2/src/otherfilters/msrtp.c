@@ -699,6 +699,8 @@ static void _sender_process(MSFilter *f) {
 		print_processing_delay_stats(d);
 		ms_box_plot_reset(&d->processing_delay_stats);
 	}
+	/* when send batching is enabled on the session, all the packets of this tick leave in a single system call */
+	rtp_session_flush_send_batch(s);
 	ms_filter_unlock(f);
 }
 
@@ -1088,6 +1090,8 @@ static void receiver_process(MSFilter *f) {
 			freemsg(m);
 		}
 	}
+	/* RTCP reports and feedback are sent while receiving, they must not wait for the sender, that may not run */
+	rtp_session_flush_send_batch(d->session);
 }
 
 static int get_receiver_output_fmt(MSFilter *f, void *arg) {
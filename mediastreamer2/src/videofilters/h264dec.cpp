@@ -102,7 +102,7 @@ static void dec_init(MSFilter *f) {
 		ms_error("Could not allocate frame");
 	}
 	d->regulator = NULL;
-	d->buf_allocator = ms_yuv_buf_allocator_new();
+	d->buf_allocator = ms_yuv_buf_allocator_new_with_pool(ms_factory_get_frame_pool(f->factory));
 	f->data = d;
 }
 
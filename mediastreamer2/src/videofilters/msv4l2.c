@@ -678,7 +678,7 @@ static void msv4l2_init(MSFilter *f) {
 	if (tmp != NULL && (strcmp("1", tmp) == 0)) {
 		s->use_rotation = TRUE;
 		s->rotation = 0;
-		s->buf_allocator = ms_yuv_buf_allocator_new();
+		s->buf_allocator = ms_yuv_buf_allocator_new_with_pool(ms_factory_get_frame_pool(f->factory));
 	} else {
 		s->use_rotation = FALSE;
 	}
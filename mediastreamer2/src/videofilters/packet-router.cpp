@@ -21,6 +21,7 @@
 #include "packet-router.h"
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #ifdef AV1_ENABLED
@@ -272,6 +273,39 @@ void RouterOutput::configure(const MSPacketRouterPinData *pinData) {
 	std::copy(std::begin(pinData->extension_ids), std::end(pinData->extension_ids), std::begin(mExtensionIds));
 }
 
+/*
+ * Returns the packet to put on this output's queue. The same input packet is forwarded to many outputs: its payload is
+ * shared between them by reference (dupb), never copied. In full packet mode the RTP header is rewritten per output,
+ * here (extension ids) and by the RtpSession in transfer mode (sequence number, payload type), so each output gets a
+ * private copy of the header, followed by a reference to the payload. Non full packets only carry the payload, which
+ * is left untouched as everything to rewrite is in the mblk_t itself.
+ */
+mblk_t *RouterOutput::forwardPacket(mblk_t *source) const {
+	if (!mRouter->isFullPacketModeEnabled()) return dupmsg(source);
+
+	size_t size = (size_t)(source->b_wptr - source->b_rptr);
+	if (size < RTP_FIXED_HEADER_SIZE) return copymsg(source);
+
+	size_t headerSize = RTP_FIXED_HEADER_SIZE + (size_t)rtp_get_cc(source) * 4;
+	if (rtp_get_extbit(source)) {
+		int extSize = rtp_get_extheader(source, nullptr, nullptr);
+		if (extSize < 0) return copymsg(source);
+		headerSize += 4 + (size_t)extSize;
+	}
+	// The header must lie in the first block, with some payload behind it.
+	if (headerSize >= size) return copymsg(source);
+
+	mblk_t *header = allocb(headerSize, 0);
+	mblk_meta_copy(source, header);
+	memcpy(header->b_wptr, source->b_rptr, headerSize);
+	header->b_wptr += headerSize;
+
+	header->b_cont = dupmsg(source);
+	header->b_cont->b_rptr += headerSize;
+
+	return header;
+}
+
 void RouterOutput::rewritePacketInformation(mblk_t *source, mblk_t *output) {
 	if (mblk_get_timestamp_info(source) != mOutTimestamp) {
 		if (mRouter->getRoutingMode() == PacketRouter::RoutingMode::Video) {
@@ -336,7 +370,7 @@ void RouterAudioOutput::transfer() {
 					for (mblk_t *m = ms_queue_peek_first(inputQueue); !ms_queue_end(inputQueue, m);
 					     m = ms_queue_peek_next(inputQueue, m)) {
 
-						mblk_t *o = copymsg(m);
+						mblk_t *o = forwardPacket(m);
 
 						if (!mRouter->isFullPacketModeEnabled()) {
 							rewritePacketInformation(m, o);
@@ -393,7 +427,7 @@ void RouterVideoOutput::transfer() {
 			mblk_t *start = input->mKeyFrameStart ? input->mKeyFrameStart : ms_queue_peek_first(inputQueue);
 
 			for (mblk_t *m = start; !ms_queue_end(inputQueue, m); m = ms_queue_peek_next(inputQueue, m)) {
-				mblk_t *o = copymsg(m);
+				mblk_t *o = forwardPacket(m);
 
 				// Only re-write packet information if full packet mode is disabled
 				if (!mRouter->isFullPacketModeEnabled()) {
@@ -421,7 +455,8 @@ void RouterInputAudioSelector::select() {
 	mSelected.clear();
 
 	if (mRouter->isFullPacketModeEnabled()) {
-		auto speakers = vector<RouterAudioInput *>{};
+		auto &speakers = mSpeakers;
+		speakers.clear();
 
 		// If only two, select them anyway to always have audio.
 		const int activeParticipants = mRouter->getRouterActiveInputs();
@@ -447,12 +482,12 @@ void RouterInputAudioSelector::select() {
 		}
 
 		if (activeParticipants > 2 && !speakers.empty()) {
-			// Sort by descending volume order
-			// Keep the first MAX_SPEAKER_AT_ONCE speakers
-			if (speakers.size() > PacketRouter::MAX_SPEAKER_AT_ONCE) {
-				std::sort(speakers.begin(), speakers.end(), [](auto a, auto b) { return a->mVolume > b->mVolume; });
-				speakers.resize(PacketRouter::MAX_SPEAKER_AT_ONCE);
-			}
+			// Keep the loudest speakers only, sorted by descending volume order. The others are not forwarded, so
+			// that the clients never have more than this number of streams to decode, whatever the room size.
+			const size_t maxSpeakers = std::min(speakers.size(), static_cast<size_t>(mRouter->getMaxSpeakers()));
+			std::partial_sort(speakers.begin(), speakers.begin() + maxSpeakers, speakers.end(),
+			                  [](auto a, auto b) { return a->mVolume > b->mVolume; });
+			speakers.resize(maxSpeakers);
 
 			// Keep the pin of the active speaker which is the front of the vector
 			mActiveSpeakerPin = speakers.front()->getPin();
@@ -678,38 +713,33 @@ bool PacketRouter::isEndToEndEncryptionEnabled() const {
 	return mEndToEndEncryptionEnabled;
 }
 
+// These are called for each input or output at each tick: the log context is only built when there is an error.
 RouterInput *PacketRouter::getRouterInput(int index) const {
-	PackerRouterLogContextualizer prlc(this);
-
 	if (index < 0 || (size_t)index > ROUTER_MAX_INPUT_CHANNELS) {
 		return nullptr;
 	}
 
-	try {
-		const auto &input = mInputs.at(index);
-		return input != nullptr ? input.get() : nullptr;
-	} catch (const std::out_of_range &) {
+	if ((size_t)index >= mInputs.size()) {
+		PackerRouterLogContextualizer prlc(this);
 		ms_error("Trying to get router input on un-existing pin");
+		return nullptr;
 	}
 
-	return nullptr;
+	return mInputs[index].get();
 }
 
 RouterOutput *PacketRouter::getRouterOutput(int index) const {
-	PackerRouterLogContextualizer prlc(this);
-
-	if (index < 0 || (size_t)index > mOutputs.size()) {
+	if (index < 0) {
 		return nullptr;
 	}
 
-	try {
-		const auto &output = mOutputs.at(index);
-		return output != nullptr ? output.get() : nullptr;
-	} catch (const std::out_of_range &) {
+	if ((size_t)index >= mOutputs.size()) {
+		PackerRouterLogContextualizer prlc(this);
 		ms_error("Trying to get router output on un-existing pin");
+		return nullptr;
 	}
 
-	return nullptr;
+	return mOutputs[index].get();
 }
 
 RouterInputSelector *PacketRouter::getRouterInputSelector() const {
@@ -827,6 +857,16 @@ int PacketRouter::getActiveSpeakerPin() const {
 	return -1;
 }
 
+void PacketRouter::setMaxSpeakers(int maxSpeakers) {
+	PackerRouterLogContextualizer prlc(this);
+	ms_message("Forwarding at most %d speakers at once", maxSpeakers);
+	mMaxSpeakers = maxSpeakers;
+}
+
+int PacketRouter::getMaxSpeakers() const {
+	return mMaxSpeakers;
+}
+
 #ifdef VIDEO_ENABLED
 void PacketRouter::setFocus(int pin) {
 	PackerRouterLogContextualizer prlc(this);
@@ -1075,6 +1115,23 @@ int PacketRouterFilterWrapper::onGetActiveSpeakerPin(MSFilter *f, void *arg) {
 	}
 }
 
+int PacketRouterFilterWrapper::onSetMaxSpeakers(MSFilter *f, void *arg) {
+	try {
+		int maxSpeakers = *static_cast<int *>(arg);
+		if (maxSpeakers <= 0) {
+			ms_error("PacketRouter: Invalid argument to MS_PACKET_ROUTER_SET_MAX_SPEAKERS");
+			return -1;
+		}
+
+		ms_filter_lock(f);
+		static_cast<PacketRouter *>(f->data)->setMaxSpeakers(maxSpeakers);
+		ms_filter_unlock(f);
+		return 0;
+	} catch (const PacketRouter::MethodCallFailed &) {
+		return -1;
+	}
+}
+
 #ifdef VIDEO_ENABLED
 int PacketRouterFilterWrapper::onSetFocus(MSFilter *f, void *arg) {
 	try {
@@ -1201,6 +1258,7 @@ static MSFilterMethod MS_FILTER_WRAPPER_METHODS_NAME(PacketRouter)[] = {
     {MS_PACKET_ROUTER_UNCONFIGURE_OUTPUT, PacketRouterFilterWrapper::onUnconfigureOutput},
     {MS_PACKET_ROUTER_SET_AS_LOCAL_MEMBER, PacketRouterFilterWrapper::onSetAsLocalMember},
     {MS_PACKET_ROUTER_GET_ACTIVE_SPEAKER_PIN, PacketRouterFilterWrapper::onGetActiveSpeakerPin},
+    {MS_PACKET_ROUTER_SET_MAX_SPEAKERS, PacketRouterFilterWrapper::onSetMaxSpeakers},
 #ifdef VIDEO_ENABLED
     {MS_PACKET_ROUTER_SET_FOCUS, PacketRouterFilterWrapper::onSetFocus},
     {MS_PACKET_ROUTER_NOTIFY_PLI, PacketRouterFilterWrapper::onNotifyPli},
@@ -129,6 +129,7 @@ public:
 	}
 
 protected:
+	mblk_t *forwardPacket(mblk_t *source) const;
 	void rewritePacketInformation(mblk_t *source, mblk_t *output);
 	void rewriteExtensionIds(mblk_t *output, int inputIds[16], int outputIds[16]);
 
@@ -204,6 +205,9 @@ protected:
 	// We use a set to ease selection and avoid sending duplicates
 	std::set<RouterAudioInput *> mSelected{};
 
+	// The inputs with voice activity, kept to avoid reallocating it at each tick
+	std::vector<RouterAudioInput *> mSpeakers{};
+
 	int mActiveSpeakerPin = -1;
 };
 
@@ -270,6 +274,9 @@ public:
 	// Audio mode only
 	int getActiveSpeakerPin() const;
 
+	void setMaxSpeakers(int maxSpeakers);
+	int getMaxSpeakers() const;
+
 	// Video mode only
 #ifdef VIDEO_ENABLED
 	void setFocus(int pin);
@@ -291,6 +298,8 @@ protected:
 	bool mFullPacketMode = false;
 	bool mEndToEndEncryptionEnabled = false;
 
+	int mMaxSpeakers = MAX_SPEAKER_AT_ONCE;
+
 	std::unique_ptr<RouterInputSelector> mSelector = nullptr;
 
 	std::vector<std::unique_ptr<RouterInput>> mInputs{};
@@ -317,6 +326,7 @@ public:
 	static int onSetAsLocalMember(MSFilter *f, void *arg);
 
 	static int onGetActiveSpeakerPin(MSFilter *f, void *arg);
+	static int onSetMaxSpeakers(MSFilter *f, void *arg);
 
 #ifdef VIDEO_ENABLED
 	static int onSetFocus(MSFilter *f, void *arg);
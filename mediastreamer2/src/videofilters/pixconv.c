@@ -29,6 +29,7 @@ typedef struct PixConvState {
 	YuvBuf outbuf;
 	MSYuvBufAllocator *allocator;
 	MSScalerContext *scaler;
+	MSVideoSize scaler_size; /* size the scaler was created for */
 	MSVideoSize size;
 	MSPixFmt in_fmt;
 	MSPixFmt out_fmt;
@@ -36,7 +37,7 @@ typedef struct PixConvState {
 
 static void pixconv_init(MSFilter *f) {
 	PixConvState *s = ms_new0(PixConvState, 1);
-	s->allocator = ms_yuv_buf_allocator_new();
+	s->allocator = ms_yuv_buf_allocator_new_with_pool(ms_factory_get_frame_pool(f->factory));
 	s->size.width = MS_VIDEO_SIZE_CIF_W;
 	s->size.height = MS_VIDEO_SIZE_CIF_H;
 	s->in_fmt = MS_YUV420P;
@@ -65,23 +66,31 @@ static void pixconv_process(MSFilter *f) {
 
 	while ((im = ms_queue_get(f->inputs[0])) != NULL) {
 		uint32_t frame_ts = mblk_get_timestamp_info(im);
+		om = NULL;
 		if (s->in_fmt == s->out_fmt) {
 			om = im;
 		} else {
 			MSPicture inbuf;
 			if (ms_picture_init_from_mblk_with_size(&inbuf, im, s->in_fmt, s->size.width, s->size.height) == 0) {
-				om = pixconv_alloc_mblk(s);
+				if (s->scaler != NULL && !ms_video_size_equal(s->scaler_size, s->size)) {
+					ms_scaler_context_free(s->scaler);
+					s->scaler = NULL;
+				}
 				if (s->scaler == NULL) {
 					s->scaler = ms_scaler_create_context(inbuf.w, inbuf.h, s->in_fmt, inbuf.w, inbuf.h, s->out_fmt,
 					                                     MS_SCALER_METHOD_BILINEAR);
+					s->scaler_size = s->size;
 				}
-				if (s->in_fmt == MS_RGB24_REV) {
-					inbuf.planes[0] += inbuf.strides[0] * (inbuf.h - 1);
-					inbuf.strides[0] = -inbuf.strides[0];
-				}
-				if (ms_scaler_process(s->scaler, inbuf.planes, inbuf.strides, s->outbuf.planes, s->outbuf.strides) <
-				    0) {
-					ms_error("MSPixConv: Error in ms_sws_scale().");
+				if (s->scaler != NULL) om = pixconv_alloc_mblk(s);
+				if (om != NULL) {
+					if (s->in_fmt == MS_RGB24_REV) {
+						inbuf.planes[0] += inbuf.strides[0] * (inbuf.h - 1);
+						inbuf.strides[0] = -inbuf.strides[0];
+					}
+					if (ms_scaler_process(s->scaler, inbuf.planes, inbuf.strides, s->outbuf.planes,
+					                      s->outbuf.strides) < 0) {
+						ms_error("MSPixConv: Error in ms_sws_scale().");
+					}
 				}
 			}
 			freemsg(im);
@@ -102,6 +111,10 @@ static int pixconv_set_vsize(MSFilter *f, void *arg) {
 static int pixconv_set_pixfmt(MSFilter *f, void *arg) {
 	MSPixFmt fmt = *(MSPixFmt *)arg;
 	PixConvState *s = (PixConvState *)f->data;
+	if (s->in_fmt != fmt && s->scaler != NULL) {
+		ms_scaler_context_free(s->scaler);
+		s->scaler = NULL;
+	}
 	s->in_fmt = fmt;
 	return 0;
 }
@@ -50,7 +50,7 @@ static void size_conv_init(MSFilter *f) {
 	s->in_vsize.width = 0;
 	s->in_vsize.height = 0;
 	s->sws_ctx = NULL;
-	s->allocator = ms_yuv_buf_allocator_new();
+	s->allocator = ms_yuv_buf_allocator_new_with_pool(ms_factory_get_frame_pool(f->factory));
 	s->start_time = 0;
 	s->frame_count = -1;
 	s->needRefresh = FALSE;
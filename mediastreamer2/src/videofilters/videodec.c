@@ -68,7 +68,7 @@ static void dec_init(MSFilter *f, enum CodecID cid) {
 	ms_ffmpeg_check_init();
 
 	avcodec_get_context_defaults3(&s->av_context, NULL);
-	s->allocator = ms_yuv_buf_allocator_new();
+	s->allocator = ms_yuv_buf_allocator_new_with_pool(ms_factory_get_frame_pool(f->factory));
 	s->av_codec = NULL;
 	s->codec = cid;
 	s->input = NULL;
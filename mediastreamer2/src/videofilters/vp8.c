@@ -930,7 +930,7 @@ static void dec_init(MSFilter *f) {
 	s->last_error_reported_time = 0;
 	s->yuv_width = 0;
 	s->yuv_height = 0;
-	s->allocator = ms_yuv_buf_allocator_new();
+	s->allocator = ms_yuv_buf_allocator_new_with_pool(ms_factory_get_frame_pool(f->factory));
 	ms_yuv_buf_allocator_set_max_frames(s->allocator, 3);
 	s->first_image_decoded = FALSE;
 	s->avpf_enabled = FALSE;
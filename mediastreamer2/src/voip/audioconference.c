@@ -76,6 +76,9 @@ MSAudioConference *ms_audio_conference_new(const MSAudioConferenceParams *params
 		obj->mixer = ms_factory_create_filter(factory, MS_AUDIO_MIXER_ID);
 		ms_filter_call_method(obj->mixer, MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, &tmp);
 		ms_filter_call_method(obj->mixer, MS_FILTER_SET_SAMPLE_RATE, &obj->params.samplerate);
+		if (params->max_speakers > 0) {
+			ms_filter_call_method(obj->mixer, MS_AUDIO_MIXER_SET_MAX_SPEAKERS, &obj->params.max_speakers);
+		}
 	} else {
 		obj->mixer = ms_factory_create_filter(factory, MS_PACKET_ROUTER_ID);
 
@@ -87,6 +90,10 @@ MSAudioConference *ms_audio_conference_new(const MSAudioConferenceParams *params
 
 		bool_t end_to_end_encryption = params->security_level == MSStreamSecurityLevelEndToEnd ? TRUE : FALSE;
 		ms_filter_call_method(obj->mixer, MS_PACKET_ROUTER_SET_END_TO_END_ENCRYPTION_ENABLED, &end_to_end_encryption);
+
+		if (params->max_speakers > 0) {
+			ms_filter_call_method(obj->mixer, MS_PACKET_ROUTER_SET_MAX_SPEAKERS, &obj->params.max_speakers);
+		}
 	}
 
 	return obj;
@@ -269,23 +269,67 @@ void ms_yuv_buf_copy_with_pix_strides(uint8_t *src_planes[],
 	           dst_pix_strides[2], &dst_roi);
 }
 
-MSYuvBufAllocator *ms_yuv_buf_allocator_new(void) {
-	msgb_allocator_t *allocator = (msgb_allocator_t *)ms_new0(msgb_allocator_t, 1);
-	msgb_allocator_init(allocator);
+struct _MSYuvBufAllocator {
+	MSFramePool *pool;
+	ms_mutex_t lock;
+	int max_frames;
+	int live_frames;
+	bool_t released; /* ms_yuv_buf_allocator_free() was called while frames were still in use */
+};
+
+static void yuv_buf_allocator_destroy(MSYuvBufAllocator *obj) {
+	ms_frame_pool_unref(obj->pool);
+	ms_mutex_destroy(&obj->lock);
+	ms_free(obj);
+}
+
+MSYuvBufAllocator *ms_yuv_buf_allocator_new_with_pool(MSFramePool *pool) {
+	MSYuvBufAllocator *allocator = ms_new0(MSYuvBufAllocator, 1);
+	allocator->pool = ms_frame_pool_ref(pool);
+	ms_mutex_init(&allocator->lock, NULL);
 	ms_yuv_buf_allocator_set_max_frames(allocator, 15); /* abitrary limit to avoid undefinite memory inflation */
 	return allocator;
 }
 
+MSYuvBufAllocator *ms_yuv_buf_allocator_new(void) {
+	MSFramePool *pool = ms_frame_pool_new();
+	MSYuvBufAllocator *allocator = ms_yuv_buf_allocator_new_with_pool(pool);
+	ms_frame_pool_unref(pool);
+	return allocator;
+}
+
 void ms_yuv_buf_allocator_set_max_frames(MSYuvBufAllocator *obj, int max_frames) {
-	msgb_allocator_set_max_blocks(obj, max_frames);
+	ms_mutex_lock(&obj->lock);
+	obj->max_frames = max_frames;
+	ms_mutex_unlock(&obj->lock);
+}
+
+/* called by the pool when a frame of the allocator is given back, possibly from another thread */
+static void yuv_buf_allocator_on_frame_free(void *owner) {
+	MSYuvBufAllocator *obj = (MSYuvBufAllocator *)owner;
+	bool_t destroy;
+	ms_mutex_lock(&obj->lock);
+	obj->live_frames--;
+	destroy = obj->released && obj->live_frames == 0;
+	ms_mutex_unlock(&obj->lock);
+	if (destroy) yuv_buf_allocator_destroy(obj);
 }
 
 mblk_t *ms_yuv_allocator_get(MSYuvBufAllocator *obj, int size, int w, int h) {
 	const int header_size = sizeof(mblk_video_header);
 	const int padding = 16;
 	mblk_video_header *hdr;
-	mblk_t *msg = msgb_allocator_alloc(obj, header_size + size + padding);
-	if (msg == NULL) return NULL;
+	mblk_t *msg;
+
+	ms_mutex_lock(&obj->lock);
+	if (obj->max_frames != 0 && obj->live_frames >= obj->max_frames) {
+		ms_mutex_unlock(&obj->lock);
+		return NULL;
+	}
+	obj->live_frames++;
+	ms_mutex_unlock(&obj->lock);
+
+	msg = ms_frame_pool_alloc_with_owner(obj->pool, header_size + size + padding, yuv_buf_allocator_on_frame_free, obj);
 	hdr = (mblk_video_header *)msg->b_wptr;
 	hdr->w = w;
 	hdr->h = h;
@@ -304,18 +348,44 @@ mblk_t *ms_yuv_buf_allocator_get(MSYuvBufAllocator *obj, MSPicture *buf, int w,
 }
 
 void ms_yuv_buf_allocator_free(MSYuvBufAllocator *obj) {
-	mblk_t *m;
-	int possibly_leaked = 0;
-	for (m = qbegin(&obj->q); !qend(&obj->q, m); m = qnext(&obj->q, m)) {
-		if (dblk_ref_value(m->b_datap) > 1) possibly_leaked++;
-	}
-	msgb_allocator_uninit(obj);
-	ms_free(obj);
-	if (possibly_leaked > 0) {
-		ms_warning("ms_yuv_buf_allocator_free(): leaving %i mblk_t still ref'd, possible leak.", possibly_leaked);
+	int live_frames;
+	ms_mutex_lock(&obj->lock);
+	live_frames = obj->live_frames;
+	obj->released = TRUE;
+	ms_mutex_unlock(&obj->lock);
+	if (live_frames > 0) {
+		/* the allocator is destroyed when its last frame is freed */
+		ms_warning("ms_yuv_buf_allocator_free(): leaving %i mblk_t still ref'd, possible leak.", live_frames);
+		return;
 	}
+	yuv_buf_allocator_destroy(obj);
 }
 
+#ifdef HAVE_LIBYUV_H
+/* The rows are mirrored by libyuv into a temporary row, which is faster than swapping the pixels in place */
+static void plane_horizontal_mirror(uint8_t *p, int linesize, int w, int h) {
+	int j;
+	uint8_t *tmp = alloca(w);
+	for (j = 0; j < h; ++j) {
+		MirrorPlane(p, 0, tmp, 0, w, 1);
+		memcpy(p, tmp, w);
+		p += linesize;
+	}
+}
+static void plane_central_mirror(uint8_t *p, int linesize, int w, int h) {
+	int j;
+	uint8_t *tmp = alloca(w);
+	uint8_t *bottom_line = p + (h - 1) * linesize;
+	for (j = 0; j < h / 2; ++j) {
+		MirrorPlane(p, 0, tmp, 0, w, 1);
+		MirrorPlane(bottom_line, 0, p, 0, w, 1);
+		memcpy(bottom_line, tmp, w);
+		p += linesize;
+		bottom_line -= linesize;
+	}
+	if (h & 0x1) plane_horizontal_mirror(p, linesize, w, 1);
+}
+#else
 static void plane_horizontal_mirror(uint8_t *p, int linesize, int w, int h) {
 	int i, j;
 	uint8_t tmp;
@@ -345,7 +415,10 @@ static void plane_central_mirror(uint8_t *p, int linesize, int w, int h) {
 		p += linesize - w;
 		end_of_image -= linesize - w;
 	}
+	/* the middle line of an odd number of lines is only mirrored horizontally */
+	if (h & 0x1) plane_horizontal_mirror(p, linesize, w, 1);
 }
+#endif
 static void plane_vertical_mirror(uint8_t *p, int linesize, int w, int h) {
 	int j;
 	uint8_t *tmp = alloca(w * sizeof(int));
@@ -419,21 +492,21 @@ MSPixFmt ms_fourcc_to_pix_fmt(uint32_t fourcc) {
 }
 
 void rgb24_mirror(uint8_t *buf, int w, int h, int linesize) {
-	int i, j;
-	uint8_t r, g, b;
+	int i;
 	int end = w * 3;
+	uint8_t *tmp = alloca(end);
 	for (i = 0; i < h; ++i) {
-		for (j = 0; j < end / 2; j += 3) {
-			r = buf[j];
-			g = buf[j + 1];
-			b = buf[j + 2];
-			buf[j] = buf[end - j - 3];
-			buf[j + 1] = buf[end - j - 2];
-			buf[j + 2] = buf[end - j - 1];
-			buf[end - j - 3] = r;
-			buf[end - j - 2] = g;
-			buf[end - j - 1] = b;
+#ifdef HAVE_LIBYUV_H
+		RGB24Mirror(buf, 0, tmp, 0, w, 1);
+#else
+		int j;
+		for (j = 0; j < end; j += 3) {
+			tmp[j] = buf[end - j - 3];
+			tmp[j + 1] = buf[end - j - 2];
+			tmp[j + 2] = buf[end - j - 1];
 		}
+#endif
+		memcpy(buf, tmp, end);
 		buf += linesize;
 	}
 }
@@ -515,65 +588,204 @@ void ms_rgb_to_yuv(const uint8_t rgb[3], uint8_t yuv[3]) {
 }
 
 #ifdef HAVE_LIBYUV_H
+typedef int (*YuvToI420Func)(const uint8_t *src,
+                             int src_stride,
+                             uint8_t *dst_y,
+                             int dst_stride_y,
+                             uint8_t *dst_u,
+                             int dst_stride_u,
+                             uint8_t *dst_v,
+                             int dst_stride_v,
+                             int width,
+                             int height);
+typedef int (*YuvFromI420Func)(const uint8_t *src_y,
+                               int src_stride_y,
+                               const uint8_t *src_u,
+                               int src_stride_u,
+                               const uint8_t *src_v,
+                               int src_stride_v,
+                               uint8_t *dst,
+                               int dst_stride,
+                               int width,
+                               int height);
+
+static YuvToI420Func yuv_to_i420_func(MSPixFmt fmt) {
+	switch (fmt) {
+		case MS_YUY2:
+		case MS_YUYV:
+			return YUY2ToI420;
+		case MS_UYVY:
+			return UYVYToI420;
+		case MS_RGB24: /*BI_RGB on windows*/
+			return RGB24ToI420; /* limited range, like I420ToRGB24() and the other conversions */
+		case MS_RGB24_REV:
+			return RAWToI420;
+		case MS_RGBA32:
+			return ABGRToI420;
+		case MS_RGBA32_REV: // BGRAToI420, ABGRToI420
+			return ARGBToI420;
+		case MS_RGB565:
+			return RGB565ToI420;
+		default:
+			return NULL;
+	}
+}
+
+static YuvFromI420Func yuv_from_i420_func(MSPixFmt fmt) {
+	switch (fmt) {
+		case MS_YUY2:
+		case MS_YUYV:
+			return I420ToYUY2;
+		case MS_UYVY:
+			return I420ToUYVY;
+		case MS_RGB24:
+			return I420ToRGB24;
+		case MS_RGB24_REV:
+			return I420ToRAW;
+		case MS_RGBA32:
+			return I420ToABGR;
+		case MS_RGBA32_REV:
+			return I420ToARGB;
+		case MS_RGB565:
+			return I420ToRGB565;
+		default:
+			return NULL;
+	}
+}
+
+static int yuv_bytes_per_pixel(MSPixFmt fmt) {
+	switch (fmt) {
+		case MS_YUY2:
+		case MS_YUYV:
+		case MS_UYVY:
+		case MS_RGB565:
+			return 2;
+		case MS_RGB24:
+		case MS_RGB24_REV:
+			return 3;
+		case MS_RGBA32:
+		case MS_RGBA32_REV:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * Any supported format is converted to any other one, possibly with a different size. Conversions and scaling are
+ * done by libyuv, which has SIMD versions of all of them. The source is converted to I420 at its own size, then scaled,
+ * then converted to the destination format: the steps that are not needed are skipped, and a single step writes
+ * directly into the destination. When two steps or more are needed, the intermediate pictures are kept in the context
+ * so that nothing is allocated per frame.
+ */
 struct _MSYuvScalerContext {
 	MSVideoSize source;
 	MSVideoSize target;
 	MSPixFmt src_fmt;
+	MSPixFmt dst_fmt;
+	enum FilterMode filter;
+	YuvToI420Func to_i420;     /* NULL if the source is I420 or if no conversion is needed */
+	YuvFromI420Func from_i420; /* NULL if the destination is I420 or if no conversion is needed */
+	MSPicture src_pic;         /* source converted to I420, when it has to be scaled or converted again */
+	MSPicture dst_pic;         /* scaled I420 picture, when it has to be converted to the destination format */
+	uint8_t *buffer;
 };
 
 typedef struct _MSYuvScalerContext MSYuvScalerContext;
 
-static MSScalerContext *yuv_create_scale_context(int src_w,
-                                                 int src_h,
-                                                 MSPixFmt src_fmt,
-                                                 int dst_w,
-                                                 int dst_h,
-                                                 BCTBX_UNUSED(MSPixFmt dst_fmt),
-                                                 BCTBX_UNUSED(int flags)) {
-	MSYuvScalerContext *ctx = ms_new0(MSYuvScalerContext, 1);
+static uint8_t *yuv_picture_init(MSPicture *pic, int w, int h, uint8_t *ptr) {
+	int stride = (w + 1) & ~1; /* the chroma planes have (w + 1) / 2 columns for libyuv */
+	ms_yuv_buf_init(pic, w, h, stride, ptr);
+	return ptr + (stride * ((h + 1) & ~1) * 3) / 2;
+}
+
+static MSScalerContext *yuv_create_scale_context(
+    int src_w, int src_h, MSPixFmt src_fmt, int dst_w, int dst_h, MSPixFmt dst_fmt, int flags) {
+	MSYuvScalerContext *ctx;
+	bool_t same_size = src_w == dst_w && src_h == dst_h;
+	YuvToI420Func to_i420 = NULL;
+	YuvFromI420Func from_i420 = NULL;
+	size_t size = 0;
+	uint8_t *ptr;
+
+	if (src_fmt == dst_fmt && src_fmt != MS_YUV420P &&
+	    (same_size || src_fmt == MS_RGBA32 || src_fmt == MS_RGBA32_REV)) {
+		/* copied, or scaled by ARGBScale(), without going through I420 */
+	} else {
+		if (src_fmt != MS_YUV420P && (to_i420 = yuv_to_i420_func(src_fmt)) == NULL) {
+			ms_error("yuv_create_scale_context: unsupported source format %s", ms_pix_fmt_to_string(src_fmt));
+			return NULL;
+		}
+		if (dst_fmt != MS_YUV420P && (from_i420 = yuv_from_i420_func(dst_fmt)) == NULL) {
+			ms_error("yuv_create_scale_context: unsupported destination format %s", ms_pix_fmt_to_string(dst_fmt));
+			return NULL;
+		}
+	}
+
+	ctx = ms_new0(MSYuvScalerContext, 1);
 	ctx->source.width = src_w;
 	ctx->source.height = src_h;
 	ctx->target.width = dst_w;
 	ctx->target.height = dst_h;
 	ctx->src_fmt = src_fmt;
+	ctx->dst_fmt = dst_fmt;
+	ctx->filter = (flags & MS_SCALER_METHOD_NEIGHBOUR) ? kFilterNone : kFilterBilinear;
+	ctx->to_i420 = to_i420;
+	ctx->from_i420 = from_i420;
+
+	if (to_i420 && (from_i420 || !same_size)) size += ((src_w + 1) & ~1) * ((src_h + 1) & ~1) * 3 / 2;
+	if (from_i420 && !same_size) size += ((dst_w + 1) & ~1) * ((dst_h + 1) & ~1) * 3 / 2;
+	if (size > 0) {
+		ptr = ctx->buffer = ms_malloc(size);
+		if (to_i420 && (from_i420 || !same_size)) ptr = yuv_picture_init(&ctx->src_pic, src_w, src_h, ptr);
+		if (from_i420 && !same_size) yuv_picture_init(&ctx->dst_pic, dst_w, dst_h, ptr);
+	}
 	return (MSScalerContext *)ctx;
 }
 
 static int yuv_scale(MSScalerContext *ctx, uint8_t *src[], int src_strides[], uint8_t *dst[], int dst_strides[]) {
 	MSYuvScalerContext *fctx = (MSYuvScalerContext *)ctx;
-	int err = -1;
+	bool_t same_size = ms_video_size_equal(fctx->source, fctx->target);
+	uint8_t **planes = src;
+	int *strides = src_strides;
+	int err = 0;
+
+	if (fctx->src_fmt != MS_YUV420P && fctx->to_i420 == NULL) {
+		/* same packed format on both sides */
+		if (same_size) {
+			CopyPlane(src[0], src_strides[0], dst[0], dst_strides[0],
+			          fctx->source.width * yuv_bytes_per_pixel(fctx->src_fmt), fctx->source.height);
+			return 0;
+		}
+		err = ARGBScale(src[0], src_strides[0], fctx->source.width, fctx->source.height, dst[0], dst_strides[0],
+		                fctx->target.width, fctx->target.height, fctx->filter);
+		return err != 0 ? -1 : 0;
+	}
 
-	switch (fctx->src_fmt) {
-		case MS_YUV420P:
-			err = I420Scale(src[0], src_strides[0], src[1], src_strides[1], src[2], src_strides[2], fctx->source.width,
-			                fctx->source.height, dst[0], dst_strides[0], dst[1], dst_strides[1], dst[2], dst_strides[2],
-			                fctx->target.width, fctx->target.height, kFilterBilinear);
-			break;
-		case MS_YUY2:
-		case MS_YUYV:
-			err = YUY2ToI420(src[0], src_strides[0], dst[0], dst_strides[0], dst[1], dst_strides[1], dst[2],
-			                 dst_strides[2], fctx->target.width, fctx->target.height);
-			break;
-			break;
-		case MS_UYVY:
-			err = UYVYToI420(src[0], src_strides[0], dst[0], dst_strides[0], dst[1], dst_strides[1], dst[2],
-			                 dst_strides[2], fctx->target.width, fctx->target.height);
-			break;
-		case MS_RGB24: /*BI_RGB on windows*/
-			err = RGB24ToJ420(src[0], src_strides[0], dst[0], dst_strides[0], dst[1], dst_strides[1], dst[2],
-			                  dst_strides[2], fctx->target.width, fctx->target.height);
-			break;
-		case MS_RGB24_REV:
-			err = RAWToI420(src[0], src_strides[0], dst[0], dst_strides[0], dst[1], dst_strides[1], dst[2],
-			                dst_strides[2], fctx->target.width, fctx->target.height);
-			break;
-		case MS_RGBA32_REV: // BGRAToI420, ABGRToI420
-			err = ARGBToI420(src[0], src_strides[0], dst[0], dst_strides[0], dst[1], dst_strides[1], dst[2],
-			                 dst_strides[2], fctx->target.width, fctx->target.height);
-			break;
-		default:
-			ms_warning("yuv_scale: unsupported format %s", ms_pix_fmt_to_string(fctx->src_fmt));
-			break;
+	if (fctx->to_i420) {
+		uint8_t **out = fctx->src_pic.planes[0] ? fctx->src_pic.planes : dst;
+		int *out_strides = fctx->src_pic.planes[0] ? fctx->src_pic.strides : dst_strides;
+		err = fctx->to_i420(src[0], src_strides[0], out[0], out_strides[0], out[1], out_strides[1], out[2],
+		                    out_strides[2], fctx->source.width, fctx->source.height);
+		planes = out;
+		strides = out_strides;
+	}
+	if (err == 0 && !same_size) {
+		uint8_t **out = fctx->from_i420 ? fctx->dst_pic.planes : dst;
+		int *out_strides = fctx->from_i420 ? fctx->dst_pic.strides : dst_strides;
+		err = I420Scale(planes[0], strides[0], planes[1], strides[1], planes[2], strides[2], fctx->source.width,
+		                fctx->source.height, out[0], out_strides[0], out[1], out_strides[1], out[2], out_strides[2],
+		                fctx->target.width, fctx->target.height, fctx->filter);
+		planes = out;
+		strides = out_strides;
+	}
+	if (err == 0 && fctx->from_i420) {
+		err = fctx->from_i420(planes[0], strides[0], planes[1], strides[1], planes[2], strides[2], dst[0],
+		                      dst_strides[0], fctx->target.width, fctx->target.height);
+	} else if (err == 0 && planes == src) {
+		/* I420 to I420 of the same size */
+		err = I420Copy(src[0], src_strides[0], src[1], src_strides[1], src[2], src_strides[2], dst[0], dst_strides[0],
+		               dst[1], dst_strides[1], dst[2], dst_strides[2], fctx->target.width, fctx->target.height);
 	}
 	if (err != 0) // err can be negative or positive in case of error.
 		return -1;
@@ -581,6 +793,8 @@ static int yuv_scale(MSScalerContext *ctx, uint8_t *src[], int src_strides[], ui
 }
 
 static void yuv_free(MSScalerContext *ctx) {
+	MSYuvScalerContext *fctx = (MSYuvScalerContext *)ctx;
+	if (fctx->buffer) ms_free(fctx->buffer);
 	ms_free(ctx);
 }
 
@@ -774,6 +988,25 @@ static void rotate_plane_down_scale_by_2(int wDest,
 	}
 }
 
+#ifdef HAVE_LIBYUV_H
+/* Returns the libyuv rotation mode for a rotation in degrees, or -1 if libyuv can't be used for this picture size. */
+static int yuv_rotation_mode(int rotation, int w, int h) {
+	if (w & 0x1 || h & 0x1) return -1; /* the chroma planes of the destination have w / 2 columns and h / 2 rows */
+	switch (((rotation % 360) + 360) % 360) {
+		case 0:
+			return kRotate0;
+		case 90:
+			return kRotate90;
+		case 180:
+			return kRotate180;
+		case 270:
+			return kRotate270;
+		default:
+			return -1;
+	}
+}
+#endif
+
 #ifdef __ANDROID__
 
 static int hasNeon = -1;
@@ -825,6 +1058,20 @@ mblk_t *copy_ycbcrbiplanar_to_true_yuv_with_rotation_and_down_scale_by_2(MSYuvBu
 		pict.planes[2] = tmp;
 	}
 
+#ifdef HAVE_LIBYUV_H
+	if (!down_scale) {
+		int mode = yuv_rotation_mode(rotation, w, h);
+		if (mode >= 0) {
+			/* de-interlacing and rotation in a single pass; libyuv takes the size of the source */
+			bool_t transposed = mode == kRotate90 || mode == kRotate270;
+			if (NV12ToI420Rotate(y, y_byte_per_row, cbcr, cbcr_byte_per_row, pict.planes[0], pict.strides[0],
+			                     pict.planes[1], pict.strides[1], pict.planes[2], pict.strides[2], transposed ? h : w,
+			                     transposed ? w : h, (enum RotationMode)mode) == 0)
+				return yuv_block;
+		}
+	}
+#endif
+
 	if (rotation % 180 == 0) {
 		int i, j;
 		uint8_t *u_dest = pict.planes[1], *v_dest = pict.planes[2];
@@ -949,6 +1196,19 @@ mblk_t *copy_yuv_with_rotation(MSYuvBufAllocator *allocator,
 	yuv_block = ms_yuv_buf_allocator_get(allocator, &pict, w, h);
 	if (!yuv_block) return NULL;
 
+#ifdef HAVE_LIBYUV_H
+	{
+		int mode = yuv_rotation_mode(rotation, w, h);
+		if (mode >= 0) {
+			bool_t transposed = mode == kRotate90 || mode == kRotate270;
+			if (I420Rotate(y, y_byte_per_row, u, u_byte_per_row, v, v_byte_per_row, pict.planes[0], pict.strides[0],
+			               pict.planes[1], pict.strides[1], pict.planes[2], pict.strides[2], transposed ? h : w,
+			               transposed ? w : h, (enum RotationMode)mode) == 0)
+				return yuv_block;
+		}
+	}
+#endif
+
 	if (rotation % 180 == 0) {
 		int i, j;
 
@@ -19,9 +19,13 @@
  */
 
 #include "mediastreamer2/dtmfgen.h"
+#include "mediastreamer2/msaudiomixer.h"
 #include "mediastreamer2/mediastream.h"
 #include "mediastreamer2/msfileplayer.h"
 #include "mediastreamer2/msfilerec.h"
+#include "mediastreamer2/msitc.h"
+#include "mediastreamer2/mspacketrouter.h"
+#include "mediastreamer2/msresample.h"
 #include "mediastreamer2/msrtp.h"
 #include "mediastreamer2/mstonedetector.h"
 #include "mediastreamer2_tester.h"
@@ -218,6 +222,56 @@ check_picture(const MSVideoSize *buffer_size, const MSRect *roi, bool_t semi_pla
 	return TRUE;
 }
 
+static void test_frame_pool(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSFramePool *pool = ms_factory_get_frame_pool(factory);
+	MSYuvBufAllocator *yba = ms_yuv_buf_allocator_new_with_pool(pool);
+	MSFramePoolStats stats;
+	MSPicture pic;
+	mblk_t *frames[3];
+	mblk_t *dup;
+	uint8_t *buffer;
+	int i;
+
+	ms_yuv_buf_allocator_set_max_frames(yba, 3);
+	for (i = 0; i < 3; i++) {
+		frames[i] = ms_yuv_buf_allocator_get(yba, &pic, MS_VIDEO_SIZE_VGA_W, MS_VIDEO_SIZE_VGA_H);
+		BC_ASSERT_PTR_NOT_NULL(frames[i]);
+	}
+	/* the allocator is limited to 3 frames in use */
+	BC_ASSERT_PTR_NULL(ms_yuv_buf_allocator_get(yba, &pic, MS_VIDEO_SIZE_VGA_W, MS_VIDEO_SIZE_VGA_H));
+	ms_frame_pool_get_stats(pool, &stats);
+	BC_ASSERT_EQUAL(stats.live_frames, 3, int, "%i");
+	BC_ASSERT_EQUAL(stats.free_frames, 0, int, "%i");
+	BC_ASSERT_TRUE(stats.live_bytes >= 3 * (size_t)(MS_VIDEO_SIZE_VGA_W * MS_VIDEO_SIZE_VGA_H * 3 / 2));
+
+	/* a frame goes back to the pool only once all its references are dropped */
+	buffer = frames[0]->b_datap->db_base;
+	dup = dupmsg(frames[0]);
+	freemsg(frames[0]);
+	ms_frame_pool_get_stats(pool, &stats);
+	BC_ASSERT_EQUAL(stats.live_frames, 3, int, "%i");
+	freemsg(dup);
+	ms_frame_pool_get_stats(pool, &stats);
+	BC_ASSERT_EQUAL(stats.live_frames, 2, int, "%i");
+	BC_ASSERT_EQUAL(stats.free_frames, 1, int, "%i");
+
+	/* and is reused for the next frame of the same size */
+	frames[0] = ms_yuv_buf_allocator_get(yba, &pic, MS_VIDEO_SIZE_VGA_W, MS_VIDEO_SIZE_VGA_H);
+	BC_ASSERT_PTR_NOT_NULL(frames[0]);
+	BC_ASSERT_PTR_EQUAL(frames[0]->b_datap->db_base, buffer);
+	ms_frame_pool_get_stats(pool, &stats);
+	BC_ASSERT_EQUAL((int)stats.allocations, 3, int, "%i");
+	BC_ASSERT_EQUAL((int)stats.reuses, 1, int, "%i");
+	BC_ASSERT_EQUAL(stats.free_frames, 0, int, "%i");
+
+	/* the allocator and the factory may go away before the frames */
+	ms_yuv_buf_allocator_free(yba);
+	ms_factory_destroy(factory);
+	for (i = 0; i < 3; i++)
+		freemsg(frames[i]);
+}
+
 static void test_video_processing_base(bool_t downscaling, bool_t rotate_clock_wise, bool_t flip) {
 	MSVideoSize src_size = {MS_VIDEO_SIZE_VGA_W, MS_VIDEO_SIZE_VGA_H};
 	MSVideoSize dest_size = src_size;
@@ -392,6 +446,389 @@ static void test_copy_ycbcrbiplanar_to_true_yuv_with_rotation_180_with_downscali
 	test_video_processing_base(TRUE, FALSE, TRUE);
 }
 
+static int grey_of_column(int column) {
+	static const uint8_t greys[] = {0, 64, 128, 255};
+	return greys[(column / 16) % 4];
+}
+
+/* conversions and mirrors, libyuv ones when available, compared with the portable code */
+static void test_video_conversion_and_mirrors(void) {
+	const int w = 64, h = 48;
+	uint8_t *rgb = ms_malloc(w * h * 3);
+	uint8_t *rgb2 = ms_malloc0(w * h * 3);
+	uint8_t *mirrored = ms_malloc(w * h * 3);
+	YuvBuf yuv;
+	mblk_t *yuv_block = ms_yuv_buf_alloc(&yuv, w, h);
+	int i, j, k, errors;
+
+	/* bands of grey 16 pixels wide, so that every chroma sample covers a single grey */
+	for (j = 0; j < h; j++) {
+		for (i = 0; i < w; i++) {
+			for (k = 0; k < 3; k++)
+				rgb[(j * w + i) * 3 + k] = (uint8_t)grey_of_column(i);
+		}
+	}
+
+	if (ms_video_get_scaler_impl() != NULL) {
+		int rgb_strides[4] = {w * 3, 0, 0, 0};
+		uint8_t *rgb_planes[4] = {rgb, NULL, NULL, NULL};
+		uint8_t *rgb2_planes[4] = {rgb2, NULL, NULL, NULL};
+		MSScalerContext *ctx = ms_scaler_create_context(w, h, MS_RGB24, w, h, MS_YUV420P, MS_SCALER_METHOD_BILINEAR);
+		int y_errors = 0, chroma_errors = 0, rgb_errors = 0;
+
+		if (BC_ASSERT_PTR_NOT_NULL(ctx)) {
+			BC_ASSERT_EQUAL(ms_scaler_process(ctx, rgb_planes, rgb_strides, yuv.planes, yuv.strides), 0, int, "%d");
+			ms_scaler_context_free(ctx);
+		}
+		/* the same limited range as ms_rgb_to_yuv() */
+		for (j = 0; j < h; j++) {
+			for (i = 0; i < w; i++) {
+				uint8_t grey[3] = {(uint8_t)grey_of_column(i), (uint8_t)grey_of_column(i), (uint8_t)grey_of_column(i)};
+				uint8_t expected[3];
+				ms_rgb_to_yuv(grey, expected);
+				if (abs(yuv.planes[0][j * yuv.strides[0] + i] - expected[0]) > 2) y_errors++;
+				if ((i % 2) == 0 && (j % 2) == 0) {
+					if (abs(yuv.planes[1][(j / 2) * yuv.strides[1] + i / 2] - expected[1]) > 2) chroma_errors++;
+					if (abs(yuv.planes[2][(j / 2) * yuv.strides[2] + i / 2] - expected[2]) > 2) chroma_errors++;
+				}
+			}
+		}
+		BC_ASSERT_EQUAL(y_errors, 0, int, "%d");
+		BC_ASSERT_EQUAL(chroma_errors, 0, int, "%d");
+
+		/* and back to the original picture */
+		ctx = ms_scaler_create_context(w, h, MS_YUV420P, w, h, MS_RGB24, MS_SCALER_METHOD_BILINEAR);
+		if (BC_ASSERT_PTR_NOT_NULL(ctx)) {
+			BC_ASSERT_EQUAL(ms_scaler_process(ctx, yuv.planes, yuv.strides, rgb2_planes, rgb_strides), 0, int, "%d");
+			ms_scaler_context_free(ctx);
+		}
+		for (i = 0; i < w * h * 3; i++) {
+			if (abs(rgb2[i] - rgb[i]) > 3) rgb_errors++;
+		}
+		BC_ASSERT_EQUAL(rgb_errors, 0, int, "%d");
+	}
+
+	/* a picture of distinct pixels */
+	for (i = 0; i < w * h * 3; i++)
+		rgb[i] = (uint8_t)(i * 7 + i / (w * 3));
+	memcpy(mirrored, rgb, w * h * 3);
+	rgb24_mirror(mirrored, w, h, w * 3);
+	errors = 0;
+	for (j = 0; j < h; j++) {
+		for (i = 0; i < w; i++) {
+			if (memcmp(&mirrored[(j * w + i) * 3], &rgb[(j * w + w - 1 - i) * 3], 3) != 0) errors++;
+		}
+	}
+	BC_ASSERT_EQUAL(errors, 0, int, "%d");
+
+	for (i = 0; i < w * h; i++)
+		yuv.planes[0][i] = (uint8_t)(i * 7 + i / w);
+	memcpy(rgb, yuv.planes[0], w * h);
+	ms_yuv_buf_mirrors(&yuv, MS_HORIZONTAL_MIRROR);
+	errors = 0;
+	for (j = 0; j < h; j++) {
+		for (i = 0; i < w; i++) {
+			if (yuv.planes[0][j * w + i] != rgb[j * w + w - 1 - i]) errors++;
+		}
+	}
+	BC_ASSERT_EQUAL(errors, 0, int, "%d");
+	ms_yuv_buf_mirrors(&yuv, MS_HORIZONTAL_MIRROR);
+	ms_yuv_buf_mirrors(&yuv, MS_CENTRAL_MIRROR);
+	errors = 0;
+	for (j = 0; j < h; j++) {
+		for (i = 0; i < w; i++) {
+			if (yuv.planes[0][j * w + i] != rgb[(h - 1 - j) * w + w - 1 - i]) errors++;
+		}
+	}
+	BC_ASSERT_EQUAL(errors, 0, int, "%d");
+
+	freemsg(yuv_block);
+	ms_free(rgb);
+	ms_free(rgb2);
+	ms_free(mirrored);
+}
+
+/* a value that differs from those of the neighbours in every direction */
+static uint8_t pattern_value(int row, int column) {
+	return (uint8_t)(row * 29 + column * 7);
+}
+
+/* position in the source picture of the pixel (x, y) of the destination, for a clockwise rotation */
+static void rotated_source_position(int rotation, int dst_w, int dst_h, int x, int y, int *src_x, int *src_y) {
+	switch (rotation) {
+		case 90:
+			*src_x = y;
+			*src_y = dst_w - 1 - x;
+			break;
+		case 180:
+			*src_x = dst_w - 1 - x;
+			*src_y = dst_h - 1 - y;
+			break;
+		case 270:
+			*src_x = dst_h - 1 - y;
+			*src_y = x;
+			break;
+		default:
+			*src_x = x;
+			*src_y = y;
+			break;
+	}
+}
+
+/*
+ * Compares a rotated picture with its source. A chroma sample of the destination must be one of the source chroma
+ * samples of the four luma pixels it covers: with odd sizes, these are not always the same.
+ */
+static int count_rotation_errors(const MSPicture *dst,
+                                 const uint8_t *y,
+                                 int y_stride,
+                                 const uint8_t *u,
+                                 const uint8_t *v,
+                                 int uv_stride,
+                                 int uv_step,
+                                 int rotation) {
+	int errors = 0;
+	int i, j, k;
+
+	for (j = 0; j < dst->h; j++) {
+		for (i = 0; i < dst->w; i++) {
+			int sx, sy;
+			rotated_source_position(rotation, dst->w, dst->h, i, j, &sx, &sy);
+			if (dst->planes[0][j * dst->strides[0] + i] != y[sy * y_stride + sx]) errors++;
+		}
+	}
+	for (j = 0; j < dst->h / 2; j++) {
+		for (i = 0; i < dst->w / 2; i++) {
+			bool_t u_found = FALSE, v_found = FALSE;
+			for (k = 0; k < 4; k++) {
+				int sx, sy, offset;
+				rotated_source_position(rotation, dst->w, dst->h, 2 * i + (k & 1), 2 * j + (k >> 1), &sx, &sy);
+				offset = (sy / 2) * uv_stride + (sx / 2) * uv_step;
+				if (dst->planes[1][j * dst->strides[1] + i] == u[offset]) u_found = TRUE;
+				if (dst->planes[2][j * dst->strides[2] + i] == v[offset]) v_found = TRUE;
+			}
+			if (!u_found) errors++;
+			if (!v_found) errors++;
+		}
+	}
+	return errors;
+}
+
+/* rotations of I420 and NV12 pictures, libyuv ones when available, compared with the expected pixels */
+static void test_video_rotation_base(int src_w, int src_h) {
+	const int uv_w = (src_w + 1) / 2, uv_h = (src_h + 1) / 2;
+	uint8_t *y = ms_malloc(src_w * src_h);
+	uint8_t *u = ms_malloc(uv_w * uv_h);
+	uint8_t *v = ms_malloc(uv_w * uv_h);
+	uint8_t *cbcr = ms_malloc(uv_w * 2 * uv_h);
+	MSYuvBufAllocator *allocator = ms_yuv_buf_allocator_new();
+	static const int rotations[] = {90, 180, 270};
+	int i, j, r;
+
+	for (j = 0; j < src_h; j++) {
+		for (i = 0; i < src_w; i++)
+			y[j * src_w + i] = pattern_value(j, i);
+	}
+	for (j = 0; j < uv_h; j++) {
+		for (i = 0; i < uv_w; i++) {
+			u[j * uv_w + i] = cbcr[j * uv_w * 2 + i * 2] = pattern_value(j, i);
+			v[j * uv_w + i] = cbcr[j * uv_w * 2 + i * 2 + 1] = (uint8_t)~pattern_value(j, i);
+		}
+	}
+
+	for (r = 0; r < (int)(sizeof(rotations) / sizeof(rotations[0])); r++) {
+		int rotation = rotations[r];
+		int dst_w = rotation == 180 ? src_w : src_h;
+		int dst_h = rotation == 180 ? src_h : src_w;
+		MSPicture pict;
+		mblk_t *m;
+
+		/* I420 sources only come with even sizes */
+		if (src_w % 2 == 0 && src_h % 2 == 0) {
+			m = copy_yuv_with_rotation(allocator, y, u, v, rotation, dst_w, dst_h, src_w, uv_w, uv_w);
+			if (BC_ASSERT_PTR_NOT_NULL(m)) {
+				BC_ASSERT_EQUAL(ms_yuv_buf_init_from_mblk(&pict, m), 0, int, "%d");
+				BC_ASSERT_EQUAL(pict.w, dst_w, int, "%d");
+				BC_ASSERT_EQUAL(pict.h, dst_h, int, "%d");
+				BC_ASSERT_EQUAL(count_rotation_errors(&pict, y, src_w, u, v, uv_w, 1, rotation), 0, int, "%d");
+				freemsg(m);
+			}
+		}
+
+		m = copy_ycbcrbiplanar_to_true_yuv_with_rotation(allocator, y, cbcr, rotation, dst_w, dst_h, src_w,
+		                                                 uv_w * 2, TRUE);
+		if (BC_ASSERT_PTR_NOT_NULL(m)) {
+			BC_ASSERT_EQUAL(ms_yuv_buf_init_from_mblk(&pict, m), 0, int, "%d");
+			BC_ASSERT_EQUAL(pict.w, dst_w, int, "%d");
+			BC_ASSERT_EQUAL(pict.h, dst_h, int, "%d");
+			BC_ASSERT_EQUAL(count_rotation_errors(&pict, y, src_w, cbcr, cbcr + 1, uv_w * 2, 2, rotation), 0, int,
+			                "%d");
+			freemsg(m);
+		}
+	}
+
+	ms_yuv_buf_allocator_free(allocator);
+	ms_free(y);
+	ms_free(u);
+	ms_free(v);
+	ms_free(cbcr);
+}
+
+static void test_video_rotation(void) {
+	test_video_rotation_base(64, 48);
+}
+
+static void test_video_rotation_odd_size(void) {
+	test_video_rotation_base(35, 27);
+}
+
+/* colors with as much red as blue, so that the byte order of the RGB formats does not matter */
+static void block_color(int column, int row, uint8_t rgb[3]) {
+	static const uint8_t colors[][3] = {{180, 60, 180}, {60, 180, 60}, {230, 230, 230},
+	                                    {30, 30, 30},   {200, 120, 200}, {90, 200, 90}};
+	memcpy(rgb, colors[(column + 2 * row) % 6], 3);
+}
+
+static int pix_fmt_bytes_per_pixel(MSPixFmt fmt) {
+	switch (fmt) {
+		case MS_RGBA32:
+			return 4;
+		case MS_RGB24:
+			return 3;
+		default:
+			return 2;
+	}
+}
+
+static mblk_t *alloc_picture(MSPixFmt fmt, int w, int h, uint8_t *planes[4], int strides[4]) {
+	memset(planes, 0, 4 * sizeof(uint8_t *));
+	memset(strides, 0, 4 * sizeof(int));
+	if (fmt == MS_YUV420P) {
+		MSPicture pict;
+		mblk_t *m = ms_yuv_buf_alloc(&pict, w, h);
+		memcpy(planes, pict.planes, 4 * sizeof(uint8_t *));
+		memcpy(strides, pict.strides, 4 * sizeof(int));
+		return m;
+	}
+	strides[0] = w * pix_fmt_bytes_per_pixel(fmt);
+	planes[0] = ms_malloc0(strides[0] * h);
+	return NULL;
+}
+
+static void free_picture(mblk_t *m, uint8_t *planes[4]) {
+	if (m) freemsg(m);
+	else ms_free(planes[0]);
+}
+
+static void write_pixel(MSPixFmt fmt, uint8_t *planes[4], const int strides[4], int x, int y, const uint8_t rgb[3]) {
+	uint8_t yuv[3];
+	uint8_t *p;
+
+	ms_rgb_to_yuv(rgb, yuv);
+	switch (fmt) {
+		case MS_YUV420P:
+			planes[0][y * strides[0] + x] = yuv[0];
+			planes[1][(y / 2) * strides[1] + x / 2] = yuv[1];
+			planes[2][(y / 2) * strides[2] + x / 2] = yuv[2];
+			break;
+		case MS_YUY2:
+			p = planes[0] + y * strides[0] + (x & ~1) * 2;
+			p[(x & 1) * 2] = yuv[0];
+			p[1] = yuv[1];
+			p[3] = yuv[2];
+			break;
+		default:
+			p = planes[0] + y * strides[0] + x * pix_fmt_bytes_per_pixel(fmt);
+			memcpy(p, rgb, 3);
+			if (fmt == MS_RGBA32) p[3] = 255;
+			break;
+	}
+}
+
+static void read_pixel_yuv(MSPixFmt fmt, uint8_t *planes[4], const int strides[4], int x, int y, uint8_t yuv[3]) {
+	const uint8_t *p;
+
+	switch (fmt) {
+		case MS_YUV420P:
+			yuv[0] = planes[0][y * strides[0] + x];
+			yuv[1] = planes[1][(y / 2) * strides[1] + x / 2];
+			yuv[2] = planes[2][(y / 2) * strides[2] + x / 2];
+			break;
+		case MS_YUY2:
+			p = planes[0] + y * strides[0] + (x & ~1) * 2;
+			yuv[0] = p[(x & 1) * 2];
+			yuv[1] = p[1];
+			yuv[2] = p[3];
+			break;
+		default:
+			ms_rgb_to_yuv(planes[0] + y * strides[0] + x * pix_fmt_bytes_per_pixel(fmt), yuv);
+			break;
+	}
+}
+
+/*
+ * Converts and scales a picture made of 16x16 blocks of plain colors. Away from the edges of the blocks, where the
+ * filters mix the neighbouring colors, the destination must have the colors of the source.
+ */
+static void check_scaling(MSPixFmt src_fmt, MSPixFmt dst_fmt, int dst_w, int dst_h) {
+	const int src_w = 64, src_h = 48, block = 16, margin = 3;
+	const int dst_block = block * dst_w / src_w;
+	uint8_t *src_planes[4], *dst_planes[4];
+	int src_strides[4], dst_strides[4];
+	mblk_t *src_msg = alloc_picture(src_fmt, src_w, src_h, src_planes, src_strides);
+	mblk_t *dst_msg = alloc_picture(dst_fmt, dst_w, dst_h, dst_planes, dst_strides);
+	MSScalerContext *ctx;
+	int i, j, errors = 0;
+
+	for (j = 0; j < src_h; j++) {
+		for (i = 0; i < src_w; i++) {
+			uint8_t rgb[3];
+			block_color(i / block, j / block, rgb);
+			write_pixel(src_fmt, src_planes, src_strides, i, j, rgb);
+		}
+	}
+
+	ctx = ms_scaler_create_context(src_w, src_h, src_fmt, dst_w, dst_h, dst_fmt, MS_SCALER_METHOD_BILINEAR);
+	if (BC_ASSERT_PTR_NOT_NULL(ctx)) {
+		BC_ASSERT_EQUAL(ms_scaler_process(ctx, src_planes, src_strides, dst_planes, dst_strides), 0, int, "%d");
+		ms_scaler_context_free(ctx);
+		for (j = 0; j < dst_h; j++) {
+			for (i = 0; i < dst_w; i++) {
+				uint8_t rgb[3], expected[3], yuv[3];
+				int k;
+				if (i % dst_block < margin || i % dst_block >= dst_block - margin || j % dst_block < margin ||
+				    j % dst_block >= dst_block - margin)
+					continue;
+				block_color(i / dst_block, j / dst_block, rgb);
+				ms_rgb_to_yuv(rgb, expected);
+				read_pixel_yuv(dst_fmt, dst_planes, dst_strides, i, j, yuv);
+				for (k = 0; k < 3; k++) {
+					if (abs(yuv[k] - expected[k]) > 4) errors++;
+				}
+			}
+		}
+		if (errors != 0)
+			ms_error("Wrong colors scaling %s to %s", ms_pix_fmt_to_string(src_fmt), ms_pix_fmt_to_string(dst_fmt));
+		BC_ASSERT_EQUAL(errors, 0, int, "%d");
+	}
+	free_picture(src_msg, src_planes);
+	free_picture(dst_msg, dst_planes);
+}
+
+static void test_video_scaling_of_packed_formats(void) {
+	if (ms_video_get_scaler_impl() == NULL) {
+		ms_message("No scaler available, skipping.");
+		return;
+	}
+	check_scaling(MS_RGB24, MS_RGB24, 32, 24);
+	check_scaling(MS_RGBA32, MS_RGBA32, 32, 24);
+	check_scaling(MS_RGBA32, MS_RGBA32, 128, 96);
+	check_scaling(MS_YUY2, MS_YUV420P, 128, 96);
+	check_scaling(MS_YUV420P, MS_YUY2, 32, 24);
+	check_scaling(MS_RGB24, MS_YUY2, 96, 72);
+	check_scaling(MS_YUY2, MS_RGBA32, 32, 24);
+}
+
 static void test_yuv_buf_copy_with_pix_strides_base(const MSVideoSize *size,
                                                     bool_t src_is_semiplanar,
                                                     bool_t dst_is_semiplanar,
@@ -601,12 +1038,935 @@ static void test_worker_threads_2(void) {
 	}
 }
 
+#define PARALLEL_TICKER_GRAPHS 8
+
+static void test_parallel_ticker(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSTicker *ticker = ms_ticker_new();
+	MSFilter *sources[PARALLEL_TICKER_GRAPHS];
+	MSFilter *sinks[PARALLEL_TICKER_GRAPHS];
+	MSFilter *mixer_sources[2];
+	MSFilter *mixer, *mixer_sink;
+	MSTickerComponentStats stats[PARALLEL_TICKER_GRAPHS + 1];
+	bool_t send_silence = TRUE;
+	uint32_t ticks;
+	int i, count;
+
+	ms_ticker_set_worker_count(ticker, 3);
+	for (i = 0; i < PARALLEL_TICKER_GRAPHS; i++) {
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_call_method(sources[i], MS_VOID_SOURCE_SEND_SILENCE, &send_silence);
+		ms_filter_link(sources[i], 0, sinks[i], 0);
+		ms_ticker_attach(ticker, sources[i]);
+	}
+	/* a graph with two sources is a single component */
+	mixer = ms_factory_create_filter(factory, MS_AUDIO_MIXER_ID);
+	mixer_sink = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+	for (i = 0; i < 2; i++) {
+		mixer_sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		ms_filter_call_method(mixer_sources[i], MS_VOID_SOURCE_SEND_SILENCE, &send_silence);
+		ms_filter_link(mixer_sources[i], 0, mixer, i);
+	}
+	ms_filter_link(mixer, 0, mixer_sink, 0);
+	ms_ticker_attach(ticker, mixer);
+
+	ticks = ticker->ticks;
+	ms_usleep(200000);
+	BC_ASSERT_GREATER((int)(ticker->ticks - ticks), 10, int, "%i");
+	count = ms_ticker_get_component_stats(ticker, stats, PARALLEL_TICKER_GRAPHS + 1);
+	BC_ASSERT_EQUAL(count, PARALLEL_TICKER_GRAPHS + 1, int, "%i");
+	for (i = 0; i < count && i < PARALLEL_TICKER_GRAPHS + 1; i++) {
+		if (stats[i].source == mixer_sources[0] || stats[i].source == mixer_sources[1]) {
+			BC_ASSERT_EQUAL(stats[i].filter_count, 4, int, "%i");
+		} else {
+			BC_ASSERT_EQUAL(stats[i].filter_count, 2, int, "%i");
+		}
+	}
+
+	/* detached graphs are no longer run */
+	for (i = 0; i < PARALLEL_TICKER_GRAPHS / 2; i++) {
+		ms_ticker_detach(ticker, sources[i]);
+	}
+	ms_usleep(50000);
+	count = ms_ticker_get_component_stats(ticker, stats, PARALLEL_TICKER_GRAPHS + 1);
+	BC_ASSERT_EQUAL(count, PARALLEL_TICKER_GRAPHS / 2 + 1, int, "%i");
+
+	/* back to sequential execution */
+	ms_ticker_set_worker_count(ticker, 0);
+	ticks = ticker->ticks;
+	ms_usleep(50000);
+	BC_ASSERT_GREATER((int)(ticker->ticks - ticks), 1, int, "%i");
+	BC_ASSERT_EQUAL(ms_ticker_get_component_stats(ticker, stats, PARALLEL_TICKER_GRAPHS + 1), 0, int, "%i");
+
+	for (i = PARALLEL_TICKER_GRAPHS / 2; i < PARALLEL_TICKER_GRAPHS; i++) {
+		ms_ticker_detach(ticker, sources[i]);
+	}
+	ms_ticker_detach(ticker, mixer);
+	ms_ticker_destroy(ticker);
+	for (i = 0; i < PARALLEL_TICKER_GRAPHS; i++) {
+		ms_filter_unlink(sources[i], 0, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+	}
+	for (i = 0; i < 2; i++) {
+		ms_filter_unlink(mixer_sources[i], 0, mixer, i);
+		ms_filter_destroy(mixer_sources[i]);
+	}
+	ms_filter_unlink(mixer, 0, mixer_sink, 0);
+	ms_filter_destroy(mixer);
+	ms_filter_destroy(mixer_sink);
+	ms_factory_destroy(factory);
+}
+
+static void disable_profiling_process(MSFilter *f) {
+	ms_ticker_enable_profiling(f->ticker, FALSE);
+}
+
+static void test_ticker_profiling(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSTicker *ticker = ms_ticker_new();
+	MSFilter *source = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+	MSFilter *sink = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+	MSFilter *disabler;
+	MSFilterDesc desc;
+	MSFilterProfile profiles[2];
+	bool_t send_silence = TRUE;
+	char *report;
+	int i, count;
+
+	ms_filter_call_method(source, MS_VOID_SOURCE_SEND_SILENCE, &send_silence);
+	ms_filter_link(source, 0, sink, 0);
+	BC_ASSERT_EQUAL(ms_ticker_get_filter_profiles(ticker, profiles, 2), 0, int, "%i");
+	BC_ASSERT_PTR_NULL(ms_ticker_get_profiling_report(ticker, MS_TICKER_PROFILE_JSON));
+	ms_ticker_enable_profiling(ticker, TRUE);
+	BC_ASSERT_TRUE(ms_ticker_profiling_enabled(ticker));
+	ms_ticker_attach(ticker, source);
+	ms_usleep(200000);
+
+	count = ms_ticker_get_filter_profiles(ticker, profiles, 2);
+	BC_ASSERT_EQUAL(count, 2, int, "%i");
+	for (i = 0; i < count && i < 2; i++) {
+		BC_ASSERT_TRUE(profiles[i].filter == source || profiles[i].filter == sink);
+		BC_ASSERT_PTR_EQUAL(profiles[i].graph_source, source);
+		BC_ASSERT_GREATER((int)profiles[i].count, 10, int, "%i");
+		BC_ASSERT_TRUE(profiles[i].p99_ns <= profiles[i].max_ns);
+		BC_ASSERT_TRUE(profiles[i].max_ns <= profiles[i].total_ns);
+	}
+	report = ms_ticker_get_profiling_report(ticker, MS_TICKER_PROFILE_JSON);
+	if (BC_ASSERT_PTR_NOT_NULL(report)) {
+		BC_ASSERT_PTR_NOT_NULL(strstr(report, "\"slowest_ticks\":[{"));
+		BC_ASSERT_PTR_NOT_NULL(strstr(report, "\"name\":\"MSVoidSink\""));
+		ms_free(report);
+	}
+	report = ms_ticker_get_profiling_report(ticker, MS_TICKER_PROFILE_CHROME_TRACE);
+	if (BC_ASSERT_PTR_NOT_NULL(report)) {
+		BC_ASSERT_PTR_NOT_NULL(strstr(report, "\"traceEvents\":["));
+		BC_ASSERT_PTR_NOT_NULL(strstr(report, "\"name\":\"MSVoidSource\",\"cat\":\"filter\""));
+		ms_free(report);
+	}
+
+	/* filters leaving the ticker are no longer profiled */
+	ms_ticker_detach(ticker, source);
+	BC_ASSERT_EQUAL(ms_ticker_get_filter_profiles(ticker, profiles, 2), 0, int, "%i");
+	ms_ticker_enable_profiling(ticker, FALSE);
+	BC_ASSERT_FALSE(ms_ticker_profiling_enabled(ticker));
+
+	/* a filter may disable the profiling while it is processed */
+	memset(&desc, 0, sizeof(desc));
+	desc.id = MS_FILTER_PLUGIN_ID;
+	desc.name = "MSDisableProfiling";
+	desc.category = MS_FILTER_OTHER;
+	desc.process = disable_profiling_process;
+	disabler = ms_factory_create_filter_from_desc(factory, &desc);
+	ms_filter_preprocess(disabler, ticker);
+	ms_ticker_enable_profiling(ticker, TRUE);
+	ms_filter_process(disabler);
+	BC_ASSERT_FALSE(ms_ticker_profiling_enabled(ticker));
+	ms_filter_postprocess(disabler);
+	ms_filter_destroy(disabler);
+
+	ms_ticker_destroy(ticker);
+	ms_filter_unlink(source, 0, sink, 0);
+	ms_filter_destroy(source);
+	ms_filter_destroy(sink);
+	ms_factory_destroy(factory);
+}
+
+static void test_itc_queue(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSFilter *producer = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+	MSFilter *sink = ms_factory_create_filter(factory, MS_ITC_SINK_ID);
+	MSFilter *source = ms_factory_create_filter(factory, MS_ITC_SOURCE_ID);
+	MSFilter *consumer = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+	MSFilter *unconnected_sink;
+	MSItcStats stats;
+	int i, count;
+	mblk_t *m;
+
+	ms_filter_link(producer, 0, sink, 0);
+	ms_filter_link(source, 0, consumer, 0);
+	ms_filter_call_method(sink, MS_ITC_SINK_CONNECT, source);
+
+	/* the queue is bounded: what does not fit is dropped */
+	ms_filter_call_method(sink, MS_ITC_SINK_GET_STATS, &stats);
+	for (i = 0; i < stats.capacity + 10; i++) {
+		m = allocb(4, 0);
+		*(int *)m->b_wptr = i;
+		m->b_wptr += 4;
+		ms_queue_put(sink->inputs[0], m);
+	}
+	ms_filter_process(sink);
+	ms_filter_call_method(sink, MS_ITC_SINK_GET_STATS, &stats);
+	BC_ASSERT_EQUAL(stats.queued, stats.capacity, int, "%i");
+	BC_ASSERT_EQUAL(stats.max_queued, stats.capacity, int, "%i");
+	BC_ASSERT_EQUAL(stats.dropped, 10, int, "%i");
+
+	/* the source gets the buffers in order */
+	ms_filter_process(source);
+	count = 0;
+	while ((m = ms_queue_get(source->outputs[0])) != NULL) {
+		BC_ASSERT_EQUAL(*(int *)m->b_rptr, count, int, "%i");
+		count++;
+		freemsg(m);
+	}
+	BC_ASSERT_EQUAL(count, stats.capacity, int, "%i");
+	ms_filter_call_method(sink, MS_ITC_SINK_GET_STATS, &stats);
+	BC_ASSERT_EQUAL(stats.queued, 0, int, "%i");
+
+	ms_filter_unlink(producer, 0, sink, 0);
+
+	/* without a source, the buffers are dropped too */
+	unconnected_sink = ms_factory_create_filter(factory, MS_ITC_SINK_ID);
+	ms_filter_link(producer, 0, unconnected_sink, 0);
+	for (i = 0; i < 3; i++)
+		ms_queue_put(unconnected_sink->inputs[0], allocb(4, 0));
+	ms_filter_process(unconnected_sink);
+	ms_filter_call_method(unconnected_sink, MS_ITC_SINK_GET_STATS, &stats);
+	BC_ASSERT_EQUAL(stats.queued, 0, int, "%i");
+	BC_ASSERT_EQUAL(stats.dropped, 3, int, "%i");
+	ms_filter_unlink(producer, 0, unconnected_sink, 0);
+	ms_filter_destroy(unconnected_sink);
+
+	ms_filter_unlink(source, 0, consumer, 0);
+	ms_filter_destroy(producer);
+	ms_filter_destroy(sink);
+	ms_filter_destroy(source);
+	ms_filter_destroy(consumer);
+	ms_factory_destroy(factory);
+}
+
+#define ITC_TEST_BUFFERS 1000000
+
+typedef struct ItcConsumer {
+	MSFilter *source;
+	uint8_t *received; /* per buffer number, the number of times it was received */
+} ItcConsumer;
+
+static ms_mutex_t itc_consumers_lock;
+static bool_t itc_consumers_running;
+
+/* processes an itc source in a loop, as its ticker would do but without waiting for the next tick */
+static void *itc_consumer_run(void *data) {
+	ItcConsumer *consumer = (ItcConsumer *)data;
+	bool_t running = TRUE;
+	mblk_t *m;
+
+	while (running) {
+		ms_filter_process(consumer->source);
+		while ((m = ms_queue_get(consumer->source->outputs[0])) != NULL) {
+			consumer->received[*(int *)m->b_rptr]++;
+			freemsg(m);
+		}
+		ms_mutex_lock(&itc_consumers_lock);
+		running = itc_consumers_running;
+		ms_mutex_unlock(&itc_consumers_lock);
+	}
+	return NULL;
+}
+
+static void test_itc_reconnection(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSFilter *producer = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+	MSFilter *sink = ms_factory_create_filter(factory, MS_ITC_SINK_ID);
+	MSFilter *void_sinks[2];
+	ItcConsumer consumers[2];
+	bctbx_thread_t threads[2];
+	MSItcStats stats;
+	int received = 0, duplicates = 0;
+	int i;
+
+	ms_mutex_init(&itc_consumers_lock, NULL);
+	itc_consumers_running = TRUE;
+	ms_filter_link(producer, 0, sink, 0);
+	for (i = 0; i < 2; i++) {
+		consumers[i].source = ms_factory_create_filter(factory, MS_ITC_SOURCE_ID);
+		consumers[i].received = ms_new0(uint8_t, ITC_TEST_BUFFERS);
+		void_sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_link(consumers[i].source, 0, void_sinks[i], 0);
+		bctbx_thread_create(&threads[i], NULL, itc_consumer_run, &consumers[i]);
+	}
+
+	/* the sink is switched from one source to the other, by bursts of buffers, while both of them consume */
+	for (i = 0; i < ITC_TEST_BUFFERS; i++) {
+		mblk_t *m = allocb(4, 0);
+		*(int *)m->b_wptr = i;
+		m->b_wptr += 4;
+		ms_queue_put(sink->inputs[0], m);
+		if (i % 32 == 31) {
+			ms_filter_process(sink);
+			ms_filter_call_method(sink, MS_ITC_SINK_CONNECT, consumers[(i / 32) % 2].source);
+		}
+	}
+	ms_filter_process(sink);
+	ms_usleep(20000);
+	ms_mutex_lock(&itc_consumers_lock);
+	itc_consumers_running = FALSE;
+	ms_mutex_unlock(&itc_consumers_lock);
+	for (i = 0; i < 2; i++)
+		bctbx_thread_join(threads[i], NULL);
+
+	for (i = 0; i < ITC_TEST_BUFFERS; i++) {
+		int count = consumers[0].received[i] + consumers[1].received[i];
+		if (count > 0) received++;
+		if (count > 1) duplicates++;
+	}
+	ms_filter_call_method(sink, MS_ITC_SINK_GET_STATS, &stats);
+	BC_ASSERT_EQUAL(duplicates, 0, int, "%i");
+	BC_ASSERT_EQUAL(received + stats.dropped + stats.queued, ITC_TEST_BUFFERS, int, "%i");
+
+	ms_filter_unlink(producer, 0, sink, 0);
+	ms_filter_destroy(producer);
+	ms_filter_destroy(sink);
+	for (i = 0; i < 2; i++) {
+		ms_filter_unlink(consumers[i].source, 0, void_sinks[i], 0);
+		ms_filter_destroy(consumers[i].source);
+		ms_filter_destroy(void_sinks[i]);
+		ms_free(consumers[i].received);
+	}
+	ms_mutex_destroy(&itc_consumers_lock);
+	ms_factory_destroy(factory);
+}
+
+#define MIXER_TEST_PINS 5
+
+/* pushes one tick of a constant signal on each input of the mixer, processes it and returns the first sample of each
+ * output, or leaves the outputs in their queues if outputs is NULL */
+static void mixer_tick(MSFilter *mixer, MSTicker *ticker, const int16_t *amplitudes, int16_t *outputs) {
+	int nsamples = 80; /* 10 ms at 8 kHz */
+	int i, j;
+
+	ticker->time += ticker->interval;
+	for (i = 0; i < MIXER_TEST_PINS; i++) {
+		mblk_t *m = allocb(nsamples * 2, 0);
+		for (j = 0; j < nsamples; j++)
+			((int16_t *)m->b_wptr)[j] = amplitudes[i];
+		m->b_wptr += nsamples * 2;
+		ms_queue_put(mixer->inputs[i], m);
+	}
+	ms_filter_process(mixer);
+	if (outputs == NULL) return;
+	for (i = 0; i < MIXER_TEST_PINS; i++) {
+		mblk_t *m = ms_queue_get(mixer->outputs[i]);
+		outputs[i] = m ? *(int16_t *)m->b_rptr : -1;
+		if (m) freemsg(m);
+		ms_queue_flush(mixer->outputs[i]);
+	}
+}
+
+static void test_audio_mixer_speaker_selection(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSFilter *mixer = ms_factory_create_filter(factory, MS_AUDIO_MIXER_ID);
+	MSFilter *sources[MIXER_TEST_PINS];
+	MSFilter *sinks[MIXER_TEST_PINS];
+	int16_t amplitudes[MIXER_TEST_PINS] = {8000, 4000, 1000, 0, 0};
+	int16_t outputs[MIXER_TEST_PINS];
+	mblk_t *listener_outputs[2];
+	MSTicker ticker;
+	int rate = 8000;
+	int conf_mode = TRUE;
+	int max_speakers = 2;
+	int i;
+
+	/* the mixer is driven by hand, with a ticker whose time is set by the test */
+	memset(&ticker, 0, sizeof(ticker));
+	ticker.interval = 10;
+	ms_filter_call_method(mixer, MS_FILTER_SET_SAMPLE_RATE, &rate);
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, &conf_mode);
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_MAX_SPEAKERS, &max_speakers);
+	for (i = 0; i < MIXER_TEST_PINS; i++) {
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_link(sources[i], 0, mixer, i);
+		ms_filter_link(mixer, i, sinks[i], 0);
+	}
+	ms_filter_preprocess(mixer, &ticker);
+
+	/* the two loudest channels are mixed, each one hears the other */
+	for (i = 0; i < 3; i++)
+		mixer_tick(mixer, &ticker, amplitudes, outputs);
+	BC_ASSERT_EQUAL(outputs[0], 4000, int, "%i");
+	BC_ASSERT_EQUAL(outputs[1], 8000, int, "%i");
+	BC_ASSERT_EQUAL(outputs[2], 12000, int, "%i");
+	BC_ASSERT_EQUAL(outputs[3], 12000, int, "%i");
+
+	/* a channel slightly louder than a speaker does not replace it */
+	amplitudes[2] = 5000;
+	for (i = 0; i < 60; i++)
+		mixer_tick(mixer, &ticker, amplitudes, outputs);
+	BC_ASSERT_EQUAL(outputs[2], 12000, int, "%i");
+	BC_ASSERT_EQUAL(outputs[3], 12000, int, "%i");
+
+	/* 3 dB louder, it does */
+	amplitudes[2] = 7000;
+	mixer_tick(mixer, &ticker, amplitudes, outputs);
+	BC_ASSERT_EQUAL(outputs[1], 15000, int, "%i");
+	BC_ASSERT_EQUAL(outputs[2], 8000, int, "%i");
+	BC_ASSERT_EQUAL(outputs[4], 15000, int, "%i");
+
+	/* the outputs of the listeners are independent: changing one in place, as an equalizer does, leaves the other */
+	mixer_tick(mixer, &ticker, amplitudes, NULL);
+	listener_outputs[0] = ms_queue_get(mixer->outputs[3]);
+	listener_outputs[1] = ms_queue_get(mixer->outputs[4]);
+	if (BC_ASSERT_PTR_NOT_NULL(listener_outputs[0]) && BC_ASSERT_PTR_NOT_NULL(listener_outputs[1])) {
+		memset(listener_outputs[0]->b_rptr, 0, listener_outputs[0]->b_wptr - listener_outputs[0]->b_rptr);
+		BC_ASSERT_EQUAL(*(int16_t *)listener_outputs[1]->b_rptr, 15000, int, "%i");
+	}
+	for (i = 0; i < 2; i++) {
+		if (listener_outputs[i]) freemsg(listener_outputs[i]);
+	}
+	for (i = 0; i < MIXER_TEST_PINS; i++)
+		ms_queue_flush(mixer->outputs[i]);
+
+	ms_filter_postprocess(mixer);
+	for (i = 0; i < MIXER_TEST_PINS; i++) {
+		ms_filter_unlink(sources[i], 0, mixer, i);
+		ms_filter_unlink(mixer, i, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+	}
+	ms_filter_destroy(mixer);
+	ms_factory_destroy(factory);
+}
+
+static void set_mixer_simd(const char *kernels) {
+#ifdef _WIN32
+	_putenv_s("MS2_AUDIO_MIXER_SIMD", kernels ? kernels : "");
+#else
+	if (kernels) setenv("MS2_AUDIO_MIXER_SIMD", kernels, 1);
+	else unsetenv("MS2_AUDIO_MIXER_SIMD");
+#endif
+}
+
+/* mixes a few ticks of loud noise with the given kernels, and returns the outputs of all the pins one after the other */
+static int16_t *mix_with_kernels(MSFactory *factory, const char *kernels, int nticks, int nsamples) {
+	MSFilter *mixer;
+	MSFilter *sources[MIXER_TEST_PINS];
+	MSFilter *sinks[MIXER_TEST_PINS];
+	MSAudioMixerCtl ctl;
+	MSTicker ticker;
+	int16_t *outputs = ms_new0(int16_t, nticks * MIXER_TEST_PINS * nsamples);
+	int16_t *out = outputs;
+	uint32_t noise = 12345;
+	int rate = nsamples * 100;
+	int conf_mode = TRUE;
+	int max_speakers = MIXER_TEST_PINS - 1;
+	int i, j, k;
+
+	set_mixer_simd(kernels);
+	mixer = ms_factory_create_filter(factory, MS_AUDIO_MIXER_ID);
+	set_mixer_simd(NULL);
+	memset(&ticker, 0, sizeof(ticker));
+	ticker.interval = 10;
+	ms_filter_call_method(mixer, MS_FILTER_SET_SAMPLE_RATE, &rate);
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, &conf_mode);
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_MAX_SPEAKERS, &max_speakers);
+	/* gains above and below 1, so that the gain saturates too */
+	for (i = 0; i < MIXER_TEST_PINS; i++) {
+		ctl.pin = i;
+		ctl.param.gain = 0.5f + 0.4f * (float)i;
+		ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_INPUT_GAIN, &ctl);
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_link(sources[i], 0, mixer, i);
+		ms_filter_link(mixer, i, sinks[i], 0);
+	}
+	ms_filter_preprocess(mixer, &ticker);
+
+	for (k = 0; k < nticks; k++) {
+		ticker.time += ticker.interval;
+		for (i = 0; i < MIXER_TEST_PINS; i++) {
+			mblk_t *m = allocb(nsamples * 2, 0);
+			for (j = 0; j < nsamples; j++) {
+				noise = noise * 1103515245 + 12345;
+				/* the last pin is quieter, to be left out of the speakers */
+				((int16_t *)m->b_wptr)[j] = (int16_t)(noise >> 16) >> (i == MIXER_TEST_PINS - 1 ? 4 : 0);
+			}
+			m->b_wptr += nsamples * 2;
+			ms_queue_put(mixer->inputs[i], m);
+		}
+		ms_filter_process(mixer);
+		for (i = 0; i < MIXER_TEST_PINS; i++) {
+			mblk_t *m = ms_queue_get(mixer->outputs[i]);
+			if (m && msgdsize(m) == (size_t)nsamples * 2) memcpy(out, m->b_rptr, nsamples * 2);
+			if (m) freemsg(m);
+			ms_queue_flush(mixer->outputs[i]);
+			out += nsamples;
+		}
+	}
+
+	ms_filter_postprocess(mixer);
+	for (i = 0; i < MIXER_TEST_PINS; i++) {
+		ms_filter_unlink(sources[i], 0, mixer, i);
+		ms_filter_unlink(mixer, i, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+	}
+	ms_filter_destroy(mixer);
+	return outputs;
+}
+
+static void test_audio_mixer_kernels(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	const char *kernels[] = {"sse2", "avx2", "neon"};
+	/* 110 samples per tick: the vectorized kernels have a tail to process */
+	const int nticks = 20;
+	const int nsamples = 110;
+	const size_t size = nticks * MIXER_TEST_PINS * nsamples * sizeof(int16_t);
+	int16_t *reference = mix_with_kernels(factory, "c", nticks, nsamples);
+	bool_t saturated_high = FALSE, saturated_low = FALSE;
+	size_t i;
+
+	for (i = 0; i < size / sizeof(int16_t); i++) {
+		if (reference[i] == 32767) saturated_high = TRUE;
+		if (reference[i] == -32767) saturated_low = TRUE;
+	}
+	BC_ASSERT_TRUE(saturated_high);
+	BC_ASSERT_TRUE(saturated_low);
+
+	/* the kernels that the cpu does not support are replaced by the best ones */
+	for (i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+		int16_t *outputs = mix_with_kernels(factory, kernels[i], nticks, nsamples);
+		if (!BC_ASSERT_TRUE(memcmp(outputs, reference, size) == 0)) ms_error("[%s] mixing kernels differ", kernels[i]);
+		ms_free(outputs);
+	}
+	ms_free(reference);
+	ms_factory_destroy(factory);
+}
+
+typedef struct _ResampleTestCase {
+	int input_rate;
+	int output_rate;
+	int input_nchannels;
+	int output_nchannels;
+} ResampleTestCase;
+
+/* chunks of 97 frames: the vectorized kernels have a tail to process */
+#define RESAMPLE_TEST_CHUNKS 20
+#define RESAMPLE_TEST_CHUNK_FRAMES 97
+#define RESAMPLE_TEST_FRAMES (RESAMPLE_TEST_CHUNKS * RESAMPLE_TEST_CHUNK_FRAMES)
+
+static const ResampleTestCase resample_test_cases[] = {
+    {8000, 16000, 2, 1}, {16000, 8000, 1, 2},  {48000, 16000, 2, 3}, {8000, 48000, 2, 3},
+    {48000, 48000, 2, 1}, {48000, 48000, 1, 2}, {48000, 48000, 2, 3}};
+
+static void set_resample_simd(const char *kernels) {
+#ifdef _WIN32
+	_putenv_s("MS2_RESAMPLE_SIMD", kernels ? kernels : "");
+#else
+	if (kernels) setenv("MS2_RESAMPLE_SIMD", kernels, 1);
+	else unsetenv("MS2_RESAMPLE_SIMD");
+#endif
+}
+
+/* a different noise on each channel, so that taking the wrong channel shows */
+static int16_t *make_resample_input(int nchannels) {
+	int16_t *input = ms_new(int16_t, RESAMPLE_TEST_FRAMES * nchannels);
+	uint32_t noise = 12345;
+	int i;
+
+	for (i = 0; i < RESAMPLE_TEST_FRAMES * nchannels; i++) {
+		noise = noise * 1103515245 + 12345;
+		input[i] = (int16_t)(noise >> 16) >> 2;
+	}
+	return input;
+}
+
+/* resamples the whole input with the given kernels and quality, and returns the output, or NULL if MSResample is not
+ * available */
+static int16_t *resample_with_kernels(MSFactory *factory,
+                                      const char *kernels,
+                                      const ResampleTestCase *tc,
+                                      int quality,
+                                      const int16_t *input,
+                                      int *nframes) {
+	const int max_frames = RESAMPLE_TEST_FRAMES * tc->output_rate / tc->input_rate + RESAMPLE_TEST_CHUNKS;
+	const size_t chunk_size = RESAMPLE_TEST_CHUNK_FRAMES * tc->input_nchannels * sizeof(int16_t);
+	const size_t max_size = max_frames * tc->output_nchannels * sizeof(int16_t);
+	MSFilter *resampler, *source, *sink;
+	MSTicker ticker;
+	uint8_t *output;
+	size_t size = 0;
+	int i;
+
+	set_resample_simd(kernels);
+	resampler = ms_factory_create_filter(factory, MS_RESAMPLE_ID);
+	set_resample_simd(NULL);
+	if (resampler == NULL) return NULL;
+	output = ms_new0(uint8_t, max_size);
+	memset(&ticker, 0, sizeof(ticker));
+	ticker.interval = 10;
+	ms_filter_call_method(resampler, MS_FILTER_SET_SAMPLE_RATE, (void *)&tc->input_rate);
+	ms_filter_call_method(resampler, MS_FILTER_SET_OUTPUT_SAMPLE_RATE, (void *)&tc->output_rate);
+	ms_filter_call_method(resampler, MS_FILTER_SET_NCHANNELS, (void *)&tc->input_nchannels);
+	ms_filter_call_method(resampler, MS_FILTER_SET_OUTPUT_NCHANNELS, (void *)&tc->output_nchannels);
+	BC_ASSERT_EQUAL(ms_filter_call_method(resampler, MS_RESAMPLE_SET_QUALITY, &quality), 0, int, "%d");
+	source = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+	sink = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+	ms_filter_link(source, 0, resampler, 0);
+	ms_filter_link(resampler, 0, sink, 0);
+	ms_filter_preprocess(resampler, &ticker);
+
+	for (i = 0; i < RESAMPLE_TEST_CHUNKS; i++) {
+		mblk_t *m = allocb(chunk_size, 0);
+		memcpy(m->b_wptr, (const uint8_t *)input + i * chunk_size, chunk_size);
+		m->b_wptr += chunk_size;
+		ms_queue_put(resampler->inputs[0], m);
+		ms_filter_process(resampler);
+		while ((m = ms_queue_get(resampler->outputs[0])) != NULL) {
+			size_t len = msgdsize(m);
+			if (BC_ASSERT_TRUE(size + len <= max_size)) {
+				memcpy(output + size, m->b_rptr, len);
+				size += len;
+			}
+			freemsg(m);
+		}
+	}
+
+	ms_filter_postprocess(resampler);
+	ms_filter_unlink(source, 0, resampler, 0);
+	ms_filter_unlink(resampler, 0, sink, 0);
+	ms_filter_destroy(source);
+	ms_filter_destroy(resampler);
+	ms_filter_destroy(sink);
+	*nframes = (int)(size / (tc->output_nchannels * sizeof(int16_t)));
+	return (int16_t *)output;
+}
+
+/* every output channel must be the first input channel, resampled alone */
+static void test_resample_channel_adaptation(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	size_t i;
+
+	for (i = 0; i < sizeof(resample_test_cases) / sizeof(resample_test_cases[0]); i++) {
+		const ResampleTestCase *tc = &resample_test_cases[i];
+		ResampleTestCase mono_tc = *tc;
+		int16_t *input = make_resample_input(tc->input_nchannels);
+		int16_t *first_channel = ms_new(int16_t, RESAMPLE_TEST_FRAMES);
+		int16_t *output, *reference;
+		int nframes = 0, reference_nframes = 0, errors = 0;
+		int j, c;
+
+		for (j = 0; j < RESAMPLE_TEST_FRAMES; j++)
+			first_channel[j] = input[j * tc->input_nchannels];
+		mono_tc.input_nchannels = mono_tc.output_nchannels = 1;
+		output = resample_with_kernels(factory, NULL, tc, MS_RESAMPLE_QUALITY_DEFAULT, input, &nframes);
+		if (output == NULL) {
+			ms_message("MSResample is not available, skipping.");
+			ms_free(input);
+			ms_free(first_channel);
+			break;
+		}
+		reference = resample_with_kernels(factory, NULL, &mono_tc, MS_RESAMPLE_QUALITY_DEFAULT, first_channel,
+		                                  &reference_nframes);
+		BC_ASSERT_GREATER(nframes, RESAMPLE_TEST_FRAMES * tc->output_rate / tc->input_rate / 2, int, "%d");
+		BC_ASSERT_EQUAL(nframes, reference_nframes, int, "%d");
+		for (j = 0; j < MIN(nframes, reference_nframes); j++) {
+			for (c = 0; c < tc->output_nchannels; c++) {
+				if (output[j * tc->output_nchannels + c] != reference[j]) errors++;
+			}
+		}
+		if (errors != 0)
+			ms_error("Resampling from %i Hz, %i channels to %i Hz, %i channels: %i wrong samples", tc->input_rate,
+			         tc->input_nchannels, tc->output_rate, tc->output_nchannels, errors);
+		BC_ASSERT_EQUAL(errors, 0, int, "%d");
+		ms_free(output);
+		ms_free(reference);
+		ms_free(input);
+		ms_free(first_channel);
+	}
+	ms_factory_destroy(factory);
+}
+
+/* the vectorized channel kernels, and unknown ones that fall back to the best kernels, must give the output of the
+ * portable ones */
+static void test_resample_kernels(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	const char *kernels[] = {"sse2", "avx2", "neon", "unknown"};
+	size_t i, k;
+
+	for (i = 0; i < sizeof(resample_test_cases) / sizeof(resample_test_cases[0]); i++) {
+		const ResampleTestCase *tc = &resample_test_cases[i];
+		int16_t *input = make_resample_input(tc->input_nchannels);
+		int reference_nframes = 0;
+		int16_t *reference =
+		    resample_with_kernels(factory, "c", tc, MS_RESAMPLE_QUALITY_DEFAULT, input, &reference_nframes);
+
+		if (reference == NULL) {
+			ms_message("MSResample is not available, skipping.");
+			ms_free(input);
+			break;
+		}
+		for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+			int nframes = 0;
+			int16_t *output = resample_with_kernels(factory, kernels[k], tc, MS_RESAMPLE_QUALITY_DEFAULT, input,
+			                                        &nframes);
+			BC_ASSERT_EQUAL(nframes, reference_nframes, int, "%d");
+			if (nframes == reference_nframes &&
+			    !BC_ASSERT_TRUE(memcmp(output, reference, nframes * tc->output_nchannels * sizeof(int16_t)) == 0))
+				ms_error("[%s] resampling kernels differ, from %i to %i channels", kernels[k], tc->input_nchannels,
+				         tc->output_nchannels);
+			ms_free(output);
+		}
+		ms_free(reference);
+		ms_free(input);
+	}
+	ms_factory_destroy(factory);
+}
+
+/* both qualities must keep the level of a tone, with different filters */
+static void test_resample_quality(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	const ResampleTestCase tc = {8000, 48000, 1, 1};
+	int16_t *tone = ms_new(int16_t, RESAMPLE_TEST_FRAMES);
+	int16_t *outputs[2];
+	int nframes[2];
+	int i, q;
+
+	for (i = 0; i < RESAMPLE_TEST_FRAMES; i++)
+		tone[i] = (int16_t)(10000 * sin(2 * M_PI * 400 * i / tc.input_rate));
+	outputs[0] = resample_with_kernels(factory, NULL, &tc, MS_RESAMPLE_QUALITY_DEFAULT, tone, &nframes[0]);
+	if (outputs[0] == NULL) {
+		ms_message("MSResample is not available, skipping.");
+		goto end;
+	}
+	outputs[1] = resample_with_kernels(factory, NULL, &tc, MS_RESAMPLE_QUALITY_FAST, tone, &nframes[1]);
+	for (q = 0; q < 2; q++) {
+		/* away from the delay of the filter */
+		double energy = 0;
+		int count = 0;
+		for (i = nframes[q] / 4; i < nframes[q]; i++, count++)
+			energy += (double)outputs[q][i] * outputs[q][i];
+		BC_ASSERT_GREATER(nframes[q], RESAMPLE_TEST_FRAMES * 5, int, "%d");
+		/* the tone has a RMS level of 10000 / sqrt(2) */
+		if (count > 0) {
+			BC_ASSERT_GREATER(sqrt(energy / count), 6500, double, "%f");
+			BC_ASSERT_LOWER(sqrt(energy / count), 7700, double, "%f");
+		}
+	}
+	BC_ASSERT_FALSE(nframes[0] == nframes[1] && memcmp(outputs[0], outputs[1], nframes[0] * sizeof(int16_t)) == 0);
+	ms_free(outputs[0]);
+	ms_free(outputs[1]);
+end:
+	ms_free(tone);
+	ms_factory_destroy(factory);
+}
+
+#define ROUTER_TEST_PINS 5
+
+/* pushes on each input of the router a packet with the given client to mixer audio level, a level of 0 meaning no
+ * voice activity, and returns for each output a bit mask of the inputs whose packet it got */
+static void router_tick(MSFilter *router, RtpSession *session, const int *levels, int *received) {
+	uint8_t payload[20] = {0};
+	int i;
+
+	for (i = 0; i < ROUTER_TEST_PINS; i++) {
+		mblk_t *m = rtp_session_create_packet_header(session, 0);
+		rtp_set_ssrc(m, i);
+		rtp_add_client_to_mixer_audio_level(m, RTP_EXTENSION_CLIENT_TO_MIXER_AUDIO_LEVEL, levels[i] != 0,
+		                                    levels[i] != 0 ? levels[i] : -90);
+		m->b_cont = rtp_create_packet(payload, sizeof(payload));
+		ms_queue_put(router->inputs[i], m);
+	}
+	ms_filter_process(router);
+	for (i = 0; i < ROUTER_TEST_PINS; i++) {
+		mblk_t *m;
+		received[i] = 0;
+		while ((m = ms_queue_get(router->outputs[i])) != NULL) {
+			received[i] |= 1 << rtp_get_ssrc(m);
+			freemsg(m);
+		}
+	}
+}
+
+static void test_packet_router_speaker_selection(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSFilter *router = ms_factory_create_filter(factory, MS_PACKET_ROUTER_ID);
+	MSFilter *sources[ROUTER_TEST_PINS];
+	MSFilter *sinks[ROUTER_TEST_PINS];
+	RtpSession *session = rtp_session_new(RTP_SESSION_SENDONLY);
+	MSPacketRouterMode mode = MS_PACKET_ROUTER_MODE_AUDIO;
+	bool_t full_packet = TRUE;
+	int levels[ROUTER_TEST_PINS] = {-10, -20, -30, -40, 0};
+	int received[ROUTER_TEST_PINS];
+	int max_speakers = 0;
+	int active_speaker = -1;
+	MSTicker ticker;
+	int i;
+
+	memset(&ticker, 0, sizeof(ticker));
+	ticker.interval = 20;
+	ms_filter_call_method(router, MS_PACKET_ROUTER_SET_ROUTING_MODE, &mode);
+	ms_filter_call_method(router, MS_PACKET_ROUTER_SET_FULL_PACKET_MODE_ENABLED, &full_packet);
+	BC_ASSERT_EQUAL(ms_filter_call_method(router, MS_PACKET_ROUTER_SET_MAX_SPEAKERS, &max_speakers), -1, int, "%d");
+	max_speakers = 2;
+	BC_ASSERT_EQUAL(ms_filter_call_method(router, MS_PACKET_ROUTER_SET_MAX_SPEAKERS, &max_speakers), 0, int, "%d");
+	for (i = 0; i < ROUTER_TEST_PINS; i++) {
+		MSPacketRouterPinData pin_data;
+		memset(&pin_data, 0, sizeof(pin_data));
+		pin_data.input = pin_data.output = pin_data.self = i;
+		ms_filter_call_method(router, MS_PACKET_ROUTER_CONFIGURE_OUTPUT, &pin_data);
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_link(sources[i], 0, router, i);
+		ms_filter_link(router, i, sinks[i], 0);
+	}
+	ms_filter_preprocess(router, &ticker);
+
+	/* only the two loudest speakers are forwarded, never to themselves */
+	router_tick(router, session, levels, received);
+	BC_ASSERT_EQUAL(received[0], 1 << 1, int, "%x");
+	BC_ASSERT_EQUAL(received[1], 1 << 0, int, "%x");
+	BC_ASSERT_EQUAL(received[4], (1 << 0) | (1 << 1), int, "%x");
+	ms_filter_call_method(router, MS_PACKET_ROUTER_GET_ACTIVE_SPEAKER_PIN, &active_speaker);
+	BC_ASSERT_EQUAL(active_speaker, 0, int, "%d");
+
+	max_speakers = 3;
+	ms_filter_call_method(router, MS_PACKET_ROUTER_SET_MAX_SPEAKERS, &max_speakers);
+	router_tick(router, session, levels, received);
+	BC_ASSERT_EQUAL(received[4], (1 << 0) | (1 << 1) | (1 << 2), int, "%x");
+
+	/* less speakers than the maximum: the active speaker is still the loudest one, not the first pin */
+	levels[0] = levels[1] = 0;
+	levels[2] = -30;
+	levels[3] = -10;
+	router_tick(router, session, levels, received);
+	BC_ASSERT_EQUAL(received[4], (1 << 2) | (1 << 3), int, "%x");
+	ms_filter_call_method(router, MS_PACKET_ROUTER_GET_ACTIVE_SPEAKER_PIN, &active_speaker);
+	BC_ASSERT_EQUAL(active_speaker, 3, int, "%d");
+
+	ms_filter_postprocess(router);
+	for (i = 0; i < ROUTER_TEST_PINS; i++) {
+		ms_filter_unlink(sources[i], 0, router, i);
+		ms_filter_unlink(router, i, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+	}
+	ms_filter_destroy(router);
+	rtp_session_destroy(session);
+	ms_factory_destroy(factory);
+}
+
+/* in full packet mode, a packet forwarded to several outputs shares its payload, but not its header */
+static void test_packet_router_forwarding(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSFilter *router = ms_factory_create_filter(factory, MS_PACKET_ROUTER_ID);
+	MSFilter *sources[3];
+	MSFilter *sinks[3];
+	RtpSession *session = rtp_session_new(RTP_SESSION_SENDONLY);
+	MSPacketRouterMode mode = MS_PACKET_ROUTER_MODE_AUDIO;
+	bool_t full_packet = TRUE;
+	uint8_t payload[20];
+	mblk_t *m;
+	mblk_t *outputs[2];
+	uint8_t *data;
+	bool_t voice_activity = FALSE;
+	MSTicker ticker;
+	int i;
+
+	memset(&ticker, 0, sizeof(ticker));
+	ticker.interval = 20;
+	ms_filter_call_method(router, MS_PACKET_ROUTER_SET_ROUTING_MODE, &mode);
+	ms_filter_call_method(router, MS_PACKET_ROUTER_SET_FULL_PACKET_MODE_ENABLED, &full_packet);
+	for (i = 0; i < 3; i++) {
+		MSPacketRouterPinData pin_data;
+		memset(&pin_data, 0, sizeof(pin_data));
+		pin_data.input = pin_data.output = pin_data.self = i;
+		/* the participant of the second pin negotiated another id for the audio level */
+		pin_data.extension_ids[RTP_EXTENSION_CLIENT_TO_MIXER_AUDIO_LEVEL] =
+		    i == 1 ? 9 : RTP_EXTENSION_CLIENT_TO_MIXER_AUDIO_LEVEL;
+		ms_filter_call_method(router, MS_PACKET_ROUTER_CONFIGURE_OUTPUT, &pin_data);
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_link(sources[i], 0, router, i);
+		ms_filter_link(router, i, sinks[i], 0);
+	}
+	ms_filter_preprocess(router, &ticker);
+
+	/* a packet in a single block, as received from the network */
+	for (i = 0; i < (int)sizeof(payload); i++)
+		payload[i] = (uint8_t)i;
+	m = rtp_session_create_packet_header(session, 0);
+	rtp_add_client_to_mixer_audio_level(m, RTP_EXTENSION_CLIENT_TO_MIXER_AUDIO_LEVEL, TRUE, -10);
+	m->b_cont = rtp_create_packet(payload, sizeof(payload));
+	msgpullup(m, (size_t)-1);
+	ms_queue_put(router->inputs[0], m);
+	ms_filter_process(router);
+
+	outputs[0] = ms_queue_get(router->outputs[1]);
+	outputs[1] = ms_queue_get(router->outputs[2]);
+	if (!BC_ASSERT_PTR_NOT_NULL(outputs[0]) || !BC_ASSERT_PTR_NOT_NULL(outputs[1])) goto end;
+	if (!BC_ASSERT_PTR_NOT_NULL(outputs[0]->b_cont) || !BC_ASSERT_PTR_NOT_NULL(outputs[1]->b_cont)) goto end;
+	BC_ASSERT_TRUE(outputs[0]->b_datap != outputs[1]->b_datap);
+	BC_ASSERT_TRUE(outputs[0]->b_cont->b_datap == outputs[1]->b_cont->b_datap);
+	BC_ASSERT_EQUAL((int)msgdsize(outputs[0]->b_cont), (int)sizeof(payload), int, "%d");
+	BC_ASSERT_TRUE(memcmp(outputs[1]->b_cont->b_rptr, payload, sizeof(payload)) == 0);
+
+	/* the extension id is remapped in the header of the second pin only */
+	BC_ASSERT_EQUAL(rtp_get_client_to_mixer_audio_level(outputs[0], 9, &voice_activity), -10, int, "%d");
+	BC_ASSERT_TRUE(voice_activity);
+	BC_ASSERT_EQUAL(rtp_get_extension_header(outputs[0], RTP_EXTENSION_CLIENT_TO_MIXER_AUDIO_LEVEL, &data), -1, int,
+	                "%d");
+	BC_ASSERT_EQUAL(
+	    rtp_get_client_to_mixer_audio_level(outputs[1], RTP_EXTENSION_CLIENT_TO_MIXER_AUDIO_LEVEL, &voice_activity), -10,
+	    int, "%d");
+	BC_ASSERT_EQUAL(rtp_get_extension_header(outputs[1], 9, &data), -1, int, "%d");
+
+end:
+	for (i = 0; i < 2; i++) {
+		if (outputs[i]) freemsg(outputs[i]);
+	}
+	ms_filter_postprocess(router);
+	for (i = 0; i < 3; i++) {
+		ms_queue_flush(router->outputs[i]);
+		ms_filter_unlink(sources[i], 0, router, i);
+		ms_filter_unlink(router, i, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+	}
+	ms_filter_destroy(router);
+	rtp_session_destroy(session);
+	ms_factory_destroy(factory);
+}
+
 static test_t tests[] = {TEST_NO_TAG("Multiple ms_voip_init", filter_register_tester),
                          TEST_NO_TAG("Is multicast", test_is_multicast),
                          TEST_NO_TAG("FilterDesc enabling/disabling", test_filterdesc_enable_disable),
                          TEST_NO_TAG("Worker threads", test_worker_threads),
                          TEST_NO_TAG("Worker threads 2", test_worker_threads_2),
+                         TEST_NO_TAG("Parallel ticker", test_parallel_ticker),
+                         TEST_NO_TAG("Ticker profiling", test_ticker_profiling),
+                         TEST_NO_TAG("Inter ticker queue", test_itc_queue),
+                         TEST_NO_TAG("Inter ticker reconnection", test_itc_reconnection),
+                         TEST_NO_TAG("Audio mixer speaker selection", test_audio_mixer_speaker_selection),
+                         TEST_NO_TAG("Audio mixer kernels", test_audio_mixer_kernels),
+                         TEST_NO_TAG("Resampler channel adaptation", test_resample_channel_adaptation),
+                         TEST_NO_TAG("Resampler kernels", test_resample_kernels),
+                         TEST_NO_TAG("Resampler quality", test_resample_quality),
+                         TEST_NO_TAG("Packet router speaker selection", test_packet_router_speaker_selection),
+                         TEST_NO_TAG("Packet router forwarding", test_packet_router_forwarding),
 #ifdef VIDEO_ENABLED
+                         TEST_NO_TAG("Frame pool", test_frame_pool),
                          TEST_NO_TAG("Video processing function", test_video_processing),
                          TEST_NO_TAG("Copy ycbcrbiplanar to true yuv with downscaling",
                                      test_copy_ycbcrbiplanar_to_true_yuv_with_downscaling),
@@ -618,6 +1978,10 @@ static test_t tests[] = {TEST_NO_TAG("Multiple ms_voip_init", filter_register_te
                                      test_copy_ycbcrbiplanar_to_true_yuv_with_rotation_180),
                          TEST_NO_TAG("Copy ycbcrbiplanar to true yuv with rotation 180 with downscaling",
                                      test_copy_ycbcrbiplanar_to_true_yuv_with_rotation_180_with_downscaling),
+                         TEST_NO_TAG("Video conversion and mirrors", test_video_conversion_and_mirrors),
+                         TEST_NO_TAG("Video rotation", test_video_rotation),
+                         TEST_NO_TAG("Video rotation with odd size", test_video_rotation_odd_size),
+                         TEST_NO_TAG("Video scaling of packed formats", test_video_scaling_of_packed_formats),
                          TEST_NO_TAG("Copy yuv buffer with pixel strides: planar to planar",
                                      test_yuv_copy_with_pix_strides_planar_to_planar),
                          TEST_NO_TAG("Copy yuv buffer with pixel strides: planar to semi-planar",
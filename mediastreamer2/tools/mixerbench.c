@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* this program measures the processing time of a MSAudioMixer in conference mode, for various numbers of participants
+   and for each set of mixing kernels (see MS2_AUDIO_MIXER_SIMD in audiomixer.c), with all the participants mixed or
+   only the loudest ones (see MS_AUDIO_MIXER_SET_MAX_SPEAKERS). */
+
+#include <bctoolbox/defs.h>
+
+#include "mediastreamer2/msaudiomixer.h"
+#include "mediastreamer2/msfactory.h"
+#include "mediastreamer2/msticker.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PARTICIPANTS 128
+
+static const char *help = "usage: mediastreamer2-mixerbench [tick_count]\n";
+
+static uint64_t get_time_us(void) {
+	MSTimeSpec ts;
+	ms_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void set_kernels(const char *name) {
+#ifdef _WIN32
+	_putenv_s("MS2_AUDIO_MIXER_SIMD", name);
+#else
+	setenv("MS2_AUDIO_MIXER_SIMD", name, 1);
+#endif
+}
+
+/* returns the mean processing time of the mixer for one tick, in microseconds */
+static double run_bench(MSFactory *factory, MSTicker *ticker, int participants, int max_speakers, int tick_count) {
+	MSFilter *sources[MAX_PARTICIPANTS];
+	MSFilter *sinks[MAX_PARTICIPANTS];
+	MSFilter *mixer = ms_factory_create_filter(factory, MS_AUDIO_MIXER_ID);
+	int rate = 48000;
+	int conf_mode = TRUE;
+	bool_t send_silence = TRUE;
+	uint64_t elapsed = 0;
+	int i, tick;
+
+	ms_filter_call_method(mixer, MS_FILTER_SET_SAMPLE_RATE, &rate);
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, &conf_mode);
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_MAX_SPEAKERS, &max_speakers);
+	for (i = 0; i < participants; i++) {
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_call_method(sources[i], MS_FILTER_SET_SAMPLE_RATE, &rate);
+		ms_filter_call_method(sources[i], MS_VOID_SOURCE_SEND_SILENCE, &send_silence);
+		ms_filter_link(sources[i], 0, mixer, i);
+		ms_filter_link(mixer, i, sinks[i], 0);
+	}
+	if (participants > 1) {
+		/* a non unity gain on one input exercises the gain kernel as well */
+		MSAudioMixerCtl ctl = {0};
+		ctl.pin = 0;
+		ctl.param.gain = 0.5f;
+		ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_INPUT_GAIN, &ctl);
+	}
+
+	/* the graph is driven here rather than by the ticker, in order to time the mixer alone */
+	ms_filter_preprocess(mixer, ticker);
+	for (i = 0; i < participants; i++) {
+		ms_filter_preprocess(sources[i], ticker);
+		ms_filter_preprocess(sinks[i], ticker);
+	}
+	for (tick = 0; tick < tick_count; tick++) {
+		uint64_t start;
+		for (i = 0; i < participants; i++)
+			ms_filter_process(sources[i]);
+		start = get_time_us();
+		ms_filter_process(mixer);
+		elapsed += get_time_us() - start;
+		for (i = 0; i < participants; i++)
+			ms_filter_process(sinks[i]);
+	}
+	ms_filter_postprocess(mixer);
+	for (i = 0; i < participants; i++) {
+		ms_filter_postprocess(sources[i]);
+		ms_filter_postprocess(sinks[i]);
+		ms_filter_unlink(sources[i], 0, mixer, i);
+		ms_filter_unlink(mixer, i, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+	}
+	ms_filter_destroy(mixer);
+	return (double)elapsed / tick_count;
+}
+
+int main(int argc, char *argv[]) {
+	static const int participant_counts[] = {8, 32, 128};
+	static const int max_speakers[] = {0, 3};
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	static const char *kernels[] = {"c", "sse2", "avx2"};
+#elif MS_HAS_ARM_NEON
+	static const char *kernels[] = {"c", "neon"};
+#else
+	static const char *kernels[] = {"c"};
+#endif
+	int tick_count = 5000;
+	MSFactory *factory;
+	MSTicker *ticker;
+	size_t i, j, k;
+
+	if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+		printf("%s", help);
+		return 0;
+	}
+	if (argc > 1) tick_count = atoi(argv[1]);
+	if (tick_count <= 0) {
+		printf("%s", help);
+		return -1;
+	}
+
+	bctbx_set_log_level(NULL, BCTBX_LOG_WARNING);
+	factory = ms_factory_new_with_voip();
+	ticker = ms_ticker_new();
+
+	printf("%-14s %-8s %-8s %14s %18s %10s\n", "participants", "mixed", "kernels", "us per tick",
+	       "us per participant", "load (%)");
+	for (i = 0; i < sizeof(participant_counts) / sizeof(participant_counts[0]); i++) {
+		for (k = 0; k < sizeof(max_speakers) / sizeof(max_speakers[0]); k++) {
+			char mixed[16];
+			if (max_speakers[k] == 0) snprintf(mixed, sizeof(mixed), "all");
+			else snprintf(mixed, sizeof(mixed), "%i", max_speakers[k]);
+			for (j = 0; j < sizeof(kernels) / sizeof(kernels[0]); j++) {
+				double us;
+				set_kernels(kernels[j]);
+				us = run_bench(factory, ticker, participant_counts[i], max_speakers[k], tick_count);
+				printf("%-14i %-8s %-8s %14.2f %18.3f %10.2f\n", participant_counts[i], mixed, kernels[j], us,
+				       us / participant_counts[i], us / (10.0 * ticker->interval));
+			}
+		}
+	}
+
+	ms_ticker_destroy(ticker);
+	ms_factory_destroy(factory);
+	return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* this program measures the processing time of a MSResample filter for the usual pairs of sample rates, for both
+   resampling qualities and for the stereo <-> mono adaptations, with each set of channel kernels (see
+   MS2_RESAMPLE_SIMD in msresample.c). */
+
+#include <bctoolbox/defs.h>
+
+#include "mediastreamer2/msfactory.h"
+#include "mediastreamer2/msresample.h"
+#include "mediastreamer2/msticker.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *help = "usage: mediastreamer2-resamplebench [tick_count]\n";
+
+typedef struct _BenchRates {
+	int input_rate;
+	int output_rate;
+} BenchRates;
+
+typedef struct _BenchChannels {
+	int input_nchannels;
+	int output_nchannels;
+} BenchChannels;
+
+static uint64_t get_time_us(void) {
+	MSTimeSpec ts;
+	ms_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void set_kernels(const char *name) {
+#ifdef _WIN32
+	_putenv_s("MS2_RESAMPLE_SIMD", name);
+#else
+	setenv("MS2_RESAMPLE_SIMD", name, 1);
+#endif
+}
+
+/* returns the mean processing time of the resampler for one tick, in microseconds */
+static double run_bench(MSFactory *factory,
+                        MSTicker *ticker,
+                        const BenchRates *rates,
+                        const BenchChannels *channels,
+                        int quality,
+                        int tick_count) {
+	MSFilter *source = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+	MSFilter *resampler = ms_factory_create_filter(factory, MS_RESAMPLE_ID);
+	MSFilter *sink = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+	uint64_t elapsed = 0;
+	bool_t send_silence = TRUE;
+	int tick;
+
+	ms_filter_call_method(source, MS_VOID_SOURCE_SEND_SILENCE, &send_silence);
+	ms_filter_call_method(source, MS_FILTER_SET_SAMPLE_RATE, (void *)&rates->input_rate);
+	ms_filter_call_method(source, MS_FILTER_SET_NCHANNELS, (void *)&channels->input_nchannels);
+	ms_filter_call_method(resampler, MS_FILTER_SET_SAMPLE_RATE, (void *)&rates->input_rate);
+	ms_filter_call_method(resampler, MS_FILTER_SET_OUTPUT_SAMPLE_RATE, (void *)&rates->output_rate);
+	ms_filter_call_method(resampler, MS_FILTER_SET_NCHANNELS, (void *)&channels->input_nchannels);
+	ms_filter_call_method(resampler, MS_FILTER_SET_OUTPUT_NCHANNELS, (void *)&channels->output_nchannels);
+	ms_filter_call_method(resampler, MS_RESAMPLE_SET_QUALITY, &quality);
+	ms_filter_link(source, 0, resampler, 0);
+	ms_filter_link(resampler, 0, sink, 0);
+
+	/* the graph is driven here rather than by the ticker, in order to time the resampler alone */
+	ms_filter_preprocess(source, ticker);
+	ms_filter_preprocess(resampler, ticker);
+	ms_filter_preprocess(sink, ticker);
+	for (tick = 0; tick < tick_count; tick++) {
+		uint64_t start;
+		ms_filter_process(source);
+		start = get_time_us();
+		ms_filter_process(resampler);
+		elapsed += get_time_us() - start;
+		ms_filter_process(sink);
+	}
+	ms_filter_postprocess(source);
+	ms_filter_postprocess(resampler);
+	ms_filter_postprocess(sink);
+	ms_filter_unlink(source, 0, resampler, 0);
+	ms_filter_unlink(resampler, 0, sink, 0);
+	ms_filter_destroy(source);
+	ms_filter_destroy(resampler);
+	ms_filter_destroy(sink);
+	return (double)elapsed / tick_count;
+}
+
+static void print_result(const BenchRates *rates,
+                         const BenchChannels *channels,
+                         const char *quality,
+                         const char *kernels,
+                         double us,
+                         MSTicker *ticker) {
+	char rate_pair[32];
+	char channel_pair[16];
+	snprintf(rate_pair, sizeof(rate_pair), "%i -> %i", rates->input_rate, rates->output_rate);
+	snprintf(channel_pair, sizeof(channel_pair), "%i -> %i", channels->input_nchannels, channels->output_nchannels);
+	/* the number of streams a core could resample in real time */
+	printf("%-16s %-9s %-8s %-8s %12.2f %12.0f\n", rate_pair, channel_pair, quality, kernels, us,
+	       (1000.0 * ticker->interval) / us);
+}
+
+int main(int argc, char *argv[]) {
+	static const BenchRates rate_pairs[] = {{8000, 16000},  {16000, 8000},  {8000, 48000},  {48000, 8000},
+	                                        {16000, 48000}, {48000, 16000}, {44100, 48000}, {48000, 44100}};
+	static const BenchChannels channel_pairs[] = {{1, 1}, {2, 2}, {2, 1}, {1, 2}};
+	static const BenchRates same_rate = {48000, 48000};
+	static const BenchChannels adaptations[] = {{2, 1}, {1, 2}};
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	static const char *kernels[] = {"c", "sse2", "avx2"};
+#elif MS_HAS_ARM_NEON
+	static const char *kernels[] = {"c", "neon"};
+#else
+	static const char *kernels[] = {"c"};
+#endif
+	int tick_count = 5000;
+	MSFactory *factory;
+	MSTicker *ticker;
+	MSFilter *resampler;
+	size_t i, j, k;
+
+	if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+		printf("%s", help);
+		return 0;
+	}
+	if (argc > 1) tick_count = atoi(argv[1]);
+	if (tick_count <= 0) {
+		printf("%s", help);
+		return -1;
+	}
+
+	bctbx_set_log_level(NULL, BCTBX_LOG_WARNING);
+	factory = ms_factory_new_with_voip();
+	resampler = ms_factory_create_filter(factory, MS_RESAMPLE_ID);
+	if (resampler == NULL) {
+		printf("No resampler built-in.\n");
+		ms_factory_destroy(factory);
+		return -1;
+	}
+	ms_filter_destroy(resampler);
+	ticker = ms_ticker_new();
+
+	printf("%-16s %-9s %-8s %-8s %12s %12s\n", "rates", "channels", "quality", "kernels", "us per tick",
+	       "streams/core");
+	for (i = 0; i < sizeof(rate_pairs) / sizeof(rate_pairs[0]); i++) {
+		for (j = 0; j < sizeof(channel_pairs) / sizeof(channel_pairs[0]); j++) {
+			double us = run_bench(factory, ticker, &rate_pairs[i], &channel_pairs[j], MS_RESAMPLE_QUALITY_DEFAULT,
+			                      tick_count);
+			print_result(&rate_pairs[i], &channel_pairs[j], "default", "auto", us, ticker);
+			us = run_bench(factory, ticker, &rate_pairs[i], &channel_pairs[j], MS_RESAMPLE_QUALITY_FAST, tick_count);
+			print_result(&rate_pairs[i], &channel_pairs[j], "fast", "auto", us, ticker);
+		}
+	}
+	/* the channel kernels alone */
+	for (j = 0; j < sizeof(adaptations) / sizeof(adaptations[0]); j++) {
+		for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+			double us;
+			set_kernels(kernels[k]);
+			us = run_bench(factory, ticker, &same_rate, &adaptations[j], MS_RESAMPLE_QUALITY_DEFAULT, tick_count);
+			print_result(&same_rate, &adaptations[j], "-", kernels[k], us, ticker);
+		}
+	}
+
+	ms_ticker_destroy(ticker);
+	ms_factory_destroy(factory);
+	return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* this program measures the time taken by the pixel conversions, scaling, rotations and mirroring of msvideo.c on
+   720p and 1080p pictures, with the scaler implementation built in (libyuv or ffmpeg). */
+
+#include <bctoolbox/defs.h>
+
+#include "mediastreamer2/mscommon.h"
+#include "mediastreamer2/msvideo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *help = "usage: mediastreamer2-scalerbench [frame_count]\n";
+
+typedef struct _BenchConversion {
+	MSPixFmt src_fmt;
+	MSPixFmt dst_fmt;
+	int src_w, src_h;
+	int dst_w, dst_h;
+} BenchConversion;
+
+static uint64_t get_time_us(void) {
+	MSTimeSpec ts;
+	ms_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static int bytes_per_pixel(MSPixFmt fmt) {
+	switch (fmt) {
+		case MS_YUY2:
+		case MS_YUYV:
+		case MS_UYVY:
+		case MS_RGB565:
+			return 2;
+		case MS_RGB24:
+		case MS_RGB24_REV:
+			return 3;
+		case MS_RGBA32:
+		case MS_RGBA32_REV:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+/* sets the planes of a picture in buffer, which must be large enough for 4 bytes per pixel */
+static void init_picture(MSPicture *pic, MSPixFmt fmt, int w, int h, uint8_t *buffer) {
+	if (fmt == MS_YUV420P) {
+		ms_yuv_buf_init(pic, w, h, w, buffer);
+	} else {
+		memset(pic, 0, sizeof(*pic));
+		pic->w = w;
+		pic->h = h;
+		pic->planes[0] = buffer;
+		pic->strides[0] = w * bytes_per_pixel(fmt);
+	}
+}
+
+static void fill(uint8_t *buffer, size_t size) {
+	size_t i;
+	for (i = 0; i < size; i++)
+		buffer[i] = (uint8_t)(i * 7 + i / 1920);
+}
+
+static void bench_conversion(const BenchConversion *c, int frame_count) {
+	uint8_t *src = ms_malloc((size_t)c->src_w * c->src_h * 4);
+	uint8_t *dst = ms_malloc((size_t)c->dst_w * c->dst_h * 4);
+	MSPicture src_pic, dst_pic;
+	MSScalerContext *ctx;
+	uint64_t start, elapsed;
+	int i;
+
+	fill(src, (size_t)c->src_w * c->src_h * 4);
+	init_picture(&src_pic, c->src_fmt, c->src_w, c->src_h, src);
+	init_picture(&dst_pic, c->dst_fmt, c->dst_w, c->dst_h, dst);
+	ctx = ms_scaler_create_context(c->src_w, c->src_h, c->src_fmt, c->dst_w, c->dst_h, c->dst_fmt,
+	                               MS_SCALER_METHOD_BILINEAR);
+	if (ctx == NULL) {
+		printf("%-14s %4ix%-4i -> %-14s %4ix%-4i  unsupported\n", ms_pix_fmt_to_string(c->src_fmt), c->src_w,
+		       c->src_h, ms_pix_fmt_to_string(c->dst_fmt), c->dst_w, c->dst_h);
+	} else {
+		start = get_time_us();
+		for (i = 0; i < frame_count; i++) {
+			ms_scaler_process(ctx, src_pic.planes, src_pic.strides, dst_pic.planes, dst_pic.strides);
+		}
+		elapsed = get_time_us() - start;
+		ms_scaler_context_free(ctx);
+		printf("%-14s %4ix%-4i -> %-14s %4ix%-4i  %10.3f ms/frame\n", ms_pix_fmt_to_string(c->src_fmt), c->src_w,
+		       c->src_h, ms_pix_fmt_to_string(c->dst_fmt), c->dst_w, c->dst_h,
+		       (double)elapsed / (1000.0 * frame_count));
+	}
+	ms_free(src);
+	ms_free(dst);
+}
+
+static void bench_rotations(int w, int h, int frame_count) {
+	MSYuvBufAllocator *allocator = ms_yuv_buf_allocator_new();
+	uint8_t *buffer = ms_malloc((size_t)w * h * 3 / 2);
+	MSPicture pic;
+	int rotation, i;
+
+	fill(buffer, (size_t)w * h * 3 / 2);
+	ms_yuv_buf_init(&pic, w, h, w, buffer);
+	for (rotation = 0; rotation < 360; rotation += 90) {
+		bool_t transposed = rotation % 180 != 0;
+		uint64_t i420_us = 0, nv12_us = 0, start;
+		for (i = 0; i < frame_count; i++) {
+			mblk_t *m;
+			start = get_time_us();
+			m = copy_yuv_with_rotation(allocator, pic.planes[0], pic.planes[1], pic.planes[2], rotation,
+			                           transposed ? h : w, transposed ? w : h, pic.strides[0], pic.strides[1],
+			                           pic.strides[2]);
+			i420_us += get_time_us() - start;
+			freemsg(m);
+			/* the U and V planes make a single interleaved plane of w * h / 2 bytes for NV12 */
+			start = get_time_us();
+			m = copy_ycbcrbiplanar_to_true_yuv_with_rotation(allocator, pic.planes[0], pic.planes[1], rotation,
+			                                                 transposed ? h : w, transposed ? w : h, pic.strides[0],
+			                                                 pic.strides[0], TRUE);
+			nv12_us += get_time_us() - start;
+			freemsg(m);
+		}
+		printf("rotation %3i   %4ix%-4i  I420: %10.3f ms/frame  NV12: %10.3f ms/frame\n", rotation, w, h,
+		       (double)i420_us / (1000.0 * frame_count), (double)nv12_us / (1000.0 * frame_count));
+	}
+	ms_free(buffer);
+	ms_yuv_buf_allocator_free(allocator);
+}
+
+static void bench_mirrors(int w, int h, int frame_count) {
+	static const MSMirrorType types[] = {MS_HORIZONTAL_MIRROR, MS_VERTICAL_MIRROR, MS_CENTRAL_MIRROR};
+	static const char *names[] = {"horizontal", "vertical", "central"};
+	uint8_t *buffer = ms_malloc((size_t)w * h * 3);
+	MSPicture pic;
+	uint64_t start;
+	size_t t;
+	int i;
+
+	fill(buffer, (size_t)w * h * 3);
+	ms_yuv_buf_init(&pic, w, h, w, buffer);
+	for (t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		start = get_time_us();
+		for (i = 0; i < frame_count; i++)
+			ms_yuv_buf_mirrors(&pic, types[t]);
+		printf("mirror %-10s %4ix%-4i  I420: %10.3f ms/frame\n", names[t], w, h,
+		       (double)(get_time_us() - start) / (1000.0 * frame_count));
+	}
+	start = get_time_us();
+	for (i = 0; i < frame_count; i++)
+		rgb24_mirror(buffer, w, h, w * 3);
+	printf("mirror %-10s %4ix%-4i  RGB24: %9.3f ms/frame\n", names[0], w, h,
+	       (double)(get_time_us() - start) / (1000.0 * frame_count));
+	ms_free(buffer);
+}
+
+int main(int argc, char *argv[]) {
+	static const BenchConversion conversions[] = {
+	    {MS_YUV420P, MS_YUV420P, 1920, 1080, 1280, 720},   {MS_YUV420P, MS_YUV420P, 1280, 720, 640, 360},
+	    {MS_YUY2, MS_YUV420P, 1280, 720, 1280, 720},       {MS_YUY2, MS_YUV420P, 1920, 1080, 1280, 720},
+	    {MS_UYVY, MS_YUV420P, 1920, 1080, 1920, 1080},     {MS_RGB24, MS_YUV420P, 1280, 720, 1280, 720},
+	    {MS_RGBA32_REV, MS_YUV420P, 1920, 1080, 1920, 1080}, {MS_YUV420P, MS_RGBA32, 1280, 720, 1280, 720},
+	    {MS_YUV420P, MS_RGBA32, 1280, 720, 1920, 1080},    {MS_YUV420P, MS_RGB565, 1920, 1080, 1280, 720},
+	    {MS_RGBA32, MS_RGBA32, 1920, 1080, 1280, 720}};
+	int frame_count = 100;
+	size_t i;
+
+	if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+		printf("%s", help);
+		return 0;
+	}
+	if (argc > 1) frame_count = atoi(argv[1]);
+	if (frame_count <= 0) {
+		printf("%s", help);
+		return -1;
+	}
+
+	bctbx_set_log_level(NULL, BCTBX_LOG_WARNING);
+
+	if (ms_video_get_scaler_impl() == NULL) {
+		printf("No scaler implementation built-in, skipping the conversions.\n");
+	} else {
+		for (i = 0; i < sizeof(conversions) / sizeof(conversions[0]); i++)
+			bench_conversion(&conversions[i], frame_count);
+	}
+	bench_rotations(MS_VIDEO_SIZE_720P_W, MS_VIDEO_SIZE_720P_H, frame_count);
+	bench_rotations(MS_VIDEO_SIZE_1080P_W, MS_VIDEO_SIZE_1080P_H, frame_count);
+	bench_mirrors(MS_VIDEO_SIZE_720P_W, MS_VIDEO_SIZE_720P_H, frame_count);
+	bench_mirrors(MS_VIDEO_SIZE_1080P_W, MS_VIDEO_SIZE_1080P_H, frame_count);
+
+	return 0;
+}
@@ -75,6 +75,8 @@ extern "C" {
 ORTP_PUBLIC bool_t ortp_min_version_required(int major, int minor, int micro);
 ORTP_PUBLIC void ortp_init(void);
 ORTP_PUBLIC void ortp_scheduler_init(void);
+ORTP_PUBLIC void ortp_scheduler_init_with_workers(int worker_count);
+ORTP_PUBLIC int ortp_scheduler_get_worker_count(void);
 ORTP_PUBLIC void ortp_exit(void);
 
 /****************/
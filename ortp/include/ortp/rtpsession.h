@@ -324,6 +324,8 @@ typedef struct _OrtpStream {
 	bctbx_list_t *aux_destinations; /*list of OrtpAddress */
 	queue_t bundleq;                /* For bundle mode */
 	ortp_mutex_t bundleq_lock;
+	struct _OrtpRecvBatch *recv_batch; /* datagrams read ahead by batched reception */
+	struct _OrtpSendBatch *send_batch; /* packets queued by send batching */
 	bool_t remote_address_adaptation;
 } OrtpStream;
 
@@ -332,6 +334,7 @@ typedef struct _RtpStream {
 	int time_jump;
 	uint32_t ts_jump;
 	queue_t rq;
+	struct _OrtpSeqRing *rq_ring; /* index of rq by sequence number */
 	queue_t tev_rq;
 	void *QoSHandle;
 	unsigned long QoSFlowID;
@@ -421,6 +424,7 @@ struct _RtpSession {
 	int inc_same_ssrc_count;
 	int hw_recv_pt; /* recv payload type before jitter buffer */
 	int recv_buf_size;
+	int recv_batch_size; /* max number of datagrams read per system call */
 	int target_upload_bandwidth;     /* Target upload bandwidth at network layer (with IP and UDP headers) in bits/s */
 	int max_target_upload_bandwidth; /* the largest target upload bandwidth at network layer (with IP and UDP headers)
 	                                    in bits/s ever set through rtp_session_set_target_upload_bandwidth */
@@ -494,6 +498,7 @@ struct _RtpSession {
 	bool_t warn_non_working_pkt_info;
 	bool_t transfer_mode;
 	bool_t audio_bandwidth_estimator_enabled;
+	bool_t send_batching; /* queue outgoing packets until rtp_session_flush_send_batch() */
 };
 
 /**
@@ -612,6 +617,18 @@ ORTP_PUBLIC int rtp_session_get_dscp(const RtpSession *session);
 /* Packet info */
 ORTP_PUBLIC int rtp_session_set_pktinfo(RtpSession *session, int activate);
 
+/* Batched reception */
+ORTP_PUBLIC void rtp_session_set_recv_batch_size(RtpSession *session, int batch_size);
+ORTP_PUBLIC int rtp_session_get_recv_batch_size(const RtpSession *session);
+ORTP_PUBLIC int rtp_session_get_recv_batch_max_count(const RtpSession *session);
+
+/* Batched sending */
+ORTP_PUBLIC void rtp_session_enable_send_batching(RtpSession *session, bool_t yesno);
+ORTP_PUBLIC bool_t rtp_session_send_batching_enabled(const RtpSession *session);
+ORTP_PUBLIC void rtp_session_flush_send_batch(RtpSession *session);
+ORTP_PUBLIC int rtp_session_get_send_batch_max_segments(const RtpSession *session);
+ORTP_PUBLIC void rtp_session_reset_send_batch_max_segments(RtpSession *session);
+
 /* Multicast methods */
 ORTP_PUBLIC int rtp_session_set_multicast_ttl(RtpSession *session, int ttl);
 ORTP_PUBLIC int rtp_session_get_multicast_ttl(RtpSession *session);
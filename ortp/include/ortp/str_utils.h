@@ -85,6 +85,14 @@ typedef struct datab {
 	void *db_ref; // Atomic variable
 } dblk_t;
 
+/* Statistics of the pool recycling mblk_t and data blocks */
+typedef struct ortp_mblk_pool_stats {
+	uint64_t hits;           /* allocations served by recycled blocks */
+	uint64_t misses;         /* allocations that required a new block from the system allocator */
+	size_t allocated_blocks; /* blocks currently allocated from the system, in use or waiting in the pool */
+	size_t high_water;       /* highest value reached by allocated_blocks */
+} ortp_mblk_pool_stats_t;
+
 typedef struct _queue {
 	mblk_t _q_stopper;
 	int q_mcount; /*number of packet in the q */
@@ -102,6 +110,11 @@ ORTP_PUBLIC int dblk_ref_value(dblk_t *db);
 ORTP_PUBLIC unsigned char *dblk_base(dblk_t *db);
 ORTP_PUBLIC unsigned char *dblk_lim(dblk_t *db);
 
+/* fills stats with the counters of the mblk_t and data block pool */
+ORTP_PUBLIC void ortp_mblk_pool_get_stats(ortp_mblk_pool_stats_t *stats);
+/* gives back to the system the unused blocks of the pool, except those cached by other threads */
+ORTP_PUBLIC void ortp_mblk_pool_trim(void);
+
 ORTP_PUBLIC void qinit(queue_t *q);
 
 ORTP_PUBLIC void putq(queue_t *q, mblk_t *m);
@@ -34,6 +34,8 @@
 #cmakedefine HAVE_ARC4RANDOM 1
 #cmakedefine HAVE_RECVMSG 1
 #cmakedefine HAVE_SENDMSG 1
+#cmakedefine HAVE_RECVMMSG 1
+#cmakedefine HAVE_SENDMMSG 1
 
 #cmakedefine ORTP_BIGENDIAN
 
@@ -22,34 +22,259 @@
 #include "ortp-config.h"
 #endif
 #include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <new>
 #include <ortp/port.h>
 #include <ortp/str_utils.h>
 
+#include "utils.h"
+
 using namespace std;
 
-extern "C" {
-dblk_t *dblk_alloc(size_t size) {
-	struct datab *db;
-	size_t total_size = sizeof(struct datab) + size;
-	db = (struct datab *)ortp_malloc(total_size);
+/*
+ * mblk_t and data blocks are recycled through a pool of size classes, with a cache per thread in front of a shared
+ * depot, so that the packet path does not go through the system allocator once the pool is warm.
+ * A data block is allocated in a single chunk: its reference counter, the dblk_t and, for dblk_alloc(), the buffer.
+ * Memory held by the pool is only given back to the system by ortp_mblk_pool_trim().
+ */
+
+namespace {
+
+struct DblkBlock {
+	atomic_int ref; /* dblk_t.db_ref points here */
+	int size_class; /* -1 for blocks too large for the pool */
+	dblk_t db;
+};
+
+/* buffer sizes of the data block classes, the last one fits an Ethernet MTU sized packet and some headroom */
+constexpr size_t dblkBufferSizes[] = {256, 512, 1024, 2048};
+constexpr int dblkClassCount = sizeof(dblkBufferSizes) / sizeof(dblkBufferSizes[0]);
+constexpr int externalDblkClass = dblkClassCount; /* dblk_t of dblk_alloc2(), without buffer */
+constexpr int mblkClass = dblkClassCount + 1;
+constexpr int classCount = dblkClassCount + 2;
 
-	db->db_base = (uint8_t *)db + sizeof(struct datab);
-	db->db_lim = db->db_base + size;
-	db->db_ref = new atomic_int(1);
-	db->db_freefn = NULL; /* the buffer pointed by db_base must never be freed !*/
+constexpr int threadCacheMaxBlocks = 256; /* per class */
+constexpr int transferBatchSize = 64;     /* blocks moved at once between a thread cache and the depot */
 
-	return db;
+size_t classBlockSize(int sizeClass) {
+	if (sizeClass < dblkClassCount) return sizeof(DblkBlock) + dblkBufferSizes[sizeClass];
+	if (sizeClass == externalDblkClass) return sizeof(DblkBlock);
+	return sizeof(mblk_t);
 }
-struct datab *dblk_alloc2(uint8_t *buf, size_t size, void (*freefn)(void *)) {
-	struct datab *db;
-	db = (struct datab *)ortp_malloc(sizeof(struct datab));
 
-	db->db_base = buf;
-	db->db_lim = buf + size;
-	db->db_ref = new atomic_int(1);
-	db->db_freefn = freefn;
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+struct FreeList {
+	FreeBlock *head = nullptr;
+	int count = 0;
+
+	void push(void *block) {
+		FreeBlock *fb = static_cast<FreeBlock *>(block);
+		fb->next = head;
+		head = fb;
+		count++;
+	}
+	void *pop() {
+		FreeBlock *fb = head;
+		if (fb) {
+			head = fb->next;
+			count--;
+		}
+		return fb;
+	}
+	/* moves at most n blocks to other */
+	void transferTo(FreeList &other, int n) {
+		while (n-- > 0 && head) other.push(pop());
+	}
+	void release() {
+		void *block;
+		while ((block = pop()) != nullptr) ortp_free(block);
+	}
+};
+
+struct ThreadCache {
+	FreeList lists[classCount];
+	atomic<uint64_t> hits{0}; /* only written by the owner thread */
+	ThreadCache *next = nullptr;
+};
+
+class Depot {
+public:
+	void *allocate(ThreadCache *cache, int sizeClass) {
+		void *block;
+		if (cache) {
+			FreeList &list = cache->lists[sizeClass];
+			if (list.head == nullptr) {
+				lock_guard<mutex> lock(mMutex);
+				mLists[sizeClass].transferTo(list, transferBatchSize);
+			}
+			if ((block = list.pop()) != nullptr) {
+				cache->hits.store(cache->hits.load(memory_order_relaxed) + 1, memory_order_relaxed);
+				return block;
+			}
+		} else {
+			lock_guard<mutex> lock(mMutex);
+			if ((block = mLists[sizeClass].pop()) != nullptr) {
+				mRetiredHits++;
+				return block;
+			}
+		}
+		block = ortp_malloc(classBlockSize(sizeClass));
+		mMisses.fetch_add(1, memory_order_relaxed);
+		size_t allocated = mAllocatedBlocks.fetch_add(1, memory_order_relaxed) + 1;
+		size_t highWater = mHighWater.load(memory_order_relaxed);
+		while (allocated > highWater && !mHighWater.compare_exchange_weak(highWater, allocated, memory_order_relaxed))
+			;
+		return block;
+	}
+
+	void release(ThreadCache *cache, int sizeClass, void *block) {
+		if (cache) {
+			FreeList &list = cache->lists[sizeClass];
+			list.push(block);
+			if (list.count > threadCacheMaxBlocks) {
+				lock_guard<mutex> lock(mMutex);
+				list.transferTo(mLists[sizeClass], transferBatchSize);
+			}
+		} else {
+			lock_guard<mutex> lock(mMutex);
+			mLists[sizeClass].push(block);
+		}
+	}
+
+	void addCache(ThreadCache *cache) {
+		lock_guard<mutex> lock(mMutex);
+		cache->next = mCaches;
+		mCaches = cache;
+	}
+
+	/* gives back the blocks of an exiting thread to the depot */
+	void removeCache(ThreadCache *cache) {
+		lock_guard<mutex> lock(mMutex);
+		for (ThreadCache **it = &mCaches; *it != nullptr; it = &(*it)->next) {
+			if (*it == cache) {
+				*it = cache->next;
+				break;
+			}
+		}
+		for (int i = 0; i < classCount; i++)
+			cache->lists[i].transferTo(mLists[i], cache->lists[i].count);
+		mRetiredHits += cache->hits.load(memory_order_relaxed);
+	}
+
+	void trim(ThreadCache *cache) {
+		int released = 0;
+		lock_guard<mutex> lock(mMutex);
+		for (int i = 0; i < classCount; i++) {
+			if (cache) {
+				released += cache->lists[i].count;
+				cache->lists[i].release();
+			}
+			released += mLists[i].count;
+			mLists[i].release();
+		}
+		mAllocatedBlocks.fetch_sub((size_t)released, memory_order_relaxed);
+	}
+
+	void getStats(ortp_mblk_pool_stats_t *stats) {
+		lock_guard<mutex> lock(mMutex);
+		stats->hits = mRetiredHits;
+		for (ThreadCache *cache = mCaches; cache != nullptr; cache = cache->next)
+			stats->hits += cache->hits.load(memory_order_relaxed);
+		stats->misses = mMisses.load(memory_order_relaxed);
+		stats->allocated_blocks = mAllocatedBlocks.load(memory_order_relaxed);
+		stats->high_water = mHighWater.load(memory_order_relaxed);
+	}
+
+	/* the depot is never destroyed, blocks may still be released by static destructors at exit */
+	static Depot &get() {
+		static Depot *depot = new Depot();
+		return *depot;
+	}
+
+private:
+	mutex mMutex;
+	FreeList mLists[classCount];
+	ThreadCache *mCaches = nullptr;
+	uint64_t mRetiredHits = 0;
+	atomic<uint64_t> mMisses{0};
+	atomic<size_t> mAllocatedBlocks{0};
+	atomic<size_t> mHighWater{0};
+};
 
-	return db;
+thread_local ThreadCache *threadCache = nullptr;
+thread_local bool threadCacheDestroyed = false;
+
+struct ThreadCacheGuard {
+	ThreadCacheGuard() {
+		threadCache = new ThreadCache();
+		Depot::get().addCache(threadCache);
+	}
+	~ThreadCacheGuard() {
+		Depot::get().removeCache(threadCache);
+		delete threadCache;
+		threadCache = nullptr;
+		threadCacheDestroyed = true;
+	}
+};
+
+/* returns NULL once the thread cache has been destroyed, when the thread exits */
+ThreadCache *getThreadCache() {
+	if (threadCache == nullptr && !threadCacheDestroyed) {
+		static thread_local ThreadCacheGuard guard;
+		(void)guard;
+	}
+	return threadCache;
+}
+
+void *poolAllocate(int sizeClass) {
+	return Depot::get().allocate(getThreadCache(), sizeClass);
+}
+
+void poolRelease(int sizeClass, void *block) {
+	Depot::get().release(getThreadCache(), sizeClass, block);
+}
+
+dblk_t *dblkBlockInit(DblkBlock *block, int sizeClass, uint8_t *base, size_t size, void (*freefn)(void *)) {
+	new (&block->ref) atomic_int(1);
+	block->size_class = sizeClass;
+	block->db.db_base = base;
+	block->db.db_lim = base + size;
+	block->db.db_ref = &block->ref;
+	block->db.db_freefn = freefn;
+	return &block->db;
+}
+
+DblkBlock *dblkToBlock(dblk_t *db) {
+	return static_cast<DblkBlock *>(db->db_ref); /* ref is the first member of DblkBlock */
+}
+
+} // namespace
+
+extern "C" {
+dblk_t *dblk_alloc(size_t size) {
+	DblkBlock *block;
+	int sizeClass = 0;
+
+	while (sizeClass < dblkClassCount && size > dblkBufferSizes[sizeClass])
+		sizeClass++;
+	if (sizeClass < dblkClassCount) {
+		block = static_cast<DblkBlock *>(poolAllocate(sizeClass));
+	} else {
+		block = static_cast<DblkBlock *>(ortp_malloc(sizeof(DblkBlock) + size));
+		sizeClass = -1;
+	}
+	/* the buffer pointed by db_base must never be freed !*/
+	return dblkBlockInit(block, sizeClass, (uint8_t *)block + sizeof(DblkBlock), size, NULL);
+}
+
+struct datab *dblk_alloc2(uint8_t *buf, size_t size, void (*freefn)(void *)) {
+	DblkBlock *block = static_cast<DblkBlock *>(poolAllocate(externalDblkClass));
+	return dblkBlockInit(block, externalDblkClass, buf, size, freefn);
 }
 
 void dblk_ref(struct datab *data) {
@@ -60,10 +285,12 @@ void dblk_unref(struct datab *data) {
 	atomic_int previous_ref(
 	    atomic_fetch_sub_explicit(static_cast<atomic_int *>(data->db_ref), 1, memory_order_release));
 	if (previous_ref == 1) {
+		DblkBlock *block = dblkToBlock(data);
+		atomic_thread_fence(memory_order_acquire);
 		if (data->db_freefn != NULL) data->db_freefn(data->db_base);
-		delete static_cast<atomic_int *>(data->db_ref);
 		data->db_ref = NULL;
-		ortp_free(data);
+		if (block->size_class < 0) ortp_free(block);
+		else poolRelease(block->size_class, block);
 	}
 }
 
@@ -71,4 +298,22 @@ int dblk_ref_value(dblk_t *db) {
 	return (int)static_cast<atomic_int *>(db->db_ref)->load();
 }
 
-} // extern "C"
\ No newline at end of file
+mblk_t *ortp_mblk_alloc(void) {
+	mblk_t *mp = static_cast<mblk_t *>(poolAllocate(mblkClass));
+	memset(mp, 0, sizeof(mblk_t));
+	return mp;
+}
+
+void ortp_mblk_free(mblk_t *mp) {
+	poolRelease(mblkClass, mp);
+}
+
+void ortp_mblk_pool_get_stats(ortp_mblk_pool_stats_t *stats) {
+	Depot::get().getStats(stats);
+}
+
+void ortp_mblk_pool_trim(void) {
+	Depot::get().trim(getThreadCache());
+}
+
+} // extern "C"
@@ -26,6 +26,7 @@
 #include <set>
 
 #include "packet-api.h"
+#include "seqnum-map.h"
 
 namespace ortp {
 
@@ -72,14 +73,14 @@ public:
 	/**
 	 * Return the set of sequence numbers of the row repair packets that protects the source packet.
 	 */
-	std::set<uint16_t> getRowRepair() const {
+	const std::set<uint16_t> &getRowRepair() const {
 		return mRowRepairSeqNum;
 	};
 
 	/**
 	 * Return the set of sequence numbers of the column repair packets that protects the source packet.
 	 */
-	std::set<uint16_t> getColRepair() const {
+	const std::set<uint16_t> &getColRepair() const {
 		return mColRepairSeqNum;
 	};
 
@@ -138,7 +139,7 @@ public:
 	/**
 	 * Return the set of sequence numbers of the source packets that are protected by the repair packet.
 	 */
-	std::set<uint16_t> getProtectedSources() const {
+	const std::set<uint16_t> &getProtectedSources() const {
 		return mSourceSeqNum;
 	};
 
@@ -255,13 +256,13 @@ public:
 	void reset();
 
 private:
-	std::map<uint16_t, FecSourceNode> mSourceNodes =
-	    {}; /**< All source packets, identified by the sequence numbers, and their connections with repair packets. */
+	SeqnumMap<FecSourceNode> mSourceNodes{
+	    256}; /**< All source packets, identified by the sequence numbers, and their connections with repair packets. */
 
-	std::map<uint16_t, FecRepairNode> mRowRepairNodes = {}; /**< All row repair packets, identified by a unique sequence
-	                                                           number, and their connections with source packets. */
+	SeqnumMap<FecRepairNode> mRowRepairNodes; /**< All row repair packets, identified by a unique sequence
+	                                             number, and their connections with source packets. */
 
-	std::map<uint16_t, FecRepairNode> mColRepairNodes = {}; /**< All column repair packets, identified by a unique
+	SeqnumMap<FecRepairNode> mColRepairNodes; /**< All column repair packets, identified by a unique
 	           sequence number, and their connections with source packets. */
 };
 
@@ -19,8 +19,57 @@
  */
 
 #include "packet-api.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FEC_XOR_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FEC_XOR_NEON
+#endif
+
 using namespace ortp;
 
+void ortp::fecXor(uint8_t *dst, const uint8_t *src, size_t size) {
+	size_t i = 0;
+#if defined(FEC_XOR_SSE2)
+	for (; i + 64 <= size; i += 64) {
+		__m128i d0 = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i d1 = _mm_loadu_si128((const __m128i *)(dst + i + 16));
+		__m128i d2 = _mm_loadu_si128((const __m128i *)(dst + i + 32));
+		__m128i d3 = _mm_loadu_si128((const __m128i *)(dst + i + 48));
+		d0 = _mm_xor_si128(d0, _mm_loadu_si128((const __m128i *)(src + i)));
+		d1 = _mm_xor_si128(d1, _mm_loadu_si128((const __m128i *)(src + i + 16)));
+		d2 = _mm_xor_si128(d2, _mm_loadu_si128((const __m128i *)(src + i + 32)));
+		d3 = _mm_xor_si128(d3, _mm_loadu_si128((const __m128i *)(src + i + 48)));
+		_mm_storeu_si128((__m128i *)(dst + i), d0);
+		_mm_storeu_si128((__m128i *)(dst + i + 16), d1);
+		_mm_storeu_si128((__m128i *)(dst + i + 32), d2);
+		_mm_storeu_si128((__m128i *)(dst + i + 48), d3);
+	}
+	for (; i + 16 <= size; i += 16) {
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(d, _mm_loadu_si128((const __m128i *)(src + i))));
+	}
+#elif defined(FEC_XOR_NEON)
+	for (; i + 16 <= size; i += 16) {
+		vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+	}
+#endif
+	for (; i + 8 <= size; i += 8) {
+		uint64_t d, s;
+		memcpy(&d, dst + i, sizeof(d));
+		memcpy(&s, src + i, sizeof(s));
+		d ^= s;
+		memcpy(dst + i, &d, sizeof(d));
+	}
+	for (; i < size; i++) {
+		dst[i] ^= src[i];
+	}
+}
+
 Bitstring::Bitstring() {
 	memset(&mBuffer[0], 0, 8);
 }
@@ -100,14 +149,9 @@ void FecSourcePacket::addBitstring(Bitstring const &other) {
 void FecSourcePacket::addPayload(const uint8_t *toAdd, size_t size) {
 
 	uint8_t *wptr = NULL;
-	uint8_t *rptr = (uint8_t *)toAdd;
 	size_t currentSize = getPayloadBuffer(&wptr);
 	size_t minSize = (size < currentSize) ? size : currentSize;
-	for (size_t i = 0; i < minSize; i++) {
-		*wptr ^= *rptr;
-		wptr++;
-		rptr++;
-	}
+	fecXor(wptr, toAdd, minSize);
 }
 
 void FecSourcePacket::addPayload(FecSourcePacket const &other) {
@@ -193,6 +237,8 @@ FecRepairPacket::FecRepairPacket(
 	// writeD
 	*(uint8_t *)mPacket->b_wptr = mD;
 	mPacket->b_wptr += sizeof(uint8_t);
+	// the payload grows in place up to preallocatedPayloadSize
+	msgpullup(mPacket, msgdsize(mPacket) + preallocatedPayloadSize);
 }
 
 FecRepairPacket::FecRepairPacket(const mblk_t *repairPacket) {
@@ -269,11 +315,7 @@ void FecRepairPacket::addPayload(FecSourcePacket const &sourcePacket) {
 	}
 	repairPayloadSize = repairPayloadStart(&repair_wptr);
 	size_t minSize = (repairPayloadSize > sourcePayloadSize) ? sourcePayloadSize : repairPayloadSize;
-	for (size_t i = 0; i < minSize; i++) {
-		*repair_wptr ^= *packet_rptr;
-		repair_wptr++;
-		packet_rptr++;
-	}
+	fecXor(repair_wptr, packet_rptr, minSize);
 }
 
 void FecRepairPacket::add(FecSourcePacket const &sourcePacket) {
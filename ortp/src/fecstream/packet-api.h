@@ -26,6 +26,13 @@
 #include <vector>
 
 namespace ortp {
+
+/**
+ * XOR size bytes of src into dst. The buffers are processed a SIMD register or a machine word at a time, they don't
+ * need to be aligned and must not overlap.
+ */
+ORTP_PUBLIC void fecXor(uint8_t *dst, const uint8_t *src, size_t size);
+
 class ORTP_PUBLIC Bitstring {
 
 private:
@@ -95,6 +102,11 @@ public:
 };
 
 class ORTP_PUBLIC FecRepairPacket {
+public:
+	/* Repair payloads are allocated with this size upfront, so that they don't need to be reallocated as bigger
+	 * source packets are added. */
+	static constexpr size_t preallocatedPayloadSize = 1500;
+
 private:
 	mblk_t *mPacket;
 	uint8_t mL;
@@ -91,14 +91,14 @@ void ReceiveCluster::add(const std::shared_ptr<FecRepairPacket> &packet) {
 }
 
 std::shared_ptr<FecSourcePacket> ReceiveCluster::getSourcePacket(uint16_t seqnum) const {
-	auto it = mSource.find(seqnum);
-	if (it != mSource.end()) return it->second;
+	auto packet = mSource.find(seqnum);
+	if (packet) return *packet;
 	else return nullptr;
 }
 
 void ReceiveCluster::repair(uint16_t seqNum) {
 
-	if (getSourcePacket(seqNum)) {
+	if (mSource.find(seqNum)) {
 		ortp_debug("receive-cluster[%p] packet %d already repaired", this, seqNum);
 		return;
 	}
@@ -140,7 +140,7 @@ void ReceiveCluster::repair2D() {
 }
 
 int ReceiveCluster::repair1D(bool interleaved) {
-	auto repairPackets = (interleaved) ? mColRepairForDecoding : mRowRepairForDecoding;
+	const auto &repairPackets = (interleaved) ? mColRepairForDecoding : mRowRepairForDecoding;
 	int repaired = 0;
 	for (size_t i = 0; i < repairPackets.size(); i++) {
 		repaired += repairOne(*repairPackets[i]);
@@ -159,12 +159,12 @@ int ReceiveCluster::repairOne(FecRepairPacket const &repairPacket) {
 
 	while (loss <= 1 && (unsigned long)i < seqnumList.size()) {
 
-		std::shared_ptr<FecSourcePacket> source = getSourcePacket(seqnumList[i]);
+		auto source = mSource.find(seqnumList[i]);
 		if (source == nullptr) {
 			seqnumToRepair = seqnumList[i];
 			loss++;
 		} else {
-			recoveryBs.add(source->getBitstring());
+			recoveryBs.add((*source)->getBitstring());
 		}
 		i++;
 	}
@@ -179,8 +179,7 @@ int ReceiveCluster::repairOne(FecRepairPacket const &repairPacket) {
 
 	for (int i = 0; (unsigned long)i < seqnumList.size(); i++) {
 		if (seqnumList[i] == seqnumToRepair) continue;
-		std::shared_ptr<FecSourcePacket> sourceP = getSourcePacket(seqnumList[i]);
-		recovery->addPayload(*sourceP);
+		recovery->addPayload(**mSource.find(seqnumList[i]));
 	}
 	repairAddPacket(*recovery, repairPacket);
 	mSource.emplace(seqnumToRepair, recovery);
@@ -29,6 +29,7 @@
 #include "fec-packets-connection.h"
 #include "fec-params.h"
 #include "packet-api.h"
+#include "seqnum-map.h"
 
 namespace ortp {
 
@@ -168,11 +169,10 @@ private:
 	std::multimap<uint32_t, uint16_t>
 	    mRepairTimeStamp; /**< Sequence numbers of the repair packets ordered by their
 	                          time stamps, to handle the repair window. Both row and columns repair packets are added.*/
-	std::unordered_map<uint16_t, std::shared_ptr<FecSourcePacket>>
-	    mSource; /**< Source packets received, in the repair window.*/
-	std::unordered_map<uint16_t, std::shared_ptr<FecRepairPacket>>
+	SeqnumMap<std::shared_ptr<FecSourcePacket>> mSource{256}; /**< Source packets received, in the repair window.*/
+	SeqnumMap<std::shared_ptr<FecRepairPacket>>
 	    mRowRepairAll; /**< Row repair packets received that protect the source packets in mSource.*/
-	std::unordered_map<uint16_t, std::shared_ptr<FecRepairPacket>>
+	SeqnumMap<std::shared_ptr<FecRepairPacket>>
 	    mColRepairAll;      /**< Column repair packets received that protect the source packets in mSource.*/
 	uint64_t mRowRepairCpt; /**< Counter of the row repair packets received*/
 	uint64_t mColRepairCpt; /**< Counter of the column repair packets received*/
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEQNUM_MAP_H
+#define SEQNUM_MAP_H
+
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ortp {
+
+/** @class SeqnumMap
+ * @brief Flat map whose keys are RTP sequence numbers.
+ *
+ * The element with the key seqnum is stored in the slot seqnum & (number of slots - 1). The number of slots is a power
+ * of two, doubled whenever two keys would share a slot, so that a lookup is a single array access. The packets kept
+ * by the FEC have close sequence numbers, so that the array stays small; with 65536 slots every key has its own one.
+ */
+template <typename T>
+class SeqnumMap {
+public:
+	SeqnumMap(size_t initialSize = 64) : mSlots(initialSize) {
+	}
+
+	/**
+	 * Return the element with the key seqnum, or nullptr if there is none.
+	 */
+	T *find(uint16_t seqnum) {
+		auto &slot = mSlots[seqnum & mask()];
+		return (slot && slot->first == seqnum) ? &slot->second : nullptr;
+	}
+
+	const T *find(uint16_t seqnum) const {
+		const auto &slot = mSlots[seqnum & mask()];
+		return (slot && slot->first == seqnum) ? &slot->second : nullptr;
+	}
+
+	size_t count(uint16_t seqnum) const {
+		return find(seqnum) ? 1 : 0;
+	}
+
+	T &at(uint16_t seqnum) {
+		T *value = find(seqnum);
+		if (!value) throw std::out_of_range("SeqnumMap::at");
+		return *value;
+	}
+
+	const T &at(uint16_t seqnum) const {
+		const T *value = find(seqnum);
+		if (!value) throw std::out_of_range("SeqnumMap::at");
+		return *value;
+	}
+
+	/**
+	 * Construct an element with the key seqnum, unless there is already one. Return true if the element was added.
+	 */
+	template <typename... Args>
+	bool emplace(uint16_t seqnum, Args &&...args) {
+		while (mSlots[seqnum & mask()] && mSlots[seqnum & mask()]->first != seqnum)
+			grow();
+		auto &slot = mSlots[seqnum & mask()];
+		if (slot) return false;
+		slot.emplace(std::piecewise_construct, std::forward_as_tuple(seqnum),
+		             std::forward_as_tuple(std::forward<Args>(args)...));
+		mCount++;
+		return true;
+	}
+
+	size_t erase(uint16_t seqnum) {
+		auto &slot = mSlots[seqnum & mask()];
+		if (!slot || slot->first != seqnum) return 0;
+		slot.reset();
+		mCount--;
+		return 1;
+	}
+
+	void clear() {
+		for (auto &slot : mSlots)
+			slot.reset();
+		mCount = 0;
+	}
+
+	bool empty() const {
+		return mCount == 0;
+	}
+
+	size_t size() const {
+		return mCount;
+	}
+
+private:
+	size_t mask() const {
+		return mSlots.size() - 1;
+	}
+
+	void grow() {
+		std::vector<std::optional<std::pair<uint16_t, T>>> slots(mSlots.size() * 2);
+		size_t newMask = slots.size() - 1;
+		for (auto &slot : mSlots) {
+			if (slot) slots[slot->first & newMask].emplace(std::move(*slot));
+		}
+		mSlots.swap(slots);
+	}
+
+	std::vector<std::optional<std::pair<uint16_t, T>>> mSlots;
+	size_t mCount = 0;
+};
+
+} // namespace ortp
+
+#endif // SEQNUM_MAP_H
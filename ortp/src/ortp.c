@@ -89,9 +89,31 @@ void ortp_init(void) {
  *
  **/
 void ortp_scheduler_init(void) {
-	static bool_t initialized = FALSE;
-	if (initialized) return;
-	initialized = TRUE;
+	ortp_scheduler_init_with_workers(0);
+}
+
+/**
+ *	Initialize the oRTP scheduler with the processing of the scheduled sessions shared among worker threads,
+ *	each one pinned to a cpu core, so that blocking mode sessions scale with the number of cores.
+ *	If the scheduler is already initialized, it is restarted with the new worker count as long as no session is
+ *	scheduled yet, otherwise a warning is logged and its worker count is kept.
+ *
+ *	@param worker_count number of worker threads, 0 to process all sessions in the scheduler thread,
+ *	a negative value for one worker per cpu core.
+ **/
+void ortp_scheduler_init_with_workers(int worker_count) {
+	/* the scheduler is destroyed by ortp_exit(), it can then be initialized again */
+	if (__ortp_scheduler != NULL) {
+		if (rtp_scheduler_has_sessions(__ortp_scheduler)) {
+			ortp_warning("The scheduler already has sessions, it keeps its %i workers instead of %i.",
+			             __ortp_scheduler->worker_count, worker_count);
+			return;
+		}
+		rtp_scheduler_stop(__ortp_scheduler);
+		rtp_scheduler_set_worker_count(__ortp_scheduler, worker_count);
+		rtp_scheduler_start(__ortp_scheduler);
+		return;
+	}
 #ifdef __hpux
 	/* on hpux, we must block sigalrm on the main process, because signal delivery
 	is ?random?, well, sometimes the SIGALRM goes to both the main thread and the
@@ -103,6 +125,7 @@ void ortp_scheduler_init(void) {
 #endif /* __hpux */
 
 	__ortp_scheduler = rtp_scheduler_new();
+	rtp_scheduler_set_worker_count(__ortp_scheduler, worker_count);
 	rtp_scheduler_start(__ortp_scheduler);
 }
 
@@ -121,9 +144,18 @@ void ortp_exit(void) {
 			rtp_scheduler_destroy(__ortp_scheduler);
 			__ortp_scheduler = NULL;
 		}
+		ortp_mblk_pool_trim();
 	}
 }
 
+/**
+ *	Returns the number of worker threads processing the scheduled sessions, 0 if they are processed by the scheduler
+ *	thread or if the scheduler is not initialized.
+ **/
+int ortp_scheduler_get_worker_count(void) {
+	return __ortp_scheduler != NULL ? __ortp_scheduler->worker_count : 0;
+}
+
 RtpScheduler *ortp_get_scheduler(void) {
 	if (__ortp_scheduler == NULL)
 		ortp_error("Cannot use the scheduled mode: the scheduler is not "
@@ -25,11 +25,13 @@
 #include "congestiondetector.h"
 #include "jitterctl.h"
 #include "ortp/ortp.h"
+#include "rtpseqring.h"
 #include "rtpsession_priv.h"
 #include "utils.h"
 #include "videobandwidthestimator.h"
 
-static bool_t queue_packet(queue_t *q, int maxrqsz, mblk_t *mp, rtp_header_t *rtp, int *discarded, int *duplicate) {
+static bool_t queue_packet(
+    queue_t *q, OrtpSeqRing *ring, int maxrqsz, mblk_t *mp, rtp_header_t *rtp, int *discarded, int *duplicate) {
 	mblk_t *tmp;
 	int header_size;
 	*discarded = 0;
@@ -43,7 +45,7 @@ static bool_t queue_packet(queue_t *q, int maxrqsz, mblk_t *mp, rtp_header_t *rt
 	}
 
 	/* and then add the packet to the queue */
-	if (rtp_putq(q, mp) < 0) {
+	if ((ring ? ortp_seq_ring_putq(ring, q, mp) : rtp_putq(q, mp)) < 0) {
 		/* It was a duplicate packet */
 		(*duplicate)++;
 		return FALSE;
@@ -53,6 +55,7 @@ static bool_t queue_packet(queue_t *q, int maxrqsz, mblk_t *mp, rtp_header_t *rt
 	while (q->q_mcount > maxrqsz) {
 		/* remove the oldest mblk_t */
 		tmp = getq(q);
+		ortp_seq_ring_remove(ring, tmp);
 
 		ortp_warning("rtp_putq: Queue is full. Discarding message with ts=%u", rtp_get_timestamp(tmp));
 		freemsg(tmp);
@@ -301,7 +304,8 @@ void rtp_session_rtp_parse(
 
 	/* check for possible telephone events */
 	if (rtp_profile_is_telephone_event(session->snd.profile, rtp->paytype)) {
-		queue_packet(&session->rtp.tev_rq, session->rtp.jittctl.params.max_packets, mp, rtp, &discarded, &duplicate);
+		queue_packet(&session->rtp.tev_rq, NULL, session->rtp.jittctl.params.max_packets, mp, rtp, &discarded,
+		             &duplicate);
 		stats->discarded += discarded;
 		ortp_global_stats.discarded += discarded;
 		stats->packet_dup_recv += duplicate;
@@ -379,7 +383,8 @@ void rtp_session_rtp_parse(
 		check_for_seq_number_gap_immediate(session, rtp);
 	}
 
-	if (queue_packet(&session->rtp.rq, session->rtp.jittctl.params.max_packets, mp, rtp, &discarded, &duplicate))
+	if (queue_packet(&session->rtp.rq, session->rtp.rq_ring, session->rtp.jittctl.params.max_packets, mp, rtp,
+	                 &discarded, &duplicate))
 		jitter_control_update_size(&session->rtp.jittctl, &session->rtp.rq);
 	stats->discarded += discarded;
 	ortp_global_stats.discarded += discarded;
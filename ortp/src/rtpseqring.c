@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ortp/logging.h"
+#include "ortp/rtp.h"
+#include "rtpseqring.h"
+#include "rtpsession_priv.h"
+
+OrtpSeqRing *ortp_seq_ring_new(void) {
+	OrtpSeqRing *ring = ortp_new0(OrtpSeqRing, 1);
+	ring->slots = ortp_new0(mblk_t *, ORTP_SEQ_RING_MIN_SIZE);
+	ring->mask = ORTP_SEQ_RING_MIN_SIZE - 1;
+	ring->indexed = TRUE;
+	return ring;
+}
+
+void ortp_seq_ring_destroy(OrtpSeqRing *ring) {
+	ortp_free(ring->slots);
+	ortp_free(ring);
+}
+
+static uint16_t queue_span(queue_t *q, uint16_t seq) {
+	uint16_t first = rtp_get_seqnumber(qfirst(q));
+	uint16_t last = rtp_get_seqnumber(qlast(q));
+	if (RTP_SEQ_IS_STRICTLY_GREATER_THAN(seq, last)) return (uint16_t)(seq - first);
+	if (RTP_SEQ_IS_STRICTLY_GREATER_THAN(first, seq)) return (uint16_t)(last - seq);
+	return (uint16_t)(last - first);
+}
+
+/* Rebuilds the slots from the queue, with enough of them for a span of sequence numbers */
+static void reindex(OrtpSeqRing *ring, queue_t *q, uint16_t span) {
+	uint32_t size = (uint32_t)ring->mask + 1;
+	mblk_t *mp;
+
+	if (span >= size) {
+		while (span >= size)
+			size <<= 1;
+		ortp_free(ring->slots);
+		ring->slots = ortp_new0(mblk_t *, size);
+		ring->mask = (uint16_t)(size - 1);
+		ortp_debug("ortp_seq_ring: grown to %u slots", size);
+	} else {
+		memset(ring->slots, 0, size * sizeof(mblk_t *));
+	}
+	for (mp = qbegin(q); !qend(q, mp); mp = qnext(q, mp)) {
+		ring->slots[rtp_get_seqnumber(mp) & ring->mask] = mp;
+	}
+	ring->indexed = TRUE;
+}
+
+/* Makes sure that the queue will be indexed once a packet making its span equal to span is inserted */
+static bool_t ensure_indexed(OrtpSeqRing *ring, queue_t *q, uint16_t span) {
+	if (ring->indexed && span <= ring->mask) return TRUE;
+	if (span >= ORTP_SEQ_RING_MAX_SIZE) {
+		if (ring->indexed) {
+			ortp_message("ortp_seq_ring: span of %u sequence numbers in the receive queue, using a linear search",
+			             (unsigned int)span);
+			memset(ring->slots, 0, ((size_t)ring->mask + 1) * sizeof(mblk_t *));
+			ring->indexed = FALSE;
+		}
+		return FALSE;
+	}
+	reindex(ring, q, span);
+	return TRUE;
+}
+
+int ortp_seq_ring_putq(OrtpSeqRing *ring, queue_t *q, mblk_t *mp) {
+	uint16_t seq = rtp_get_seqnumber(mp);
+	mblk_t **slot;
+
+	if (qempty(q)) {
+		/* an empty queue has all its slots free, whatever happened before */
+		ring->indexed = TRUE;
+		ring->slots[seq & ring->mask] = mp;
+		putq(q, mp);
+		return 0;
+	}
+	if (!ensure_indexed(ring, q, queue_span(q, seq))) return rtp_putq(q, mp);
+
+	slot = &ring->slots[seq & ring->mask];
+	if (*slot != NULL) {
+		/* the span being smaller than the number of slots, it can only be the same sequence number */
+		ortp_debug("ortp_seq_ring_putq: duplicated message.");
+		freemsg(mp);
+		return -1;
+	}
+	if (RTP_SEQ_IS_STRICTLY_GREATER_THAN(seq, rtp_get_seqnumber(qlast(q)))) {
+		putq(q, mp);
+	} else if (RTP_SEQ_IS_STRICTLY_GREATER_THAN(rtp_get_seqnumber(qfirst(q)), seq)) {
+		insq(q, qfirst(q), mp);
+	} else {
+		/* insert after the closest older packet, the first packet of the queue being one of them */
+		uint16_t prev = (uint16_t)(seq - 1);
+		mblk_t *older;
+		while ((older = ring->slots[prev & ring->mask]) == NULL)
+			prev--;
+		insq(q, older->b_next, mp);
+	}
+	*slot = mp;
+	return 0;
+}
+
+void ortp_seq_ring_remove(OrtpSeqRing *ring, mblk_t *mp) {
+	mblk_t **slot;
+	if (ring == NULL || mp == NULL || !ring->indexed) return;
+	slot = &ring->slots[rtp_get_seqnumber(mp) & ring->mask];
+	if (*slot == mp) *slot = NULL;
+}
+
+mblk_t *ortp_seq_ring_find(OrtpSeqRing *ring, queue_t *q, uint16_t seq) {
+	mblk_t *mp;
+	if (ring->indexed) {
+		mp = ring->slots[seq & ring->mask];
+		return (mp != NULL && rtp_get_seqnumber(mp) == seq) ? mp : NULL;
+	}
+	for (mp = qbegin(q); !qend(q, mp); mp = qnext(q, mp)) {
+		if (rtp_get_seqnumber(mp) == seq) return mp;
+	}
+	return NULL;
+}
+
+void ortp_seq_ring_flushq(OrtpSeqRing *ring, queue_t *q) {
+	flushq(q, FLUSHALL);
+	memset(ring->slots, 0, ((size_t)ring->mask + 1) * sizeof(mblk_t *));
+	ring->indexed = TRUE;
+}
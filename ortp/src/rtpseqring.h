@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RTPSEQRING_H
+#define RTPSEQRING_H
+
+#include <ortp/port.h>
+#include <ortp/str_utils.h>
+
+/*
+ * Index of a receive queue by RTP sequence number.
+ * The queue itself stays a queue_t sorted by increasing sequence number, so that it can still be walked and
+ * measured as before. The ring is a power of two array of slots, the packet with sequence number seq being
+ * stored at slot (seq & mask). As long as the span of sequence numbers present in the queue is smaller than
+ * the number of slots, no two packets share a slot: insertion, duplicate detection and lookup are then done
+ * without walking the queue. The ring grows up to ORTP_SEQ_RING_MAX_SIZE slots; above that (very large jump in
+ * the sequence numbers), it is put aside and the queue is walked until its span becomes small enough again.
+ */
+
+#define ORTP_SEQ_RING_MIN_SIZE 64
+#define ORTP_SEQ_RING_MAX_SIZE 8192
+
+typedef struct _OrtpSeqRing {
+	mblk_t **slots;
+	uint16_t mask;  /* number of slots minus one */
+	bool_t indexed; /* FALSE while the packets of the queue are not all in their slot */
+} OrtpSeqRing;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OrtpSeqRing *ortp_seq_ring_new(void);
+void ortp_seq_ring_destroy(OrtpSeqRing *ring);
+
+/* Same as rtp_putq(): returns -1 and frees mp if it is a duplicate, 0 otherwise. */
+int ortp_seq_ring_putq(OrtpSeqRing *ring, queue_t *q, mblk_t *mp);
+/* To be called for every packet leaving the queue, before or after it has been unlinked. */
+void ortp_seq_ring_remove(OrtpSeqRing *ring, mblk_t *mp);
+mblk_t *ortp_seq_ring_find(OrtpSeqRing *ring, queue_t *q, uint16_t seq);
+void ortp_seq_ring_flushq(OrtpSeqRing *ring, queue_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
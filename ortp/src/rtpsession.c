@@ -30,6 +30,7 @@
 #include "ortp/ortp.h"
 #include "ortp/rtcp.h"
 #include "ortp/telephonyevents.h"
+#include "rtpseqring.h"
 #include "rtpsession_priv.h"
 #include "scheduler.h"
 #include "utils.h"
@@ -247,6 +248,7 @@ void rtp_session_init(RtpSession *session, RtpSessionMode mode) {
 	session->multicast_ttl = RTP_DEFAULT_MULTICAST_TTL;
 	session->multicast_loopback = RTP_DEFAULT_MULTICAST_LOOPBACK;
 	qinit(&session->rtp.rq);
+	session->rtp.rq_ring = ortp_seq_ring_new();
 	qinit(&session->rtp.tev_rq);
 	qinit(&session->rtp.winrq);
 	qinit(&session->contributing_sources);
@@ -283,6 +285,7 @@ void rtp_session_init(RtpSession *session, RtpSessionMode mode) {
 	rtp_session_enable_rtcp(session, TRUE);
 	rtp_session_set_rtcp_report_interval(session, RTCP_DEFAULT_REPORT_INTERVAL);
 	session->recv_buf_size = UDP_MAX_SIZE;
+	session->recv_batch_size = 1;
 	session->symmetric_rtp = FALSE;
 	session->permissive = FALSE;
 	session->reuseaddr = TRUE;
@@ -1572,14 +1575,7 @@ static void payload_type_changed_notify(RtpSession *session, int paytype) {
  **/
 
 mblk_t *rtp_session_pick_with_cseq(RtpSession *session, const uint16_t sequence_number) {
-	queue_t *q = &session->rtp.rq;
-	mblk_t *mb;
-	for (mb = qbegin(q); !qend(q, mb); mb = qnext(q, mb)) {
-		if (rtp_get_seqnumber(mb) == sequence_number) {
-			return mb;
-		}
-	}
-	return NULL;
+	return ortp_seq_ring_find(session->rtp.rq_ring, &session->rtp.rq, sequence_number);
 }
 
 static void check_for_seq_number_gap(RtpSession *session, rtp_header_t *rtp) {
@@ -1651,7 +1647,7 @@ static void apply_fec_on_missing_packets(RtpSession *session) {
 
 							if (fec_mp != NULL) {
 								/* inject recovered packet in jitter buffer */
-								rtp_putq(&session->rtp.rq, fec_mp);
+								ortp_seq_ring_putq(session->rtp.rq_ring, &session->rtp.rq, fec_mp);
 							}
 							seq_num_missing++;
 							seq_num_diff--;
@@ -1782,7 +1778,10 @@ mblk_t *rtp_session_recvm_with_ts(RtpSession *session, uint32_t user_ts) {
 
 end:
 
-	if (!qempty(&session->rtp.rq) && mp != NULL) remq(&session->rtp.rq, mp);
+	if (!qempty(&session->rtp.rq) && mp != NULL) {
+		ortp_seq_ring_remove(session->rtp.rq_ring, mp);
+		remq(&session->rtp.rq, mp);
+	}
 
 	if (mp != NULL) {
 		size_t msgsize = msgdsize(mp); /* evaluate how much bytes (including header) is received by app */
@@ -2039,10 +2038,16 @@ void _rtp_session_release_sockets(RtpSession *session, bool_t release_transports
 		session->rtcp.gs.tr = 0;
 	}
 
+	/* queued packets must leave before their sockets are closed */
+	ortp_stream_release_send_batch(session, &session->rtp.gs);
+	ortp_stream_release_send_batch(session, &session->rtcp.gs);
 	if (session->rtp.gs.socket != (ortp_socket_t)-1) close_socket(session->rtp.gs.socket);
 	if (session->rtcp.gs.socket != (ortp_socket_t)-1) close_socket(session->rtcp.gs.socket);
 	session->rtp.gs.socket = -1;
 	session->rtcp.gs.socket = -1;
+	/* datagrams read ahead belong to the sockets that have just been closed */
+	ortp_stream_release_recv_batch(&session->rtp.gs);
+	ortp_stream_release_recv_batch(&session->rtcp.gs);
 
 	/* don't discard remote addresses, then can be preserved for next use.
 	session->rtp.gs.rem_addrlen=0;
@@ -2141,6 +2146,8 @@ void rtp_session_uninit(RtpSession *session) {
 
 	/*flush all queues */
 	flushq(&session->rtp.rq, FLUSHALL);
+	ortp_seq_ring_destroy(session->rtp.rq_ring);
+	session->rtp.rq_ring = NULL;
 	flushq(&session->rtp.tev_rq, FLUSHALL);
 	flushq(&session->rtp.winrq, FLUSHALL);
 
@@ -2229,7 +2236,7 @@ void rtp_session_set_ssrc_changed_threshold(RtpSession *session, int numpackets)
  * @param session the rtp session
  **/
 void rtp_session_resync(RtpSession *session) {
-	flushq(&session->rtp.rq, FLUSHALL);
+	ortp_seq_ring_flushq(session->rtp.rq_ring, &session->rtp.rq);
 	rtp_session_set_flag(session, RTP_SESSION_RECV_SYNC);
 	rtp_session_unset_flag(session, RTP_SESSION_FIRST_PACKET_DELIVERED);
 	rtp_session_init_jitter_buffer(session);
@@ -74,6 +74,10 @@
 #endif
 #ifdef HAVE_SENDMSG
 #define USE_SENDMSG 1
+#ifdef HAVE_SENDMMSG
+#define USE_SENDMMSG 1
+#include <netinet/udp.h> /* UDP_SEGMENT */
+#endif
 #endif
 #endif
 
@@ -1172,40 +1176,18 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 #else
 #ifdef USE_SENDMSG
 #define MAX_IOV 64
-static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem_addr, socklen_t addr_len) {
-	struct msghdr msg;
-	struct iovec iov[MAX_IOV];
-	int iovlen;
-	u_char control_buffer[512] = {0};
-	mblk_t *m_track = m;
-	int controlSize = 0; // Used to reset msg.msg_controllen to the real control size
+/*
+ * Writes the source address control messages (pktinfo) of the packet in msg->msg_control, which must be able to hold
+ * msg->msg_controllen bytes. Returns the size of the written control data.
+ */
+static int rtp_sendmsg_fill_control(struct msghdr *msg, mblk_t *m) {
+	int controlSize = 0;
 	struct cmsghdr *cmsg;
 	struct sockaddr_storage v4, v6Mapped;
 	socklen_t v4Len = 0, v6MappedLen = 0;
 	bool_t useV4 = FALSE;
-	int error;
-
-	for (iovlen = 0; iovlen < MAX_IOV && m_track != NULL; m_track = m_track->b_cont, iovlen++) {
-		iov[iovlen].iov_base = m_track->b_rptr;
-		iov[iovlen].iov_len = m_track->b_wptr - m_track->b_rptr;
-	}
-	if (iovlen == MAX_IOV) {
-		int count = 0;
-		while (m_track != NULL) {
-			count++;
-			m_track = m_track->b_cont;
-		}
-		ortp_error("Too long msgb (%i fragments) , didn't fit into iov, end discarded.", MAX_IOV + count);
-	}
-	msg.msg_name = (void *)rem_addr;
-	msg.msg_namelen = addr_len;
-	msg.msg_iov = &iov[0];
-	msg.msg_iovlen = iovlen;
-	msg.msg_flags = 0;
-	msg.msg_control = control_buffer;
-	msg.msg_controllen = sizeof(control_buffer);
 
-	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg = CMSG_FIRSTHDR(msg);
 #ifdef IPV6_PKTINFO
 	if (m->recv_addr.family == AF_INET6 && !IN6_IS_ADDR_UNSPECIFIED(&m->recv_addr.addr.ipi6_addr) &&
 	    !IN6_IS_ADDR_LOOPBACK(&m->recv_addr.addr.ipi6_addr)) { // Add IPV6 to the message control. We only add it if the
@@ -1223,7 +1205,7 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 			pktinfo->ipi6_ifindex = 0; // Set to 0 to let the kernel to use routable interface
 			pktinfo->ipi6_addr = m->recv_addr.addr.ipi6_addr;
 			controlSize += CMSG_SPACE(sizeof(struct in6_pktinfo));
-			cmsg = CMSG_NXTHDR(&msg, cmsg);
+			cmsg = CMSG_NXTHDR(msg, cmsg);
 		}
 	}
 #endif
@@ -1237,7 +1219,7 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 		if (useV4 == TRUE) pktinfo->ipi_spec_dst = ((struct sockaddr_in *)&v4)->sin_addr;
 		else pktinfo->ipi_spec_dst = m->recv_addr.addr.ipi_addr;
 		controlSize += CMSG_SPACE(sizeof(struct in_pktinfo));
-		cmsg = CMSG_NXTHDR(&msg, cmsg);
+		cmsg = CMSG_NXTHDR(msg, cmsg);
 	}
 #endif
 
@@ -1257,7 +1239,7 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 			pktinfo = (struct in6_addr *)CMSG_DATA(cmsg);
 			*pktinfo = m->recv_addr.addr.ipi6_addr;
 			controlSize += CMSG_SPACE(sizeof(struct in6_addr));
-			cmsg = CMSG_NXTHDR(&msg, cmsg);
+			cmsg = CMSG_NXTHDR(msg, cmsg);
 		}
 	}
 #endif
@@ -1271,10 +1253,43 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 		if (useV4 == TRUE) *pktinfo = ((struct sockaddr_in *)&v4)->sin_addr;
 		else *pktinfo = m->recv_addr.addr.ipi_addr;
 		controlSize += CMSG_SPACE(sizeof(struct in_addr));
-		//		cmsg = CMSG_NXTHDR(&msg, cmsg);		// Uncomment if you want to add interfaces
+		//		cmsg = CMSG_NXTHDR(msg, cmsg);		// Uncomment if you want to add interfaces
 	}
 #endif
+	(void)cmsg;
+	return controlSize;
+}
 
+static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem_addr, socklen_t addr_len) {
+	struct msghdr msg;
+	struct iovec iov[MAX_IOV];
+	int iovlen;
+	u_char control_buffer[512] = {0};
+	mblk_t *m_track = m;
+	int controlSize; // Used to reset msg.msg_controllen to the real control size
+	int error;
+
+	for (iovlen = 0; iovlen < MAX_IOV && m_track != NULL; m_track = m_track->b_cont, iovlen++) {
+		iov[iovlen].iov_base = m_track->b_rptr;
+		iov[iovlen].iov_len = m_track->b_wptr - m_track->b_rptr;
+	}
+	if (iovlen == MAX_IOV) {
+		int count = 0;
+		while (m_track != NULL) {
+			count++;
+			m_track = m_track->b_cont;
+		}
+		ortp_error("Too long msgb (%i fragments) , didn't fit into iov, end discarded.", MAX_IOV + count);
+	}
+	msg.msg_name = (void *)rem_addr;
+	msg.msg_namelen = addr_len;
+	msg.msg_iov = &iov[0];
+	msg.msg_iovlen = iovlen;
+	msg.msg_flags = 0;
+	msg.msg_control = control_buffer;
+	msg.msg_controllen = sizeof(control_buffer);
+
+	controlSize = rtp_sendmsg_fill_control(&msg, m);
 	msg.msg_controllen = controlSize;
 	if (controlSize == 0) // Have to reset msg_control to NULL as msg_controllen is not sufficient on some platforms
 		msg.msg_control = NULL;
@@ -1289,6 +1304,265 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 #endif
 #endif
 
+#ifdef USE_SENDMMSG
+#define ORTP_SEND_BATCH_MAX_SIZE 64
+#define ORTP_SEND_BATCH_CONTROL_SIZE 128
+#define ORTP_GSO_MAX_SEGMENTS 64
+#define ORTP_GSO_MAX_SIZE 64000
+
+static void
+log_send_error(RtpSession *session, const char *type, mblk_t *m, struct sockaddr *destaddr, socklen_t destlen);
+
+/*
+ * Packets queued by rtp_session_sendto() when send batching is enabled, waiting for rtp_session_flush_send_batch().
+ * Each packet is a private contiguous copy whose net_addr holds the destination.
+ */
+struct _OrtpSendBatch {
+	int count;
+	int max_segments; /* largest number of packets sent as the segments of a single datagram */
+	bool_t gso_disabled;
+	mblk_t *packets[ORTP_SEND_BATCH_MAX_SIZE];
+};
+
+static bool_t ortp_send_batch_can_segment(const mblk_t *first, const mblk_t *m) {
+	return m->net_addrlen == first->net_addrlen && memcmp(&m->net_addr, &first->net_addr, m->net_addrlen) == 0 &&
+	       memcmp(&m->recv_addr, &first->recv_addr, sizeof(m->recv_addr)) == 0;
+}
+
+/*
+ * Number of consecutive packets starting at index that can be sent as a single UDP GSO message: same destination,
+ * same source address and same size, except the last one which may be shorter.
+ */
+static int ortp_send_batch_gso_segments(OrtpSendBatch *batch, int index) {
+	int n = 1;
+#ifdef UDP_SEGMENT
+	mblk_t *first = batch->packets[index];
+	size_t segment_size = (size_t)(first->b_wptr - first->b_rptr);
+	size_t total = segment_size;
+
+	if (batch->gso_disabled) return 1;
+	while (index + n < batch->count && n < ORTP_GSO_MAX_SEGMENTS) {
+		mblk_t *m = batch->packets[index + n];
+		size_t size = (size_t)(m->b_wptr - m->b_rptr);
+		if (size > segment_size || total + size > ORTP_GSO_MAX_SIZE || !ortp_send_batch_can_segment(first, m)) break;
+		total += size;
+		n++;
+		if (size < segment_size) break; /* only the last segment may be shorter */
+	}
+#else
+	(void)batch;
+	(void)index;
+#endif
+	return n;
+}
+
+static void ortp_send_batch_send_one(RtpSession *session, ortp_socket_t sock, mblk_t *m) {
+	if (rtp_sendmsg(sock, m, m->net_addrlen ? (struct sockaddr *)&m->net_addr : NULL, m->net_addrlen) < 0) {
+		log_send_error(session, "batched", m, (struct sockaddr *)&m->net_addr, m->net_addrlen);
+	}
+}
+
+static void ortp_send_batch_flush(RtpSession *session, OrtpStream *os, ortp_socket_t sock) {
+	OrtpSendBatch *batch = os->send_batch;
+	struct mmsghdr msgs[ORTP_SEND_BATCH_MAX_SIZE];
+	struct iovec iovs[ORTP_SEND_BATCH_MAX_SIZE];
+	u_char controls[ORTP_SEND_BATCH_MAX_SIZE][ORTP_SEND_BATCH_CONTROL_SIZE];
+	int first_packet[ORTP_SEND_BATCH_MAX_SIZE]; /* index of the first packet of each message */
+	int msg_count = 0;
+	int i = 0;
+	int sent = 0;
+
+	if (batch->count == 0) return;
+	if (sock == (ortp_socket_t)-1) {
+		ortp_warning("RtpSession [%p]: no socket to flush %i batched packets.", session, batch->count);
+		goto end;
+	}
+	memset(msgs, 0, sizeof(struct mmsghdr) * batch->count);
+	memset(controls, 0, sizeof(controls[0]) * batch->count);
+	for (i = 0; i < batch->count; i++) {
+		iovs[i].iov_base = batch->packets[i]->b_rptr;
+		iovs[i].iov_len = batch->packets[i]->b_wptr - batch->packets[i]->b_rptr;
+	}
+	/* Packets are contiguous, so the packets of a GSO message simply use consecutive iovecs. */
+	for (i = 0; i < batch->count;) {
+		mblk_t *m = batch->packets[i];
+		struct msghdr *hdr = &msgs[msg_count].msg_hdr;
+		int segments = ortp_send_batch_gso_segments(batch, i);
+		int control_size;
+
+		hdr->msg_name = m->net_addrlen ? (void *)&m->net_addr : NULL;
+		hdr->msg_namelen = m->net_addrlen;
+		hdr->msg_iov = &iovs[i];
+		hdr->msg_iovlen = segments;
+		hdr->msg_control = controls[msg_count];
+		hdr->msg_controllen = ORTP_SEND_BATCH_CONTROL_SIZE;
+		control_size = rtp_sendmsg_fill_control(hdr, m);
+#ifdef UDP_SEGMENT
+		if (segments > 1) {
+			struct cmsghdr *cmsg = (struct cmsghdr *)(controls[msg_count] + control_size);
+			cmsg->cmsg_level = SOL_UDP;
+			cmsg->cmsg_type = UDP_SEGMENT;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			*((uint16_t *)CMSG_DATA(cmsg)) = (uint16_t)iovs[i].iov_len;
+			control_size += CMSG_SPACE(sizeof(uint16_t));
+		}
+#endif
+		hdr->msg_controllen = control_size;
+		if (control_size == 0) hdr->msg_control = NULL;
+		first_packet[msg_count++] = i;
+		i += segments;
+	}
+
+	while (sent < msg_count) {
+		int ret = sendmmsg((int)sock, &msgs[sent], (unsigned int)(msg_count - sent), 0);
+		if (ret > 0) {
+			for (i = sent; i < sent + ret; i++) {
+				if ((int)msgs[i].msg_hdr.msg_iovlen > batch->max_segments)
+					batch->max_segments = (int)msgs[i].msg_hdr.msg_iovlen;
+			}
+			sent += ret;
+			continue;
+		}
+		/* The message at index 'sent' could not be sent: send its packets one by one, which retries without the
+		 * pktinfo control messages if they are refused, then go on with the next messages. */
+		{
+			int first = first_packet[sent];
+			int last = sent + 1 < msg_count ? first_packet[sent + 1] : batch->count;
+			if (last - first > 1 && !batch->gso_disabled &&
+			    (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP)) {
+				ortp_warning("RtpSession [%p]: UDP segmentation offload refused (%s), disabling it.", session,
+				             getSocketError());
+				batch->gso_disabled = TRUE;
+			}
+			for (i = first; i < last; i++) {
+				ortp_send_batch_send_one(session, sock, batch->packets[i]);
+			}
+		}
+		sent++;
+	}
+
+end:
+	for (i = 0; i < batch->count; i++) {
+		freemsg(batch->packets[i]);
+		batch->packets[i] = NULL;
+	}
+	batch->count = 0;
+}
+
+static OrtpStream *rtp_session_get_send_stream(RtpSession *session, bool_t is_rtp) {
+	return (is_rtp || session->rtcp_mux) ? &session->rtp.gs : &session->rtcp.gs;
+}
+
+static int rtp_session_queue_send(RtpSession *session,
+                                  bool_t is_rtp,
+                                  ortp_socket_t sock,
+                                  mblk_t *m,
+                                  const struct sockaddr *destaddr,
+                                  socklen_t destlen) {
+	OrtpStream *os = rtp_session_get_send_stream(session, is_rtp);
+	OrtpSendBatch *batch = os->send_batch;
+	size_t size = msgdsize(m);
+	mblk_t *copy;
+	mblk_t *it;
+
+	if (batch == NULL) batch = os->send_batch = ortp_new0(OrtpSendBatch, 1);
+	else if (batch->count == ORTP_SEND_BATCH_MAX_SIZE) ortp_send_batch_flush(session, os, sock);
+
+	/* The caller keeps ownership of m and modifiers may alter it in place for the next destination (auxiliary
+	 * addresses), so a private contiguous copy is queued. */
+	copy = allocb(size, 0);
+	for (it = m; it != NULL; it = it->b_cont) {
+		size_t len = (size_t)(it->b_wptr - it->b_rptr);
+		memcpy(copy->b_wptr, it->b_rptr, len);
+		copy->b_wptr += len;
+	}
+	copy->recv_addr = m->recv_addr;
+	if (destaddr && destlen > 0) memcpy(&copy->net_addr, destaddr, destlen);
+	copy->net_addrlen = destaddr ? destlen : 0;
+	batch->packets[batch->count++] = copy;
+	return (int)size;
+}
+#endif
+
+void ortp_stream_flush_send_batch(RtpSession *session, OrtpStream *os) {
+#ifdef USE_SENDMMSG
+	if (os->send_batch) ortp_send_batch_flush(session, os, os->socket);
+#else
+	(void)session;
+	(void)os;
+#endif
+}
+
+void ortp_stream_release_send_batch(RtpSession *session, OrtpStream *os) {
+	if (os->send_batch == NULL) return;
+	ortp_stream_flush_send_batch(session, os);
+	ortp_free(os->send_batch);
+	os->send_batch = NULL;
+}
+
+/**
+ * Enables or disables send batching.
+ * When enabled, the RTP and RTCP packets sent through the session sockets (including the copies sent to auxiliary
+ * destinations) are queued instead of being sent immediately, and are sent all at once by
+ * rtp_session_flush_send_batch(), typically called once per processing cycle, with a single sendmmsg() system call.
+ * Consecutive packets of the same size for the same destination are coalesced with UDP segmentation offload (GSO)
+ * when the kernel supports it. The queue is also flushed when full, when the sockets are released and when
+ * batching is disabled. This is only supported on platforms providing sendmmsg().
+ * Note that RTCP packets are also sent while receiving (receiver reports, feedback): an application that only receives
+ * on the session must call rtp_session_flush_send_batch() after rtp_session_recvm_with_ts() too.
+ * @param session a rtp session
+ * @param yesno TRUE to enable send batching.
+ **/
+void rtp_session_enable_send_batching(RtpSession *session, bool_t yesno) {
+#ifndef USE_SENDMMSG
+	if (yesno) {
+		ortp_warning("RtpSession [%p]: send batching is not supported on this platform.", session);
+		yesno = FALSE;
+	}
+#endif
+	session->send_batching = yesno;
+	if (!yesno) {
+		ortp_stream_release_send_batch(session, &session->rtp.gs);
+		ortp_stream_release_send_batch(session, &session->rtcp.gs);
+	}
+}
+
+bool_t rtp_session_send_batching_enabled(const RtpSession *session) {
+	return session->send_batching;
+}
+
+/**
+ * Sends all the packets queued since the last call, when send batching is enabled.
+ * @param session a rtp session
+ **/
+void rtp_session_flush_send_batch(RtpSession *session) {
+	if (session->bundle && !session->is_primary) {
+		/* packets of secondary sessions are sent through the sockets of the primary session */
+		RtpSession *primary = rtp_bundle_get_primary_session(session->bundle);
+		if (primary && primary != session) rtp_session_flush_send_batch(primary);
+	}
+	ortp_stream_flush_send_batch(session, &session->rtp.gs);
+	ortp_stream_flush_send_batch(session, &session->rtcp.gs);
+}
+
+/**
+ * Returns the largest number of RTP packets sent as the segments of a single datagram since send batching was enabled
+ * or since rtp_session_reset_send_batch_max_segments(), 0 if none were sent. Meant for tests.
+ * @param session a rtp session
+ **/
+int rtp_session_get_send_batch_max_segments(BCTBX_UNUSED(const RtpSession *session)) {
+#ifdef USE_SENDMMSG
+	if (session->rtp.gs.send_batch) return session->rtp.gs.send_batch->max_segments;
+#endif
+	return 0;
+}
+
+void rtp_session_reset_send_batch_max_segments(BCTBX_UNUSED(RtpSession *session)) {
+#ifdef USE_SENDMMSG
+	if (session->rtp.gs.send_batch) session->rtp.gs.send_batch->max_segments = 0;
+#endif
+}
+
 ortp_socket_t rtp_session_get_socket(RtpSession *session, bool_t is_rtp) {
 	return is_rtp ? session->rtp.gs.socket : session->rtcp.gs.socket;
 }
@@ -1331,7 +1605,12 @@ int rtp_session_sendto(
 	if (!using_simulator) {
 		ortp_socket_t sockfd = rtp_session_get_socket(session, is_rtp || session->rtcp_mux);
 		if (sockfd != (ortp_socket_t)-1) {
-			ret = _ortp_sendto(sockfd, m, flags, destaddr, destlen);
+#ifdef USE_SENDMMSG
+			if (session->send_batching && flags == 0) {
+				ret = rtp_session_queue_send(session, is_rtp, sockfd, m, destaddr, destlen);
+			} else
+#endif
+				ret = _ortp_sendto(sockfd, m, flags, destaddr, destlen);
 		} else {
 			ret = -1;
 		}
@@ -1396,10 +1675,26 @@ static const ortp_recv_addr_t *get_recv_addr(RtpSession *session, struct sockadd
 	}
 }
 
+#ifdef HAVE_RECVMMSG
+static int rtp_session_batch_recvfrom(RtpSession *session,
+                                      OrtpStream *os,
+                                      ortp_socket_t socket,
+                                      mblk_t *msg,
+                                      struct sockaddr *from,
+                                      socklen_t *fromlen);
+#endif
+
 int rtp_session_recvfrom(
     RtpSession *session, bool_t is_rtp, mblk_t *m, int flags, struct sockaddr *from, socklen_t *fromlen) {
-	int ret = rtp_session_rtp_recv_abstract(is_rtp ? session->rtp.gs.socket : session->rtcp.gs.socket, m, flags, from,
-	                                        fromlen);
+	ortp_socket_t socket = is_rtp ? session->rtp.gs.socket : session->rtcp.gs.socket;
+	int ret;
+#ifdef HAVE_RECVMMSG
+	OrtpStream *os = is_rtp ? &session->rtp.gs : &session->rtcp.gs;
+	if (flags == 0 && (session->recv_batch_size > 1 || os->recv_batch != NULL)) {
+		ret = rtp_session_batch_recvfrom(session, os, socket, m, from, fromlen);
+	} else
+#endif
+		ret = rtp_session_rtp_recv_abstract(socket, m, flags, from, fromlen);
 	if ((ret >= 0) && (session->use_pktinfo == TRUE)) {
 		if (m->recv_addr.family == AF_UNSPEC) {
 			const ortp_recv_addr_t *recv_addr;
@@ -1632,6 +1927,67 @@ static int rtp_recvmsg(ortp_socket_t socket,
 	return error;
 }
 #endif
+
+#ifdef _WIN32
+typedef WSAMSG ortp_msghdr_t;
+typedef WSACMSGHDR ortp_cmsghdr_t;
+#else
+typedef struct msghdr ortp_msghdr_t;
+typedef struct cmsghdr ortp_cmsghdr_t;
+#endif
+
+/* Fills the mblk_t with the ancillary data (reception time, destination address, ttl) of a received datagram. */
+static void rtp_session_read_recv_control(ortp_msghdr_t *msghdr, mblk_t *msg) {
+	ortp_cmsghdr_t *cmsghdr;
+	for (cmsghdr = CMSG_FIRSTHDR(msghdr); cmsghdr != NULL; cmsghdr = CMSG_NXTHDR(msghdr, cmsghdr)) {
+#ifdef _RECV_SO_TIMESTAMP_TYPE
+		if (cmsghdr->cmsg_level == SOL_SOCKET && cmsghdr->cmsg_type == _RECV_SO_TIMESTAMP_TYPE) {
+			memcpy(&msg->timestamp, (struct timeval *)CMSG_DATA(cmsghdr), sizeof(struct timeval));
+		}
+#endif
+#ifdef IP_PKTINFO
+		if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_PKTINFO)) {
+			struct in_pktinfo *pi = (struct in_pktinfo *)CMSG_DATA(cmsghdr);
+			memcpy(&msg->recv_addr.addr.ipi_addr, &pi->ipi_addr, sizeof(msg->recv_addr.addr.ipi_addr));
+			msg->recv_addr.family = AF_INET;
+		}
+#endif
+#ifdef IPV6_PKTINFO
+		if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_PKTINFO)) {
+			struct in6_pktinfo *pi = (struct in6_pktinfo *)CMSG_DATA(cmsghdr);
+			memcpy(&msg->recv_addr.addr.ipi6_addr, &pi->ipi6_addr, sizeof(msg->recv_addr.addr.ipi6_addr));
+			msg->recv_addr.family = AF_INET6;
+		}
+#endif
+#ifdef IP_RECVDSTADDR
+		if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_RECVDSTADDR)) {
+			struct in_addr *ia = (struct in_addr *)CMSG_DATA(cmsghdr);
+			memcpy(&msg->recv_addr.addr.ipi_addr, ia, sizeof(msg->recv_addr.addr.ipi_addr));
+			msg->recv_addr.family = AF_INET;
+		}
+#endif
+#ifdef IPV6_RECVDSTADDR
+		if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_RECVDSTADDR)) {
+			struct in6_addr *ia = (struct in6_addr *)CMSG_DATA(cmsghdr);
+			memcpy(&msg->recv_addr.addr.ipi6_addr, ia, sizeof(msg->recv_addr.addr.ipi6_addr));
+			msg->recv_addr.family = AF_INET6;
+		}
+#endif
+#ifdef IP_RECVTTL
+		if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_TTL)) {
+			uint32_t *ptr = (uint32_t *)CMSG_DATA(cmsghdr);
+			msg->ttl_or_hl = (*ptr & 0xFF);
+		}
+#endif
+#ifdef IPV6_RECVHOPLIMIT
+		if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_HOPLIMIT)) {
+			uint32_t *ptr = (uint32_t *)CMSG_DATA(cmsghdr);
+			msg->ttl_or_hl = (*ptr & 0xFF);
+		}
+#endif
+	}
+}
+
 int rtp_session_rtp_recv_abstract(
     ortp_socket_t socket, mblk_t *msg, int flags, struct sockaddr *from, socklen_t *fromlen) {
 	int ret;
@@ -1639,7 +1995,6 @@ int rtp_session_rtp_recv_abstract(
 	char control[512] = {0};
 #ifdef _WIN32
 	WSAMSG msghdr = {0};
-	WSACMSGHDR *cmsghdr;
 	WSABUF data_buf;
 	DWORD bytes_received = 0;
 	int error = 0;
@@ -1672,65 +2027,185 @@ int rtp_session_rtp_recv_abstract(
 	ret = recvfrom(socket, msg->b_wptr, bufsz, flags, from, fromlen);
 #endif
 	if (ret >= 0) {
-		struct cmsghdr *cmsghdr;
 #endif
-		for (cmsghdr = CMSG_FIRSTHDR(&msghdr); cmsghdr != NULL; cmsghdr = CMSG_NXTHDR(&msghdr, cmsghdr)) {
-#ifdef _RECV_SO_TIMESTAMP_TYPE
-			if (cmsghdr->cmsg_level == SOL_SOCKET && cmsghdr->cmsg_type == _RECV_SO_TIMESTAMP_TYPE) {
-				memcpy(&msg->timestamp, (struct timeval *)CMSG_DATA(cmsghdr), sizeof(struct timeval));
-			}
-#endif
-#ifdef IP_PKTINFO
-			if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_PKTINFO)) {
-				struct in_pktinfo *pi = (struct in_pktinfo *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi_addr, &pi->ipi_addr, sizeof(msg->recv_addr.addr.ipi_addr));
-				msg->recv_addr.family = AF_INET;
-			}
-#endif
-#ifdef IPV6_PKTINFO
-			if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_PKTINFO)) {
-				struct in6_pktinfo *pi = (struct in6_pktinfo *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi6_addr, &pi->ipi6_addr, sizeof(msg->recv_addr.addr.ipi6_addr));
-				msg->recv_addr.family = AF_INET6;
-			}
-#endif
-#ifdef IP_RECVDSTADDR
-			if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_RECVDSTADDR)) {
-				struct in_addr *ia = (struct in_addr *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi_addr, ia, sizeof(msg->recv_addr.addr.ipi_addr));
-				msg->recv_addr.family = AF_INET;
-			}
-#endif
-#ifdef IPV6_RECVDSTADDR
-			if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_RECVDSTADDR)) {
-				struct in6_addr *ia = (struct in6_addr *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi6_addr, ia, sizeof(msg->recv_addr.addr.ipi6_addr));
-				msg->recv_addr.family = AF_INET6;
-			}
-#endif
-#ifdef IP_RECVTTL
-			if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_TTL)) {
-				uint32_t *ptr = (uint32_t *)CMSG_DATA(cmsghdr);
-				msg->ttl_or_hl = (*ptr & 0xFF);
-			}
-#endif
-#ifdef IPV6_RECVHOPLIMIT
-			if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_HOPLIMIT)) {
-				uint32_t *ptr = (uint32_t *)CMSG_DATA(cmsghdr);
-				msg->ttl_or_hl = (*ptr & 0xFF);
-			}
-#endif
-		}
+		rtp_session_read_recv_control(&msghdr, msg);
 		/*store recv addr for use by modifiers*/
 		if (from && fromlen) {
 			memcpy(&msg->net_addr, from, *fromlen);
 			msg->net_addrlen = *fromlen;
 		}
-	} else {
 	}
 	return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+#define ORTP_RECV_BATCH_MAX_SIZE 64
+#define ORTP_RECV_BATCH_CONTROL_SIZE 512
+
+/*
+ * Datagrams read from a socket with a single recvmmsg() call, waiting to be handed out one by one by
+ * rtp_session_recvfrom(). All the arrays have 'size' entries and are allocated once with the batch.
+ */
+struct _OrtpRecvBatch {
+	int size;
+	int buffer_size;
+	int count;     /* number of datagrams returned by the last recvmmsg() */
+	int next;      /* index of the next datagram to hand out */
+	int max_count; /* largest number of datagrams returned by a single recvmmsg() */
+	struct mmsghdr *msgs;
+	struct iovec *iovs;
+	struct sockaddr_storage *addrs;
+	uint8_t *buffers;
+	char *controls;
+};
+
+static OrtpRecvBatch *ortp_recv_batch_new(int size, int buffer_size) {
+	OrtpRecvBatch *batch = ortp_new0(OrtpRecvBatch, 1);
+	batch->size = size;
+	batch->buffer_size = buffer_size;
+	batch->msgs = ortp_new0(struct mmsghdr, size);
+	batch->iovs = ortp_new0(struct iovec, size);
+	batch->addrs = ortp_new0(struct sockaddr_storage, size);
+	batch->buffers = ortp_new(uint8_t, (size_t)size * (size_t)buffer_size);
+	batch->controls = ortp_new(char, (size_t)size * ORTP_RECV_BATCH_CONTROL_SIZE);
+	return batch;
+}
+
+static int ortp_recv_batch_fill(OrtpRecvBatch *batch, ortp_socket_t socket) {
+	int i;
+	int ret;
+
+	for (i = 0; i < batch->size; i++) {
+		struct msghdr *hdr = &batch->msgs[i].msg_hdr;
+		batch->iovs[i].iov_base = batch->buffers + (size_t)i * (size_t)batch->buffer_size;
+		batch->iovs[i].iov_len = batch->buffer_size;
+		hdr->msg_name = &batch->addrs[i];
+		hdr->msg_namelen = sizeof(batch->addrs[i]);
+		hdr->msg_iov = &batch->iovs[i];
+		hdr->msg_iovlen = 1;
+		hdr->msg_control = batch->controls + (size_t)i * ORTP_RECV_BATCH_CONTROL_SIZE;
+		hdr->msg_controllen = ORTP_RECV_BATCH_CONTROL_SIZE;
+		hdr->msg_flags = 0;
+		batch->msgs[i].msg_len = 0;
+	}
+	/* MSG_DONTWAIT is mandatory: on a blocking socket recvmmsg() would otherwise wait for the whole batch. */
+	ret = recvmmsg(socket, batch->msgs, (unsigned int)batch->size, MSG_DONTWAIT, NULL);
+	batch->next = 0;
+	batch->count = ret > 0 ? ret : 0;
+	return ret;
+}
+
+static int ortp_recv_batch_pop(OrtpRecvBatch *batch, mblk_t *msg, struct sockaddr *from, socklen_t *fromlen) {
+	struct mmsghdr *mmsg = &batch->msgs[batch->next];
+	int bufsz = (int)(msg->b_datap->db_lim - msg->b_wptr);
+	int len = MIN((int)mmsg->msg_len, bufsz);
+
+	memcpy(msg->b_wptr, mmsg->msg_hdr.msg_iov->iov_base, len);
+	rtp_session_read_recv_control(&mmsg->msg_hdr, msg);
+	if (from && fromlen) {
+		socklen_t addrlen = MIN(*fromlen, mmsg->msg_hdr.msg_namelen);
+		memcpy(from, mmsg->msg_hdr.msg_name, addrlen);
+		*fromlen = addrlen;
+		/*store recv addr for use by modifiers*/
+		memcpy(&msg->net_addr, from, addrlen);
+		msg->net_addrlen = addrlen;
+	}
+	batch->next++;
+	return len;
+}
+
+void ortp_stream_release_recv_batch(OrtpStream *os) {
+	OrtpRecvBatch *batch = os->recv_batch;
+	if (batch == NULL) return;
+	ortp_free(batch->msgs);
+	ortp_free(batch->iovs);
+	ortp_free(batch->addrs);
+	ortp_free(batch->buffers);
+	ortp_free(batch->controls);
+	ortp_free(batch);
+	os->recv_batch = NULL;
+}
+
+static int rtp_session_batch_recvfrom(RtpSession *session,
+                                      OrtpStream *os,
+                                      ortp_socket_t socket,
+                                      mblk_t *msg,
+                                      struct sockaddr *from,
+                                      socklen_t *fromlen) {
+	OrtpRecvBatch *batch = os->recv_batch;
+
+	if (batch == NULL || batch->next >= batch->count) {
+		int ret;
+		/* The batch is drained, it is the right time to take into account a change of the batch or buffer size. */
+		if (batch != NULL &&
+		    (batch->size != session->recv_batch_size || batch->buffer_size != session->recv_buf_size)) {
+			ortp_stream_release_recv_batch(os);
+			batch = NULL;
+		}
+		if (session->recv_batch_size <= 1) return rtp_session_rtp_recv_abstract(socket, msg, 0, from, fromlen);
+		if (batch == NULL) {
+			batch = os->recv_batch = ortp_recv_batch_new(session->recv_batch_size, session->recv_buf_size);
+		}
+		ret = ortp_recv_batch_fill(batch, socket);
+		if (ret == -1 && errno == ENOSYS) {
+			ortp_warning("RtpSession [%p]: recvmmsg() is not supported by the kernel, disabling batched reception.",
+			             session);
+			session->recv_batch_size = 1;
+			ortp_stream_release_recv_batch(os);
+			return rtp_session_rtp_recv_abstract(socket, msg, 0, from, fromlen);
+		}
+		if (ret <= 0) return ret;
+		if (ret > batch->max_count) batch->max_count = ret;
+	}
+	return ortp_recv_batch_pop(batch, msg, from, fromlen);
+}
+#else
+void ortp_stream_release_recv_batch(BCTBX_UNUSED(OrtpStream *os)) {
+}
+#endif
+
+/**
+ * Sets the maximum number of datagrams that can be read from the RTP or RTCP socket with a single system call.
+ * When greater than 1 and if the platform provides recvmmsg(), the sockets are drained by batches, which
+ * considerably reduces the system call overhead of servers handling many sessions. Packets are still delivered
+ * one by one to the RtpTransport and to the jitter buffer, with their reception time, destination address and ttl.
+ * Memory usage grows with batch_size * recv_buf_size for each socket, see rtp_session_set_recv_buf_size().
+ * @param session a rtp session
+ * @param batch_size the maximum number of datagrams per system call, 1 (the default) disables batching.
+ **/
+void rtp_session_set_recv_batch_size(RtpSession *session, int batch_size) {
+	if (batch_size < 1) batch_size = 1;
+#ifdef HAVE_RECVMMSG
+	if (batch_size > ORTP_RECV_BATCH_MAX_SIZE) {
+		ortp_warning("RtpSession [%p]: recv batch size %i is too large, using %i.", session, batch_size,
+		             ORTP_RECV_BATCH_MAX_SIZE);
+		batch_size = ORTP_RECV_BATCH_MAX_SIZE;
+	}
+#else
+	if (batch_size > 1) {
+		ortp_warning("RtpSession [%p]: batched reception is not supported on this platform.", session);
+		batch_size = 1;
+	}
+#endif
+	session->recv_batch_size = batch_size;
+}
+
+int rtp_session_get_recv_batch_size(const RtpSession *session) {
+	return session->recv_batch_size;
+}
+
+/**
+ * Returns the largest number of datagrams read from the RTP socket by a single system call since the current batch was
+ * allocated, 0 if batched reception is not in use. Meant for tests.
+ * @param session a rtp session
+ **/
+int rtp_session_get_recv_batch_max_count(BCTBX_UNUSED(const RtpSession *session)) {
+#ifdef HAVE_RECVMMSG
+	if (session->rtp.gs.recv_batch) return session->rtp.gs.recv_batch->max_count;
+#endif
+	return 0;
+}
+
 void rtp_session_notify_inc_rtcp(RtpSession *session, mblk_t *m, bool_t received_via_rtcp_mux) {
 	if (session->eventqs != NULL) {
 		OrtpEvent *ev = ortp_event_new(ORTP_EVENT_RTCP_PACKET_RECEIVED);
@@ -48,6 +48,9 @@ typedef enum {
 	RTP_SESSION_SOCKET_REFRESH_REQUESTED = 1 << 16
 } RtpSessionFlags;
 
+typedef struct _OrtpRecvBatch OrtpRecvBatch;
+typedef struct _OrtpSendBatch OrtpSendBatch;
+
 #define rtp_session_using_transport(s, stream) (((s)->flags & RTP_SESSION_USING_TRANSPORT) && (s->stream.gs.tr != 0))
 
 #ifdef __cplusplus
@@ -90,6 +93,9 @@ void rtp_session_send_regular_rtcp_packet_and_reschedule(RtpSession *session, ui
 void rtp_session_send_fb_rtcp_packet_and_reschedule(RtpSession *session);
 
 void ortp_stream_clear_aux_addresses(OrtpStream *os);
+void ortp_stream_release_recv_batch(OrtpStream *os);
+void ortp_stream_flush_send_batch(RtpSession *session, OrtpStream *os);
+void ortp_stream_release_send_batch(RtpSession *session, OrtpStream *os);
 /*
  * no more public, use modifier instead
  * */
@@ -30,6 +30,10 @@
 
 #include <ortp/port.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef void (*RtpTimerFunc)(void);
 
 struct _RtpTimer {
@@ -48,4 +52,8 @@ ORTP_PUBLIC void rtp_timer_set_interval(RtpTimer *timer, struct timeval *interva
 
 ORTP_VAR_PUBLIC RtpTimer posix_timer;
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "ortp-config.h"
+#endif
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "rtpsession_priv.h"
+#include "scheduler.h"
+#include "utils.h"
+#include <ortp/ortp.h>
+
+using namespace std;
+
+// To avoid warning during compile
+extern "C" void rtp_session_process(RtpSession *session, uint32_t time, RtpScheduler *sched);
+
+/*
+ * With workers, the scheduler thread only keeps the time: at each tick, the scheduled sessions are processed by
+ * worker threads, each one owning the sessions of a shard. A shard is made of blocks of positions in the session
+ * masks, so that two workers never write the same word of a mask. The sessions are handed to their worker through a
+ * lock-free stack of requests, that the worker applies before processing its shard.
+ */
+
+/* positions of the session masks per shard block, a multiple of the mask word size on all platforms */
+#define SCHEDULER_SHARD_BLOCK_SIZE 64
+
+typedef struct _RtpSchedulerRequest {
+	struct _RtpSchedulerRequest *next;
+	RtpSession *session;
+	bool add;
+	bool done; /* removal applied, set under the worker lock */
+} RtpSchedulerRequest;
+
+typedef struct _RtpSchedulerWorker {
+	RtpScheduler *sched;
+	int index;
+	ortp_thread_t thread;
+	ortp_mutex_t lock; /* to sleep and to report removals, never held while processing the sessions */
+	ortp_cond_t cond;
+	ortp_cond_t removed_cond;
+	bool running; /* cleared to stop the thread */
+	bool alive;   /* the thread applies the requests, cleared by the thread when it leaves */
+	uint32_t tick; /* tick number and scheduler time of the last tick */
+	uint32_t time;
+	atomic<RtpSchedulerRequest *> requests{nullptr}; /* pushed by any thread, popped by the worker */
+	RtpSession *list;                                /* the sessions of the shard, only used by the worker */
+	int session_count;                               /* protected by the scheduler lock */
+} RtpSchedulerWorker;
+
+typedef struct _RtpSchedulerWorkerPool {
+	RtpSchedulerWorker *workers;
+	int count;
+	atomic_int done{0}; /* number of workers that processed the current tick */
+	ortp_mutex_t lock;
+	ortp_cond_t cond;
+} RtpSchedulerWorkerPool;
+
+static int rtp_scheduler_get_cpu_count(void) {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+static void rtp_scheduler_worker_pin(RtpSchedulerWorker *w) {
+	int cpu = w->index % rtp_scheduler_get_cpu_count();
+#if defined(__linux__) && !defined(__ANDROID__)
+	cpu_set_t set;
+	int err;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if ((err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) != 0)
+		ortp_warning("RtpScheduler [%p]: cannot pin worker %i to cpu %i: %s", w->sched, w->index, cpu, strerror(err));
+#elif defined(_WIN32) && !defined(ORTP_WINDOWS_UNIVERSAL)
+	if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0)
+		ortp_warning("RtpScheduler [%p]: cannot pin worker %i to cpu %i", w->sched, w->index, cpu);
+#else
+	ortp_message("RtpScheduler [%p]: worker %i not pinned to cpu %i, not supported", w->sched, w->index, cpu);
+#endif
+}
+
+static void rtp_scheduler_worker_push_request(RtpSchedulerWorker *w, RtpSchedulerRequest *req) {
+	req->next = w->requests.load(memory_order_relaxed);
+	while (!w->requests.compare_exchange_weak(req->next, req, memory_order_release, memory_order_relaxed)) {
+	}
+}
+
+/* applies the pending requests in their order of arrival, returns the removal ones */
+static RtpSchedulerRequest *rtp_scheduler_worker_apply_requests(RtpSchedulerWorker *w) {
+	RtpSchedulerRequest *req = w->requests.exchange(nullptr, memory_order_acquire);
+	RtpSchedulerRequest *ordered = nullptr;
+	RtpSchedulerRequest *removals = nullptr;
+	RtpSchedulerRequest *next;
+	RtpSession **it;
+
+	for (; req != nullptr; req = next) {
+		next = req->next;
+		req->next = ordered;
+		ordered = req;
+	}
+	for (req = ordered; req != nullptr; req = next) {
+		next = req->next;
+		if (req->add) {
+			req->session->next = w->list;
+			w->list = req->session;
+			ortp_free(req);
+		} else {
+			for (it = &w->list; *it != nullptr; it = &(*it)->next) {
+				if (*it == req->session) {
+					*it = req->session->next;
+					break;
+				}
+			}
+			req->next = removals;
+			removals = req;
+		}
+	}
+	return removals;
+}
+
+/* must be called with the worker lock held, the requests belong to their waiting callers */
+static void rtp_scheduler_worker_complete_removals(RtpSchedulerWorker *w, RtpSchedulerRequest *removals) {
+	RtpSchedulerRequest *next;
+	if (removals == nullptr) return;
+	for (; removals != nullptr; removals = next) {
+		next = removals->next;
+		removals->done = true;
+	}
+	ortp_cond_broadcast(&w->removed_cond);
+}
+
+static void *rtp_scheduler_worker_run(void *data) {
+	RtpSchedulerWorker *w = (RtpSchedulerWorker *)data;
+	RtpSchedulerWorkerPool *pool = w->sched->workers;
+	RtpSchedulerRequest *removals;
+	RtpSession *current;
+	uint32_t processed_tick = 0;
+	uint32_t time = 0;
+	bool tick;
+
+	rtp_scheduler_worker_pin(w);
+	ortp_mutex_lock(&w->lock);
+	while (w->running) {
+		tick = w->tick != processed_tick;
+		if (!tick && w->requests.load(memory_order_acquire) == nullptr) {
+			ortp_cond_wait(&w->cond, &w->lock);
+			continue;
+		}
+		processed_tick = w->tick;
+		time = w->time;
+		ortp_mutex_unlock(&w->lock);
+
+		removals = rtp_scheduler_worker_apply_requests(w);
+		if (removals) {
+			ortp_mutex_lock(&w->lock);
+			rtp_scheduler_worker_complete_removals(w, removals);
+			ortp_mutex_unlock(&w->lock);
+		}
+		if (tick) {
+			for (current = w->list; current != nullptr; current = current->next) {
+				rtp_session_process(current, time, w->sched);
+			}
+			if (pool->done.fetch_add(1, memory_order_acq_rel) + 1 == pool->count) {
+				ortp_mutex_lock(&pool->lock);
+				ortp_cond_signal(&pool->cond);
+				ortp_mutex_unlock(&pool->lock);
+			}
+		}
+		ortp_mutex_lock(&w->lock);
+	}
+	/* from now on, the requests are applied by their callers */
+	rtp_scheduler_worker_complete_removals(w, rtp_scheduler_worker_apply_requests(w));
+	w->alive = false;
+	ortp_mutex_unlock(&w->lock);
+	return nullptr;
+}
+
+static RtpSchedulerWorkerPool *rtp_scheduler_worker_pool_new(RtpScheduler *sched, int count) {
+	RtpSchedulerWorkerPool *pool = new RtpSchedulerWorkerPool();
+	int i;
+	pool->workers = new RtpSchedulerWorker[count]();
+	pool->count = count;
+	ortp_mutex_init(&pool->lock, NULL);
+	ortp_cond_init(&pool->cond, NULL);
+	for (i = 0; i < count; i++) {
+		RtpSchedulerWorker *w = &pool->workers[i];
+		w->sched = sched;
+		w->index = i;
+		ortp_mutex_init(&w->lock, NULL);
+		ortp_cond_init(&w->cond, NULL);
+		ortp_cond_init(&w->removed_cond, NULL);
+	}
+	return pool;
+}
+
+static void rtp_scheduler_worker_pool_destroy(RtpSchedulerWorkerPool *pool) {
+	int i;
+	for (i = 0; i < pool->count; i++) {
+		RtpSchedulerWorker *w = &pool->workers[i];
+		/* frees the pending additions */
+		rtp_scheduler_worker_apply_requests(w);
+		ortp_mutex_destroy(&w->lock);
+		ortp_cond_destroy(&w->cond);
+		ortp_cond_destroy(&w->removed_cond);
+	}
+	ortp_mutex_destroy(&pool->lock);
+	ortp_cond_destroy(&pool->cond);
+	delete[] pool->workers;
+	delete pool;
+}
+
+static void rtp_scheduler_worker_pool_start(RtpSchedulerWorkerPool *pool) {
+	int i;
+	for (i = 0; i < pool->count; i++) {
+		RtpSchedulerWorker *w = &pool->workers[i];
+		w->running = true;
+		w->alive = true;
+		ortp_thread_create(&w->thread, NULL, rtp_scheduler_worker_run, (void *)w);
+	}
+}
+
+static void rtp_scheduler_worker_pool_stop(RtpSchedulerWorkerPool *pool) {
+	int i;
+	for (i = 0; i < pool->count; i++) {
+		RtpSchedulerWorker *w = &pool->workers[i];
+		ortp_mutex_lock(&w->lock);
+		w->running = false;
+		ortp_cond_signal(&w->cond);
+		ortp_mutex_unlock(&w->lock);
+		ortp_thread_join(w->thread, NULL);
+	}
+}
+
+/* runs one tick of the workers and waits for all of them to complete it */
+static void rtp_scheduler_worker_pool_tick(RtpSchedulerWorkerPool *pool, uint32_t time) {
+	int i;
+	pool->done.store(0, memory_order_relaxed);
+	for (i = 0; i < pool->count; i++) {
+		RtpSchedulerWorker *w = &pool->workers[i];
+		ortp_mutex_lock(&w->lock);
+		w->tick++;
+		w->time = time;
+		ortp_cond_signal(&w->cond);
+		ortp_mutex_unlock(&w->lock);
+	}
+	ortp_mutex_lock(&pool->lock);
+	while (pool->done.load(memory_order_acquire) < pool->count)
+		ortp_cond_wait(&pool->cond, &pool->lock);
+	ortp_mutex_unlock(&pool->lock);
+}
+
+static void rtp_scheduler_init(RtpScheduler *sched) {
+	sched->list = 0;
+	sched->time_ = 0;
+	/* default to the posix timer */
+#if !defined(ORTP_WINDOWS_UNIVERSAL)
+	rtp_scheduler_set_timer(sched, &posix_timer);
+#endif
+	ortp_mutex_init(&sched->lock, NULL);
+	ortp_cond_init(&sched->unblock_select_cond, NULL);
+	sched->max_sessions = sizeof(SessionSet) * 8;
+	session_set_init(&sched->all_sessions);
+	sched->all_max = 0;
+	session_set_init(&sched->r_sessions);
+	sched->r_max = 0;
+	session_set_init(&sched->w_sessions);
+	sched->w_max = 0;
+	session_set_init(&sched->e_sessions);
+	sched->e_max = 0;
+}
+
+RtpScheduler *rtp_scheduler_new(void) {
+	RtpScheduler *sched = (RtpScheduler *)ortp_malloc(sizeof(RtpScheduler));
+	memset(sched, 0, sizeof(RtpScheduler));
+	rtp_scheduler_init(sched);
+	return sched;
+}
+
+void rtp_scheduler_set_timer(RtpScheduler *sched, RtpTimer *timer) {
+	if (sched->thread_running) {
+		ortp_warning("Cannot change timer while the scheduler is running !!");
+		return;
+	}
+	sched->timer = timer;
+	/* report the timer increment */
+	sched->timer_inc = (timer->interval.tv_usec / 1000) + (timer->interval.tv_sec * 1000);
+}
+
+/**
+ * Sets the number of worker threads processing the scheduled sessions, each one pinned to a cpu core.
+ * 0 keeps all the processing in the scheduler thread, a negative value means one worker per core.
+ * Must be called before the scheduler is started.
+ **/
+void rtp_scheduler_set_worker_count(RtpScheduler *sched, int count) {
+	/* two workers cannot share a block of the session masks */
+	int max_count = sched->max_sessions / SCHEDULER_SHARD_BLOCK_SIZE;
+	if (sched->thread_running) {
+		ortp_warning("Cannot change the worker count while the scheduler is running !!");
+		return;
+	}
+	if (rtp_scheduler_has_sessions(sched)) {
+		ortp_warning("Cannot change the worker count of a scheduler that already has sessions.");
+		return;
+	}
+	if (sched->workers) {
+		rtp_scheduler_worker_pool_destroy(sched->workers);
+		sched->workers = NULL;
+		sched->worker_count = 0;
+	}
+	if (count < 0) count = rtp_scheduler_get_cpu_count();
+	if (count > max_count) {
+		ortp_warning("RtpScheduler [%p]: using %i workers instead of %i", sched, max_count, count);
+		count = max_count;
+	}
+	sched->worker_count = count;
+	if (count > 0) {
+		ortp_message("RtpScheduler [%p]: scheduled sessions processed by %i workers", sched, count);
+		sched->workers = rtp_scheduler_worker_pool_new(sched, count);
+	}
+}
+
+/* with workers, the sessions are not in the scheduler list but in the shards of the workers */
+bool_t rtp_scheduler_has_sessions(RtpScheduler *sched) {
+	bool_t ret;
+	int i;
+	rtp_scheduler_lock(sched);
+	ret = sched->list != NULL;
+	for (i = 0; !ret && sched->workers && i < sched->workers->count; i++) {
+		ret = sched->workers->workers[i].session_count > 0;
+	}
+	rtp_scheduler_unlock(sched);
+	return ret;
+}
+
+void rtp_scheduler_start(RtpScheduler *sched) {
+	if (sched->thread_running == 0) {
+		sched->thread_running = 1;
+		if (sched->workers) rtp_scheduler_worker_pool_start(sched->workers);
+		ortp_mutex_lock(&sched->lock);
+		ortp_thread_create(&sched->thread, NULL, rtp_scheduler_schedule, (void *)sched);
+		ortp_cond_wait(&sched->unblock_select_cond, &sched->lock);
+		ortp_mutex_unlock(&sched->lock);
+	} else ortp_warning("Scheduler thread already running.");
+}
+void rtp_scheduler_stop(RtpScheduler *sched) {
+	if (sched->thread_running == 1) {
+		sched->thread_running = 0;
+		ortp_thread_join(sched->thread, NULL);
+		if (sched->workers) rtp_scheduler_worker_pool_stop(sched->workers);
+	} else ortp_warning("Scheduler thread is not running.");
+}
+
+void rtp_scheduler_destroy(RtpScheduler *sched) {
+	if (sched->thread_running) rtp_scheduler_stop(sched);
+	if (sched->workers) rtp_scheduler_worker_pool_destroy(sched->workers);
+	ortp_mutex_destroy(&sched->lock);
+	// g_mutex_free(sched->unblock_select_mutex);
+	ortp_cond_destroy(&sched->unblock_select_cond);
+	ortp_free(sched);
+}
+
+void *rtp_scheduler_schedule(void *psched) {
+	RtpScheduler *sched = (RtpScheduler *)psched;
+	RtpTimer *timer = sched->timer;
+	RtpSession *current;
+
+	/* take this lock to prevent the thread to start until g_thread_create() returns
+	    because we need sched->thread to be initialized */
+	ortp_mutex_lock(&sched->lock);
+	ortp_cond_signal(&sched->unblock_select_cond); /* unblock the starting thread */
+	ortp_mutex_unlock(&sched->lock);
+	timer->timer_init();
+	while (sched->thread_running) {
+		if (sched->workers) {
+			/* the workers process their shard without the scheduler lock */
+			rtp_scheduler_worker_pool_tick(sched->workers, sched->time_);
+			ortp_mutex_lock(&sched->lock);
+		} else {
+			/* do the processing here: */
+			ortp_mutex_lock(&sched->lock);
+
+			current = sched->list;
+			/* processing all scheduled rtp sessions */
+			while (current != NULL) {
+				ortp_debug("scheduler: processing session=0x%p.\n", current);
+				rtp_session_process(current, sched->time_, sched);
+				current = current->next;
+			}
+		}
+		/* wake up all the threads that are sleeping in _select()  */
+		ortp_cond_broadcast(&sched->unblock_select_cond);
+		ortp_mutex_unlock(&sched->lock);
+
+		/* now while the scheduler is going to sleep, the other threads can compute their
+		result mask and see if they have to leave, or to wait for next tick*/
+		// ortp_message("scheduler: sleeping.");
+		timer->timer_do();
+		sched->time_ += sched->timer_inc;
+	}
+	/* when leaving the thread, stop the timer */
+	timer->timer_uninit();
+	return NULL;
+}
+
+/* finds a free position in the session masks, preferably in the shard of the least loaded worker */
+static int rtp_scheduler_find_shard_position(RtpScheduler *sched) {
+	RtpSchedulerWorkerPool *pool = sched->workers;
+	int worker = 0;
+	int block, i;
+
+	for (i = 1; i < pool->count; i++) {
+		if (pool->workers[i].session_count < pool->workers[worker].session_count) worker = i;
+	}
+	for (block = worker; block * SCHEDULER_SHARD_BLOCK_SIZE < sched->max_sessions; block += pool->count) {
+		for (i = block * SCHEDULER_SHARD_BLOCK_SIZE; i < (block + 1) * SCHEDULER_SHARD_BLOCK_SIZE; i++) {
+			if (!ORTP_FD_ISSET(i, &sched->all_sessions.rtpset)) return i;
+		}
+	}
+	/* the shard is full, use any other one */
+	for (i = 0; i < sched->max_sessions; i++) {
+		if (!ORTP_FD_ISSET(i, &sched->all_sessions.rtpset)) return i;
+	}
+	return -1;
+}
+
+static RtpSchedulerWorker *rtp_scheduler_get_session_worker(RtpScheduler *sched, RtpSession *session) {
+	return &sched->workers->workers[(session->mask_pos / SCHEDULER_SHARD_BLOCK_SIZE) % sched->workers->count];
+}
+
+static void rtp_scheduler_add_session_to_worker(RtpScheduler *sched, RtpSession *session) {
+	RtpSchedulerRequest *req;
+	RtpSchedulerWorker *w;
+	int pos;
+
+	rtp_scheduler_lock(sched);
+	pos = rtp_scheduler_find_shard_position(sched);
+	if (pos == -1) {
+		rtp_scheduler_unlock(sched);
+		ortp_error("rtp_scheduler_add_session: no room for session [%p], %i sessions already scheduled.", session,
+		           sched->max_sessions);
+		return;
+	}
+	session->mask_pos = pos;
+	session_set_set(&sched->all_sessions, session);
+	/* make a new session scheduled not blockable if it has not started*/
+	if (session->flags & RTP_SESSION_RECV_NOT_STARTED) session_set_set(&sched->r_sessions, session);
+	if (session->flags & RTP_SESSION_SEND_NOT_STARTED) session_set_set(&sched->w_sessions, session);
+	if (pos > sched->all_max) sched->all_max = pos;
+	w = rtp_scheduler_get_session_worker(sched, session);
+	w->session_count++;
+	rtp_session_set_flag(session, RTP_SESSION_IN_SCHEDULER);
+	rtp_scheduler_unlock(sched);
+
+	req = ortp_new0(RtpSchedulerRequest, 1);
+	req->session = session;
+	req->add = true;
+	rtp_scheduler_worker_push_request(w, req);
+	ortp_mutex_lock(&w->lock);
+	ortp_cond_signal(&w->cond);
+	ortp_mutex_unlock(&w->lock);
+}
+
+static void rtp_scheduler_remove_session_from_worker(RtpScheduler *sched, RtpSession *session) {
+	RtpSchedulerWorker *w = rtp_scheduler_get_session_worker(sched, session);
+	RtpSchedulerRequest req = {NULL, session, false, false};
+
+	/* when the worker runs, it may be processing the session: wait until it has applied the removal */
+	rtp_scheduler_worker_push_request(w, &req);
+	ortp_mutex_lock(&w->lock);
+	if (w->alive) {
+		ortp_cond_signal(&w->cond);
+		while (!req.done)
+			ortp_cond_wait(&w->removed_cond, &w->lock);
+	} else {
+		rtp_scheduler_worker_complete_removals(w, rtp_scheduler_worker_apply_requests(w));
+	}
+	ortp_mutex_unlock(&w->lock);
+
+	rtp_scheduler_lock(sched);
+	w->session_count--;
+	rtp_session_unset_flag(session, RTP_SESSION_IN_SCHEDULER);
+	/* delete the bit in the mask */
+	session_set_clr(&sched->all_sessions, session);
+	rtp_scheduler_unlock(sched);
+}
+
+void rtp_scheduler_add_session(RtpScheduler *sched, RtpSession *session) {
+	RtpSession *oldfirst;
+	int i;
+	if (session->flags & RTP_SESSION_IN_SCHEDULER) {
+		/* the rtp session is already scheduled, so return silently */
+		return;
+	}
+	if (sched->workers) {
+		rtp_scheduler_add_session_to_worker(sched, session);
+		return;
+	}
+	rtp_scheduler_lock(sched);
+	/* enqueue the session to the list of scheduled sessions */
+	oldfirst = sched->list;
+	sched->list = session;
+	session->next = oldfirst;
+	if (sched->max_sessions == 0) {
+		ortp_error("rtp_scheduler_add_session: max_session=0 !");
+	}
+	/* find a free pos in the session mask*/
+	for (i = 0; i < sched->max_sessions; i++) {
+		if (!ORTP_FD_ISSET(i, &sched->all_sessions.rtpset)) {
+			session->mask_pos = i;
+			session_set_set(&sched->all_sessions, session);
+			/* make a new session scheduled not blockable if it has not started*/
+			if (session->flags & RTP_SESSION_RECV_NOT_STARTED) session_set_set(&sched->r_sessions, session);
+			if (session->flags & RTP_SESSION_SEND_NOT_STARTED) session_set_set(&sched->w_sessions, session);
+			if (i > sched->all_max) {
+				sched->all_max = i;
+			}
+			break;
+		}
+	}
+
+	rtp_session_set_flag(session, RTP_SESSION_IN_SCHEDULER);
+	rtp_scheduler_unlock(sched);
+}
+
+void rtp_scheduler_remove_session(RtpScheduler *sched, RtpSession *session) {
+	RtpSession *tmp;
+	int cond = 1;
+	return_if_fail(session != NULL);
+	if (!(session->flags & RTP_SESSION_IN_SCHEDULER)) {
+		/* the rtp session is not scheduled, so return silently */
+		return;
+	}
+	if (sched->workers) {
+		rtp_scheduler_remove_session_from_worker(sched, session);
+		return;
+	}
+
+	rtp_scheduler_lock(sched);
+	tmp = sched->list;
+	if (tmp == session) {
+		sched->list = tmp->next;
+		rtp_session_unset_flag(session, RTP_SESSION_IN_SCHEDULER);
+		session_set_clr(&sched->all_sessions, session);
+		rtp_scheduler_unlock(sched);
+		return;
+	}
+	/* go the position of session in the list */
+	while (cond) {
+		if (tmp != NULL) {
+			if (tmp->next == session) {
+				tmp->next = tmp->next->next;
+				cond = 0;
+			} else tmp = tmp->next;
+		} else {
+			/* the session was not found ! */
+			ortp_warning("rtp_scheduler_remove_session: the session was not found in the scheduler list!");
+			cond = 0;
+		}
+	}
+	rtp_session_unset_flag(session, RTP_SESSION_IN_SCHEDULER);
+	/* delete the bit in the mask */
+	session_set_clr(&sched->all_sessions, session);
+	rtp_scheduler_unlock(sched);
+}
@@ -25,6 +25,12 @@
 #include "ortp/sessionset.h"
 #include "rtptimer.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _RtpSchedulerWorkerPool;
+
 struct _RtpScheduler {
 
 	RtpSession *list;        /* list of scheduled sessions*/
@@ -45,12 +51,16 @@ struct _RtpScheduler {
 	struct _RtpTimer *timer;
 	uint32_t time_;     /*number of miliseconds elapsed since the start of the thread */
 	uint32_t timer_inc; /* the timer increment in milisec */
+	int worker_count;   /* when not zero, the sessions are processed by this number of worker threads */
+	struct _RtpSchedulerWorkerPool *workers;
 };
 
 typedef struct _RtpScheduler RtpScheduler;
 
 RtpScheduler *rtp_scheduler_new(void);
 void rtp_scheduler_set_timer(RtpScheduler *sched, RtpTimer *timer);
+void rtp_scheduler_set_worker_count(RtpScheduler *sched, int count);
+bool_t rtp_scheduler_has_sessions(RtpScheduler *sched);
 void rtp_scheduler_start(RtpScheduler *sched);
 void rtp_scheduler_stop(RtpScheduler *sched);
 void rtp_scheduler_destroy(RtpScheduler *sched);
@@ -66,4 +76,9 @@ void *rtp_scheduler_schedule(void *sched);
 /* void rtp_scheduler_add_set(RtpScheduler *sched, SessionSet *set); */
 
 ORTP_PUBLIC RtpScheduler *ortp_get_scheduler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
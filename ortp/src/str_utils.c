@@ -60,7 +60,7 @@ mblk_t *allocb(size_t size, BCTBX_UNUSED(int pri)) {
 	mblk_t *mp;
 	dblk_t *datab;
 
-	mp = (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+	mp = ortp_mblk_alloc();
 	datab = dblk_alloc(size);
 
 	mp->b_datap = datab;
@@ -73,7 +73,7 @@ mblk_t *esballoc(uint8_t *buf, size_t size, BCTBX_UNUSED(int pri), void (*freefn
 	mblk_t *mp;
 	dblk_t *datab;
 
-	mp = (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+	mp = ortp_mblk_alloc();
 	datab = dblk_alloc2(buf, size, freefn);
 
 	mp->b_datap = datab;
@@ -87,7 +87,7 @@ void freeb(mblk_t *mp) {
 	return_if_fail(mp->b_datap->db_base != NULL);
 
 	dblk_unref(mp->b_datap);
-	ortp_free(mp);
+	ortp_mblk_free(mp);
 }
 
 void freemsg(mblk_t *mp) {
@@ -106,7 +106,7 @@ mblk_t *dupb(mblk_t *mp) {
 	return_val_if_fail(mp->b_datap->db_base != NULL, NULL);
 
 	dblk_ref(mp->b_datap);
-	newm = (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+	newm = ortp_mblk_alloc();
 	mblk_meta_copy(mp, newm);
 	newm->b_datap = mp->b_datap;
 	newm->b_rptr = mp->b_rptr;
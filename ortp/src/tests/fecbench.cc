@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* this program measures the cost of the flexible FEC encoding and decoding for several (L, D) parameter sets:
+    the time to protect a source packet, and the time to recover a source packet lost in a FEC block. */
+
+#include <bctoolbox/port.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "fecstream/fec-encoder.h"
+#include "fecstream/receive-cluster.h"
+#include <ortp/ortp.h>
+
+using namespace ortp;
+
+static const char *help = "usage: fecbench [block_count] [payload_size]\n";
+
+struct FecBenchParams {
+	uint8_t L;
+	uint8_t D;
+	bool is2D;
+};
+
+static uint64_t get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static mblk_t *make_source_packet(RtpSession *session, uint16_t seqnum, uint32_t timestamp, size_t payloadSize) {
+	mblk_t *packet = rtp_session_create_packet_header(session, payloadSize);
+	for (size_t i = 0; i < payloadSize; i++) {
+		packet->b_wptr[i] = (uint8_t)(seqnum * 31 + i);
+	}
+	packet->b_wptr += payloadSize;
+	rtp_set_seqnumber(packet, seqnum);
+	rtp_set_timestamp(packet, timestamp);
+	return packet;
+}
+
+static void run_bench(RtpSession *session, const FecBenchParams &p, int blockCount, size_t payloadSize) {
+	int rows = (p.D > 1) ? p.D : 1;
+	int blockSize = p.L * rows;
+	FecParamsController params((uint32_t)blockSize * 100 * 4);
+	FecEncoder encoder(&params);
+	ReceiveCluster cluster(session, params.getRepairWindow());
+	uint64_t encodeUs = 0, decodeUs = 0;
+	int repaired = 0;
+	uint16_t seqnum = 0;
+	uint16_t repairSeqnum = 0;
+	uint32_t timestamp = 0;
+
+	encoder.init(session, session);
+	encoder.update(p.L, p.D, p.is2D);
+
+	for (int b = 0; b < blockCount; b++) {
+		std::vector<mblk_t *> sources;
+		std::vector<mblk_t *> repairs;
+		uint16_t base = seqnum;
+		uint16_t lost = (uint16_t)(base + b % blockSize);
+		uint64_t start;
+
+		for (int i = 0; i < blockSize; i++) {
+			/* the sequence numbers wrap around, not the timestamps */
+			sources.push_back(make_source_packet(session, seqnum++, timestamp, payloadSize));
+			timestamp += 100;
+		}
+
+		/* same sequence of calls as FecStreamCxx::onNewSourcePacketSent() */
+		start = get_time_us();
+		encoder.reset(base);
+		for (mblk_t *source : sources) {
+			FecSourcePacket packet(source);
+			encoder.add(packet);
+			packet.transfer();
+			if (encoder.isRowFull()) repairs.push_back(encoder.getRowRepairMblk(encoder.getCurrentRow()));
+			if (encoder.isColFull()) repairs.push_back(encoder.getColRepairMblk(encoder.getCurrentColumn()));
+		}
+		encodeUs += get_time_us() - start;
+
+		for (mblk_t *repair : repairs) {
+			rtp_set_seqnumber(repair, repairSeqnum++);
+			rtp_set_timestamp(repair, timestamp - 100);
+		}
+
+		start = get_time_us();
+		for (mblk_t *repair : repairs) {
+			cluster.add(std::make_shared<FecRepairPacket>(repair));
+		}
+		for (mblk_t *source : sources) {
+			if (rtp_get_seqnumber(source) != lost) cluster.add(copymsg(source));
+		}
+		cluster.repair(lost);
+		if (cluster.getSourcePacket(lost)) repaired++;
+		decodeUs += get_time_us() - start;
+
+		for (mblk_t *source : sources)
+			freemsg(source);
+		for (mblk_t *repair : repairs)
+			freemsg(repair);
+	}
+
+	printf("L=%-3i D=%-3i %-3s  encode: %8.3f us/source packet  decode: %8.3f us/block (%i/%i repaired)\n", p.L, p.D,
+	       p.is2D ? "2D" : "1D", (double)encodeUs / ((double)blockCount * blockSize), (double)decodeUs / blockCount,
+	       repaired, blockCount);
+}
+
+int main(int argc, char *argv[]) {
+	int blockCount = 2000;
+	int payloadSize = 1200;
+	const FecBenchParams paramSets[] = {{5, 0, false},  {10, 0, false}, {20, 0, false}, {5, 5, false},
+	                                    {10, 10, false}, {5, 5, true},  {10, 10, true}, {20, 10, true}};
+
+	if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+		printf("%s", help);
+		return 0;
+	}
+	if (argc > 1) blockCount = atoi(argv[1]);
+	if (argc > 2) payloadSize = atoi(argv[2]);
+	if (blockCount <= 0 || payloadSize <= 0) {
+		printf("%s", help);
+		return -1;
+	}
+
+	ortp_init();
+	ortp_set_log_level_mask(NULL, ORTP_FATAL);
+	RtpSession *session = rtp_session_new(RTP_SESSION_SENDRECV);
+	for (const auto &p : paramSets) {
+		run_bench(session, p, blockCount, (size_t)payloadSize);
+	}
+	rtp_session_destroy(session);
+	ortp_exit();
+	return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* this program measures the receive throughput (packets/s) of a RtpSession on loopback,
+    with one datagram per system call and with batched reception. */
+
+#include <bctoolbox/port.h>
+#include <ortp/ortp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *help = "usage: rtprecvbench [packet_count] [batch_size] [burst_size]\n";
+
+typedef struct _BenchResult {
+	int received;
+	uint64_t elapsed_us;
+} BenchResult;
+
+static uint64_t get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static BenchResult run_bench(int packet_count, int batch_size, int burst_size) {
+	BenchResult result = {0};
+	RtpSession *sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	RtpSession *receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	uint8_t payload[160] = {0};
+	uint32_t send_ts = 0;
+	uint32_t recv_ts = 0;
+
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+	rtp_session_enable_rtcp(receiver, FALSE);
+	rtp_session_set_rtp_socket_recv_buffer_size(receiver, 4 * 1024 * 1024);
+	rtp_session_set_recv_batch_size(receiver, batch_size);
+	rtp_session_set_remote_addr(sender, "127.0.0.1", rtp_session_get_local_port(receiver));
+
+	while (result.received < packet_count) {
+		uint64_t start;
+		mblk_t *m;
+		int i;
+
+		/* fill the socket buffer, then time how long it takes to drain it */
+		for (i = 0; i < burst_size; i++) {
+			rtp_session_send_with_ts(sender, payload, sizeof(payload), send_ts);
+			send_ts += 160;
+		}
+		/* like a media ticker, use a single timestamp per burst: the sockets are only read by the first call */
+		recv_ts += 160;
+		start = get_time_us();
+		while ((m = rtp_session_recvm_with_ts(receiver, recv_ts)) != NULL) {
+			freemsg(m);
+			result.received++;
+		}
+		result.elapsed_us += get_time_us() - start;
+	}
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+	return result;
+}
+
+static void print_result(const char *name, BenchResult result) {
+	double pps = result.elapsed_us ? (double)result.received * 1000000.0 / (double)result.elapsed_us : 0;
+	printf("%-24s %10i packets in %10llu us: %12.0f packets/s\n", name, result.received,
+	       (unsigned long long)result.elapsed_us, pps);
+}
+
+int main(int argc, char *argv[]) {
+	int packet_count = 200000;
+	int batch_size = 32;
+	int burst_size = 128;
+	BenchResult single, batched;
+	char name[64];
+
+	if (argc > 1 && strcmp(argv[1], "--help") == 0) {
+		printf("%s", help);
+		return 0;
+	}
+	if (argc > 1) packet_count = atoi(argv[1]);
+	if (argc > 2) batch_size = atoi(argv[2]);
+	if (argc > 3) burst_size = atoi(argv[3]);
+	if (packet_count <= 0 || batch_size <= 0 || burst_size <= 0) {
+		printf("%s", help);
+		return -1;
+	}
+
+	ortp_init();
+	ortp_set_log_level_mask(NULL, ORTP_FATAL);
+
+	single = run_bench(packet_count, 1, burst_size);
+	batched = run_bench(packet_count, batch_size, burst_size);
+
+	print_result("recvmsg", single);
+	snprintf(name, sizeof(name), "recvmmsg (batch=%i)", batch_size);
+	print_result(name, batched);
+	if (single.elapsed_us && batched.elapsed_us)
+		printf("speedup: %.2fx\n",
+		       (double)single.elapsed_us * batched.received / (batched.elapsed_us * single.received));
+
+	ortp_exit();
+	return 0;
+}
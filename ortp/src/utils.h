@@ -85,6 +85,10 @@ void rtcp_sdes_items_uninit(RtcpSdesItems *items);
 
 bool_t _rtcp_next_packet(mblk_t *m);
 
+/* mblk_t allocation from the pool of dblk.cc, the returned mblk_t is zeroed */
+mblk_t *ortp_mblk_alloc(void);
+void ortp_mblk_free(mblk_t *mp);
+
 #ifdef __cplusplus
 }
 #endif
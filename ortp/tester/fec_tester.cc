@@ -381,6 +381,24 @@ static void source_packet_add_payload_test3(void) {
 	rtp_session_destroy(session);
 }
 
+static void xor_test(void) {
+	uint8_t src[300], dst[300], ref[300];
+	for (size_t i = 0; i < sizeof(src); i++) {
+		src[i] = static_cast<uint8_t>(i * 7 + 3);
+		dst[i] = static_cast<uint8_t>(i * 13 + 1);
+	}
+	// unaligned buffers and sizes that aren't multiple of the vector width
+	for (size_t offset = 0; offset < 3; offset++) {
+		for (size_t size : {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 150, 290}) {
+			memcpy(ref, dst, sizeof(dst));
+			for (size_t i = 0; i < size; i++)
+				ref[offset + i] ^= src[i];
+			fecXor(dst + offset, src, size);
+			BC_ASSERT_EQUAL(memcmp(dst, ref, sizeof(dst)), 0, int, "%d");
+		}
+	}
+}
+
 static void repair_packet_bitstring_test(void) {
 
 	RtpSession *session = rtp_session_new(RTP_SESSION_SENDRECV);
@@ -1153,6 +1171,31 @@ static void graph_repair_node_test(void) {
 	}
 }
 
+static void seqnum_map_test(void) {
+	SeqnumMap<int> map(4);
+	BC_ASSERT_TRUE(map.empty());
+	BC_ASSERT_TRUE(map.emplace(10, 100));
+	BC_ASSERT_FALSE(map.emplace(10, 101));
+	BC_ASSERT_EQUAL(map.at(10), 100, int, "%d");
+	// 14, 1034 and 65530 would share a slot with 10 in a small map
+	BC_ASSERT_TRUE(map.emplace(14, 140));
+	BC_ASSERT_TRUE(map.emplace(1034, 1034));
+	BC_ASSERT_TRUE(map.emplace(65530, -6));
+	BC_ASSERT_EQUAL(map.size(), 4, size_t, "%zu");
+	BC_ASSERT_EQUAL(map.at(10), 100, int, "%d");
+	BC_ASSERT_EQUAL(map.at(14), 140, int, "%d");
+	BC_ASSERT_EQUAL(map.at(1034), 1034, int, "%d");
+	BC_ASSERT_EQUAL(map.at(65530), -6, int, "%d");
+	BC_ASSERT_PTR_NULL(map.find(11));
+	BC_ASSERT_EQUAL(map.count(65530), 1, size_t, "%zu");
+	BC_ASSERT_EQUAL(map.erase(1034), 1, size_t, "%zu");
+	BC_ASSERT_EQUAL(map.erase(1034), 0, size_t, "%zu");
+	BC_ASSERT_EQUAL(map.count(1034), 0, size_t, "%zu");
+	map.clear();
+	BC_ASSERT_TRUE(map.empty());
+	BC_ASSERT_PTR_NULL(map.find(10));
+}
+
 static void graph_packet_connection_test(void) {
 	FecPacketsConnection packetConnection;
 
@@ -1686,6 +1729,7 @@ static test_t tests[] = {
     TEST_NO_TAG("source_packet_add_payload same size", source_packet_add_payload_test1),
     TEST_NO_TAG("source_packet_add_payload bigger", source_packet_add_payload_test2),
     TEST_NO_TAG("source_packet_add_payload smaller", source_packet_add_payload_test3),
+    TEST_NO_TAG("xor", xor_test),
     TEST_NO_TAG("repair_packet_bitstring", repair_packet_bitstring_test),
     TEST_NO_TAG("repair_packet_add Payload", repair_packet_add_payload1),
     TEST_NO_TAG("repair packet seqnum list non interleaved", repair_packet_seqnumListNonInterleaved_test),
@@ -1707,6 +1751,7 @@ static test_t tests[] = {
 
     TEST_NO_TAG("graph source node", graph_source_node_test),
     TEST_NO_TAG("graph repair node", graph_repair_node_test),
+    TEST_NO_TAG("seqnum map", seqnum_map_test),
     TEST_NO_TAG("graph packet connection", graph_packet_connection_test),
 
     TEST_NO_TAG("receive cluster add source", receive_cluster_add_source_test),
@@ -320,8 +320,443 @@ static void change_remote_address(void) {
 	rtp_session_destroy(flore);
 }
 
+static void batched_reception(void) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	mblk_t *received_packet;
+	uint8_t payload[160] = {0};
+	uint32_t user_ts = 0;
+	uint32_t recv_ts = 0;
+	const int packet_count = 50;
+	int received = 0;
+	int cpt = 0;
+	int i;
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+	rtp_session_set_pktinfo(receiver, TRUE);
+	rtp_session_set_recv_batch_size(receiver, 16);
+	BC_ASSERT_EQUAL(rtp_session_get_recv_batch_size(receiver), 16, int, "%d");
+
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+
+	for (i = 0; i < packet_count; i++) {
+		mblk_t *packet = rtp_session_create_packet_header(sender, sizeof(payload));
+		payload[0] = (uint8_t)i;
+		memcpy(packet->b_wptr, payload, sizeof(payload));
+		packet->b_wptr += sizeof(payload);
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(sender, packet, user_ts), 0, int, "%d");
+		user_ts += 160;
+	}
+
+	while (received < packet_count && cpt < 100) {
+		/* the sockets are not read twice for a same timestamp */
+		received_packet = rtp_session_recvm_with_ts(receiver, recv_ts++);
+		if (received_packet == NULL) {
+			bctbx_sleep_ms(1);
+			cpt++;
+			continue;
+		}
+		/* packets come out of the batch in the order they were received, with their ancillary data */
+		BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE], (uint8_t)received, int, "%d");
+		BC_ASSERT_EQUAL(received_packet->recv_addr.family, AF_INET, int, "%d");
+		BC_ASSERT_NOT_EQUAL((int)received_packet->timestamp.tv_sec, 0, int, "%d");
+		freemsg(received_packet);
+		received++;
+	}
+	BC_ASSERT_EQUAL(received, packet_count, int, "%d");
+	/* all the packets were sent before the first read: a single recvmmsg() call must have returned several of them */
+	BC_ASSERT_GREATER(rtp_session_get_recv_batch_max_count(receiver), 1, int, "%d");
+	BC_ASSERT_LOWER(rtp_session_get_recv_batch_max_count(receiver), 16, int, "%d");
+
+	/* back to one datagram per system call */
+	rtp_session_set_recv_batch_size(receiver, 0);
+	BC_ASSERT_EQUAL(rtp_session_get_recv_batch_size(receiver), 1, int, "%d");
+	received_packet = rtp_session_create_packet_header(sender, sizeof(payload));
+	memcpy(received_packet->b_wptr, payload, sizeof(payload));
+	received_packet->b_wptr += sizeof(payload);
+	rtp_session_sendm_with_ts(sender, received_packet, user_ts);
+	for (cpt = 0, received_packet = NULL; received_packet == NULL && cpt < 10; cpt++) {
+		bctbx_sleep_ms(1);
+		received_packet = rtp_session_recvm_with_ts(receiver, recv_ts++);
+	}
+	BC_ASSERT_PTR_NOT_NULL(received_packet);
+	if (received_packet) freemsg(received_packet);
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+}
+
+static int receive_all(RtpSession *receiver, uint32_t *recv_ts, int packet_count, int last_size) {
+	mblk_t *received_packet;
+	int received = 0;
+	int cpt = 0;
+
+	while (received < packet_count && cpt < 100) {
+		received_packet = rtp_session_recvm_with_ts(receiver, (*recv_ts)++);
+		if (received_packet == NULL) {
+			bctbx_sleep_ms(1);
+			cpt++;
+			continue;
+		}
+		BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE], (uint8_t)received, int, "%d");
+		if (received == packet_count - 1) {
+			BC_ASSERT_EQUAL((int)msgdsize(received_packet), RTP_FIXED_HEADER_SIZE + last_size, int, "%d");
+		}
+		freemsg(received_packet);
+		received++;
+	}
+	return received;
+}
+
+static void batched_sending(void) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	RtpSession *aux_receiver;
+	mblk_t *received_packet;
+	uint8_t payload[160] = {0};
+	uint32_t user_ts = 0;
+	uint32_t recv_ts = 0;
+	uint32_t aux_recv_ts = 0;
+	const int packet_count = 20; /* twice as many packets are queued with the auxiliary destination */
+	int i;
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+	rtp_session_enable_send_batching(sender, TRUE);
+#ifndef __linux__
+	if (!rtp_session_send_batching_enabled(sender)) {
+		rtp_session_destroy(sender);
+		return;
+	}
+#endif
+	BC_ASSERT_TRUE(rtp_session_send_batching_enabled(sender));
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+
+	aux_receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(aux_receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(aux_receiver, 0);
+	rtp_session_enable_jitter_buffer(aux_receiver, FALSE);
+
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+	rtp_session_add_aux_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(aux_receiver), "127.0.0.1",
+	                                     rtp_session_get_local_rtcp_port(aux_receiver));
+
+	/* packets of the same size, then a shorter one: these can be sent as segments of a single datagram */
+	for (i = 0; i < packet_count; i++) {
+		int size = (i == packet_count - 1) ? 80 : (int)sizeof(payload);
+		mblk_t *packet = rtp_session_create_packet_header(sender, size);
+		payload[0] = (uint8_t)i;
+		memcpy(packet->b_wptr, payload, size);
+		packet->b_wptr += size;
+		BC_ASSERT_EQUAL(rtp_session_sendm_with_ts(sender, packet, user_ts), RTP_FIXED_HEADER_SIZE + size, int, "%d");
+		user_ts += 160;
+	}
+
+	/* nothing leaves until the batch is flushed */
+	bctbx_sleep_ms(10);
+	received_packet = rtp_session_recvm_with_ts(receiver, recv_ts++);
+	BC_ASSERT_PTR_NULL(received_packet);
+	if (received_packet) freemsg(received_packet);
+
+	rtp_session_flush_send_batch(sender);
+	BC_ASSERT_EQUAL(receive_all(receiver, &recv_ts, packet_count, 80), packet_count, int, "%d");
+	BC_ASSERT_EQUAL(receive_all(aux_receiver, &aux_recv_ts, packet_count, 80), packet_count, int, "%d");
+
+	/* disabling batching sends what is still queued */
+	received_packet = rtp_session_create_packet_header(sender, sizeof(payload));
+	payload[0] = 0;
+	memcpy(received_packet->b_wptr, payload, sizeof(payload));
+	received_packet->b_wptr += sizeof(payload);
+	rtp_session_sendm_with_ts(sender, received_packet, user_ts);
+	rtp_session_enable_send_batching(sender, FALSE);
+	BC_ASSERT_FALSE(rtp_session_send_batching_enabled(sender));
+	BC_ASSERT_EQUAL(receive_all(receiver, &recv_ts, 1, sizeof(payload)), 1, int, "%d");
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+	rtp_session_destroy(aux_receiver);
+}
+
+static void send_same_size_packets(RtpSession *sender, uint32_t *user_ts, int packet_count) {
+	uint8_t payload[160] = {0};
+	int i;
+	for (i = 0; i < packet_count; i++) {
+		int size = (i == packet_count - 1) ? 80 : (int)sizeof(payload);
+		mblk_t *packet = rtp_session_create_packet_header(sender, size);
+		payload[0] = (uint8_t)i;
+		memcpy(packet->b_wptr, payload, size);
+		packet->b_wptr += size;
+		rtp_session_sendm_with_ts(sender, packet, *user_ts);
+		*user_ts += 160;
+	}
+}
+
+static void batched_sending_segments(void) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	uint32_t user_ts = 0;
+	uint32_t recv_ts = 0;
+	const int packet_count = 20;
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+	rtp_session_enable_send_batching(sender, TRUE);
+	if (!rtp_session_send_batching_enabled(sender)) {
+		rtp_session_destroy(sender);
+		return;
+	}
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+
+	/* a single destination and a single size: the packets are the segments of one datagram when GSO is available */
+	send_same_size_packets(sender, &user_ts, packet_count);
+	rtp_session_flush_send_batch(sender);
+	BC_ASSERT_EQUAL(receive_all(receiver, &recv_ts, packet_count, 80), packet_count, int, "%d");
+#ifdef __linux__
+	BC_ASSERT_EQUAL(rtp_session_get_send_batch_max_segments(sender), packet_count, int, "%d");
+
+	/* the kernel refuses segmentation offload on a socket without UDP checksums: the packets are sent one by one */
+	{
+		int no_check = 1;
+		rtp_session_reset_send_batch_max_segments(sender);
+		BC_ASSERT_EQUAL(setsockopt(sender->rtp.gs.socket, SOL_SOCKET, SO_NO_CHECK, &no_check, sizeof(no_check)), 0,
+		                int, "%d");
+		send_same_size_packets(sender, &user_ts, packet_count);
+		rtp_session_flush_send_batch(sender);
+		BC_ASSERT_EQUAL(receive_all(receiver, &recv_ts, packet_count, 80), packet_count, int, "%d");
+		BC_ASSERT_EQUAL(rtp_session_get_send_batch_max_segments(sender), 0, int, "%d");
+
+		/* segmentation stays disabled for the next flushes */
+		send_same_size_packets(sender, &user_ts, packet_count);
+		rtp_session_flush_send_batch(sender);
+		BC_ASSERT_EQUAL(receive_all(receiver, &recv_ts, packet_count, 80), packet_count, int, "%d");
+		BC_ASSERT_EQUAL(rtp_session_get_send_batch_max_segments(sender), 1, int, "%d");
+	}
+#endif
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+}
+
+static int external_buffer_freed = 0;
+
+static void free_external_buffer(void *buf) {
+	ortp_free(buf);
+	external_buffer_freed++;
+}
+
+static void mblk_pool(void) {
+	ortp_mblk_pool_stats_t before, after;
+	mblk_t *m, *dup, *large;
+	int i;
+
+	/* warm up the pool */
+	m = allocb(160, 0);
+	freeb(m);
+	ortp_mblk_pool_get_stats(&before);
+	for (i = 0; i < 100; i++) {
+		m = allocb(160, 0);
+		dup = dupb(m);
+		BC_ASSERT_EQUAL(dblk_ref_value(m->b_datap), 2, int, "%d");
+		BC_ASSERT_PTR_EQUAL(m->b_cont, NULL);
+		BC_ASSERT_EQUAL((int)(m->b_datap->db_lim - m->b_datap->db_base), 160, int, "%d");
+		memset(m->b_wptr, i, 160);
+		m->b_wptr += 160;
+		freeb(m);
+		BC_ASSERT_EQUAL(dblk_ref_value(dup->b_datap), 1, int, "%d");
+		BC_ASSERT_EQUAL(dup->b_rptr[159], i, int, "%d");
+		freeb(dup);
+	}
+	ortp_mblk_pool_get_stats(&after);
+	/* recycled blocks only: 2 mblk_t and 1 data block per iteration */
+	BC_ASSERT_EQUAL((int)(after.misses - before.misses), 0, int, "%d");
+	BC_ASSERT_EQUAL((int)(after.hits - before.hits), 300, int, "%d");
+	BC_ASSERT_TRUE(after.high_water >= after.allocated_blocks);
+
+	/* blocks too large for the pool and external buffers */
+	large = allocb(100000, 0);
+	memset(large->b_wptr, 0, 100000);
+	freeb(large);
+	m = esballoc(ortp_malloc(10), 10, 0, free_external_buffer);
+	freeb(m);
+	BC_ASSERT_EQUAL(external_buffer_freed, 1, int, "%d");
+
+	ortp_mblk_pool_trim();
+	ortp_mblk_pool_get_stats(&after);
+	BC_ASSERT_TRUE(after.allocated_blocks < before.allocated_blocks);
+}
+
+static void sharded_scheduler(void) {
+	RtpSession *senders[8];
+	RtpSession *receivers[8];
+	RtpSession *extra_sessions[200];
+	uint8_t payload[160] = {0};
+	uint32_t recv_ts;
+	const int session_count = 8;
+	const int packet_count = 10;
+	uint64_t start;
+	int i, j;
+
+	/* the scheduler, started without workers, is restarted with them as no session is scheduled yet */
+	ortp_scheduler_init();
+	ortp_scheduler_init_with_workers(4);
+	BC_ASSERT_EQUAL(ortp_scheduler_get_worker_count(), 4, int, "%d");
+
+	for (i = 0; i < session_count; i++) {
+		receivers[i] = rtp_session_new(RTP_SESSION_RECVONLY);
+		rtp_session_set_local_addr(receivers[i], "127.0.0.1", -1, -1);
+		rtp_session_set_payload_type(receivers[i], 0);
+		rtp_session_enable_jitter_buffer(receivers[i], FALSE);
+
+		senders[i] = rtp_session_new(RTP_SESSION_SENDONLY);
+		rtp_session_set_local_addr(senders[i], "127.0.0.1", -1, -1);
+		rtp_session_set_payload_type(senders[i], 0);
+		rtp_session_set_blocking_mode(senders[i], TRUE);
+		rtp_session_set_remote_addr(senders[i], "127.0.0.1", rtp_session_get_local_port(receivers[i]));
+	}
+
+	/* sessions added and removed while the others are processed */
+	for (i = 0; i < 200; i++) {
+		extra_sessions[i] = rtp_session_new(RTP_SESSION_SENDRECV);
+		rtp_session_set_scheduling_mode(extra_sessions[i], TRUE);
+	}
+	/* the sessions are in the shards of the workers, which are kept */
+	ortp_scheduler_init_with_workers(2);
+	BC_ASSERT_EQUAL(ortp_scheduler_get_worker_count(), 4, int, "%d");
+
+	/* packets of 20 ms: the sending of a packet is blocked until the scheduler time reaches it */
+	start = bctbx_get_cur_time_ms();
+	for (j = 0; j < packet_count; j++) {
+		payload[0] = (uint8_t)j;
+		for (i = 0; i < session_count; i++) {
+			BC_ASSERT_EQUAL(rtp_session_send_with_ts(senders[i], payload, sizeof(payload), j * 160),
+			                RTP_FIXED_HEADER_SIZE + (int)sizeof(payload), int, "%d");
+		}
+		if (j == packet_count / 2) {
+			for (i = 0; i < 200; i++)
+				rtp_session_destroy(extra_sessions[i]);
+		}
+	}
+	BC_ASSERT_GREATER((int)(bctbx_get_cur_time_ms() - start), (packet_count - 2) * 20, int, "%d");
+
+	for (i = 0; i < session_count; i++) {
+		recv_ts = 0;
+		BC_ASSERT_EQUAL(receive_all(receivers[i], &recv_ts, packet_count, sizeof(payload)), packet_count, int, "%d");
+		rtp_session_destroy(senders[i]);
+		rtp_session_destroy(receivers[i]);
+	}
+}
+
+static void send_packet_with_seq(RtpSession *sender, uint16_t seq) {
+	uint8_t payload[160] = {0};
+	mblk_t *packet = rtp_session_create_packet_header(sender, sizeof(payload));
+	payload[0] = (uint8_t)seq;
+	memcpy(packet->b_wptr, payload, sizeof(payload));
+	packet->b_wptr += sizeof(payload);
+	rtp_set_seqnumber(packet, seq);
+	BC_ASSERT_GREATER(rtp_session_sendm_with_ts(sender, packet, (uint32_t)seq * 160), 0, int, "%d");
+}
+
+static uint16_t receive_seq(RtpSession *receiver, uint32_t *recv_ts) {
+	mblk_t *received_packet = NULL;
+	uint16_t seq = 0;
+	int cpt;
+	for (cpt = 0; received_packet == NULL && cpt < 100; cpt++) {
+		received_packet = rtp_session_recvm_with_ts(receiver, (*recv_ts)++);
+		if (received_packet == NULL) bctbx_sleep_ms(1);
+	}
+	if (!BC_ASSERT_PTR_NOT_NULL(received_packet)) return 0;
+	seq = rtp_get_seqnumber(received_packet);
+	BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE], (uint8_t)seq, int, "%d");
+	freemsg(received_packet);
+	return seq;
+}
+
+static void reordered_reception(void) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	mblk_t *picked;
+	uint32_t recv_ts = 0;
+	const uint16_t packet_count = 40;
+	uint16_t seq;
+	int duplicates = 0;
+	int i;
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+
+	/* the first packet, then the following ones by blocks of eight in reverse order, with some duplicates */
+	send_packet_with_seq(sender, 0);
+	for (i = 1; i < packet_count; i += 8) {
+		int j;
+		for (j = 7; j >= 0; j--) {
+			if (i + j < packet_count) send_packet_with_seq(sender, (uint16_t)(i + j));
+		}
+		send_packet_with_seq(sender, (uint16_t)(i + 3));
+		duplicates++;
+	}
+
+	/* the first recv reads everything that is waiting on the socket */
+	BC_ASSERT_EQUAL(receive_seq(receiver, &recv_ts), 0, int, "%d");
+	BC_ASSERT_PTR_NULL(rtp_session_pick_with_cseq(receiver, 0));
+	picked = rtp_session_pick_with_cseq(receiver, 20);
+	if (BC_ASSERT_PTR_NOT_NULL(picked)) BC_ASSERT_EQUAL(rtp_get_seqnumber(picked), 20, int, "%d");
+	for (seq = 1; seq < packet_count; seq++) {
+		BC_ASSERT_EQUAL(receive_seq(receiver, &recv_ts), seq, int, "%d");
+	}
+	BC_ASSERT_EQUAL((int)rtp_session_get_stats(receiver)->packet_dup_recv, duplicates, int, "%d");
+
+	/* a jump in the sequence numbers too large to be indexed, with a late packet from before the jump */
+	send_packet_with_seq(sender, packet_count);
+	send_packet_with_seq(sender, 20000);
+	send_packet_with_seq(sender, packet_count + 1);
+	BC_ASSERT_EQUAL(receive_seq(receiver, &recv_ts), packet_count, int, "%d");
+	picked = rtp_session_pick_with_cseq(receiver, 20000);
+	if (BC_ASSERT_PTR_NOT_NULL(picked)) BC_ASSERT_EQUAL(rtp_get_seqnumber(picked), 20000, int, "%d");
+	BC_ASSERT_EQUAL(receive_seq(receiver, &recv_ts), packet_count + 1, int, "%d");
+	BC_ASSERT_EQUAL(receive_seq(receiver, &recv_ts), 20000, int, "%d");
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+}
+
 static test_t tests[] = {TEST_NO_TAG("Send packets through a transfer session", send_packets_through_tranfer_session),
-                         TEST_NO_TAG("Change remote address", change_remote_address)};
+                         TEST_NO_TAG("Change remote address", change_remote_address),
+                         TEST_NO_TAG("Batched reception", batched_reception),
+                         TEST_NO_TAG("Batched sending", batched_sending),
+                         TEST_NO_TAG("Batched sending to a single destination", batched_sending_segments),
+                         TEST_NO_TAG("Mblk pool", mblk_pool),
+                         TEST_NO_TAG("Sharded scheduler", sharded_scheduler),
+                         TEST_NO_TAG("Reordered reception", reordered_reception)};
 
 test_suite_t rtp_test_suite = {
     "Rtp",                            // Name of test suite